@@ -36,6 +36,7 @@
   */
 
 #include "pipe/p_state.h"
+#include "util/u_debug.h"
 #include "util/u_framebuffer.h"
 #include "util/u_inlines.h"
 #include "util/u_math.h"
@@ -48,6 +49,23 @@
 #include "cso_context.h"
 
 
+/**
+ * Number of entries per state type of the direct-mapped cache which is
+ * looked at before the cso_hash.  Must be a power of two.
+ */
+#define CSO_FRONT_CACHE_SIZE 16
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(cso_stats, "GALLIUM_CSO_STATS", FALSE)
+
+
+struct cso_front_entry
+{
+   unsigned hash_key;
+   void *cso;   /**< struct cso_blend etc, NULL if unused */
+};
+
+
 /**
  * Info related to samplers and sampler views.
  * We have one of these for fragment samplers and another for vertex samplers.
@@ -62,6 +80,9 @@ struct sampler_info
    void *samplers[PIPE_MAX_SAMPLERS];
    unsigned nr_samplers;
 
+   /** The cso objects of samplers[], where known */
+   struct cso_sampler *csos[PIPE_MAX_SAMPLERS];
+
    void *samplers_saved[PIPE_MAX_SAMPLERS];
    unsigned nr_samplers_saved;
 
@@ -97,6 +118,17 @@ struct cso_context {
    void *vertex_shader, *vertex_shader_saved, *geometry_shader_saved;
    void *velements, *velements_saved;
 
+   /** The cso objects of the bound blend, DSA and rasterizer states, so
+    * re-setting the same state can be detected without hashing.  NULL when
+    * not known.
+    */
+   struct cso_blend *blend_cso;
+   struct cso_depth_stencil_alpha *depth_stencil_cso;
+   struct cso_rasterizer *rasterizer_cso;
+
+   struct cso_front_entry front_cache[CSO_CACHE_MAX][CSO_FRONT_CACHE_SIZE];
+   struct cso_stats stats[CSO_CACHE_MAX];
+
    struct pipe_clip_state clip;
    struct pipe_clip_state clip_saved;
 
@@ -108,6 +140,63 @@ struct cso_context {
 };
 
 
+/**
+ * Find the cso object for a state template, first in the front cache and
+ * then in the hash table.  Returns NULL if there's none.
+ */
+static void *
+cso_lookup(struct cso_context *ctx, enum cso_cache_type type,
+           unsigned hash_key, const void *templ, unsigned key_size)
+{
+   struct cso_front_entry *entry =
+      &ctx->front_cache[type][hash_key & (CSO_FRONT_CACHE_SIZE - 1)];
+   struct cso_hash_iter iter;
+
+   if (entry->cso && entry->hash_key == hash_key &&
+       !memcmp(entry->cso, templ, key_size)) {
+      ctx->stats[type].front_hits++;
+      return entry->cso;
+   }
+
+   iter = cso_find_state_template(ctx->cache, hash_key, type,
+                                  (void *) templ, key_size);
+   if (cso_hash_iter_is_null(iter))
+      return NULL;
+
+   ctx->stats[type].hash_hits++;
+   entry->hash_key = hash_key;
+   entry->cso = cso_hash_iter_data(iter);
+   return entry->cso;
+}
+
+static INLINE void
+cso_front_cache_insert(struct cso_context *ctx, enum cso_cache_type type,
+                       unsigned hash_key, void *cso)
+{
+   struct cso_front_entry *entry =
+      &ctx->front_cache[type][hash_key & (CSO_FRONT_CACHE_SIZE - 1)];
+
+   entry->hash_key = hash_key;
+   entry->cso = cso;
+   ctx->stats[type].creates++;
+}
+
+/**
+ * Forget a cso object which is being deleted.
+ */
+static void
+cso_front_cache_remove(struct cso_context *ctx, enum cso_cache_type type,
+                       void *cso)
+{
+   unsigned i;
+
+   for (i = 0; i < CSO_FRONT_CACHE_SIZE; i++) {
+      if (ctx->front_cache[type][i].cso == cso)
+         ctx->front_cache[type][i].cso = NULL;
+   }
+}
+
+
 static boolean delete_blend_state(struct cso_context *ctx, void *state)
 {
    struct cso_blend *cso = (struct cso_blend *)state;
@@ -115,6 +204,7 @@ static boolean delete_blend_state(struct cso_context *ctx, void *state)
    if (ctx->blend == cso->data)
       return FALSE;
 
+   cso_front_cache_remove(ctx, CSO_BLEND, cso);
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -128,6 +218,7 @@ static boolean delete_depth_stencil_state(struct cso_context *ctx, void *state)
    if (ctx->depth_stencil == cso->data)
       return FALSE;
 
+   cso_front_cache_remove(ctx, CSO_DEPTH_STENCIL_ALPHA, cso);
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -138,6 +229,16 @@ static boolean delete_depth_stencil_state(struct cso_context *ctx, void *state)
 static boolean delete_sampler_state(struct cso_context *ctx, void *state)
 {
    struct cso_sampler *cso = (struct cso_sampler *)state;
+   unsigned i;
+
+   cso_front_cache_remove(ctx, CSO_SAMPLER, cso);
+   for (i = 0; i < PIPE_MAX_SAMPLERS; i++) {
+      if (ctx->fragment_samplers.csos[i] == cso)
+         ctx->fragment_samplers.csos[i] = NULL;
+      if (ctx->vertex_samplers.csos[i] == cso)
+         ctx->vertex_samplers.csos[i] = NULL;
+   }
+
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -150,6 +251,7 @@ static boolean delete_rasterizer_state(struct cso_context *ctx, void *state)
 
    if (ctx->rasterizer == cso->data)
       return FALSE;
+   cso_front_cache_remove(ctx, CSO_RASTERIZER, cso);
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -326,9 +428,45 @@ void cso_release_all( struct cso_context *ctx )
                             NULL, 0);
 
    if (ctx->cache) {
+      if (debug_get_option_cso_stats()) {
+         static const char *names[] = {
+            "rasterizer", "blend", "depth/stencil", "", "", "sampler"
+         };
+         static const enum cso_cache_type types[] = {
+            CSO_BLEND, CSO_DEPTH_STENCIL_ALPHA, CSO_RASTERIZER, CSO_SAMPLER
+         };
+
+         debug_printf("cso: %-14s %10s %10s %10s %10s %10s\n", "state",
+                      "sets", "bound", "front", "hash", "created");
+         for (i = 0; i < Elements(types); i++) {
+            const struct cso_stats *stats = &ctx->stats[types[i]];
+            debug_printf("cso: %-14s %10llu %10llu %10llu %10llu %10llu\n",
+                         names[types[i]],
+                         (unsigned long long) stats->sets,
+                         (unsigned long long) stats->bound_hits,
+                         (unsigned long long) stats->front_hits,
+                         (unsigned long long) stats->hash_hits,
+                         (unsigned long long) stats->creates);
+         }
+      }
+
       cso_cache_delete( ctx->cache );
       ctx->cache = NULL;
    }
+
+   ctx->blend_cso = NULL;
+   ctx->depth_stencil_cso = NULL;
+   ctx->rasterizer_cso = NULL;
+   memset(ctx->fragment_samplers.csos, 0, sizeof(ctx->fragment_samplers.csos));
+   memset(ctx->vertex_samplers.csos, 0, sizeof(ctx->vertex_samplers.csos));
+   memset(ctx->front_cache, 0, sizeof(ctx->front_cache));
+}
+
+
+void cso_get_stats(struct cso_context *ctx, enum cso_cache_type type,
+                   struct cso_stats *stats)
+{
+   *stats = ctx->stats[type];
 }
 
 
@@ -358,16 +496,23 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
                               const struct pipe_blend_state *templ)
 {
    unsigned key_size, hash_key;
-   struct cso_hash_iter iter;
+   struct cso_blend *cso;
    void *handle;
 
    key_size = templ->independent_blend_enable ? sizeof(struct pipe_blend_state) :
               (char *)&(templ->rt[1]) - (char *)templ;
+
+   ctx->stats[CSO_BLEND].sets++;
+   if (ctx->blend_cso && !memcmp(&ctx->blend_cso->state, templ, key_size)) {
+      ctx->stats[CSO_BLEND].bound_hits++;
+      return PIPE_OK;
+   }
+
    hash_key = cso_construct_key((void*)templ, key_size);
-   iter = cso_find_state_template(ctx->cache, hash_key, CSO_BLEND, (void*)templ, key_size);
+   cso = cso_lookup(ctx, CSO_BLEND, hash_key, templ, key_size);
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_blend *cso = MALLOC(sizeof(struct cso_blend));
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_blend));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -377,18 +522,17 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
       cso->delete_state = (cso_state_callback)ctx->pipe->delete_blend_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_BLEND, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (cso_hash_iter_is_null(cso_insert_state(ctx->cache, hash_key,
+                                                 CSO_BLEND, cso))) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      cso_front_cache_insert(ctx, CSO_BLEND, hash_key, cso);
    }
 
+   handle = cso->data;
+   ctx->blend_cso = cso;
+
    if (ctx->blend != handle) {
       ctx->blend = handle;
       ctx->pipe->bind_blend_state(ctx->pipe, handle);
@@ -406,6 +550,7 @@ void cso_restore_blend(struct cso_context *ctx)
 {
    if (ctx->blend != ctx->blend_saved) {
       ctx->blend = ctx->blend_saved;
+      ctx->blend_cso = NULL;
       ctx->pipe->bind_blend_state(ctx->pipe, ctx->blend_saved);
    }
    ctx->blend_saved = NULL;
@@ -417,15 +562,22 @@ enum pipe_error cso_set_depth_stencil_alpha(struct cso_context *ctx,
                                             const struct pipe_depth_stencil_alpha_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key, 
-                                                       CSO_DEPTH_STENCIL_ALPHA,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_depth_stencil_alpha *cso;
    void *handle;
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_depth_stencil_alpha *cso = MALLOC(sizeof(struct cso_depth_stencil_alpha));
+   ctx->stats[CSO_DEPTH_STENCIL_ALPHA].sets++;
+   if (ctx->depth_stencil_cso &&
+       !memcmp(&ctx->depth_stencil_cso->state, templ, key_size)) {
+      ctx->stats[CSO_DEPTH_STENCIL_ALPHA].bound_hits++;
+      return PIPE_OK;
+   }
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   cso = cso_lookup(ctx, CSO_DEPTH_STENCIL_ALPHA, hash_key, templ, key_size);
+
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_depth_stencil_alpha));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -434,18 +586,17 @@ enum pipe_error cso_set_depth_stencil_alpha(struct cso_context *ctx,
       cso->delete_state = (cso_state_callback)ctx->pipe->delete_depth_stencil_alpha_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_DEPTH_STENCIL_ALPHA, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (cso_hash_iter_is_null(cso_insert_state(ctx->cache, hash_key,
+                                                 CSO_DEPTH_STENCIL_ALPHA, cso))) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_depth_stencil_alpha *)cso_hash_iter_data(iter))->data;
+      cso_front_cache_insert(ctx, CSO_DEPTH_STENCIL_ALPHA, hash_key, cso);
    }
 
+   handle = cso->data;
+   ctx->depth_stencil_cso = cso;
+
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
       ctx->pipe->bind_depth_stencil_alpha_state(ctx->pipe, handle);
@@ -463,6 +614,7 @@ void cso_restore_depth_stencil_alpha(struct cso_context *ctx)
 {
    if (ctx->depth_stencil != ctx->depth_stencil_saved) {
       ctx->depth_stencil = ctx->depth_stencil_saved;
+      ctx->depth_stencil_cso = NULL;
       ctx->pipe->bind_depth_stencil_alpha_state(ctx->pipe, ctx->depth_stencil_saved);
    }
    ctx->depth_stencil_saved = NULL;
@@ -474,14 +626,22 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
                                    const struct pipe_rasterizer_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_rasterizer_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key, CSO_RASTERIZER,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_rasterizer *cso;
    void *handle = NULL;
 
-   if (cso_hash_iter_is_null(iter)) {
-      struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
+   ctx->stats[CSO_RASTERIZER].sets++;
+   if (ctx->rasterizer_cso &&
+       !memcmp(&ctx->rasterizer_cso->state, templ, key_size)) {
+      ctx->stats[CSO_RASTERIZER].bound_hits++;
+      return PIPE_OK;
+   }
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   cso = cso_lookup(ctx, CSO_RASTERIZER, hash_key, templ, key_size);
+
+   if (!cso) {
+      cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -490,18 +650,17 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
       cso->delete_state = (cso_state_callback)ctx->pipe->delete_rasterizer_state;
       cso->context = ctx->pipe;
 
-      iter = cso_insert_state(ctx->cache, hash_key, CSO_RASTERIZER, cso);
-      if (cso_hash_iter_is_null(iter)) {
+      if (cso_hash_iter_is_null(cso_insert_state(ctx->cache, hash_key,
+                                                 CSO_RASTERIZER, cso))) {
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
-   }
-   else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      cso_front_cache_insert(ctx, CSO_RASTERIZER, hash_key, cso);
    }
 
+   handle = cso->data;
+   ctx->rasterizer_cso = cso;
+
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
       ctx->pipe->bind_rasterizer_state(ctx->pipe, handle);
@@ -519,6 +678,7 @@ void cso_restore_rasterizer(struct cso_context *ctx)
 {
    if (ctx->rasterizer != ctx->rasterizer_saved) {
       ctx->rasterizer = ctx->rasterizer_saved;
+      ctx->rasterizer_cso = NULL;
       ctx->pipe->bind_rasterizer_state(ctx->pipe, ctx->rasterizer_saved);
    }
    ctx->rasterizer_saved = NULL;
@@ -976,18 +1136,25 @@ single_sampler(struct cso_context *ctx,
                unsigned idx,
                const struct pipe_sampler_state *templ)
 {
-   void *handle = NULL;
+   struct cso_sampler *cso = NULL;
 
    if (templ != NULL) {
       unsigned key_size = sizeof(struct pipe_sampler_state);
-      unsigned hash_key = cso_construct_key((void*)templ, key_size);
-      struct cso_hash_iter iter =
-         cso_find_state_template(ctx->cache,
-                                 hash_key, CSO_SAMPLER,
-                                 (void *) templ, key_size);
+      unsigned hash_key;
+
+      ctx->stats[CSO_SAMPLER].sets++;
+      if (info->csos[idx] &&
+          !memcmp(&info->csos[idx]->state, templ, key_size)) {
+         ctx->stats[CSO_SAMPLER].bound_hits++;
+         info->samplers[idx] = info->csos[idx]->data;
+         return PIPE_OK;
+      }
 
-      if (cso_hash_iter_is_null(iter)) {
-         struct cso_sampler *cso = MALLOC(sizeof(struct cso_sampler));
+      hash_key = cso_construct_key((void*)templ, key_size);
+      cso = cso_lookup(ctx, CSO_SAMPLER, hash_key, templ, key_size);
+
+      if (!cso) {
+         cso = MALLOC(sizeof(struct cso_sampler));
          if (!cso)
             return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -996,20 +1163,17 @@ single_sampler(struct cso_context *ctx,
          cso->delete_state = (cso_state_callback)ctx->pipe->delete_sampler_state;
          cso->context = ctx->pipe;
 
-         iter = cso_insert_state(ctx->cache, hash_key, CSO_SAMPLER, cso);
-         if (cso_hash_iter_is_null(iter)) {
+         if (cso_hash_iter_is_null(cso_insert_state(ctx->cache, hash_key,
+                                                    CSO_SAMPLER, cso))) {
             FREE(cso);
             return PIPE_ERROR_OUT_OF_MEMORY;
          }
-
-         handle = cso->data;
-      }
-      else {
-         handle = ((struct cso_sampler *)cso_hash_iter_data(iter))->data;
+         cso_front_cache_insert(ctx, CSO_SAMPLER, hash_key, cso);
       }
    }
 
-   info->samplers[idx] = handle;
+   info->csos[idx] = cso;
+   info->samplers[idx] = cso ? cso->data : NULL;
 
    return PIPE_OK;
 }
@@ -1163,6 +1327,7 @@ restore_samplers(struct cso_context *ctx, struct sampler_info *info)
 {
    info->nr_samplers = info->nr_samplers_saved;
    memcpy(info->samplers, info->samplers_saved, sizeof(info->samplers));
+   memset(info->csos, 0, sizeof(info->csos));
    single_sampler_done(ctx, info);
 }
 
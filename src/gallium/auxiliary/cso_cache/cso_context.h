@@ -32,6 +32,7 @@
 #include "pipe/p_context.h"
 #include "pipe/p_state.h"
 #include "pipe/p_defines.h"
+#include "cso_cache/cso_cache.h"
 
 
 #ifdef	__cplusplus
@@ -40,12 +41,28 @@ extern "C" {
 
 struct cso_context;
 
+/**
+ * Counters of the cso_set_* calls for one state type.  They're printed by
+ * cso_release_all() when GALLIUM_CSO_STATS is set.
+ */
+struct cso_stats
+{
+   uint64_t sets;         /**< calls */
+   uint64_t bound_hits;   /**< same as the bound state, nothing to do */
+   uint64_t front_hits;   /**< found in the front cache */
+   uint64_t hash_hits;    /**< found in the cso_hash */
+   uint64_t creates;      /**< new state objects */
+};
+
 struct cso_context *cso_create_context( struct pipe_context *pipe );
 
 void cso_release_all( struct cso_context *ctx );
 
 void cso_destroy_context( struct cso_context *cso );
 
+void cso_get_stats(struct cso_context *cso, enum cso_cache_type type,
+                   struct cso_stats *stats);
+
 
 
 enum pipe_error cso_set_blend( struct cso_context *cso,
@@ -163,6 +163,36 @@ struct pb_manager *
 pb_cache_manager_create(struct pb_manager *provider, 
                      	unsigned usecs); 
 
+/**
+ * Like pb_cache_manager_create(), but the least recently used buffers are
+ * destroyed early when the cached buffers take more than
+ * \p maximum_cache_size bytes.
+ */
+struct pb_manager *
+pb_cache_manager_create_limited(struct pb_manager *provider,
+                                unsigned usecs,
+                                pb_size maximum_cache_size);
+
+
+/**
+ * Buffer cache counters, see pb_cache_manager_get_stats().  Setting
+ * GALLIUM_PB_CACHE_STATS prints them when the manager is destroyed.
+ */
+struct pb_cache_stats
+{
+   uint64_t hits;        /**< buffers reused */
+   uint64_t misses;      /**< buffers created by the provider */
+   uint64_t busy;        /**< lookups stopped by a buffer still in use */
+   uint64_t expired;     /**< buffers destroyed after the time interval */
+   uint64_t evicted;     /**< buffers destroyed to stay within the limit */
+   pb_size num_buffers;  /**< buffers currently cached */
+   pb_size cache_size;   /**< bytes currently cached */
+};
+
+void
+pb_cache_manager_get_stats(struct pb_manager *mgr,
+                           struct pb_cache_stats *stats);
+
 
 struct pb_fence_ops;
 
@@ -39,6 +39,7 @@
 #include "os/os_thread.h"
 #include "util/u_memory.h"
 #include "util/u_double_list.h"
+#include "util/u_math.h"
 #include "util/u_time.h"
 
 #include "pb_buffer.h"
@@ -51,6 +52,17 @@
 #define SUPER(__derived) (&(__derived)->base)
 
 
+/**
+ * Cached buffers are also sorted into buckets by util_logbase2(size), so a
+ * request only has to look at the two buckets which can hold buffers of
+ * size [size, 2*size).
+ */
+#define PB_CACHE_NUM_BUCKETS 32
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(pb_cache_stats, "GALLIUM_PB_CACHE_STATS", FALSE)
+
+
 struct pb_cache_manager;
 
 
@@ -67,7 +79,11 @@ struct pb_cache_buffer
    /** Caching time interval */
    int64_t start, end;
 
+   /** In pb_cache_manager::delayed */
    struct list_head head;
+
+   /** In pb_cache_manager::buckets */
+   struct list_head bucket_head;
 };
 
 
@@ -77,11 +93,21 @@ struct pb_cache_manager
 
    struct pb_manager *provider;
    unsigned usecs;
+
+   /** Limit of cache_size, or zero for no limit */
+   pb_size maximum_cache_size;
    
    pipe_mutex mutex;
    
+   /** All cached buffers, least recently destroyed first */
    struct list_head delayed;
    pb_size numDelayed;
+   pb_size cache_size;
+
+   /** The same buffers by size, least recently destroyed first */
+   struct list_head buckets[PB_CACHE_NUM_BUCKETS];
+
+   struct pb_cache_stats stats;
 };
 
 
@@ -110,8 +136,10 @@ _pb_cache_buffer_destroy(struct pb_cache_buffer *buf)
    struct pb_cache_manager *mgr = buf->mgr;
 
    LIST_DEL(&buf->head);
+   LIST_DEL(&buf->bucket_head);
    assert(mgr->numDelayed);
    --mgr->numDelayed;
+   mgr->cache_size -= buf->base.size;
    assert(!pipe_is_referenced(&buf->base.reference));
    pb_reference(&buf->buffer, NULL);
    FREE(buf);
@@ -139,6 +167,7 @@ _pb_cache_buffer_list_check_free(struct pb_cache_manager *mgr)
 	 break;
 	 
       _pb_cache_buffer_destroy(buf);
+      ++mgr->stats.expired;
 
       curr = next; 
       next = curr->next;
@@ -160,7 +189,18 @@ pb_cache_buffer_destroy(struct pb_buffer *_buf)
    buf->start = os_time_get();
    buf->end = buf->start + mgr->usecs;
    LIST_ADDTAIL(&buf->head, &mgr->delayed);
+   LIST_ADDTAIL(&buf->bucket_head,
+                &mgr->buckets[util_logbase2(buf->base.size)]);
    ++mgr->numDelayed;
+   mgr->cache_size += buf->base.size;
+
+   /* Over budget: drop the least recently used buffers */
+   while(mgr->maximum_cache_size &&
+         mgr->cache_size > mgr->maximum_cache_size) {
+      _pb_cache_buffer_destroy(LIST_ENTRY(struct pb_cache_buffer,
+                                          mgr->delayed.next, head));
+      ++mgr->stats.evicted;
+   }
    pipe_mutex_unlock(mgr->mutex);
 }
 
@@ -256,6 +296,43 @@ pb_cache_is_buffer_compat(struct pb_cache_buffer *buf,
 }
 
 
+/**
+ * Find a reusable buffer.  Buffers in a bucket were destroyed in order, so
+ * when one is still busy the ones after it most likely are too.
+ */
+static struct pb_cache_buffer *
+pb_cache_find_buffer(struct pb_cache_manager *mgr,
+                     pb_size size,
+                     const struct pb_desc *desc)
+{
+   const unsigned first = util_logbase2(size);
+   unsigned bucket;
+
+   for(bucket = first;
+       bucket <= first + 1 && bucket < PB_CACHE_NUM_BUCKETS;
+       ++bucket) {
+      struct list_head *curr;
+
+      for(curr = mgr->buckets[bucket].next;
+          curr != &mgr->buckets[bucket];
+          curr = curr->next) {
+         struct pb_cache_buffer *buf =
+            LIST_ENTRY(struct pb_cache_buffer, curr, bucket_head);
+         int ret = pb_cache_is_buffer_compat(buf, size, desc);
+
+         if (ret > 0)
+            return buf;
+         if (ret == -1) {
+            ++mgr->stats.busy;
+            break;
+         }
+      }
+   }
+
+   return NULL;
+}
+
+
 static struct pb_buffer *
 pb_cache_manager_create_buffer(struct pb_manager *_mgr, 
                                pb_size size,
@@ -263,60 +340,26 @@ pb_cache_manager_create_buffer(struct pb_manager *_mgr,
 {
    struct pb_cache_manager *mgr = pb_cache_manager(_mgr);
    struct pb_cache_buffer *buf;
-   struct pb_cache_buffer *curr_buf;
-   struct list_head *curr, *next;
-   int64_t now;
-   int ret = 0;
 
    pipe_mutex_lock(mgr->mutex);
 
-   buf = NULL;
-   curr = mgr->delayed.next;
-   next = curr->next;
-   
-   /* search in the expired buffers, freeing them in the process */
-   now = os_time_get();
-   while(curr != &mgr->delayed) {
-      curr_buf = LIST_ENTRY(struct pb_cache_buffer, curr, head);
-      if(!buf && (ret = pb_cache_is_buffer_compat(curr_buf, size, desc) > 0))
-         buf = curr_buf;
-      else if(os_time_timeout(curr_buf->start, curr_buf->end, now))
-         _pb_cache_buffer_destroy(curr_buf);
-      else
-         /* This buffer (and all hereafter) are still hot in cache */
-         break;
-      if (ret == -1)
-         break;
-      curr = next; 
-      next = curr->next;
-   }
+   _pb_cache_buffer_list_check_free(mgr);
 
-   /* keep searching in the hot buffers */
-   if(!buf && ret != -1) {
-      while(curr != &mgr->delayed) {
-         curr_buf = LIST_ENTRY(struct pb_cache_buffer, curr, head);
-         ret = pb_cache_is_buffer_compat(curr_buf, size, desc);
-         if (ret > 0) {
-            buf = curr_buf;
-            break;
-         }
-         if (ret == -1)
-            break;
-         /* no need to check the timeout here */
-         curr = next;
-         next = curr->next;
-      }
-   }
+   buf = pb_cache_find_buffer(mgr, size, desc);
    
    if(buf) {
       LIST_DEL(&buf->head);
+      LIST_DEL(&buf->bucket_head);
       --mgr->numDelayed;
+      mgr->cache_size -= buf->base.size;
+      ++mgr->stats.hits;
       pipe_mutex_unlock(mgr->mutex);
       /* Increase refcount */
       pipe_reference_init(&buf->base.reference, 1);
       return &buf->base;
    }
    
+   ++mgr->stats.misses;
    pipe_mutex_unlock(mgr->mutex);
 
    buf = CALLOC_STRUCT(pb_cache_buffer);
@@ -370,9 +413,36 @@ pb_cache_manager_flush(struct pb_manager *_mgr)
 }
 
 
+void
+pb_cache_manager_get_stats(struct pb_manager *_mgr,
+                           struct pb_cache_stats *stats)
+{
+   struct pb_cache_manager *mgr = pb_cache_manager(_mgr);
+
+   pipe_mutex_lock(mgr->mutex);
+   *stats = mgr->stats;
+   stats->num_buffers = mgr->numDelayed;
+   stats->cache_size = mgr->cache_size;
+   pipe_mutex_unlock(mgr->mutex);
+}
+
+
 static void
 pb_cache_manager_destroy(struct pb_manager *mgr)
 {
+   if (debug_get_option_pb_cache_stats()) {
+      struct pb_cache_stats stats;
+
+      pb_cache_manager_get_stats(mgr, &stats);
+      debug_printf("pb_cache: %llu hits, %llu misses, %llu busy, "
+                   "%llu expired, %llu evicted\n",
+                   (unsigned long long) stats.hits,
+                   (unsigned long long) stats.misses,
+                   (unsigned long long) stats.busy,
+                   (unsigned long long) stats.expired,
+                   (unsigned long long) stats.evicted);
+   }
+
    pb_cache_manager_flush(mgr);
    FREE(mgr);
 }
@@ -381,8 +451,18 @@ pb_cache_manager_destroy(struct pb_manager *mgr)
 struct pb_manager *
 pb_cache_manager_create(struct pb_manager *provider, 
                      	unsigned usecs) 
+{
+   return pb_cache_manager_create_limited(provider, usecs, 0);
+}
+
+
+struct pb_manager *
+pb_cache_manager_create_limited(struct pb_manager *provider,
+                                unsigned usecs,
+                                pb_size maximum_cache_size)
 {
    struct pb_cache_manager *mgr;
+   unsigned i;
 
    if(!provider)
       return NULL;
@@ -396,8 +476,11 @@ pb_cache_manager_create(struct pb_manager *provider,
    mgr->base.flush = pb_cache_manager_flush;
    mgr->provider = provider;
    mgr->usecs = usecs;
+   mgr->maximum_cache_size = maximum_cache_size;
    LIST_INITHEAD(&mgr->delayed);
    mgr->numDelayed = 0;
+   for (i = 0; i < PB_CACHE_NUM_BUCKETS; i++)
+      LIST_INITHEAD(&mgr->buckets[i]);
    pipe_mutex_init(mgr->mutex);
       
    return &mgr->base;
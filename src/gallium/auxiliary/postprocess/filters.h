@@ -29,6 +29,8 @@
 #define PP_EXTERNAL_FILTERS_H
 
 #include "postprocess/postprocess.h"
+#include "postprocess/pp_celshade.h"
+#include "postprocess/pp_colors.h"
 
 typedef void (*pp_init_func) (struct pp_queue_t *, unsigned int,
                               unsigned int);
@@ -41,18 +43,22 @@ struct pp_filter_t
    unsigned int verts;          /* How many are vertex shaders */
    pp_init_func init;           /* Init function */
    pp_func main;                /* Run function */
+   const char *pixel_fs;        /* Shader of a pixel-local filter, see pp_fuse.c */
 };
 
-/*	Order matters. Put new filters in a suitable place. */
+/*	Order matters. Put new filters in a suitable place.
+ *
+ *	Consecutive enabled filters with a pixel_fs are run as a single pass
+ *	with pp_nocolor, with their shaders fused by pp_fuse_shaders. */
 
 static const struct pp_filter_t pp_filters[PP_FILTERS] = {
-/*    name			inner	shaders	verts	init			run */
-   { "pp_noblue",		0,	2,	1,	pp_noblue_init,		pp_nocolor },
-   { "pp_nogreen",		0,	2,	1,	pp_nogreen_init,	pp_nocolor },
-   { "pp_nored",		0,	2,	1,	pp_nored_init,		pp_nocolor },
-   { "pp_celshade",		0,	2,	1,	pp_celshade_init,	pp_nocolor },
-   { "pp_jimenezmlaa",		2,	5,	2,	pp_jimenezmlaa_init,	pp_jimenezmlaa },
-   { "pp_jimenezmlaa_color",	2,	5,	2,	pp_jimenezmlaa_init_color, pp_jimenezmlaa_color },
+/*    name			inner	shaders	verts	init			run			pixel_fs */
+   { "pp_noblue",		0,	2,	1,	pp_noblue_init,		pp_nocolor,		noblue },
+   { "pp_nogreen",		0,	2,	1,	pp_nogreen_init,	pp_nocolor,		nogreen },
+   { "pp_nored",		0,	2,	1,	pp_nored_init,		pp_nocolor,		nored },
+   { "pp_celshade",		0,	2,	1,	pp_celshade_init,	pp_nocolor,		celshade },
+   { "pp_jimenezmlaa",		2,	5,	2,	pp_jimenezmlaa_init,	pp_jimenezmlaa,		NULL },
+   { "pp_jimenezmlaa_color",	2,	5,	2,	pp_jimenezmlaa_init_color, pp_jimenezmlaa_color,	NULL },
 };
 
 #endif
@@ -32,6 +32,7 @@
 
 #define PP_FILTERS 6            /* Increment this if you add filters */
 #define PP_MAX_PASSES 6
+#define PP_TIMING_FRAMES 100    /* Frames between two timing reports */
 
 struct pp_queue_t;              /* Forward definition */
 
@@ -60,6 +61,13 @@ struct pp_queue_t
    unsigned int *verts;
    struct program *p;
 
+   const char **names;          /* First filter run by each pp_func */
+   unsigned int *fused;         /* Number of filters run by each pp_func */
+
+   bool timing;                 /* PP_TIMING: measure each pp_func */
+   uint64_t *times;             /* Microseconds spent in each pp_func */
+   unsigned int frames;         /* Frames measured in times */
+
    bool fbos_init;
 };
 
@@ -74,6 +82,7 @@ void pp_debug(const char *, ...);
 struct program *pp_init_prog(struct pp_queue_t *, struct pipe_screen *);
 void pp_init_fbos(struct pp_queue_t *, unsigned int, unsigned int,
                   struct pipe_resource *);
+char *pp_fuse_shaders(const char *const *, unsigned int);
 
 /* The filters */
 
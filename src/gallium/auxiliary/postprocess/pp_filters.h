@@ -43,6 +43,10 @@
 
 /* Helper functions for the filters */
 
+struct pipe_sampler_view *pp_get_view(struct program *,
+                                      struct pipe_resource *);
+struct pipe_surface *pp_get_surface(struct program *, struct pipe_resource *);
+void pp_release_cached_views(struct program *);
 void pp_filter_setup_in(struct program *, struct pipe_resource *);
 void pp_filter_setup_out(struct program *, struct pipe_resource *);
 void pp_filter_end_pass(struct program *);
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Fusing of pixel-local filters.
+ *
+ * A pixel-local filter is a single pass whose fragment shader samples the
+ * input once, at its own pixel, in its first instruction:
+ *
+ *    TEX TEMP[0], IN[0].xyyy, SAMP[0], 2D
+ *
+ * and computes OUT[0] from TEMP[0] alone. Consecutive filters of this kind
+ * are run as a single pass by chaining their shaders: the temporaries and
+ * immediates of each shader are renumbered after those of the previous
+ * ones, the output of a shader is written to the TEMP[0] of the next one
+ * instead of OUT[0], and the TEX of the next one is dropped. This saves a
+ * full-screen pass and a temporary buffer per fused filter.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "postprocess/postprocess.h"
+#include "postprocess/pp_filters.h"
+#include "util/u_memory.h"
+#include "util/u_string.h"
+
+
+struct pp_fuse_info
+{
+   unsigned int num_temps;
+   unsigned int num_imms;
+   unsigned int num_insts;      /* Not counting END */
+};
+
+struct pp_fuse_buf
+{
+   char *data;
+   unsigned int size;
+   unsigned int used;
+};
+
+
+static bool
+pp_fuse_match(const char *s, const char *prefix)
+{
+   return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+/** Skip the leading white space and instruction label of a line. */
+static const char *
+pp_fuse_skip_label(const char *s)
+{
+   const char *t;
+
+   while (*s == ' ' || *s == '\t')
+      s++;
+
+   for (t = s; *t >= '0' && *t <= '9'; t++);
+   if (t != s && *t == ':') {
+      s = t + 1;
+      while (*s == ' ' || *s == '\t')
+         s++;
+   }
+
+   return s;
+}
+
+static bool
+pp_fuse_is_end(const char *s, unsigned int len)
+{
+   return len >= 3 && pp_fuse_match(s, "END") &&
+      (len == 3 || s[3] == ' ' || s[3] == '\t' || s[3] == '\r');
+}
+
+static bool
+pp_fuse_contains(const char *s, unsigned int len, const char *what)
+{
+   unsigned int n = strlen(what), i;
+
+   for (i = 0; i + n <= len; i++) {
+      if (strncmp(s + i, what, n) == 0)
+         return true;
+   }
+   return false;
+}
+
+/** Check that a shader is pixel-local and count what it declares. */
+static bool
+pp_fuse_scan(const char *text, struct pp_fuse_info *info)
+{
+   const char *line = text;
+
+   memset(info, 0, sizeof(*info));
+
+   while (*line) {
+      const char *end = strchr(line, '\n');
+      const char *s = pp_fuse_skip_label(line);
+      unsigned int len;
+
+      if (!end)
+         end = line + strlen(line);
+      len = end > s ? end - s : 0;
+
+      if (!len || pp_fuse_match(s, "FRAG") || pp_fuse_match(s, "PROPERTY")) {
+         /* Nothing to do */
+      } else if (pp_fuse_match(s, "DCL TEMP[")) {
+         unsigned int last = strtoul(s + 9, (char **) &s, 10);
+
+         if (s[0] == '.' && s[1] == '.')
+            last = strtoul(s + 2, NULL, 10);
+         info->num_temps = last + 1;
+      } else if (pp_fuse_match(s, "DCL IN[0]") ||
+                 pp_fuse_match(s, "DCL OUT[0]") ||
+                 pp_fuse_match(s, "DCL SAMP[0]")) {
+         /* Same in all the shaders */
+      } else if (pp_fuse_match(s, "DCL")) {
+         return false;
+      } else if (pp_fuse_match(s, "IMM")) {
+         info->num_imms++;
+      } else if (pp_fuse_is_end(s, len)) {
+         return info->num_insts > 1;
+      } else if (info->num_insts == 0) {
+         if (!pp_fuse_match(s, "TEX TEMP[0], IN[0]") ||
+             !pp_fuse_contains(s, len, "SAMP[0]"))
+            return false;
+         info->num_insts++;
+      } else {
+         if (pp_fuse_contains(s, len, "IN[") ||
+             pp_fuse_contains(s, len, "SAMP["))
+            return false;
+         info->num_insts++;
+      }
+
+      line = *end ? end + 1 : end;
+   }
+
+   return false;
+}
+
+static void
+pp_fuse_append(struct pp_fuse_buf *buf, const char *s, unsigned int len)
+{
+   assert(buf->used + len < buf->size);
+   memcpy(buf->data + buf->used, s, len);
+   buf->used += len;
+   buf->data[buf->used] = '\0';
+}
+
+static void
+pp_fuse_append_uint(struct pp_fuse_buf *buf, unsigned int val)
+{
+   char tmp[16];
+
+   util_snprintf(tmp, sizeof(tmp), "%u", val);
+   pp_fuse_append(buf, tmp, strlen(tmp));
+}
+
+/**
+ * Copy an instruction, adding the bases to its register indices and branch
+ * labels, and replacing OUT[0] by TEMP[out] if out isn't ~0.
+ */
+static void
+pp_fuse_emit_inst(struct pp_fuse_buf *buf, const char *s, unsigned int len,
+                  unsigned int temp_base, unsigned int imm_base,
+                  unsigned int inst_base, unsigned int out)
+{
+   const char *end = s + len;
+   char *next;
+
+   while (s < end) {
+      if (pp_fuse_match(s, "TEMP[")) {
+         pp_fuse_append(buf, "TEMP[", 5);
+         pp_fuse_append_uint(buf, strtoul(s + 5, &next, 10) + temp_base);
+         s = next;
+      } else if (pp_fuse_match(s, "IMM[")) {
+         pp_fuse_append(buf, "IMM[", 4);
+         pp_fuse_append_uint(buf, strtoul(s + 4, &next, 10) + imm_base);
+         s = next;
+      } else if (out != ~0u && pp_fuse_match(s, "OUT[0]")) {
+         pp_fuse_append(buf, "TEMP[", 5);
+         pp_fuse_append_uint(buf, out);
+         pp_fuse_append(buf, "]", 1);
+         s += 6;
+      } else if (*s == ':') {
+         pp_fuse_append(buf, ":", 1);
+         pp_fuse_append_uint(buf, strtoul(s + 1, &next, 10) + inst_base);
+         s = next;
+      } else {
+         pp_fuse_append(buf, s, 1);
+         s++;
+      }
+   }
+}
+
+/**
+ * Chain the fragment shaders of \p count pixel-local filters into one.
+ * Returns the TGSI text of the fused shader, to be freed with FREE, or
+ * NULL if one of the shaders isn't pixel-local.
+ */
+char *
+pp_fuse_shaders(const char *const *texts, unsigned int count)
+{
+   static const char header[] = "FRAG\n"
+      "PROPERTY FS_COLOR0_WRITES_ALL_CBUFS 1\n"
+      "DCL IN[0], GENERIC[0], PERSPECTIVE\n"
+      "DCL OUT[0], COLOR\n"
+      "DCL SAMP[0]\n";
+   struct pp_fuse_info info[PP_FILTERS];
+   struct pp_fuse_buf buf;
+   unsigned int i, temp_base, inst_base, num_temps = 0, size = 0;
+
+   if (count < 2 || count > PP_FILTERS)
+      return NULL;
+
+   for (i = 0; i < count; i++) {
+      if (!pp_fuse_scan(texts[i], &info[i]))
+         return NULL;
+      num_temps += info[i].num_temps;
+      size += strlen(texts[i]);
+   }
+
+   /* Renumbering grows a register index or label by a few digits at most. */
+   buf.size = sizeof(header) + 2 * size + 64;
+   buf.data = MALLOC(buf.size);
+   buf.used = 0;
+   if (!buf.data)
+      return NULL;
+
+   pp_fuse_append(&buf, header, strlen(header));
+   pp_fuse_append(&buf, "DCL TEMP[0..", 12);
+   pp_fuse_append_uint(&buf, num_temps - 1);
+   pp_fuse_append(&buf, "]\n", 2);
+
+   /* Immediates are numbered in declaration order. */
+   for (i = 0; i < count; i++) {
+      const char *line = texts[i];
+
+      while (*line) {
+         const char *end = strchr(line, '\n');
+         const char *s = pp_fuse_skip_label(line);
+
+         if (!end)
+            end = line + strlen(line);
+         if (pp_fuse_match(s, "IMM")) {
+            pp_fuse_append(&buf, s, end - s);
+            pp_fuse_append(&buf, "\n", 1);
+         }
+         line = *end ? end + 1 : end;
+      }
+   }
+
+   temp_base = inst_base = 0;
+   for (i = 0; i < count; i++) {
+      const char *line = texts[i];
+      unsigned int imm_base = 0, out = ~0u, n = 0, j;
+
+      for (j = 0; j < i; j++)
+         imm_base += info[j].num_imms;
+      if (i + 1 < count)
+         out = temp_base + info[i].num_temps;
+
+      while (*line && n < info[i].num_insts) {
+         const char *end = strchr(line, '\n');
+         const char *s = pp_fuse_skip_label(line);
+
+         if (!end)
+            end = line + strlen(line);
+
+         if (end > s && !pp_fuse_match(s, "FRAG") &&
+             !pp_fuse_match(s, "PROPERTY") && !pp_fuse_match(s, "DCL") &&
+             !pp_fuse_match(s, "IMM")) {
+            /* The input of all but the first shader is already in TEMP[0]. */
+            if (n > 0 || i == 0) {
+               pp_fuse_append_uint(&buf, inst_base + n - (i ? 1 : 0));
+               pp_fuse_append(&buf, ": ", 2);
+               pp_fuse_emit_inst(&buf, s, end - s, temp_base, imm_base,
+                                 inst_base - (i ? 1 : 0), out);
+               pp_fuse_append(&buf, "\n", 1);
+            }
+            n++;
+         }
+         line = *end ? end + 1 : end;
+      }
+
+      temp_base += info[i].num_temps;
+      inst_base += info[i].num_insts - (i ? 1 : 0);
+   }
+
+   pp_fuse_append_uint(&buf, inst_base);
+   pp_fuse_append(&buf, ": END\n", 6);
+
+   return buf.data;
+}
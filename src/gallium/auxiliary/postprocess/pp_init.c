@@ -28,6 +28,7 @@
 #include "pipe/p_compiler.h"
 
 #include "postprocess/filters.h"
+#include "postprocess/pp_filters.h"
 
 #include "pipe/p_screen.h"
 #include "util/u_inlines.h"
@@ -37,12 +38,56 @@
 #include "util/u_memory.h"
 #include "cso_cache/cso_context.h"
 
+/**
+ * Fuse the enabled pixel-local filters following pp_filters[first] into
+ * the queue entry n. Returns the number of filters fused and sets *last to
+ * the last of them, or returns 0 if there is nothing to fuse or fusing
+ * failed.
+ */
+static unsigned int
+pp_init_fused(struct pp_queue_t *ppq, unsigned int n,
+              const unsigned int *enabled, unsigned int first,
+              unsigned int *last)
+{
+   const char *texts[PP_FILTERS];
+   unsigned int count = 0, i;
+   char *text;
+
+   for (i = first; i < PP_FILTERS; i++) {
+      if (!enabled[i])
+         continue;
+      if (!pp_filters[i].pixel_fs)
+         break;
+
+      texts[count++] = pp_filters[i].pixel_fs;
+      *last = i;
+   }
+   if (count < 2)
+      return 0;
+
+   text = pp_fuse_shaders(texts, count);
+   if (!text) {
+      pp_debug("Failed to fuse %s with the following filters\n",
+               pp_filters[first].name);
+      return 0;
+   }
+
+   ppq->shaders[n][1] = pp_tgsi_to_state(ppq->p->pipe, text, false, "fused");
+   FREE(text);
+   if (!ppq->shaders[n][1])
+      return 0;
+
+   pp_debug("Fused %u filters starting with %s\n", count,
+            pp_filters[first].name);
+   return count;
+}
+
 /** Initialize the post-processing queue. */
 struct pp_queue_t *
 pp_init(struct pipe_screen *pscreen, const unsigned int *enabled)
 {
 
-   unsigned int curpos = 0, i, tmp_req = 0;
+   unsigned int curpos = 0, i, last, tmp_req = 0;
    struct pp_queue_t *ppq;
    pp_func *tmp_q;
 
@@ -60,8 +105,12 @@ pp_init(struct pipe_screen *pscreen, const unsigned int *enabled)
    tmp_q = CALLOC(curpos, sizeof(pp_func));
    ppq->shaders = CALLOC(curpos, sizeof(void *));
    ppq->verts = CALLOC(curpos, sizeof(unsigned int));
+   ppq->names = CALLOC(curpos, sizeof(const char *));
+   ppq->fused = CALLOC(curpos, sizeof(unsigned int));
+   ppq->times = CALLOC(curpos, sizeof(uint64_t));
 
-   if (!tmp_q || !ppq || !ppq->shaders || !ppq->verts)
+   if (!tmp_q || !ppq || !ppq->shaders || !ppq->verts || !ppq->names ||
+       !ppq->fused || !ppq->times)
       goto error;
 
    ppq->p = pp_init_prog(ppq, pscreen);
@@ -83,7 +132,15 @@ pp_init(struct pipe_screen *pscreen, const unsigned int *enabled)
             if (!ppq->shaders[curpos])
                goto error;
          }
-         pp_filters[i].init(ppq, curpos, enabled[i]);
+
+         ppq->names[curpos] = pp_filters[i].name;
+         ppq->fused[curpos] = pp_init_fused(ppq, curpos, enabled, i, &last);
+         if (ppq->fused[curpos]) {
+            i = last;
+         } else {
+            ppq->fused[curpos] = 1;
+            pp_filters[i].init(ppq, curpos, enabled[i]);
+         }
 
          curpos++;
       }
@@ -98,6 +155,7 @@ pp_init(struct pipe_screen *pscreen, const unsigned int *enabled)
    ppq->n_inner_tmp = tmp_req;
 
    ppq->fbos_init = false;
+   ppq->timing = debug_get_bool_option("PP_TIMING", FALSE);
 
    for (i = 0; i < curpos; i++)
       ppq->shaders[i][0] = ppq->p->passvs;
@@ -138,6 +196,8 @@ pp_free_fbos(struct pp_queue_t *ppq)
    pipe_surface_reference(&ppq->stencils, NULL);
    pipe_resource_reference(&ppq->stencil, NULL);
 
+   pp_release_cached_views(ppq->p);
+
    ppq->fbos_init = false;
 }
 
@@ -149,6 +209,7 @@ pp_free(struct pp_queue_t *ppq)
    unsigned int i, j;
 
    pp_free_fbos(ppq);
+   pp_release_cached_views(ppq->p);
 
    util_destroy_blit(ppq->p->blitctx);
 
@@ -173,6 +234,9 @@ pp_free(struct pp_queue_t *ppq)
 
    FREE(ppq->p);
    FREE(ppq->pp_queue);
+   FREE(ppq->names);
+   FREE(ppq->fused);
+   FREE(ppq->times);
    FREE(ppq);
 
    pp_debug("Queue taken down.\n");
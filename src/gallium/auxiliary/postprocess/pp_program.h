@@ -31,6 +31,8 @@
 
 #include "pipe/p_state.h"
 
+#define PP_MAX_CACHED_VIEWS 8
+
 /**
 *	Internal control details.
 */
@@ -57,6 +59,12 @@ struct program
    struct pipe_surface surf;
    struct pipe_sampler_view *view;
 
+   /* Sampler views and surfaces of the pass inputs and outputs, kept
+    * across frames. See pp_get_view and pp_get_surface. */
+   struct pipe_sampler_view *cached_views[PP_MAX_CACHED_VIEWS];
+   struct pipe_surface *cached_surfs[PP_MAX_CACHED_VIEWS];
+   unsigned int next_view, next_surf;
+
    struct blit_state *blitctx;
 };
 
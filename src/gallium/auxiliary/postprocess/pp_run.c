@@ -28,10 +28,75 @@
 #include "postprocess.h"
 
 #include "postprocess/pp_filters.h"
+#include "pipe/p_screen.h"
+#include "os/os_time.h"
 #include "util/u_blit.h"
+#include "util/u_debug.h"
 #include "util/u_inlines.h"
 #include "util/u_sampler.h"
 
+/** Run one pp_func. With PP_TIMING, wait for it and measure it. */
+static void
+pp_run_filter(struct pp_queue_t *ppq, unsigned int n,
+              struct pipe_resource *in, struct pipe_resource *out)
+{
+   struct pipe_screen *screen = ppq->p->screen;
+   struct pipe_fence_handle *fence = NULL;
+   int64_t start;
+
+   if (!ppq->timing) {
+      ppq->pp_queue[n] (ppq, in, out, n);
+      return;
+   }
+
+   start = os_time_get();
+   ppq->pp_queue[n] (ppq, in, out, n);
+
+   ppq->p->pipe->flush(ppq->p->pipe, &fence);
+   if (fence) {
+      screen->fence_finish(screen, fence, PIPE_TIMEOUT_INFINITE);
+      screen->fence_reference(screen, &fence, NULL);
+   }
+
+   ppq->times[n] += os_time_get() - start;
+}
+
+/** Print the average time of each pp_func every PP_TIMING_FRAMES frames. */
+static void
+pp_report_timing(struct pp_queue_t *ppq)
+{
+   unsigned int i;
+
+   if (++ppq->frames < PP_TIMING_FRAMES)
+      return;
+
+   for (i = 0; i < ppq->n_filters; i++) {
+      if (ppq->fused[i] > 1)
+         debug_printf("pp: %s and %u more (fused): %.3f ms\n", ppq->names[i],
+                      ppq->fused[i] - 1,
+                      ppq->times[i] / 1000.0 / ppq->frames);
+      else
+         debug_printf("pp: %s: %.3f ms\n", ppq->names[i],
+                      ppq->times[i] / 1000.0 / ppq->frames);
+      ppq->times[i] = 0;
+   }
+   ppq->frames = 0;
+}
+
+/** Drop the cached views and surfaces of a resource. */
+static void
+pp_release_resource_views(struct program *p, struct pipe_resource *res)
+{
+   unsigned int i;
+
+   for (i = 0; i < PP_MAX_CACHED_VIEWS; i++) {
+      if (p->cached_views[i] && p->cached_views[i]->texture == res)
+         pipe_sampler_view_reference(&p->cached_views[i], NULL);
+      if (p->cached_surfs[i] && p->cached_surfs[i]->texture == res)
+         pipe_surface_reference(&p->cached_surfs[i], NULL);
+   }
+}
+
 /**
 *	Main run function of the PP queue. Called on swapbuffers/flush.
 *
@@ -43,6 +108,7 @@ pp_run(struct pp_queue_t *ppq, struct pipe_resource *in,
        struct pipe_resource *out, struct pipe_resource *indepth)
 {
 
+   struct pipe_resource *app_in = in;
    unsigned int i;
 
    if (in->width0 != ppq->p->framebuffer.width ||
@@ -66,56 +132,135 @@ pp_run(struct pp_queue_t *ppq, struct pipe_resource *in,
 
    switch (ppq->n_filters) {
    case 1:                     /* No temp buf */
-      ppq->pp_queue[0] (ppq, in, out, 0);
+      pp_run_filter(ppq, 0, in, out);
       break;
    case 2:                     /* One temp buf */
 
-      ppq->pp_queue[0] (ppq, in, ppq->tmp[0], 0);
-      ppq->pp_queue[1] (ppq, ppq->tmp[0], out, 1);
+      pp_run_filter(ppq, 0, in, ppq->tmp[0]);
+      pp_run_filter(ppq, 1, ppq->tmp[0], out);
 
       break;
    default:                    /* Two temp bufs */
-      ppq->pp_queue[0] (ppq, in, ppq->tmp[0], 0);
+      pp_run_filter(ppq, 0, in, ppq->tmp[0]);
 
       for (i = 1; i < (ppq->n_filters - 1); i++) {
          if (i % 2 == 0)
-            ppq->pp_queue[i] (ppq, ppq->tmp[1], ppq->tmp[0], i);
+            pp_run_filter(ppq, i, ppq->tmp[1], ppq->tmp[0]);
 
          else
-            ppq->pp_queue[i] (ppq, ppq->tmp[0], ppq->tmp[1], i);
+            pp_run_filter(ppq, i, ppq->tmp[0], ppq->tmp[1]);
       }
 
       if (i % 2 == 0)
-         ppq->pp_queue[i] (ppq, ppq->tmp[1], out, i);
+         pp_run_filter(ppq, i, ppq->tmp[1], out);
 
       else
-         ppq->pp_queue[i] (ppq, ppq->tmp[0], out, i);
+         pp_run_filter(ppq, i, ppq->tmp[0], out);
 
       break;
    }
+
+   /* The passes only depend on each other, flush once at the end. */
+   ppq->p->pipe->flush(ppq->p->pipe, NULL);
+
+   /* Only the temp buffers are the same every frame, don't keep the
+    * application's buffers alive. */
+   pp_release_resource_views(ppq->p, app_in);
+   pp_release_resource_views(ppq->p, out);
+
+   if (ppq->timing)
+      pp_report_timing(ppq);
 }
 
 
 /* Utility functions for the filters. You're not forced to use these if */
 /* your filter is more complicated. */
 
+/**
+*	Get a sampler view of the whole resource, in its own format.
+*
+*	The views of the temp buffers are kept across frames, as the passes
+*	read them every frame; those of the frame's input and output are
+*	dropped at the end of pp_run. Release the returned reference when
+*	done.
+*/
+struct pipe_sampler_view *
+pp_get_view(struct program *p, struct pipe_resource *res)
+{
+   struct pipe_sampler_view v_tmp, *view = NULL;
+   unsigned int i;
+
+   for (i = 0; i < PP_MAX_CACHED_VIEWS; i++) {
+      struct pipe_sampler_view *cached = p->cached_views[i];
+
+      if (cached && cached->texture == res && cached->format == res->format) {
+         pipe_sampler_view_reference(&view, cached);
+         return view;
+      }
+   }
+
+   u_sampler_view_default_template(&v_tmp, res, res->format);
+   view = p->pipe->create_sampler_view(p->pipe, res, &v_tmp);
+   if (view) {
+      pipe_sampler_view_reference(&p->cached_views[p->next_view], view);
+      p->next_view = (p->next_view + 1) % PP_MAX_CACHED_VIEWS;
+   }
+
+   return view;
+}
+
+/** Same as pp_get_view, for a render target surface. */
+struct pipe_surface *
+pp_get_surface(struct program *p, struct pipe_resource *res)
+{
+   struct pipe_surface *surf = NULL;
+   unsigned int i;
+
+   for (i = 0; i < PP_MAX_CACHED_VIEWS; i++) {
+      struct pipe_surface *cached = p->cached_surfs[i];
+
+      if (cached && cached->texture == res && cached->format == res->format) {
+         pipe_surface_reference(&surf, cached);
+         return surf;
+      }
+   }
+
+   p->surf.format = res->format;
+   p->surf.usage = PIPE_BIND_RENDER_TARGET;
+
+   surf = p->pipe->create_surface(p->pipe, res, &p->surf);
+   if (surf) {
+      pipe_surface_reference(&p->cached_surfs[p->next_surf], surf);
+      p->next_surf = (p->next_surf + 1) % PP_MAX_CACHED_VIEWS;
+   }
+
+   return surf;
+}
+
+/** Release the views and surfaces kept by pp_get_view and pp_get_surface. */
+void
+pp_release_cached_views(struct program *p)
+{
+   unsigned int i;
+
+   for (i = 0; i < PP_MAX_CACHED_VIEWS; i++) {
+      pipe_sampler_view_reference(&p->cached_views[i], NULL);
+      pipe_surface_reference(&p->cached_surfs[i], NULL);
+   }
+}
+
 /** Setup this resource as the filter input. */
 void
 pp_filter_setup_in(struct program *p, struct pipe_resource *in)
 {
-   struct pipe_sampler_view v_tmp;
-   u_sampler_view_default_template(&v_tmp, in, in->format);
-   p->view = p->pipe->create_sampler_view(p->pipe, in, &v_tmp);
+   p->view = pp_get_view(p, in);
 }
 
 /** Setup this resource as the filter output. */
 void
 pp_filter_setup_out(struct program *p, struct pipe_resource *out)
 {
-   p->surf.format = out->format;
-   p->surf.usage = PIPE_BIND_RENDER_TARGET;
-
-   p->framebuffer.cbufs[0] = p->pipe->create_surface(p->pipe, out, &p->surf);
+   p->framebuffer.cbufs[0] = pp_get_surface(p, out);
 }
 
 /** Clean up the input and output set with the above. */
@@ -169,7 +314,6 @@ pp_filter_draw(struct program *p)
 {
    util_draw_vertex_buffer(p->pipe, p->cso, p->vbuf, 0,
                            PIPE_PRIM_QUADS, 4, 2);
-   p->pipe->flush(p->pipe, NULL);
 }
 
 /** Set the framebuffer as active. */
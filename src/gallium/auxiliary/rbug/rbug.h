@@ -30,4 +30,5 @@
 #include "rbug/rbug_shader.h"
 #include "rbug/rbug_context.h"
 #include "rbug/rbug_texture.h"
+#include "rbug/rbug_tiles.h"
 #include "rbug/rbug_connection.h"
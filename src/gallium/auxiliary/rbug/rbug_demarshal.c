@@ -49,12 +49,16 @@ struct rbug_header * rbug_demarshal(struct rbug_proto_header *header)
 		return (struct rbug_header *)rbug_demarshal_texture_write(header);
 	case RBUG_OP_TEXTURE_READ:
 		return (struct rbug_header *)rbug_demarshal_texture_read(header);
+	case RBUG_OP_TEXTURE_READ_TILES:
+		return (struct rbug_header *)rbug_demarshal_texture_read_tiles(header);
 	case RBUG_OP_TEXTURE_LIST_REPLY:
 		return (struct rbug_header *)rbug_demarshal_texture_list_reply(header);
 	case RBUG_OP_TEXTURE_INFO_REPLY:
 		return (struct rbug_header *)rbug_demarshal_texture_info_reply(header);
 	case RBUG_OP_TEXTURE_READ_REPLY:
 		return (struct rbug_header *)rbug_demarshal_texture_read_reply(header);
+	case RBUG_OP_TEXTURE_READ_TILES_REPLY:
+		return (struct rbug_header *)rbug_demarshal_texture_read_tiles_reply(header);
 	case RBUG_OP_CONTEXT_LIST:
 		return (struct rbug_header *)rbug_demarshal_context_list(header);
 	case RBUG_OP_CONTEXT_INFO:
@@ -113,12 +117,16 @@ const char* rbug_proto_get_name(enum rbug_opcode opcode)
 		return "RBUG_OP_TEXTURE_WRITE";
 	case RBUG_OP_TEXTURE_READ:
 		return "RBUG_OP_TEXTURE_READ";
+	case RBUG_OP_TEXTURE_READ_TILES:
+		return "RBUG_OP_TEXTURE_READ_TILES";
 	case RBUG_OP_TEXTURE_LIST_REPLY:
 		return "RBUG_OP_TEXTURE_LIST_REPLY";
 	case RBUG_OP_TEXTURE_INFO_REPLY:
 		return "RBUG_OP_TEXTURE_INFO_REPLY";
 	case RBUG_OP_TEXTURE_READ_REPLY:
 		return "RBUG_OP_TEXTURE_READ_REPLY";
+	case RBUG_OP_TEXTURE_READ_TILES_REPLY:
+		return "RBUG_OP_TEXTURE_READ_TILES_REPLY";
 	case RBUG_OP_CONTEXT_LIST:
 		return "RBUG_OP_CONTEXT_LIST";
 	case RBUG_OP_CONTEXT_INFO:
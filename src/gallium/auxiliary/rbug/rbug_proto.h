@@ -47,9 +47,11 @@ enum rbug_opcode
 	RBUG_OP_TEXTURE_INFO = 257,
 	RBUG_OP_TEXTURE_WRITE = 258,
 	RBUG_OP_TEXTURE_READ = 259,
+	RBUG_OP_TEXTURE_READ_TILES = 260,
 	RBUG_OP_TEXTURE_LIST_REPLY = -256,
 	RBUG_OP_TEXTURE_INFO_REPLY = -257,
 	RBUG_OP_TEXTURE_READ_REPLY = -259,
+	RBUG_OP_TEXTURE_READ_TILES_REPLY = -260,
 	RBUG_OP_CONTEXT_LIST = 512,
 	RBUG_OP_CONTEXT_INFO = 513,
 	RBUG_OP_CONTEXT_DRAW_BLOCK = 514,
@@ -235,6 +235,72 @@ int rbug_send_texture_read(struct rbug_connection *__con,
 	return __ret;
 }
 
+int rbug_send_texture_read_tiles(struct rbug_connection *__con,
+                                 rbug_texture_t texture,
+                                 uint32_t face,
+                                 uint32_t level,
+                                 uint32_t zslice,
+                                 uint32_t x,
+                                 uint32_t y,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 uint32_t tile_size,
+                                 uint32_t *hashes,
+                                 uint32_t hashes_len,
+                                 uint32_t *__serial)
+{
+	uint32_t __len = 0;
+	uint32_t __pos = 0;
+	uint8_t *__data = NULL;
+	int __ret = 0;
+
+	LEN(8); /* header */
+	LEN(8); /* texture */
+	LEN(4); /* face */
+	LEN(4); /* level */
+	LEN(4); /* zslice */
+	LEN(4); /* x */
+	LEN(4); /* y */
+	LEN(4); /* w */
+	LEN(4); /* h */
+	LEN(4); /* tile_size */
+	LEN_ARRAY(4, hashes); /* hashes */
+
+	/* align */
+	PAD(__len, 8);
+
+	__data = (uint8_t*)MALLOC(__len);
+	if (!__data)
+		return -ENOMEM;
+
+	WRITE(4, int32_t, ((int32_t)RBUG_OP_TEXTURE_READ_TILES));
+	WRITE(4, uint32_t, ((uint32_t)(__len / 4)));
+	WRITE(8, rbug_texture_t, texture); /* texture */
+	WRITE(4, uint32_t, face); /* face */
+	WRITE(4, uint32_t, level); /* level */
+	WRITE(4, uint32_t, zslice); /* zslice */
+	WRITE(4, uint32_t, x); /* x */
+	WRITE(4, uint32_t, y); /* y */
+	WRITE(4, uint32_t, w); /* w */
+	WRITE(4, uint32_t, h); /* h */
+	WRITE(4, uint32_t, tile_size); /* tile_size */
+	WRITE_ARRAY(4, uint32_t, hashes); /* hashes */
+
+	/* final pad */
+	PAD(__pos, 8);
+
+	if (__pos != __len) {
+		__ret = -EINVAL;
+	} else {
+		rbug_connection_send_start(__con, RBUG_OP_TEXTURE_READ_TILES, __len);
+		rbug_connection_write(__con, __data, __len);
+		__ret = rbug_connection_send_finish(__con, __serial);
+	}
+
+	FREE(__data);
+	return __ret;
+}
+
 int rbug_send_texture_list_reply(struct rbug_connection *__con,
                                  uint32_t serial,
                                  rbug_texture_t *textures,
@@ -408,6 +474,75 @@ int rbug_send_texture_read_reply(struct rbug_connection *__con,
 	return __ret;
 }
 
+int rbug_send_texture_read_tiles_reply(struct rbug_connection *__con,
+                                       uint32_t serial,
+                                       uint32_t format,
+                                       uint32_t blockw,
+                                       uint32_t blockh,
+                                       uint32_t blocksize,
+                                       uint32_t tile_size,
+                                       uint32_t *hashes,
+                                       uint32_t hashes_len,
+                                       uint32_t *tiles,
+                                       uint32_t tiles_len,
+                                       uint32_t *sizes,
+                                       uint32_t sizes_len,
+                                       uint8_t *data,
+                                       uint32_t data_len,
+                                       uint32_t *__serial)
+{
+	uint32_t __len = 0;
+	uint32_t __pos = 0;
+	uint8_t *__data = NULL;
+	int __ret = 0;
+
+	LEN(8); /* header */
+	LEN(4); /* serial */
+	LEN(4); /* format */
+	LEN(4); /* blockw */
+	LEN(4); /* blockh */
+	LEN(4); /* blocksize */
+	LEN(4); /* tile_size */
+	LEN_ARRAY(4, hashes); /* hashes */
+	LEN_ARRAY(4, tiles); /* tiles */
+	LEN_ARRAY(4, sizes); /* sizes */
+	LEN_ARRAY(1, data); /* data */
+
+	/* align */
+	PAD(__len, 8);
+
+	__data = (uint8_t*)MALLOC(__len);
+	if (!__data)
+		return -ENOMEM;
+
+	WRITE(4, int32_t, ((int32_t)RBUG_OP_TEXTURE_READ_TILES_REPLY));
+	WRITE(4, uint32_t, ((uint32_t)(__len / 4)));
+	WRITE(4, uint32_t, serial); /* serial */
+	WRITE(4, uint32_t, format); /* format */
+	WRITE(4, uint32_t, blockw); /* blockw */
+	WRITE(4, uint32_t, blockh); /* blockh */
+	WRITE(4, uint32_t, blocksize); /* blocksize */
+	WRITE(4, uint32_t, tile_size); /* tile_size */
+	WRITE_ARRAY(4, uint32_t, hashes); /* hashes */
+	WRITE_ARRAY(4, uint32_t, tiles); /* tiles */
+	WRITE_ARRAY(4, uint32_t, sizes); /* sizes */
+	WRITE_ARRAY(1, uint8_t, data); /* data */
+
+	/* final pad */
+	PAD(__pos, 8);
+
+	if (__pos != __len) {
+		__ret = -EINVAL;
+	} else {
+		rbug_connection_send_start(__con, RBUG_OP_TEXTURE_READ_TILES_REPLY, __len);
+		rbug_connection_write(__con, __data, __len);
+		__ret = rbug_connection_send_finish(__con, __serial);
+	}
+
+	FREE(__data);
+	return __ret;
+}
+
 struct rbug_proto_texture_list * rbug_demarshal_texture_list(struct rbug_proto_header *header)
 {
 	struct rbug_proto_texture_list *ret;
@@ -524,6 +659,42 @@ struct rbug_proto_texture_read * rbug_demarshal_texture_read(struct rbug_proto_h
 	return ret;
 }
 
+struct rbug_proto_texture_read_tiles * rbug_demarshal_texture_read_tiles(struct rbug_proto_header *header)
+{
+	uint32_t len = 0;
+	uint32_t pos = 0;
+	uint8_t *data =  NULL;
+	struct rbug_proto_texture_read_tiles *ret;
+
+	if (!header)
+		return NULL;
+	if (header->opcode != (int32_t)RBUG_OP_TEXTURE_READ_TILES)
+		return NULL;
+
+	pos = 0;
+	len = header->length * 4;
+	data = (uint8_t*)&header[1];
+	ret = MALLOC(sizeof(*ret));
+	if (!ret)
+		return NULL;
+
+	ret->header.__message = header;
+	ret->header.opcode = header->opcode;
+
+	READ(8, rbug_texture_t, texture); /* texture */
+	READ(4, uint32_t, face); /* face */
+	READ(4, uint32_t, level); /* level */
+	READ(4, uint32_t, zslice); /* zslice */
+	READ(4, uint32_t, x); /* x */
+	READ(4, uint32_t, y); /* y */
+	READ(4, uint32_t, w); /* w */
+	READ(4, uint32_t, h); /* h */
+	READ(4, uint32_t, tile_size); /* tile_size */
+	READ_ARRAY(4, uint32_t, hashes); /* hashes */
+
+	return ret;
+}
+
 struct rbug_proto_texture_list_reply * rbug_demarshal_texture_list_reply(struct rbug_proto_header *header)
 {
 	uint32_t len = 0;
@@ -622,3 +793,39 @@ struct rbug_proto_texture_read_reply * rbug_demarshal_texture_read_reply(struct
 
 	return ret;
 }
+
+struct rbug_proto_texture_read_tiles_reply * rbug_demarshal_texture_read_tiles_reply(struct rbug_proto_header *header)
+{
+	uint32_t len = 0;
+	uint32_t pos = 0;
+	uint8_t *data =  NULL;
+	struct rbug_proto_texture_read_tiles_reply *ret;
+
+	if (!header)
+		return NULL;
+	if (header->opcode != (int32_t)RBUG_OP_TEXTURE_READ_TILES_REPLY)
+		return NULL;
+
+	pos = 0;
+	len = header->length * 4;
+	data = (uint8_t*)&header[1];
+	ret = MALLOC(sizeof(*ret));
+	if (!ret)
+		return NULL;
+
+	ret->header.__message = header;
+	ret->header.opcode = header->opcode;
+
+	READ(4, uint32_t, serial); /* serial */
+	READ(4, uint32_t, format); /* format */
+	READ(4, uint32_t, blockw); /* blockw */
+	READ(4, uint32_t, blockh); /* blockh */
+	READ(4, uint32_t, blocksize); /* blocksize */
+	READ(4, uint32_t, tile_size); /* tile_size */
+	READ_ARRAY(4, uint32_t, hashes); /* hashes */
+	READ_ARRAY(4, uint32_t, tiles); /* tiles */
+	READ_ARRAY(4, uint32_t, sizes); /* sizes */
+	READ_ARRAY(1, uint8_t, data); /* data */
+
+	return ret;
+}
@@ -81,6 +81,22 @@ struct rbug_proto_texture_read
 	uint32_t h;
 };
 
+struct rbug_proto_texture_read_tiles
+{
+	struct rbug_header header;
+	rbug_texture_t texture;
+	uint32_t face;
+	uint32_t level;
+	uint32_t zslice;
+	uint32_t x;
+	uint32_t y;
+	uint32_t w;
+	uint32_t h;
+	uint32_t tile_size;
+	uint32_t *hashes;
+	uint32_t hashes_len;
+};
+
 struct rbug_proto_texture_list_reply
 {
 	struct rbug_header header;
@@ -122,6 +138,25 @@ struct rbug_proto_texture_read_reply
 	uint32_t stride;
 };
 
+struct rbug_proto_texture_read_tiles_reply
+{
+	struct rbug_header header;
+	uint32_t serial;
+	uint32_t format;
+	uint32_t blockw;
+	uint32_t blockh;
+	uint32_t blocksize;
+	uint32_t tile_size;
+	uint32_t *hashes;
+	uint32_t hashes_len;
+	uint32_t *tiles;
+	uint32_t tiles_len;
+	uint32_t *sizes;
+	uint32_t sizes_len;
+	uint8_t *data;
+	uint32_t data_len;
+};
+
 int rbug_send_texture_list(struct rbug_connection *__con,
                            uint32_t *__serial);
 
@@ -154,6 +189,20 @@ int rbug_send_texture_read(struct rbug_connection *__con,
                            uint32_t h,
                            uint32_t *__serial);
 
+int rbug_send_texture_read_tiles(struct rbug_connection *__con,
+                                 rbug_texture_t texture,
+                                 uint32_t face,
+                                 uint32_t level,
+                                 uint32_t zslice,
+                                 uint32_t x,
+                                 uint32_t y,
+                                 uint32_t w,
+                                 uint32_t h,
+                                 uint32_t tile_size,
+                                 uint32_t *hashes,
+                                 uint32_t hashes_len,
+                                 uint32_t *__serial);
+
 int rbug_send_texture_list_reply(struct rbug_connection *__con,
                                  uint32_t serial,
                                  rbug_texture_t *textures,
@@ -189,6 +238,23 @@ int rbug_send_texture_read_reply(struct rbug_connection *__con,
                                  uint32_t stride,
                                  uint32_t *__serial);
 
+int rbug_send_texture_read_tiles_reply(struct rbug_connection *__con,
+                                       uint32_t serial,
+                                       uint32_t format,
+                                       uint32_t blockw,
+                                       uint32_t blockh,
+                                       uint32_t blocksize,
+                                       uint32_t tile_size,
+                                       uint32_t *hashes,
+                                       uint32_t hashes_len,
+                                       uint32_t *tiles,
+                                       uint32_t tiles_len,
+                                       uint32_t *sizes,
+                                       uint32_t sizes_len,
+                                       uint8_t *data,
+                                       uint32_t data_len,
+                                       uint32_t *__serial);
+
 struct rbug_proto_texture_list * rbug_demarshal_texture_list(struct rbug_proto_header *header);
 
 struct rbug_proto_texture_info * rbug_demarshal_texture_info(struct rbug_proto_header *header);
@@ -197,10 +263,14 @@ struct rbug_proto_texture_write * rbug_demarshal_texture_write(struct rbug_proto
 
 struct rbug_proto_texture_read * rbug_demarshal_texture_read(struct rbug_proto_header *header);
 
+struct rbug_proto_texture_read_tiles * rbug_demarshal_texture_read_tiles(struct rbug_proto_header *header);
+
 struct rbug_proto_texture_list_reply * rbug_demarshal_texture_list_reply(struct rbug_proto_header *header);
 
 struct rbug_proto_texture_info_reply * rbug_demarshal_texture_info_reply(struct rbug_proto_header *header);
 
 struct rbug_proto_texture_read_reply * rbug_demarshal_texture_read_reply(struct rbug_proto_header *header);
 
+struct rbug_proto_texture_read_tiles_reply * rbug_demarshal_texture_read_tiles_reply(struct rbug_proto_header *header);
+
 #endif
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Run length coding of the tiles sent by RBUG_OP_TEXTURE_READ_TILES,
+ * see rbug_tiles.h for the format.
+ */
+
+#include "rbug_internal.h"
+#include "rbug/rbug_tiles.h"
+
+#define RUN_MAX 129
+#define LITERAL_MAX 128
+
+static INLINE boolean
+same_block(const uint8_t *a, const uint8_t *b, uint32_t blocksize)
+{
+	return memcmp(a, b, blocksize) == 0;
+}
+
+/**
+ * Encode nblocks blocks of blocksize bytes from src into dst, which must
+ * hold at least rbug_tile_encode_max_size bytes.
+ *
+ * Result:
+ *    Size of the encoding in bytes
+ */
+uint32_t
+rbug_tile_encode(const uint8_t *src, uint32_t nblocks,
+                 uint32_t blocksize, uint8_t *dst)
+{
+	uint32_t pos = 0;
+	uint32_t i = 0;
+	uint32_t literal = 0; /* start of the pending literal blocks */
+	/* shorter runs of single bytes would not pay for splitting a literal */
+	uint32_t run_min = blocksize == 1 ? 3 : 2;
+
+	while (i < nblocks) {
+		const uint8_t *block = src + i * blocksize;
+		uint32_t run = 1;
+
+		while (i + run < nblocks && run < RUN_MAX &&
+		       same_block(block, block + run * blocksize, blocksize))
+			run++;
+
+		/* flush the literal blocks before a run, or when full */
+		if ((run >= run_min && literal < i) || i - literal == LITERAL_MAX) {
+			uint32_t count = i - literal;
+			dst[pos++] = (uint8_t)(count - 1);
+			memcpy(dst + pos, src + literal * blocksize, count * blocksize);
+			pos += count * blocksize;
+			literal = i;
+		}
+
+		if (run >= run_min) {
+			dst[pos++] = (uint8_t)(run + 126);
+			memcpy(dst + pos, block, blocksize);
+			pos += blocksize;
+			i += run;
+			literal = i;
+		} else {
+			i++;
+		}
+	}
+
+	if (literal < nblocks) {
+		uint32_t count = nblocks - literal;
+		dst[pos++] = (uint8_t)(count - 1);
+		memcpy(dst + pos, src + literal * blocksize, count * blocksize);
+		pos += count * blocksize;
+	}
+
+	return pos;
+}
+
+/**
+ * Decode src_len bytes from src into nblocks blocks of blocksize bytes.
+ *
+ * Result:
+ *    0 on success, -EINVAL if the data does not decode to nblocks blocks
+ */
+int
+rbug_tile_decode(const uint8_t *src, uint32_t src_len,
+                 uint32_t blocksize, uint8_t *dst, uint32_t nblocks)
+{
+	uint32_t pos = 0;
+	uint32_t i = 0;
+
+	while (pos < src_len) {
+		uint8_t c = src[pos++];
+
+		if (c < LITERAL_MAX) {
+			uint32_t count = c + 1;
+			if (i + count > nblocks || pos + count * blocksize > src_len)
+				return -EINVAL;
+			memcpy(dst + i * blocksize, src + pos, count * blocksize);
+			pos += count * blocksize;
+			i += count;
+		} else {
+			uint32_t count = c - 126;
+			uint32_t j;
+			if (i + count > nblocks || pos + blocksize > src_len)
+				return -EINVAL;
+			for (j = 0; j < count; j++)
+				memcpy(dst + (i + j) * blocksize, src + pos, blocksize);
+			pos += blocksize;
+			i += count;
+		}
+	}
+
+	return i == nblocks ? 0 : -EINVAL;
+}
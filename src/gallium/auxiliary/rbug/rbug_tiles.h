@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Helpers for the tiled texture reads, see RBUG_OP_TEXTURE_READ_TILES.
+ *
+ * The region read is split into tiles of tile_size x tile_size blocks,
+ * numbered in rows from the top left corner; tiles on the right and bottom
+ * edges may be smaller. A tile_size of 0 selects RBUG_TILE_SIZE_DEFAULT and
+ * sizes above RBUG_TILE_SIZE_MAX are clamped, the reply holds the size used.
+ * The region is clamped to the mip level, a region that would not fit in a
+ * single reply is refused.
+ *
+ * The reply holds a hash of every tile, and the data of the tiles whose hash
+ * differs from the one the client sent with the request. The data of each
+ * tile is its rows of blocks packed without any padding, run length encoded
+ * by rbug_tile_encode.
+ *
+ * The encoding is a sequence of packets, each a control byte followed by
+ * blocks: a control byte c below 128 is followed by c + 1 blocks copied as
+ * is, otherwise by a single block repeated c - 126 times.
+ */
+
+#ifndef _RBUG_TILES_H_
+#define _RBUG_TILES_H_
+
+#include "pipe/p_compiler.h"
+
+#define RBUG_TILE_SIZE_DEFAULT 64
+#define RBUG_TILE_SIZE_MAX 256
+
+/**
+ * Number of tiles a region of nblocksx x nblocksy blocks is split into.
+ */
+static INLINE uint32_t
+rbug_tile_count(uint32_t nblocksx, uint32_t nblocksy, uint32_t tile_size)
+{
+	return ((nblocksx + tile_size - 1) / tile_size) *
+	       ((nblocksy + tile_size - 1) / tile_size);
+}
+
+/**
+ * Worst case size of the encoding of nblocks blocks.
+ */
+static INLINE uint32_t
+rbug_tile_encode_max_size(uint32_t nblocks, uint32_t blocksize)
+{
+	return nblocks * blocksize + (nblocks + 127) / 128 + 1;
+}
+
+uint32_t rbug_tile_encode(const uint8_t *src, uint32_t nblocks,
+                          uint32_t blocksize, uint8_t *dst);
+
+int rbug_tile_decode(const uint8_t *src, uint32_t src_len,
+                     uint32_t blocksize, uint8_t *dst, uint32_t nblocks);
+
+#endif
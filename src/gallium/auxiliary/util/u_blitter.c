@@ -50,6 +50,9 @@
 
 #define INVALID_PTR ((void*)~0)
 
+/* Number of rectangles a batch can hold before they are drawn. */
+#define BLITTER_BATCH_MAX_RECTS 64
+
 struct blitter_context_priv
 {
    struct blitter_context base;
@@ -104,6 +107,34 @@ struct blitter_context_priv
    /* Destination surface dimensions. */
    unsigned dst_width;
    unsigned dst_height;
+
+   /* Batching, see util_blitter_begin_batch. */
+   boolean batch;
+   unsigned batch_num_rects;
+   float batch_vertices[BLITTER_BATCH_MAX_RECTS * 6][2][4]; /**< triangles */
+   struct pipe_resource *batch_vbuf;
+
+   /* Destination surface and sampler view of the last copy of the batch,
+    * which the next copy between the same resources reuses. */
+   struct pipe_surface *batch_dstsurf;
+   struct pipe_sampler_view *batch_view;
+
+   /* State bound by the blitter during the batch, which is not bound again
+    * by the following operations. NULL if not bound yet. */
+   void *bound_blend;
+   void *bound_dsa;
+   void *bound_rs;
+   void *bound_fs;
+   void *bound_vs;
+   void *bound_velem;
+   void *bound_sampler;
+   struct pipe_sampler_view *bound_view;
+   boolean bound_fb_valid;
+   struct pipe_framebuffer_state bound_fb;
+   boolean bound_stencil_ref_valid;
+   struct pipe_stencil_ref bound_stencil_ref;
+   unsigned bound_viewport_width;
+   unsigned bound_viewport_height;
 };
 
 static void blitter_draw_rectangle(struct blitter_context *blitter,
@@ -222,6 +253,10 @@ struct blitter_context *util_blitter_create(struct pipe_context *pipe)
                                        ctx->vertices,
                                        sizeof(ctx->vertices),
                                        PIPE_BIND_VERTEX_BUFFER);
+   ctx->batch_vbuf = pipe_user_buffer_create(ctx->base.pipe->screen,
+                                             ctx->batch_vertices,
+                                             sizeof(ctx->batch_vertices),
+                                             PIPE_BIND_VERTEX_BUFFER);
 
    return &ctx->base;
 }
@@ -260,6 +295,7 @@ void util_blitter_destroy(struct blitter_context *blitter)
          pipe->delete_sampler_state(pipe, ctx->sampler_state[i]);
 
    pipe_resource_reference(&ctx->vbuf, NULL);
+   pipe_resource_reference(&ctx->batch_vbuf, NULL);
    FREE(ctx);
 }
 
@@ -359,6 +395,184 @@ static void blitter_restore_CSOs(struct blitter_context_priv *ctx)
    ctx->base.running = FALSE;
 }
 
+/* Draw the rectangles queued in the batch. This must be done before any
+ * state they are drawn with changes. */
+static void blitter_flush_batch(struct blitter_context_priv *ctx)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+   unsigned num_vertices = ctx->batch_num_rects * 6;
+
+   if (!num_vertices)
+      return;
+
+   ctx->batch_num_rects = 0;
+   pipe->redefine_user_buffer(pipe, ctx->batch_vbuf, 0,
+                              num_vertices * sizeof(ctx->batch_vertices[0]));
+   util_draw_vertex_buffer(pipe, NULL, ctx->batch_vbuf, 0,
+                           PIPE_PRIM_TRIANGLES, num_vertices, 2);
+}
+
+/* Draw the rectangles queued in the batch if they write to \p res, so that
+ * a following operation reading \p res sees them. */
+static void blitter_flush_batch_writes(struct blitter_context_priv *ctx,
+                                       struct pipe_resource *res)
+{
+   unsigned i;
+
+   if (!ctx->batch_num_rects || !ctx->bound_fb_valid)
+      return;
+
+   if (ctx->bound_fb.zsbuf && ctx->bound_fb.zsbuf->texture == res) {
+      blitter_flush_batch(ctx);
+      return;
+   }
+
+   for (i = 0; i < ctx->bound_fb.nr_cbufs; i++) {
+      if (ctx->bound_fb.cbufs[i] && ctx->bound_fb.cbufs[i]->texture == res) {
+         blitter_flush_batch(ctx);
+         return;
+      }
+   }
+}
+
+/* Draw the quad in ctx->vertices, or queue it if batching. */
+static void blitter_draw_quad(struct blitter_context_priv *ctx)
+{
+   static const unsigned corners[6] = { 0, 1, 2, 0, 2, 3 };
+   unsigned i;
+
+   if (!ctx->batch) {
+      ctx->base.pipe->redefine_user_buffer(ctx->base.pipe, ctx->vbuf,
+                                           0, ctx->vbuf->width0);
+      util_draw_vertex_buffer(ctx->base.pipe, NULL, ctx->vbuf, 0,
+                              PIPE_PRIM_TRIANGLE_FAN, 4, 2);
+      return;
+   }
+
+   for (i = 0; i < 6; i++)
+      memcpy(ctx->batch_vertices[ctx->batch_num_rects * 6 + i],
+             ctx->vertices[corners[i]], sizeof(ctx->vertices[0]));
+
+   if (++ctx->batch_num_rects == BLITTER_BATCH_MAX_RECTS)
+      blitter_flush_batch(ctx);
+}
+
+/* Draw a rectangle with the draw_rectangle callback. A driver's own
+ * callback draws right away, so queued rectangles go first. */
+static void blitter_draw(struct blitter_context_priv *ctx,
+                         unsigned x1, unsigned y1, unsigned x2, unsigned y2,
+                         float depth,
+                         enum blitter_attrib_type type,
+                         const union pipe_color_union *attrib)
+{
+   if (ctx->base.draw_rectangle != blitter_draw_rectangle)
+      blitter_flush_batch(ctx);
+
+   ctx->base.draw_rectangle(&ctx->base, x1, y1, x2, y2, depth, type, attrib);
+}
+
+/* Start and end an operation. Inside a batch, the state is saved and
+ * restored by util_blitter_begin_batch and util_blitter_end_batch. */
+static void blitter_begin_op(struct blitter_context_priv *ctx)
+{
+   if (!ctx->batch)
+      blitter_check_saved_CSOs(ctx);
+}
+
+static void blitter_end_op(struct blitter_context_priv *ctx)
+{
+   if (!ctx->batch)
+      blitter_restore_CSOs(ctx);
+}
+
+/* The functions below bind the blitter's state, skipping what is already
+ * bound if batching. */
+
+static INLINE boolean blitter_needs_bind(struct blitter_context_priv *ctx,
+                                         void **bound, void *state)
+{
+   if (ctx->batch && *bound == state)
+      return FALSE;
+
+   blitter_flush_batch(ctx);
+   *bound = state;
+   return TRUE;
+}
+
+static void blitter_bind_blend(struct blitter_context_priv *ctx, void *state)
+{
+   if (blitter_needs_bind(ctx, &ctx->bound_blend, state))
+      ctx->base.pipe->bind_blend_state(ctx->base.pipe, state);
+}
+
+static void blitter_bind_dsa(struct blitter_context_priv *ctx, void *state)
+{
+   if (blitter_needs_bind(ctx, &ctx->bound_dsa, state))
+      ctx->base.pipe->bind_depth_stencil_alpha_state(ctx->base.pipe, state);
+}
+
+static void blitter_bind_fs(struct blitter_context_priv *ctx, void *fs)
+{
+   if (blitter_needs_bind(ctx, &ctx->bound_fs, fs))
+      ctx->base.pipe->bind_fs_state(ctx->base.pipe, fs);
+}
+
+/* Bind the state which is the same for all operations. */
+static void blitter_bind_common(struct blitter_context_priv *ctx)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+
+   if (blitter_needs_bind(ctx, &ctx->bound_rs, ctx->rs_state))
+      pipe->bind_rasterizer_state(pipe, ctx->rs_state);
+   if (blitter_needs_bind(ctx, &ctx->bound_vs, ctx->vs))
+      pipe->bind_vs_state(pipe, ctx->vs);
+   if (blitter_needs_bind(ctx, &ctx->bound_velem, ctx->velem_state))
+      pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
+}
+
+static void blitter_bind_sampler(struct blitter_context_priv *ctx,
+                                 void **state,
+                                 struct pipe_sampler_view *view)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+
+   if (blitter_needs_bind(ctx, &ctx->bound_sampler, *state))
+      pipe->bind_fragment_sampler_states(pipe, 1, state);
+   if (blitter_needs_bind(ctx, (void**)&ctx->bound_view, view))
+      pipe->set_fragment_sampler_views(pipe, 1, &view);
+}
+
+static void blitter_set_stencil_ref(struct blitter_context_priv *ctx,
+                                    const struct pipe_stencil_ref *sr)
+{
+   if (ctx->batch && ctx->bound_stencil_ref_valid &&
+       memcmp(&ctx->bound_stencil_ref, sr, sizeof(*sr)) == 0)
+      return;
+
+   blitter_flush_batch(ctx);
+   ctx->base.pipe->set_stencil_ref(ctx->base.pipe, sr);
+   ctx->bound_stencil_ref = *sr;
+   ctx->bound_stencil_ref_valid = TRUE;
+}
+
+static void blitter_set_framebuffer(struct blitter_context_priv *ctx,
+                                    const struct pipe_framebuffer_state *fb)
+{
+   if (ctx->batch && ctx->bound_fb_valid &&
+       util_framebuffer_state_equal(&ctx->bound_fb, fb))
+      return;
+
+   blitter_flush_batch(ctx);
+   ctx->base.pipe->set_framebuffer_state(ctx->base.pipe, fb);
+
+   /* Keep references, so that the surfaces can't be freed and their
+    * addresses reused during the batch. */
+   if (ctx->batch) {
+      util_copy_framebuffer_state(&ctx->bound_fb, fb);
+      ctx->bound_fb_valid = TRUE;
+   }
+}
+
 static void blitter_set_rectangle(struct blitter_context_priv *ctx,
                                   unsigned x1, unsigned y1,
                                   unsigned x2, unsigned y2,
@@ -382,6 +596,15 @@ static void blitter_set_rectangle(struct blitter_context_priv *ctx,
    for (i = 0; i < 4; i++)
       ctx->vertices[i][0][2] = depth; /*z*/
 
+   if (ctx->batch &&
+       ctx->bound_viewport_width == ctx->dst_width &&
+       ctx->bound_viewport_height == ctx->dst_height)
+      return;
+
+   blitter_flush_batch(ctx);
+   ctx->bound_viewport_width = ctx->dst_width;
+   ctx->bound_viewport_height = ctx->dst_height;
+
    /* viewport */
    ctx->viewport.scale[0] = 0.5f * ctx->dst_width;
    ctx->viewport.scale[1] = 0.5f * ctx->dst_height;
@@ -664,10 +887,7 @@ static void blitter_draw_rectangle(struct blitter_context *blitter,
    }
 
    blitter_set_rectangle(ctx, x1, y1, x2, y2, depth);
-   ctx->base.pipe->redefine_user_buffer(ctx->base.pipe, ctx->vbuf,
-                                        0, ctx->vbuf->width0);
-   util_draw_vertex_buffer(ctx->base.pipe, NULL, ctx->vbuf, 0,
-                           PIPE_PRIM_TRIANGLE_FAN, 4, 2);
+   blitter_draw_quad(ctx);
 }
 
 static void util_blitter_clear_custom(struct blitter_context *blitter,
@@ -679,46 +899,48 @@ static void util_blitter_clear_custom(struct blitter_context *blitter,
                                       void *custom_blend, void *custom_dsa)
 {
    struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
-   struct pipe_context *pipe = ctx->base.pipe;
    struct pipe_stencil_ref sr = { { 0 } };
 
    assert(num_cbufs <= PIPE_MAX_COLOR_BUFS);
 
-   blitter_check_saved_CSOs(ctx);
+   blitter_begin_op(ctx);
+
+   /* This clears the framebuffer bound by the driver, which an earlier
+    * operation of the batch may have replaced. */
+   if (ctx->batch && ctx->bound_fb_valid)
+      blitter_set_framebuffer(ctx, &ctx->base.saved_fb_state);
 
    /* bind CSOs */
    if (custom_blend) {
-      pipe->bind_blend_state(pipe, custom_blend);
+      blitter_bind_blend(ctx, custom_blend);
    } else if (clear_buffers & PIPE_CLEAR_COLOR) {
-      pipe->bind_blend_state(pipe, ctx->blend_write_color);
+      blitter_bind_blend(ctx, ctx->blend_write_color);
    } else {
-      pipe->bind_blend_state(pipe, ctx->blend_keep_color);
+      blitter_bind_blend(ctx, ctx->blend_keep_color);
    }
 
    if (custom_dsa) {
-      pipe->bind_depth_stencil_alpha_state(pipe, custom_dsa);
+      blitter_bind_dsa(ctx, custom_dsa);
    } else if ((clear_buffers & PIPE_CLEAR_DEPTHSTENCIL) == PIPE_CLEAR_DEPTHSTENCIL) {
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_write_depth_stencil);
    } else if (clear_buffers & PIPE_CLEAR_DEPTH) {
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_keep_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_write_depth_keep_stencil);
    } else if (clear_buffers & PIPE_CLEAR_STENCIL) {
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_write_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_keep_depth_write_stencil);
    } else {
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_keep_depth_stencil);
    }
 
    sr.ref_value[0] = stencil & 0xff;
-   pipe->set_stencil_ref(pipe, &sr);
+   blitter_set_stencil_ref(ctx, &sr);
 
-   pipe->bind_rasterizer_state(pipe, ctx->rs_state);
-   pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
-   pipe->bind_fs_state(pipe, blitter_get_fs_col(ctx, num_cbufs));
-   pipe->bind_vs_state(pipe, ctx->vs);
+   blitter_bind_common(ctx);
+   blitter_bind_fs(ctx, blitter_get_fs_col(ctx, num_cbufs));
 
    blitter_set_dst_dimensions(ctx, width, height);
-   blitter->draw_rectangle(blitter, 0, 0, width, height, depth,
-                           UTIL_BLITTER_ATTRIB_COLOR, color);
-   blitter_restore_CSOs(ctx);
+   blitter_draw(ctx, 0, 0, width, height, depth,
+                UTIL_BLITTER_ATTRIB_COLOR, color);
+   blitter_end_op(ctx);
 }
 
 void util_blitter_clear(struct blitter_context *blitter,
@@ -749,6 +971,57 @@ boolean is_overlap(unsigned sx1, unsigned sx2, unsigned sy1, unsigned sy2,
    return sx1 < dx2 && sx2 > dx1 && sy1 < dy2 && sy2 > dy1;
 }
 
+/* Create a surface, or reuse the one of the previous copy of the batch. */
+static struct pipe_surface *
+blitter_get_surface(struct blitter_context_priv *ctx,
+                    struct pipe_resource *res,
+                    const struct pipe_surface *templ)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+   struct pipe_surface *cached = ctx->batch_dstsurf;
+   struct pipe_surface *surf = NULL;
+
+   if (ctx->batch && cached &&
+       cached->texture == res &&
+       cached->format == templ->format &&
+       cached->usage == templ->usage &&
+       cached->u.tex.level == templ->u.tex.level &&
+       cached->u.tex.first_layer == templ->u.tex.first_layer &&
+       cached->u.tex.last_layer == templ->u.tex.last_layer) {
+      pipe_surface_reference(&surf, cached);
+      return surf;
+   }
+
+   surf = pipe->create_surface(pipe, res, templ);
+   if (ctx->batch)
+      pipe_surface_reference(&ctx->batch_dstsurf, surf);
+   return surf;
+}
+
+/* Create a sampler view, or reuse the one of the previous copy of the
+ * batch. */
+static struct pipe_sampler_view *
+blitter_get_sampler_view(struct blitter_context_priv *ctx,
+                         struct pipe_resource *res,
+                         const struct pipe_sampler_view *templ)
+{
+   struct pipe_context *pipe = ctx->base.pipe;
+   struct pipe_sampler_view *cached = ctx->batch_view;
+   struct pipe_sampler_view *view = NULL;
+
+   if (ctx->batch && cached &&
+       cached->texture == res &&
+       cached->format == templ->format) {
+      pipe_sampler_view_reference(&view, cached);
+      return view;
+   }
+
+   view = pipe->create_sampler_view(pipe, res, templ);
+   if (ctx->batch)
+      pipe_sampler_view_reference(&ctx->batch_view, view);
+   return view;
+}
+
 void util_blitter_copy_texture(struct blitter_context *blitter,
                                struct pipe_resource *dst,
                                unsigned dstlevel,
@@ -784,6 +1057,11 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
    /* XXX should handle 3d regions */
    assert(srcbox->depth == 1);
 
+   /* A copy out of the destination of the batch, e.g. a region copied
+    * twice within the same texture, must see the rectangles queued so far. */
+   if (ctx->batch)
+      blitter_flush_batch_writes(ctx, src);
+
    /* Is this a ZS format? */
    is_depth = util_format_get_component_bits(src->format, UTIL_FORMAT_COLORSPACE_ZS, 0) != 0;
    is_stencil = util_format_get_component_bits(src->format, UTIL_FORMAT_COLORSPACE_ZS, 1) != 0;
@@ -800,10 +1078,15 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
                                     dst->nr_samples, bind) ||
        !screen->is_format_supported(screen, src->format, src->target,
                                     src->nr_samples, PIPE_BIND_SAMPLER_VIEW)) {
+      boolean running = ctx->base.running;
+
+      /* The software copy must see what the batch has drawn so far. */
+      blitter_flush_batch(ctx);
+
       ctx->base.running = TRUE;
       util_resource_copy_region(pipe, dst, dstlevel, dstx, dsty, dstz,
                                 src, srclevel, srcbox);
-      ctx->base.running = FALSE;
+      ctx->base.running = running;
       return;
    }
 
@@ -814,32 +1097,30 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
    surf_templ.u.tex.level = dstlevel;
    surf_templ.u.tex.first_layer = dstz;
    surf_templ.u.tex.last_layer = dstz;
-   dstsurf = pipe->create_surface(pipe, dst, &surf_templ);
+   dstsurf = blitter_get_surface(ctx, dst, &surf_templ);
 
    /* Check whether the states are properly saved. */
-   blitter_check_saved_CSOs(ctx);
+   blitter_begin_op(ctx);
    assert(blitter->saved_fb_state.nr_cbufs != ~0);
    assert(blitter->saved_num_sampler_views != ~0);
    assert(blitter->saved_num_sampler_states != ~0);
 
    /* Initialize framebuffer state. */
+   memset(&fb_state, 0, sizeof(fb_state));
    fb_state.width = dstsurf->width;
    fb_state.height = dstsurf->height;
 
    if (is_depth) {
-      pipe->bind_blend_state(pipe, ctx->blend_keep_color);
-      pipe->bind_depth_stencil_alpha_state(pipe,
-                                           ctx->dsa_write_depth_keep_stencil);
-      pipe->bind_fs_state(pipe,
-                          blitter_get_fs_texfetch_depth(ctx, src->target));
+      blitter_bind_blend(ctx, ctx->blend_keep_color);
+      blitter_bind_dsa(ctx, ctx->dsa_write_depth_keep_stencil);
+      blitter_bind_fs(ctx, blitter_get_fs_texfetch_depth(ctx, src->target));
 
       fb_state.nr_cbufs = 0;
       fb_state.zsbuf = dstsurf;
    } else {
-      pipe->bind_blend_state(pipe, ctx->blend_write_color);
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_stencil);
-      pipe->bind_fs_state(pipe,
-                          blitter_get_fs_texfetch_col(ctx, src->target));
+      blitter_bind_blend(ctx, ctx->blend_write_color);
+      blitter_bind_dsa(ctx, ctx->dsa_keep_depth_stencil);
+      blitter_bind_fs(ctx, blitter_get_fs_texfetch_col(ctx, src->target));
 
       fb_state.nr_cbufs = 1;
       fb_state.cbufs[0] = dstsurf;
@@ -850,16 +1131,13 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
 
    /* Initialize sampler view. */
    u_sampler_view_default_template(&viewTempl, src, util_format_linear(src->format));
-   view = pipe->create_sampler_view(pipe, src, &viewTempl);
+   view = blitter_get_sampler_view(ctx, src, &viewTempl);
 
    /* Set rasterizer state, shaders, and textures. */
-   pipe->bind_rasterizer_state(pipe, ctx->rs_state);
-   pipe->bind_vs_state(pipe, ctx->vs);
-   pipe->bind_fragment_sampler_states(pipe, 1,
-                                      blitter_get_sampler_state(ctx, srclevel, normalized));
-   pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
-   pipe->set_fragment_sampler_views(pipe, 1, &view);
-   pipe->set_framebuffer_state(pipe, &fb_state);
+   blitter_bind_common(ctx);
+   blitter_bind_sampler(ctx, blitter_get_sampler_state(ctx, srclevel, normalized),
+                        view);
+   blitter_set_framebuffer(ctx, &fb_state);
 
    blitter_set_dst_dimensions(ctx, dstsurf->width, dstsurf->height);
 
@@ -877,8 +1155,8 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
                           srcbox->x+width, srcbox->y+height, normalized, coord.f);
 
             /* Draw. */
-            blitter->draw_rectangle(blitter, dstx, dsty, dstx+width, dsty+height, 0,
-                                    UTIL_BLITTER_ATTRIB_TEXCOORD, &coord);
+            blitter_draw(ctx, dstx, dsty, dstx+width, dsty+height, 0,
+                         UTIL_BLITTER_ATTRIB_TEXCOORD, &coord);
          }
          break;
 
@@ -911,14 +1189,11 @@ void util_blitter_copy_texture(struct blitter_context *blitter,
 
          /* Draw. */
          blitter_set_rectangle(ctx, dstx, dsty, dstx+width, dsty+height, 0);
-         ctx->base.pipe->redefine_user_buffer(ctx->base.pipe, ctx->vbuf,
-                                              0, ctx->vbuf->width0);
-         util_draw_vertex_buffer(ctx->base.pipe, NULL, ctx->vbuf, 0,
-                                 PIPE_PRIM_TRIANGLE_FAN, 4, 2);
+         blitter_draw_quad(ctx);
          break;
    }
 
-   blitter_restore_CSOs(ctx);
+   blitter_end_op(ctx);
 
    pipe_surface_reference(&dstsurf, NULL);
    pipe_sampler_view_reference(&view, NULL);
@@ -932,7 +1207,6 @@ void util_blitter_clear_render_target(struct blitter_context *blitter,
                                       unsigned width, unsigned height)
 {
    struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
-   struct pipe_context *pipe = ctx->base.pipe;
    struct pipe_framebuffer_state fb_state;
 
    assert(dstsurf->texture);
@@ -940,29 +1214,28 @@ void util_blitter_clear_render_target(struct blitter_context *blitter,
       return;
 
    /* check the saved state */
-   blitter_check_saved_CSOs(ctx);
+   blitter_begin_op(ctx);
    assert(blitter->saved_fb_state.nr_cbufs != ~0);
 
    /* bind CSOs */
-   pipe->bind_blend_state(pipe, ctx->blend_write_color);
-   pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_stencil);
-   pipe->bind_rasterizer_state(pipe, ctx->rs_state);
-   pipe->bind_fs_state(pipe, blitter_get_fs_col(ctx, 1));
-   pipe->bind_vs_state(pipe, ctx->vs);
-   pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
+   blitter_bind_blend(ctx, ctx->blend_write_color);
+   blitter_bind_dsa(ctx, ctx->dsa_keep_depth_stencil);
+   blitter_bind_fs(ctx, blitter_get_fs_col(ctx, 1));
+   blitter_bind_common(ctx);
 
    /* set a framebuffer state */
+   memset(&fb_state, 0, sizeof(fb_state));
    fb_state.width = dstsurf->width;
    fb_state.height = dstsurf->height;
    fb_state.nr_cbufs = 1;
    fb_state.cbufs[0] = dstsurf;
    fb_state.zsbuf = 0;
-   pipe->set_framebuffer_state(pipe, &fb_state);
+   blitter_set_framebuffer(ctx, &fb_state);
 
    blitter_set_dst_dimensions(ctx, dstsurf->width, dstsurf->height);
-   blitter->draw_rectangle(blitter, dstx, dsty, dstx+width, dsty+height, 0,
-                           UTIL_BLITTER_ATTRIB_COLOR, color);
-   blitter_restore_CSOs(ctx);
+   blitter_draw(ctx, dstx, dsty, dstx+width, dsty+height, 0,
+                UTIL_BLITTER_ATTRIB_COLOR, color);
+   blitter_end_op(ctx);
 }
 
 /* Clear a region of a depth stencil surface. */
@@ -975,7 +1248,6 @@ void util_blitter_clear_depth_stencil(struct blitter_context *blitter,
                                       unsigned width, unsigned height)
 {
    struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
-   struct pipe_context *pipe = ctx->base.pipe;
    struct pipe_framebuffer_state fb_state;
    struct pipe_stencil_ref sr = { { 0 } };
 
@@ -984,45 +1256,44 @@ void util_blitter_clear_depth_stencil(struct blitter_context *blitter,
       return;
 
    /* check the saved state */
-   blitter_check_saved_CSOs(ctx);
+   blitter_begin_op(ctx);
    assert(blitter->saved_fb_state.nr_cbufs != ~0);
 
    /* bind CSOs */
-   pipe->bind_blend_state(pipe, ctx->blend_keep_color);
+   blitter_bind_blend(ctx, ctx->blend_keep_color);
    if ((clear_flags & PIPE_CLEAR_DEPTHSTENCIL) == PIPE_CLEAR_DEPTHSTENCIL) {
       sr.ref_value[0] = stencil & 0xff;
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_stencil);
-      pipe->set_stencil_ref(pipe, &sr);
+      blitter_bind_dsa(ctx, ctx->dsa_write_depth_stencil);
+      blitter_set_stencil_ref(ctx, &sr);
    }
    else if (clear_flags & PIPE_CLEAR_DEPTH) {
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_write_depth_keep_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_write_depth_keep_stencil);
    }
    else if (clear_flags & PIPE_CLEAR_STENCIL) {
       sr.ref_value[0] = stencil & 0xff;
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_write_stencil);
-      pipe->set_stencil_ref(pipe, &sr);
+      blitter_bind_dsa(ctx, ctx->dsa_keep_depth_write_stencil);
+      blitter_set_stencil_ref(ctx, &sr);
    }
    else
       /* hmm that should be illegal probably, or make it a no-op somewhere */
-      pipe->bind_depth_stencil_alpha_state(pipe, ctx->dsa_keep_depth_stencil);
+      blitter_bind_dsa(ctx, ctx->dsa_keep_depth_stencil);
 
-   pipe->bind_rasterizer_state(pipe, ctx->rs_state);
-   pipe->bind_fs_state(pipe, blitter_get_fs_col(ctx, 0));
-   pipe->bind_vs_state(pipe, ctx->vs);
-   pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
+   blitter_bind_fs(ctx, blitter_get_fs_col(ctx, 0));
+   blitter_bind_common(ctx);
 
    /* set a framebuffer state */
+   memset(&fb_state, 0, sizeof(fb_state));
    fb_state.width = dstsurf->width;
    fb_state.height = dstsurf->height;
    fb_state.nr_cbufs = 0;
    fb_state.cbufs[0] = 0;
    fb_state.zsbuf = dstsurf;
-   pipe->set_framebuffer_state(pipe, &fb_state);
+   blitter_set_framebuffer(ctx, &fb_state);
 
    blitter_set_dst_dimensions(ctx, dstsurf->width, dstsurf->height);
-   blitter->draw_rectangle(blitter, dstx, dsty, dstx+width, dsty+height, depth,
-                           UTIL_BLITTER_ATTRIB_NONE, NULL);
-   blitter_restore_CSOs(ctx);
+   blitter_draw(ctx, dstx, dsty, dstx+width, dsty+height, depth,
+                UTIL_BLITTER_ATTRIB_NONE, NULL);
+   blitter_end_op(ctx);
 }
 
 /* draw a rectangle across a region using a custom dsa stage - for r600g */
@@ -1032,7 +1303,6 @@ void util_blitter_custom_depth_stencil(struct blitter_context *blitter,
 				       void *dsa_stage, float depth)
 {
    struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
-   struct pipe_context *pipe = ctx->base.pipe;
    struct pipe_framebuffer_state fb_state;
 
    assert(zsurf->texture);
@@ -1040,19 +1310,18 @@ void util_blitter_custom_depth_stencil(struct blitter_context *blitter,
       return;
 
    /* check the saved state */
-   blitter_check_saved_CSOs(ctx);
+   blitter_begin_op(ctx);
    assert(blitter->saved_fb_state.nr_cbufs != ~0);
 
    /* bind CSOs */
-   pipe->bind_blend_state(pipe, ctx->blend_write_color);
-   pipe->bind_depth_stencil_alpha_state(pipe, dsa_stage);
+   blitter_bind_blend(ctx, ctx->blend_write_color);
+   blitter_bind_dsa(ctx, dsa_stage);
 
-   pipe->bind_rasterizer_state(pipe, ctx->rs_state);
-   pipe->bind_fs_state(pipe, blitter_get_fs_col(ctx, 0));
-   pipe->bind_vs_state(pipe, ctx->vs);
-   pipe->bind_vertex_elements_state(pipe, ctx->velem_state);
+   blitter_bind_fs(ctx, blitter_get_fs_col(ctx, 0));
+   blitter_bind_common(ctx);
 
    /* set a framebuffer state */
+   memset(&fb_state, 0, sizeof(fb_state));
    fb_state.width = zsurf->width;
    fb_state.height = zsurf->height;
    fb_state.nr_cbufs = 1;
@@ -1064,10 +1333,50 @@ void util_blitter_custom_depth_stencil(struct blitter_context *blitter,
 	   fb_state.nr_cbufs = 0;
    }
    fb_state.zsbuf = zsurf;
-   pipe->set_framebuffer_state(pipe, &fb_state);
+   blitter_set_framebuffer(ctx, &fb_state);
 
    blitter_set_dst_dimensions(ctx, zsurf->width, zsurf->height);
-   blitter->draw_rectangle(blitter, 0, 0, zsurf->width, zsurf->height, depth,
-                           UTIL_BLITTER_ATTRIB_NONE, NULL);
+   blitter_draw(ctx, 0, 0, zsurf->width, zsurf->height, depth,
+                UTIL_BLITTER_ATTRIB_NONE, NULL);
+   blitter_end_op(ctx);
+}
+
+void util_blitter_begin_batch(struct blitter_context *blitter)
+{
+   struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
+
+   assert(!ctx->batch);
+
+   blitter_check_saved_CSOs(ctx);
+   ctx->batch = TRUE;
+
+   /* Nothing is known to be bound yet. */
+   ctx->bound_blend = NULL;
+   ctx->bound_dsa = NULL;
+   ctx->bound_rs = NULL;
+   ctx->bound_fs = NULL;
+   ctx->bound_vs = NULL;
+   ctx->bound_velem = NULL;
+   ctx->bound_sampler = NULL;
+   ctx->bound_view = NULL;
+   ctx->bound_fb_valid = FALSE;
+   ctx->bound_stencil_ref_valid = FALSE;
+   ctx->bound_viewport_width = 0;
+   ctx->bound_viewport_height = 0;
+}
+
+void util_blitter_end_batch(struct blitter_context *blitter)
+{
+   struct blitter_context_priv *ctx = (struct blitter_context_priv*)blitter;
+
+   assert(ctx->batch);
+
+   blitter_flush_batch(ctx);
+   ctx->batch = FALSE;
+
    blitter_restore_CSOs(ctx);
+
+   util_unreference_framebuffer_state(&ctx->bound_fb);
+   pipe_surface_reference(&ctx->batch_dstsurf, NULL);
+   pipe_sampler_view_reference(&ctx->batch_view, NULL);
 }
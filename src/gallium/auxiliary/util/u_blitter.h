@@ -215,10 +215,28 @@ void util_blitter_custom_depth_stencil(struct blitter_context *blitter,
 				       struct pipe_surface *cbsurf,
 				       void *dsa_stage, float depth);
 
+/**
+ * Batch the following operations, up to util_blitter_end_batch.
+ *
+ * The saved state is checked once here and restored once at the end,
+ * instead of around every operation, so it must be saved for all the
+ * operations of the batch before this is called. State the blitter has
+ * already bound is not bound again, and the rectangles of consecutive
+ * operations drawn with the same state -- e.g. copies between the same
+ * two resources -- are drawn together. A copy reading the destination of
+ * the previous operations draws their rectangles first.
+ *
+ * Resources written by the batch must not be read by other means before
+ * util_blitter_end_batch.
+ */
+void util_blitter_begin_batch(struct blitter_context *blitter);
+
+void util_blitter_end_batch(struct blitter_context *blitter);
+
 /* The functions below should be used to save currently bound constant state
  * objects inside a driver. The objects are automatically restored at the end
- * of the util_blitter_{clear, copy_region, fill_region} functions and then
- * forgotten.
+ * of the util_blitter_{clear, copy_region, fill_region} functions, or of the
+ * batch (util_blitter_end_batch), and then forgotten.
  *
  * CSOs not listed here are not affected by util_blitter. */
 
@@ -557,6 +557,98 @@ def generate_pack_kernel(format, src_channel, src_native_type):
         print '         memcpy(dst, &pixel, sizeof pixel);'
     
 
+def is_unorm_channel(channel, max_size):
+    return channel.type == UNSIGNED and channel.norm and channel.size <= max_size
+
+
+def is_4x8unorm(format):
+    if format.block_size() != 32:
+        return False
+    for channel in format.channels:
+        if channel.size != 8:
+            return False
+        if channel.type != VOID and not is_unorm_channel(channel, 8):
+            return False
+    return True
+
+
+def is_16bit_unorm(format):
+    if format.block_size() != 16:
+        return False
+    for channel in format.channels:
+        if channel.type != VOID and not is_unorm_channel(channel, 8):
+            return False
+    return True
+
+
+def is_4xfloat(format, size):
+    for channel in format.channels:
+        if channel.type != FLOAT or channel.size != size:
+            return False
+    return format.swizzles == [SWIZZLE_X, SWIZZLE_Y, SWIZZLE_Z, SWIZZLE_W]
+
+
+def sse_variant(format, direction, suffix):
+    '''Return the u_format_sse.c kernel converting rows of the format in the
+    given direction, the util_cpu_caps flag it needs and the format specific
+    arguments it takes, or None.'''
+
+    if format.layout != PLAIN or format.colorspace != RGB:
+        return None
+
+    if direction == 'unpack':
+        swizzles = format.swizzles
+    else:
+        swizzles = [swizzle is None and SWIZZLE_0 or swizzle for swizzle in format.inv_swizzles()]
+
+    if is_4x8unorm(format):
+        if suffix == 'rgba_8unorm':
+            return 'util_format_swizzle_4x8unorm_ssse3', 'has_ssse3', [('swizzle', swizzles)]
+        else:
+            return 'util_format_%s_4x8unorm_float_ssse3' % direction, 'has_ssse3', [('swizzle', swizzles)]
+
+    if is_4xfloat(format, 16) and suffix == 'rgba_float':
+        return 'util_format_%s_4x16float_float_sse2' % direction, 'has_sse2', []
+
+    if is_4xfloat(format, 32) and suffix == 'rgba_8unorm':
+        return 'util_format_%s_4x32float_8unorm_sse2' % direction, 'has_sse2', []
+
+    if is_16bit_unorm(format) and suffix == 'rgba_8unorm':
+        shifts = []
+        sizes = []
+        shift = 0
+        for channel in format.channels:
+            shifts.append(shift)
+            if channel.type == VOID:
+                sizes.append(0)
+            else:
+                sizes.append(channel.size)
+            shift += channel.size
+        return 'util_format_%s_16bit_8unorm_sse2' % direction, 'has_sse2', [('shift', shifts), ('size', sizes), ('swizzle', swizzles)]
+
+    return None
+
+
+def generate_sse_dispatch(format, direction, suffix):
+    '''Generate the code handing whole rows over to an SSE kernel, when
+    there is one for the format and the CPU supports it.'''
+
+    variant = sse_variant(format, direction, suffix)
+    if variant is None:
+        return
+
+    function, cap, args = variant
+
+    print '#ifdef PIPE_ARCH_SSE'
+    print '   if (util_cpu_caps.%s) {' % cap
+    for name, values in args:
+        print '      static const unsigned char %s[4] = {%s};' % (name, ', '.join([str(value) for value in values]))
+    print '      %s(dst_row, dst_stride, src_row, src_stride, width, height%s);' % (function, ''.join([', ' + name for name, values in args]))
+    print '      return;'
+    print '   }'
+    print '#endif'
+
+
 def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
     '''Generate the function to unpack pixels from a particular format'''
 
@@ -568,6 +660,7 @@ def generate_format_unpack(format, dst_channel, dst_native_type, dst_suffix):
 
     if is_format_supported(format):
         print '   unsigned x, y;'
+        generate_sse_dispatch(format, 'unpack', dst_suffix)
         print '   for(y = 0; y < height; y += %u) {' % (format.block_height,)
         print '      %s *dst = dst_row;' % (dst_native_type)
         print '      const uint8_t *src = src_row;'
@@ -597,6 +690,7 @@ def generate_format_pack(format, src_channel, src_native_type, src_suffix):
     
     if is_format_supported(format):
         print '   unsigned x, y;'
+        generate_sse_dispatch(format, 'pack', src_suffix)
         print '   for(y = 0; y < height; y += %u) {' % (format.block_height,)
         print '      const %s *src = src_row;' % (src_native_type)
         print '      uint8_t *dst = dst_row;'
@@ -640,8 +734,10 @@ def generate(formats):
     print '#include "pipe/p_compiler.h"'
     print '#include "u_math.h"'
     print '#include "u_half.h"'
+    print '#include "u_cpu_detect.h"'
     print '#include "u_format.h"'
     print '#include "u_format_other.h"'
+    print '#include "u_format_sse.h"'
     print '#include "u_format_srgb.h"'
     print '#include "u_format_yuv.h"'
     print '#include "u_format_zs.h"'
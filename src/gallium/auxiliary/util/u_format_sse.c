@@ -0,0 +1,633 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "u_format_sse.h"
+
+
+#if defined(PIPE_ARCH_SSE)
+
+#include "u_format.h"
+#include "u_half.h"
+#include "u_math.h"
+#include "u_sse.h"
+
+
+static INLINE uint8_t
+swizzle_ubyte(const uint8_t *src, unsigned swizzle)
+{
+   if (swizzle < 4)
+      return src[swizzle];
+   return swizzle == UTIL_FORMAT_SWIZZLE_1 ? 255 : 0;
+}
+
+
+/**
+ * pshufb mask applying the swizzle to four pixels of four bytes, and the
+ * bytes to set for UTIL_FORMAT_SWIZZLE_1.
+ */
+static void
+swizzle_4x8_masks(const unsigned char swizzle[4],
+                  __m128i *shuffle, __m128i *ones)
+{
+   union m128i s, o;
+   unsigned i;
+
+   for (i = 0; i < 16; ++i) {
+      unsigned swz = swizzle[i % 4];
+      s.ub[i] = swz < 4 ? (i & ~3) + swz : 0x80;
+      o.ub[i] = swz == UTIL_FORMAT_SWIZZLE_1 ? 0xff : 0;
+   }
+
+   *shuffle = s.m;
+   *ones = o.m;
+}
+
+
+/**
+ * float_to_ubyte() on four floats, giving four 32 bit integers.
+ */
+static INLINE __m128i
+float_to_ubyte_sse2(__m128 f)
+{
+   __m128i i = _mm_castps_si128(f);
+   __m128i neg = _mm_cmplt_epi32(i, _mm_setzero_si128());
+   __m128i big = _mm_cmpgt_epi32(i, _mm_set1_epi32(0x3f7f0000 - 1));
+   __m128i byte = _mm_set1_epi32(0xff);
+   __m128 t;
+   __m128i r;
+
+   t = _mm_mul_ps(f, _mm_set1_ps(255.0f/256.0f));
+   t = _mm_add_ps(t, _mm_set1_ps(32768.0f));
+   r = _mm_and_si128(_mm_castps_si128(t), byte);
+   r = _mm_andnot_si128(_mm_or_si128(neg, big), r);
+   return _mm_or_si128(r, _mm_and_si128(big, byte));
+}
+
+
+/**
+ * Four pixels of 32 bit integers in [0, 255] to 16 rgba bytes.
+ */
+static INLINE __m128i
+pack_4x4_ubyte(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+   return _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+}
+
+
+/**
+ * ubyte_to_float() on the four bytes at the bottom of each 32 bit lane.
+ */
+static INLINE __m128
+ubyte_to_float_sse2(__m128i i)
+{
+   return _mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(1.0f / 255.0f));
+}
+
+
+/**
+ * Store 16 rgba bytes as four pixels of floats.
+ */
+static INLINE void
+store_4x4_ubyte_float(float *dst, __m128i v)
+{
+   const __m128i zero = _mm_setzero_si128();
+   __m128i lo = _mm_unpacklo_epi8(v, zero);
+   __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+   _mm_storeu_ps(dst + 0, ubyte_to_float_sse2(_mm_unpacklo_epi16(lo, zero)));
+   _mm_storeu_ps(dst + 4, ubyte_to_float_sse2(_mm_unpackhi_epi16(lo, zero)));
+   _mm_storeu_ps(dst + 8, ubyte_to_float_sse2(_mm_unpacklo_epi16(hi, zero)));
+   _mm_storeu_ps(dst + 12, ubyte_to_float_sse2(_mm_unpackhi_epi16(hi, zero)));
+}
+
+
+/**
+ * util_half_to_floatui() on four halves in the bottom of 32 bit lanes.
+ * Denormals are not handled; the lanes holding one are flagged in the
+ * returned movemask so that the caller can fall back to the tables.
+ */
+static INLINE __m128i
+half_to_float_sse2(__m128i h, int *denorm)
+{
+   const __m128i bias = _mm_set1_epi32(0x38000000);
+   __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+   __m128i em = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+   __m128i zero = _mm_cmpeq_epi32(em, _mm_setzero_si128());
+   __m128i small = _mm_cmplt_epi32(em, _mm_set1_epi32(0x400));
+   __m128i inf = _mm_cmpgt_epi32(em, _mm_set1_epi32(0x7bff));
+   __m128i f;
+
+   /* rebias the exponent, twice for infinities and NaNs */
+   f = _mm_add_epi32(_mm_slli_epi32(em, 13), bias);
+   f = _mm_add_epi32(f, _mm_and_si128(inf, bias));
+   f = _mm_andnot_si128(zero, f);
+
+   *denorm = _mm_movemask_epi8(_mm_andnot_si128(zero, small));
+   return _mm_or_si128(f, sign);
+}
+
+
+/**
+ * util_floatui_to_half() on four floats, in the bottom of 32 bit lanes.
+ * Like above, lanes that would give a denormal are left to the caller.
+ */
+static INLINE __m128i
+float_to_half_sse2(__m128i f, int *denorm)
+{
+   __m128i e = _mm_and_si128(_mm_srli_epi32(f, 23), _mm_set1_epi32(0xff));
+   __m128i sign = _mm_and_si128(_mm_srli_epi32(f, 16), _mm_set1_epi32(0x8000));
+   __m128i m = _mm_srli_epi32(_mm_and_si128(f, _mm_set1_epi32(0x7fffff)), 13);
+   __m128i small = _mm_cmplt_epi32(e, _mm_set1_epi32(113));
+   __m128i big = _mm_cmpgt_epi32(e, _mm_set1_epi32(142));
+   __m128i nan = _mm_cmpeq_epi32(e, _mm_set1_epi32(255));
+   __m128i h;
+
+   h = _mm_slli_epi32(_mm_sub_epi32(e, _mm_set1_epi32(112)), 10);
+   h = _mm_add_epi32(h, m);
+   h = _mm_or_si128(_mm_andnot_si128(big, h),
+                    _mm_and_si128(big, _mm_set1_epi32(0x7c00)));
+   /* infinities and NaNs keep the top of the mantissa */
+   h = _mm_add_epi32(h, _mm_and_si128(nan, m));
+   h = _mm_andnot_si128(small, h);
+
+   *denorm = _mm_movemask_epi8(_mm_and_si128(small,
+                                             _mm_cmpgt_epi32(e, _mm_set1_epi32(102))));
+   return _mm_or_si128(h, sign);
+}
+
+
+/**
+ * Pack two vectors of 32 bit lanes holding 16 bit values.
+ */
+static INLINE __m128i
+pack_epi32_to_epi16(__m128i a, __m128i b)
+{
+   a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+   b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+   return _mm_packs_epi32(a, b);
+}
+
+
+void
+util_format_swizzle_4x8unorm_ssse3(uint8_t *dst_row, unsigned dst_stride,
+                                   const uint8_t *src_row, unsigned src_stride,
+                                   unsigned width, unsigned height,
+                                   const unsigned char swizzle[4])
+{
+   __m128i shuffle, ones;
+   unsigned x, y, i;
+
+   swizzle_4x8_masks(swizzle, &shuffle, &ones);
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 4 <= width; x += 4) {
+         __m128i v = _mm_loadu_si128((const __m128i *)src);
+         v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), ones);
+         _mm_storeu_si128((__m128i *)dst, v);
+         src += 16;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         uint8_t tmp[4];
+         for (i = 0; i < 4; ++i)
+            tmp[i] = swizzle_ubyte(src, swizzle[i]);
+         memcpy(dst, tmp, 4);
+         src += 4;
+         dst += 4;
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride;
+   }
+}
+
+
+void
+util_format_unpack_4x8unorm_float_ssse3(float *dst_row, unsigned dst_stride,
+                                        const uint8_t *src_row, unsigned src_stride,
+                                        unsigned width, unsigned height,
+                                        const unsigned char swizzle[4])
+{
+   __m128i shuffle, ones;
+   unsigned x, y, i;
+
+   swizzle_4x8_masks(swizzle, &shuffle, &ones);
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      float *dst = dst_row;
+
+      for (x = 0; x + 4 <= width; x += 4) {
+         __m128i v = _mm_loadu_si128((const __m128i *)src);
+         v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), ones);
+         store_4x4_ubyte_float(dst, v);
+         src += 16;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         for (i = 0; i < 4; ++i)
+            dst[i] = ubyte_to_float(swizzle_ubyte(src, swizzle[i]));
+         src += 4;
+         dst += 4;
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride/sizeof(*dst_row);
+   }
+}
+
+
+void
+util_format_pack_4x8unorm_float_ssse3(uint8_t *dst_row, unsigned dst_stride,
+                                      const float *src_row, unsigned src_stride,
+                                      unsigned width, unsigned height,
+                                      const unsigned char swizzle[4])
+{
+   __m128i shuffle, ones;
+   unsigned x, y, i;
+
+   swizzle_4x8_masks(swizzle, &shuffle, &ones);
+
+   for (y = 0; y < height; ++y) {
+      const float *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 4 <= width; x += 4) {
+         __m128i v;
+         v = pack_4x4_ubyte(float_to_ubyte_sse2(_mm_loadu_ps(src + 0)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(src + 4)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(src + 8)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(src + 12)));
+         v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), ones);
+         _mm_storeu_si128((__m128i *)dst, v);
+         src += 16;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         uint8_t rgba[4], tmp[4];
+         for (i = 0; i < 4; ++i)
+            rgba[i] = float_to_ubyte(src[i]);
+         for (i = 0; i < 4; ++i)
+            tmp[i] = swizzle_ubyte(rgba, swizzle[i]);
+         memcpy(dst, tmp, 4);
+         src += 4;
+         dst += 4;
+      }
+
+      dst_row += dst_stride;
+      src_row += src_stride/sizeof(*src_row);
+   }
+}
+
+
+void
+util_format_unpack_4x16float_float_sse2(float *dst_row, unsigned dst_stride,
+                                        const uint8_t *src_row, unsigned src_stride,
+                                        unsigned width, unsigned height)
+{
+   const __m128i zero = _mm_setzero_si128();
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      float *dst = dst_row;
+
+      for (x = 0; x + 2 <= width; x += 2) {
+         __m128i h = _mm_loadu_si128((const __m128i *)src);
+         __m128i f0, f1;
+         int denorm0, denorm1;
+
+         f0 = half_to_float_sse2(_mm_unpacklo_epi16(h, zero), &denorm0);
+         f1 = half_to_float_sse2(_mm_unpackhi_epi16(h, zero), &denorm1);
+         _mm_storeu_si128((__m128i *)(dst + 0), f0);
+         _mm_storeu_si128((__m128i *)(dst + 4), f1);
+
+         if (denorm0 | denorm1) {
+            uint16_t tmp[8];
+            memcpy(tmp, src, sizeof tmp);
+            for (i = 0; i < 8; ++i)
+               dst[i] = util_half_to_float(tmp[i]);
+         }
+
+         src += 16;
+         dst += 8;
+      }
+
+      for (; x < width; ++x) {
+         uint16_t tmp[4];
+         memcpy(tmp, src, sizeof tmp);
+         for (i = 0; i < 4; ++i)
+            dst[i] = util_half_to_float(tmp[i]);
+         src += 8;
+         dst += 4;
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride/sizeof(*dst_row);
+   }
+}
+
+
+void
+util_format_pack_4x16float_float_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                      const float *src_row, unsigned src_stride,
+                                      unsigned width, unsigned height)
+{
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const float *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 2 <= width; x += 2) {
+         __m128i f0 = _mm_loadu_si128((const __m128i *)(src + 0));
+         __m128i f1 = _mm_loadu_si128((const __m128i *)(src + 4));
+         __m128i h0, h1;
+         int denorm0, denorm1;
+
+         h0 = float_to_half_sse2(f0, &denorm0);
+         h1 = float_to_half_sse2(f1, &denorm1);
+
+         if (denorm0 | denorm1) {
+            uint16_t tmp[8];
+            for (i = 0; i < 8; ++i)
+               tmp[i] = util_float_to_half(src[i]);
+            memcpy(dst, tmp, sizeof tmp);
+         }
+         else {
+            _mm_storeu_si128((__m128i *)dst, pack_epi32_to_epi16(h0, h1));
+         }
+
+         src += 8;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         uint16_t tmp[4];
+         for (i = 0; i < 4; ++i)
+            tmp[i] = util_float_to_half(src[i]);
+         memcpy(dst, tmp, sizeof tmp);
+         src += 4;
+         dst += 8;
+      }
+
+      dst_row += dst_stride;
+      src_row += src_stride/sizeof(*src_row);
+   }
+}
+
+
+void
+util_format_unpack_4x32float_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                         const uint8_t *src_row, unsigned src_stride,
+                                         unsigned width, unsigned height)
+{
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 4 <= width; x += 4) {
+         const float *f = (const float *)src;
+         __m128i v;
+         v = pack_4x4_ubyte(float_to_ubyte_sse2(_mm_loadu_ps(f + 0)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(f + 4)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(f + 8)),
+                            float_to_ubyte_sse2(_mm_loadu_ps(f + 12)));
+         _mm_storeu_si128((__m128i *)dst, v);
+         src += 64;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         float tmp[4];
+         memcpy(tmp, src, sizeof tmp);
+         for (i = 0; i < 4; ++i)
+            dst[i] = float_to_ubyte(tmp[i]);
+         src += 16;
+         dst += 4;
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride;
+   }
+}
+
+
+void
+util_format_pack_4x32float_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                       const uint8_t *src_row, unsigned src_stride,
+                                       unsigned width, unsigned height)
+{
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 4 <= width; x += 4) {
+         store_4x4_ubyte_float((float *)dst,
+                               _mm_loadu_si128((const __m128i *)src));
+         src += 16;
+         dst += 64;
+      }
+
+      for (; x < width; ++x) {
+         float tmp[4];
+         for (i = 0; i < 4; ++i)
+            tmp[i] = ubyte_to_float(src[i]);
+         memcpy(dst, tmp, sizeof tmp);
+         src += 4;
+         dst += 16;
+      }
+
+      dst_row += dst_stride;
+      src_row += src_stride;
+   }
+}
+
+
+/**
+ * Multiplier and shift dividing x * 0xff by 2**size - 1 with _mm_mulhi_epu16,
+ * exact for x up to 2**size - 1. A 1 bit channel needs no division.
+ */
+static const struct {
+   unsigned short mul;
+   unsigned char shift;
+} unorm_div[9] = {
+   {0, 0},
+   {0, 0},
+   {21846, 0},
+   {9363, 0},
+   {4370, 0},
+   {8457, 2},
+   {8323, 3},
+   {33027, 6},
+   {258, 0}
+};
+
+
+static INLINE uint8_t
+expand_unorm_ubyte(unsigned value, unsigned shift, unsigned size)
+{
+   unsigned max = (1 << size) - 1;
+   return (uint8_t)(((value >> shift) & max) * 0xff / max);
+}
+
+
+void
+util_format_unpack_16bit_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                     const uint8_t *src_row, unsigned src_stride,
+                                     unsigned width, unsigned height,
+                                     const unsigned char shift[4],
+                                     const unsigned char size[4],
+                                     const unsigned char swizzle[4])
+{
+   const __m128i ubyte_max = _mm_set1_epi16(0xff);
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 8 <= width; x += 8) {
+         __m128i v = _mm_loadu_si128((const __m128i *)src);
+         __m128i rgba[4], rg, ba;
+
+         for (i = 0; i < 4; ++i) {
+            unsigned swz = swizzle[i];
+            if (swz < 4 && size[swz]) {
+               unsigned n = size[swz];
+               __m128i c;
+               c = _mm_srl_epi16(v, _mm_cvtsi32_si128(shift[swz]));
+               c = _mm_and_si128(c, _mm_set1_epi16((1 << n) - 1));
+               c = _mm_mullo_epi16(c, ubyte_max);
+               if (unorm_div[n].mul) {
+                  c = _mm_mulhi_epu16(c, _mm_set1_epi16(unorm_div[n].mul));
+                  c = _mm_srl_epi16(c, _mm_cvtsi32_si128(unorm_div[n].shift));
+               }
+               rgba[i] = c;
+            }
+            else if (swz == UTIL_FORMAT_SWIZZLE_1) {
+               rgba[i] = ubyte_max;
+            }
+            else {
+               rgba[i] = _mm_setzero_si128();
+            }
+         }
+
+         rg = _mm_or_si128(rgba[0], _mm_slli_epi16(rgba[1], 8));
+         ba = _mm_or_si128(rgba[2], _mm_slli_epi16(rgba[3], 8));
+         _mm_storeu_si128((__m128i *)(dst + 0), _mm_unpacklo_epi16(rg, ba));
+         _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+         src += 16;
+         dst += 32;
+      }
+
+      for (; x < width; ++x) {
+         uint16_t value;
+         memcpy(&value, src, sizeof value);
+         for (i = 0; i < 4; ++i) {
+            unsigned swz = swizzle[i];
+            if (swz < 4 && size[swz])
+               dst[i] = expand_unorm_ubyte(value, shift[swz], size[swz]);
+            else
+               dst[i] = swz == UTIL_FORMAT_SWIZZLE_1 ? 255 : 0;
+         }
+         src += 2;
+         dst += 4;
+      }
+
+      src_row += src_stride;
+      dst_row += dst_stride;
+   }
+}
+
+
+void
+util_format_pack_16bit_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                   const uint8_t *src_row, unsigned src_stride,
+                                   unsigned width, unsigned height,
+                                   const unsigned char shift[4],
+                                   const unsigned char size[4],
+                                   const unsigned char swizzle[4])
+{
+   const __m128i byte = _mm_set1_epi32(0xff);
+   unsigned x, y, i;
+
+   for (y = 0; y < height; ++y) {
+      const uint8_t *src = src_row;
+      uint8_t *dst = dst_row;
+
+      for (x = 0; x + 8 <= width; x += 8) {
+         __m128i v0 = _mm_loadu_si128((const __m128i *)(src + 0));
+         __m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+         __m128i p0 = _mm_setzero_si128();
+         __m128i p1 = _mm_setzero_si128();
+
+         for (i = 0; i < 4; ++i) {
+            unsigned swz = swizzle[i];
+            if (swz < 4 && size[i]) {
+               __m128i from = _mm_cvtsi32_si128(8 * swz + 8 - size[i]);
+               __m128i to = _mm_cvtsi32_si128(shift[i]);
+               __m128i mask = _mm_srli_epi32(byte, 8 - size[i]);
+               __m128i c0, c1;
+               c0 = _mm_and_si128(_mm_srl_epi32(v0, from), mask);
+               c1 = _mm_and_si128(_mm_srl_epi32(v1, from), mask);
+               p0 = _mm_or_si128(p0, _mm_sll_epi32(c0, to));
+               p1 = _mm_or_si128(p1, _mm_sll_epi32(c1, to));
+            }
+         }
+
+         _mm_storeu_si128((__m128i *)dst, pack_epi32_to_epi16(p0, p1));
+         src += 32;
+         dst += 16;
+      }
+
+      for (; x < width; ++x) {
+         uint16_t value = 0;
+         for (i = 0; i < 4; ++i) {
+            unsigned swz = swizzle[i];
+            if (swz < 4 && size[i])
+               value |= (uint16_t)((src[swz] >> (8 - size[i])) << shift[i]);
+         }
+         memcpy(dst, &value, sizeof value);
+         src += 4;
+         dst += 2;
+      }
+
+      dst_row += dst_stride;
+      src_row += src_stride;
+   }
+}
+
+
+#endif /* PIPE_ARCH_SSE */
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SSE2/SSSE3 row conversion kernels shared by the generated pack/unpack
+ * functions (see u_format_pack.py).
+ *
+ * Each kernel covers a class of formats, the generated code passes the
+ * layout of the particular format and only calls it when util_cpu_caps
+ * reports the needed instruction set. The results are bit for bit the
+ * same as the ones of the generated C code.
+ *
+ * Swizzles are arrays of UTIL_FORMAT_SWIZZLE_* values, one per destination
+ * channel, UTIL_FORMAT_SWIZZLE_NONE standing for 0.
+ */
+
+
+#ifndef U_FORMAT_SSE_H_
+#define U_FORMAT_SSE_H_
+
+
+#include "pipe/p_config.h"
+#include "pipe/p_compiler.h"
+
+
+#if defined(PIPE_ARCH_SSE)
+
+
+/**
+ * Formats with four 8 bit unorm channels from/to rgba 8unorm. This is a
+ * byte shuffle, so it serves both directions: unpacking takes the format
+ * swizzle, packing its inverse.
+ */
+void
+util_format_swizzle_4x8unorm_ssse3(uint8_t *dst_row, unsigned dst_stride,
+                                   const uint8_t *src_row, unsigned src_stride,
+                                   unsigned width, unsigned height,
+                                   const unsigned char swizzle[4]);
+
+void
+util_format_unpack_4x8unorm_float_ssse3(float *dst_row, unsigned dst_stride,
+                                        const uint8_t *src_row, unsigned src_stride,
+                                        unsigned width, unsigned height,
+                                        const unsigned char swizzle[4]);
+
+void
+util_format_pack_4x8unorm_float_ssse3(uint8_t *dst_row, unsigned dst_stride,
+                                      const float *src_row, unsigned src_stride,
+                                      unsigned width, unsigned height,
+                                      const unsigned char swizzle[4]);
+
+
+/**
+ * PIPE_FORMAT_R16G16B16A16_FLOAT from/to rgba float.
+ */
+void
+util_format_unpack_4x16float_float_sse2(float *dst_row, unsigned dst_stride,
+                                        const uint8_t *src_row, unsigned src_stride,
+                                        unsigned width, unsigned height);
+
+void
+util_format_pack_4x16float_float_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                      const float *src_row, unsigned src_stride,
+                                      unsigned width, unsigned height);
+
+
+/**
+ * PIPE_FORMAT_R32G32B32A32_FLOAT from/to rgba 8unorm.
+ */
+void
+util_format_unpack_4x32float_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                         const uint8_t *src_row, unsigned src_stride,
+                                         unsigned width, unsigned height);
+
+void
+util_format_pack_4x32float_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                       const uint8_t *src_row, unsigned src_stride,
+                                       unsigned width, unsigned height);
+
+
+/**
+ * 16 bit formats made of unorm channels of up to 8 bits from/to rgba
+ * 8unorm. shift and size describe the format channels, a size of 0 marking
+ * a void channel. Unpacking takes the format swizzle, packing its inverse.
+ */
+void
+util_format_unpack_16bit_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                     const uint8_t *src_row, unsigned src_stride,
+                                     unsigned width, unsigned height,
+                                     const unsigned char shift[4],
+                                     const unsigned char size[4],
+                                     const unsigned char swizzle[4]);
+
+void
+util_format_pack_16bit_8unorm_sse2(uint8_t *dst_row, unsigned dst_stride,
+                                   const uint8_t *src_row, unsigned src_stride,
+                                   unsigned width, unsigned height,
+                                   const unsigned char shift[4],
+                                   const unsigned char size[4],
+                                   const unsigned char swizzle[4]);
+
+
+#endif /* PIPE_ARCH_SSE */
+
+
+#endif /* U_FORMAT_SSE_H_ */
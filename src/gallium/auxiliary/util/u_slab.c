@@ -22,6 +22,7 @@
 
 #include "util/u_slab.h"
 
+#include "util/u_atomic.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_simple_list.h"
@@ -30,6 +31,11 @@
 
 #define UTIL_SLAB_MAGIC 0xcafe4321
 
+/* Id of the calling thread, starting at 1. */
+static pipe_tsd util_slab_thread_tsd;
+static unsigned util_slab_num_threads;
+pipe_static_mutex(util_slab_thread_mutex);
+
 /* The block is either allocated memory or free space. */
 struct util_slab_block {
    /* The header. */
@@ -103,7 +109,8 @@ static void util_slab_free_st(struct util_slab_mempool *pool, void *ptr)
    pool->first_free = block;
 }
 
-static void *util_slab_alloc_mt(struct util_slab_mempool *pool)
+/* The pool functions locked, for the threads without a cache. */
+static void *util_slab_alloc_locked(struct util_slab_mempool *pool)
 {
    void *mem;
 
@@ -113,19 +120,195 @@ static void *util_slab_alloc_mt(struct util_slab_mempool *pool)
    return mem;
 }
 
-static void util_slab_free_mt(struct util_slab_mempool *pool, void *ptr)
+static void util_slab_free_locked(struct util_slab_mempool *pool, void *ptr)
 {
    pipe_mutex_lock(pool->mutex);
    util_slab_free_st(pool, ptr);
    pipe_mutex_unlock(pool->mutex);
 }
 
+/* Return the cache of the calling thread, claiming it on first use, or NULL
+ * if it belongs to another thread.  Only its owner touches a cache, so it
+ * is used without locking. */
+static struct util_slab_cache *
+util_slab_get_cache(struct util_slab_mempool *pool)
+{
+   uintptr_t id = (uintptr_t) pipe_tsd_get(&util_slab_thread_tsd);
+   struct util_slab_cache *cache;
+   int32_t owner;
+
+   if (!id) {
+      pipe_mutex_lock(util_slab_thread_mutex);
+      id = ++util_slab_num_threads;
+      pipe_mutex_unlock(util_slab_thread_mutex);
+      pipe_tsd_set(&util_slab_thread_tsd, (void *) id);
+   }
+
+   cache = &pool->caches[(id - 1) % UTIL_SLAB_NUM_CACHES];
+   owner = p_atomic_read(&cache->owner);
+   if (owner == (int32_t) id)
+      return cache;
+   if (!owner && p_atomic_cmpxchg(&cache->owner, 0, (int32_t) id) == 0)
+      return cache;
+   return NULL;
+}
+
+/* Return an empty magazine from the depot.  The pool mutex must be held. */
+static struct util_slab_magazine *
+util_slab_get_empty_magazine(struct util_slab_mempool *pool)
+{
+   struct util_slab_magazine *mag = pool->empty_magazines;
+
+   if (mag)
+      pool->empty_magazines = mag->next;
+   else
+      mag = MALLOC_STRUCT(util_slab_magazine);
+
+   if (mag)
+      mag->count = 0;
+   return mag;
+}
+
+static void *util_slab_alloc_mt(struct util_slab_mempool *pool)
+{
+   struct util_slab_cache *cache = util_slab_get_cache(pool);
+   struct util_slab_magazine *mag;
+
+   if (!cache)
+      return util_slab_alloc_locked(pool);
+
+   if (!cache->loaded->count) {
+      if (cache->previous->count) {
+         mag = cache->previous;
+         cache->previous = cache->loaded;
+         cache->loaded = mag;
+      }
+      else {
+         pipe_mutex_lock(pool->mutex);
+         if (pool->full_magazines) {
+            /* Trade the empty magazine for a full one. */
+            mag = pool->full_magazines;
+            pool->full_magazines = mag->next;
+            cache->loaded->next = pool->empty_magazines;
+            pool->empty_magazines = cache->loaded;
+            cache->loaded = mag;
+         }
+         else {
+            /* Refill from the pages. */
+            mag = cache->loaded;
+            while (mag->count < UTIL_SLAB_MAGAZINE_SIZE)
+               mag->rounds[mag->count++] = util_slab_alloc_st(pool);
+         }
+         pipe_mutex_unlock(pool->mutex);
+      }
+   }
+
+   return cache->loaded->rounds[--cache->loaded->count];
+}
+
+static void util_slab_free_mt(struct util_slab_mempool *pool, void *ptr)
+{
+   struct util_slab_cache *cache = util_slab_get_cache(pool);
+   struct util_slab_magazine *mag;
+
+   assert(((struct util_slab_block*)
+           ((uint8_t*)ptr - sizeof(struct util_slab_block)))->magic ==
+          UTIL_SLAB_MAGIC);
+
+   if (!cache) {
+      util_slab_free_locked(pool, ptr);
+      return;
+   }
+
+   if (cache->loaded->count == UTIL_SLAB_MAGAZINE_SIZE) {
+      if (cache->previous->count == 0) {
+         mag = cache->previous;
+         cache->previous = cache->loaded;
+         cache->loaded = mag;
+      }
+      else {
+         /* Trade the full magazine for an empty one. */
+         pipe_mutex_lock(pool->mutex);
+         mag = util_slab_get_empty_magazine(pool);
+         if (!mag) {
+            util_slab_free_st(pool, ptr);
+            pipe_mutex_unlock(pool->mutex);
+            return;
+         }
+         cache->previous->next = pool->full_magazines;
+         pool->full_magazines = cache->previous;
+         cache->previous = cache->loaded;
+         cache->loaded = mag;
+         pipe_mutex_unlock(pool->mutex);
+      }
+   }
+
+   cache->loaded->rounds[cache->loaded->count++] = ptr;
+}
+
+static void util_slab_free_magazines(struct util_slab_magazine *mag)
+{
+   while (mag) {
+      struct util_slab_magazine *next = mag->next;
+      FREE(mag);
+      mag = next;
+   }
+}
+
+static void util_slab_destroy_caches(struct util_slab_mempool *pool,
+                                     unsigned num_caches)
+{
+   unsigned i;
+
+   for (i = 0; i < num_caches; i++) {
+      FREE(pool->caches[i].loaded);
+      FREE(pool->caches[i].previous);
+   }
+   FREE(pool->caches);
+   pool->caches = NULL;
+}
+
+/* Set up the thread caches.  Returns FALSE if out of memory. */
+static boolean util_slab_create_caches(struct util_slab_mempool *pool)
+{
+   unsigned i;
+
+   pipe_mutex_lock(util_slab_thread_mutex);
+   if (util_slab_thread_tsd.initMagic != (int) PIPE_TSD_INIT_MAGIC)
+      pipe_tsd_init(&util_slab_thread_tsd);
+   pipe_mutex_unlock(util_slab_thread_mutex);
+
+   pool->caches = CALLOC(UTIL_SLAB_NUM_CACHES, sizeof(*pool->caches));
+   if (!pool->caches)
+      return FALSE;
+
+   for (i = 0; i < UTIL_SLAB_NUM_CACHES; i++) {
+      struct util_slab_cache *cache = &pool->caches[i];
+
+      cache->loaded = CALLOC_STRUCT(util_slab_magazine);
+      cache->previous = CALLOC_STRUCT(util_slab_magazine);
+      if (!cache->loaded || !cache->previous) {
+         util_slab_destroy_caches(pool, i + 1);
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/* Blocks held by the thread caches and the depot remain there when
+ * switching to the singlethreaded mode, for when the pool becomes
+ * multithreaded again; they're released with the pages.
+ */
 void util_slab_set_thread_safety(struct util_slab_mempool *pool,
                                     enum util_slab_threading threading)
 {
    pool->threading = threading;
 
-   if (threading) {
+   if (threading && !pool->caches && !util_slab_create_caches(pool)) {
+      /* Fall back to locking around the singlethreaded functions. */
+      pool->alloc = util_slab_alloc_locked;
+      pool->free = util_slab_free_locked;
+   } else if (threading) {
       pool->alloc = util_slab_alloc_mt;
       pool->free = util_slab_free_mt;
    } else {
@@ -148,6 +331,9 @@ void util_slab_create(struct util_slab_mempool *pool,
    pool->page_size = sizeof(struct util_slab_page) +
                      num_blocks * pool->block_size;
    pool->first_free = NULL;
+   pool->caches = NULL;
+   pool->full_magazines = NULL;
+   pool->empty_magazines = NULL;
 
    make_empty_list(&pool->list);
 
@@ -160,6 +346,11 @@ void util_slab_destroy(struct util_slab_mempool *pool)
 {
    struct util_slab_page *page, *temp;
 
+   if (pool->caches)
+      util_slab_destroy_caches(pool, UTIL_SLAB_NUM_CACHES);
+   util_slab_free_magazines(pool->full_magazines);
+   util_slab_free_magazines(pool->empty_magazines);
+
    foreach_s(page, temp, &pool->list) {
       remove_from_list(page);
       FREE(page);
@@ -30,6 +30,16 @@
  *
  * Candidates: get_transfer, user_buffer_create
  *
+ * In the multithreaded mode each thread allocates from and frees to its own
+ * cache of blocks (two "magazines" of up to UTIL_SLAB_MAGAZINE_SIZE blocks)
+ * without taking any lock.  Only when both are empty (or full) is the
+ * mutex-protected depot of the pool used, exchanging a whole magazine at a
+ * time.  Blocks may be freed by any thread.
+ *
+ * A cache belongs to the first thread using it for good.  Threads whose
+ * cache is taken by another thread, and pools whose caches couldn't be
+ * allocated, fall back to locking the pool around every call.
+ *
  * @author Marek Olšák
  */
 
@@ -43,6 +53,27 @@ enum util_slab_threading {
    UTIL_SLAB_MULTITHREADED = TRUE
 };
 
+#define UTIL_SLAB_MAGAZINE_SIZE 32
+
+/* Number of thread caches per pool.  Threads are given one each,
+ * round-robin. */
+#define UTIL_SLAB_NUM_CACHES 8
+
+/* A stack of free blocks. */
+struct util_slab_magazine {
+   struct util_slab_magazine *next;
+   unsigned count;
+   void *rounds[UTIL_SLAB_MAGAZINE_SIZE];
+};
+
+struct util_slab_cache {
+   int32_t owner;   /* id of the owning thread, 0 if none yet */
+   struct util_slab_magazine *loaded, *previous;
+
+   /* Keep the caches of different threads on different cache lines. */
+   uint8_t pad[64];
+};
+
 /* The page is an array of blocks (allocations). */
 struct util_slab_page {
    /* The header (linked-list pointers). */
@@ -68,7 +99,13 @@ struct util_slab_mempool {
    unsigned num_pages;
    enum util_slab_threading threading;
 
+   /* Protects the members above and the depot in the multithreaded mode. */
    pipe_mutex mutex;
+
+   /* Multithreaded mode. */
+   struct util_slab_cache *caches;
+   struct util_slab_magazine *full_magazines;
+   struct util_slab_magazine *empty_magazines;
 };
 
 void util_slab_create(struct util_slab_mempool *pool,
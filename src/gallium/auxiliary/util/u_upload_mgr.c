@@ -27,17 +27,39 @@
 
 /* Helper utility for uploading user buffers & other data, and
  * coalescing small buffers into larger ones.
+ *
+ * The upload buffer is used as a ring: once the end is reached,
+ * allocations start over from the beginning, behind the data the GPU may
+ * still read. What the GPU may still read is known from the fences the
+ * driver hands to u_upload_fence(); when the ring catches up with them
+ * only the oldest fences are waited for. Without fences, or when the
+ * fences don't free enough space, a new buffer is allocated as before.
  */
 
 #include "pipe/p_defines.h"
 #include "util/u_inlines.h"
 #include "pipe/p_context.h"
+#include "pipe/p_screen.h"
+#include "util/u_debug.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
 
 #include "u_upload_mgr.h"
 
 
+/* Number of fences tracked per upload buffer. When all are in use, the
+ * newest one is replaced, which only makes waits more conservative. */
+#define U_UPLOAD_MAX_FENCES 32
+
+DEBUG_GET_ONCE_BOOL_OPTION(upload_stats, "GALLIUM_UPLOAD_STATS", FALSE)
+
+
+/* Data up to "end" is read by commands preceding "fence". */
+struct u_upload_range {
+   struct pipe_fence_handle *fence;
+   unsigned end;
+};
+
 struct u_upload_mgr {
    struct pipe_context *pipe;
 
@@ -51,6 +73,15 @@ struct u_upload_mgr {
    unsigned size;   /* Actual size of the upload buffer. */
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
+   unsigned tail;   /* Start of the oldest data the GPU may still read. */
+
+   /* Fenced ranges, oldest first. The ranges follow each other starting
+    * at "tail", wrapping around at the end of the buffer. */
+   struct u_upload_range fences[U_UPLOAD_MAX_FENCES];
+   unsigned first_fence;
+   unsigned num_fences;
+
+   struct u_upload_stats stats;
 };
 
 
@@ -88,6 +119,20 @@ void u_upload_unmap( struct u_upload_mgr *upload )
    }
 }
 
+static void u_upload_release_fences( struct u_upload_mgr *upload )
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+
+   while (upload->num_fences) {
+      screen->fence_reference(screen,
+                              &upload->fences[upload->first_fence].fence,
+                              NULL);
+      upload->first_fence = (upload->first_fence + 1) % U_UPLOAD_MAX_FENCES;
+      upload->num_fences--;
+   }
+   upload->first_fence = 0;
+}
+
 /* Release old buffer.
  * 
  * This must usually be called prior to firing the command stream
@@ -101,18 +146,163 @@ void u_upload_flush( struct u_upload_mgr *upload )
 {
    /* Unmap and unreference the upload buffer. */
    u_upload_unmap(upload);
+   u_upload_release_fences(upload);
    pipe_resource_reference( &upload->buffer, NULL );
    upload->size = 0;
+   upload->offset = 0;
+   upload->tail = 0;
 }
 
 
 void u_upload_destroy( struct u_upload_mgr *upload )
 {
    u_upload_flush( upload );
+
+   if (debug_get_option_upload_stats()) {
+      debug_printf("u_upload: %llu bytes in %llu allocations, %llu wraps, "
+                   "%llu stalls, %llu buffers created\n",
+                   (unsigned long long)upload->stats.bytes_uploaded,
+                   (unsigned long long)upload->stats.allocations,
+                   (unsigned long long)upload->stats.wraps,
+                   (unsigned long long)upload->stats.stalls,
+                   (unsigned long long)upload->stats.reallocations);
+   }
+
    FREE( upload );
 }
 
 
+static struct u_upload_range *
+u_upload_last_range( struct u_upload_mgr *upload )
+{
+   if (!upload->num_fences)
+      return NULL;
+
+   return &upload->fences[(upload->first_fence + upload->num_fences - 1) %
+                          U_UPLOAD_MAX_FENCES];
+}
+
+
+boolean u_upload_unfenced( struct u_upload_mgr *upload )
+{
+   struct u_upload_range *range = u_upload_last_range(upload);
+
+   if (!upload->buffer)
+      return FALSE;
+
+   return upload->offset != (range ? range->end : upload->tail);
+}
+
+
+void u_upload_fence( struct u_upload_mgr *upload,
+                     struct pipe_fence_handle *fence )
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+   struct u_upload_range *range;
+
+   if (!fence || !u_upload_unfenced(upload))
+      return;
+
+   range = u_upload_last_range(upload);
+
+   if (upload->num_fences < U_UPLOAD_MAX_FENCES) {
+      range = &upload->fences[(upload->first_fence + upload->num_fences) %
+                              U_UPLOAD_MAX_FENCES];
+      range->fence = NULL;
+      upload->num_fences++;
+   }
+
+   screen->fence_reference(screen, &range->fence, fence);
+   range->end = upload->offset;
+}
+
+
+void u_upload_get_stats( struct u_upload_mgr *upload,
+                         struct u_upload_stats *stats )
+{
+   *stats = upload->stats;
+}
+
+
+/* Release the oldest fenced range, waiting for its fence if "wait" is set.
+ * Returns FALSE if the fence hasn't signalled and "wait" isn't set.
+ */
+static boolean
+u_upload_retire( struct u_upload_mgr *upload, boolean wait )
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+   struct u_upload_range *range = &upload->fences[upload->first_fence];
+
+   if (!screen->fence_signalled(screen, range->fence)) {
+      if (!wait)
+         return FALSE;
+
+      screen->fence_finish(screen, range->fence, PIPE_TIMEOUT_INFINITE);
+      upload->stats.stalls++;
+   }
+
+   screen->fence_reference(screen, &range->fence, NULL);
+   upload->tail = range->end;
+   upload->first_fence = (upload->first_fence + 1) % U_UPLOAD_MAX_FENCES;
+   upload->num_fences--;
+   return TRUE;
+}
+
+
+/* Find room for "size" bytes at or after "min_offset" in the current
+ * buffer, retiring fenced ranges as needed. The returned offset is lower
+ * than upload->offset if the ring wrapped around.
+ */
+static boolean
+u_upload_find_space( struct u_upload_mgr *upload,
+                     unsigned min_offset,
+                     unsigned size,
+                     unsigned *out_offset )
+{
+   if (min_offset + size > upload->size)
+      return FALSE;
+
+   for (;;) {
+      unsigned offset = MAX2(upload->offset, min_offset);
+
+      if (!upload->num_fences && upload->tail == upload->offset) {
+         /* Nothing the GPU may still read, start over if needed. */
+         if (offset + size > upload->size) {
+            upload->tail = 0;
+            offset = min_offset;
+         }
+         *out_offset = offset;
+         return TRUE;
+      }
+
+      if (upload->offset >= upload->tail) {
+         /* Free space is after offset and before tail. The end of the
+          * allocation must stay below tail, as offset == tail means the
+          * ring is empty. */
+         if (offset + size <= upload->size) {
+            *out_offset = offset;
+            return TRUE;
+         }
+         if (min_offset + size < upload->tail) {
+            *out_offset = min_offset;
+            return TRUE;
+         }
+      } else {
+         /* Wrapped: free space is between offset and tail. */
+         if (offset + size < upload->tail) {
+            *out_offset = offset;
+            return TRUE;
+         }
+      }
+
+      if (!upload->num_fences)
+         return FALSE;
+
+      u_upload_retire(upload, TRUE);
+   }
+}
+
+
 static enum pipe_error 
 u_upload_alloc_buffer( struct u_upload_mgr *upload,
                        unsigned min_size )
@@ -123,6 +313,8 @@ u_upload_alloc_buffer( struct u_upload_mgr *upload,
     */
    u_upload_flush( upload );
 
+   upload->stats.reallocations++;
+
    /* Allocate a new one: 
     */
    size = align(MAX2(upload->default_size, min_size), 4096);
@@ -167,19 +359,23 @@ enum pipe_error u_upload_alloc( struct u_upload_mgr *upload,
 
    /* Make sure we have enough space in the upload buffer
     * for the sub-allocation. */
-   if (MAX2(upload->offset, alloc_offset) + alloc_size > upload->size) {
+   if (!u_upload_find_space(upload, alloc_offset, alloc_size, &offset)) {
       enum pipe_error ret = u_upload_alloc_buffer(upload,
                                                   alloc_offset + alloc_size);
       if (ret)
          return ret;
 
+      offset = alloc_offset;
       *flushed = TRUE;
    } else {
+      if (offset < upload->offset) {
+         /* Wrapped around, map again from the new offset. */
+         u_upload_unmap(upload);
+         upload->stats.wraps++;
+      }
       *flushed = FALSE;
    }
 
-   offset = MAX2(upload->offset, alloc_offset);
-
    if (!upload->map) {
       upload->map = pipe_buffer_map_range(upload->pipe, upload->buffer,
 					  offset, upload->size - offset,
@@ -199,6 +395,8 @@ enum pipe_error u_upload_alloc( struct u_upload_mgr *upload,
    *out_offset = offset;
 
    upload->offset = offset + alloc_size;
+   upload->stats.allocations++;
+   upload->stats.bytes_uploaded += size;
    return PIPE_OK;
 }
 
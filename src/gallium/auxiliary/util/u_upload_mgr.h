@@ -36,6 +36,20 @@
 
 struct pipe_context;
 struct pipe_resource;
+struct pipe_fence_handle;
+
+
+/**
+ * Upload manager counters, see u_upload_get_stats(). Setting
+ * GALLIUM_UPLOAD_STATS prints them when the manager is destroyed.
+ */
+struct u_upload_stats {
+   uint64_t bytes_uploaded;  /**< bytes sub-allocated */
+   uint64_t allocations;     /**< sub-allocations */
+   uint64_t wraps;           /**< times the ring started over */
+   uint64_t stalls;          /**< waits for a fence which hadn't signalled */
+   uint64_t reallocations;   /**< upload buffers created */
+};
 
 
 /**
@@ -61,11 +75,35 @@ void u_upload_destroy( struct u_upload_mgr *upload );
  * This is like u_upload_unmap() except the upload buffer is released for
  * recycling. This should be called on real hardware flushes on systems
  * that don't support the PIPE_TRANSFER_UNSYNCHRONIZED flag, as otherwise
- * the next u_upload_buffer will cause a sync on the buffer.
+ * the next u_upload_buffer will cause a sync on the buffer. Drivers
+ * which call u_upload_fence() instead keep reusing the same buffer.
  */
 
 void u_upload_flush( struct u_upload_mgr *upload );
 
+/**
+ * Tell the upload manager that everything uploaded so far is read by
+ * commands preceding \p fence.
+ *
+ * Drivers call this on hardware flushes. It lets the upload buffer be
+ * used as a ring, reusing its beginning once the fences covering it have
+ * signalled, instead of allocating a new buffer when it is full. The
+ * buffer is mapped with PIPE_TRANSFER_UNSYNCHRONIZED.
+ */
+void u_upload_fence( struct u_upload_mgr *upload,
+                     struct pipe_fence_handle *fence );
+
+/**
+ * Return TRUE if data was uploaded since the last u_upload_fence().
+ */
+boolean u_upload_unfenced( struct u_upload_mgr *upload );
+
+/**
+ * Return the counters of the upload manager.
+ */
+void u_upload_get_stats( struct u_upload_mgr *upload,
+                         struct u_upload_stats *stats );
+
 /**
  * Unmap upload buffer
  *
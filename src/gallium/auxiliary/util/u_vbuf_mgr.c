@@ -52,6 +52,34 @@ struct u_vbuf_elements {
    boolean incompatible_layout;
 };
 
+/* How many translated vertex buffers are kept around. */
+#define U_VBUF_TRANSLATED_CACHE_SIZE 8
+
+/* A set of vertices translated by u_vbuf_translate_begin.
+ *
+ * Entries are matched by the translate key and by the buffers, offsets
+ * and strides it reads from. The first translation of some vertices
+ * only records them and goes through the uploader as usual. If the same
+ * vertices are translated again and none of the source buffers have been
+ * written in between, the whole buffers are translated into a buffer of
+ * their own which is then reused by all draws until a source buffer
+ * is written to again. Buffers updated between draws thus never leave
+ * the uploader path. */
+struct u_vbuf_translated {
+   struct translate_key key;
+   uint32_t vb_mask; /* which vertex buffers are read, 0 if unused */
+
+   /* The source buffers (referenced) and their write counters. */
+   struct pipe_vertex_buffer vb[PIPE_MAX_ATTRIBS];
+   unsigned write_counter[PIPE_MAX_ATTRIBS];
+
+   /* Vertices 0..max_index translated, or NULL. */
+   struct pipe_resource *buffer;
+   unsigned max_index;
+
+   unsigned last_used;
+};
+
 struct u_vbuf_priv {
    struct u_vbuf_mgr b;
    struct pipe_context *pipe;
@@ -59,6 +87,9 @@ struct u_vbuf_priv {
    struct translate_cache *translate_cache;
    unsigned translate_vb_slot;
 
+   struct u_vbuf_translated translated[U_VBUF_TRANSLATED_CACHE_SIZE];
+   unsigned translated_stamp;
+
    struct u_vbuf_elements *ve;
    void *saved_ve, *fallback_ve;
    boolean ve_binding_lock;
@@ -120,6 +151,18 @@ u_vbuf_create(struct pipe_context *pipe,
    return &mgr->b;
 }
 
+static void
+u_vbuf_translated_release(struct u_vbuf_translated *t)
+{
+   unsigned i;
+
+   for (i = 0; i < PIPE_MAX_ATTRIBS; i++) {
+      pipe_resource_reference(&t->vb[i].buffer, NULL);
+   }
+   pipe_resource_reference(&t->buffer, NULL);
+   memset(t, 0, sizeof(*t));
+}
+
 void u_vbuf_destroy(struct u_vbuf_mgr *mgrb)
 {
    struct u_vbuf_priv *mgr = (struct u_vbuf_priv*)mgrb;
@@ -132,11 +175,214 @@ void u_vbuf_destroy(struct u_vbuf_mgr *mgrb)
       pipe_resource_reference(&mgr->b.real_vertex_buffer[i].buffer, NULL);
    }
 
+   for (i = 0; i < U_VBUF_TRANSLATED_CACHE_SIZE; i++) {
+      u_vbuf_translated_release(&mgr->translated[i]);
+   }
+
    translate_cache_destroy(mgr->translate_cache);
    u_upload_destroy(mgr->b.uploader);
    FREE(mgr);
 }
 
+/* Translate num_verts vertices starting at start_index into out_map. */
+static void
+u_vbuf_translate_run(struct u_vbuf_priv *mgr, struct translate *tr,
+                     uint32_t vb_mask, int start_index, unsigned num_verts,
+                     void *out_map)
+{
+   uint8_t *vb_map;
+   struct pipe_transfer *vb_transfer[PIPE_MAX_ATTRIBS] = {0};
+   unsigned i;
+
+   /* Map buffers we want to translate. */
+   for (i = 0; i < mgr->b.nr_vertex_buffers; i++) {
+      if (vb_mask & (1 << i)) {
+         struct pipe_vertex_buffer *vb = &mgr->b.vertex_buffer[i];
+
+         vb_map = pipe_buffer_map(mgr->pipe, vb->buffer,
+                                  PIPE_TRANSFER_READ, &vb_transfer[i]);
+
+         tr->set_buffer(tr, i,
+                        vb_map + vb->buffer_offset + vb->stride * start_index,
+                        vb->stride, ~0);
+      }
+   }
+
+   /* Translate. */
+   tr->run(tr, 0, num_verts, 0, out_map);
+
+   /* Unmap all buffers. */
+   for (i = 0; i < mgr->b.nr_vertex_buffers; i++) {
+      if (vb_mask & (1 << i)) {
+         pipe_buffer_unmap(mgr->pipe, vb_transfer[i]);
+      }
+   }
+}
+
+/* Whether nobody but the cache references the source buffers anymore. */
+static boolean
+u_vbuf_translated_is_orphaned(const struct u_vbuf_translated *t)
+{
+   unsigned i;
+
+   for (i = 0; i < PIPE_MAX_ATTRIBS; i++) {
+      if ((t->vb_mask & (1 << i)) &&
+          p_atomic_read(&t->vb[i].buffer->reference.count) == 1) {
+         return TRUE;
+      }
+   }
+   return FALSE;
+}
+
+static boolean
+u_vbuf_translated_is_current(const struct u_vbuf_translated *t)
+{
+   unsigned i;
+
+   for (i = 0; i < PIPE_MAX_ATTRIBS; i++) {
+      if ((t->vb_mask & (1 << i)) &&
+          u_vbuf_resource(t->vb[i].buffer)->write_counter !=
+          t->write_counter[i]) {
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/* Record the current source buffers and their write counters in t. */
+static void
+u_vbuf_translated_set_sources(struct u_vbuf_priv *mgr,
+                              struct u_vbuf_translated *t)
+{
+   unsigned i;
+
+   for (i = 0; i < PIPE_MAX_ATTRIBS; i++) {
+      if (t->vb_mask & (1 << i)) {
+         struct pipe_vertex_buffer *vb = &mgr->b.vertex_buffer[i];
+
+         pipe_resource_reference(&t->vb[i].buffer, vb->buffer);
+         t->vb[i].buffer_offset = vb->buffer_offset;
+         t->vb[i].stride = vb->stride;
+         t->write_counter[i] = u_vbuf_resource(vb->buffer)->write_counter;
+      }
+   }
+}
+
+/* Find the entry describing the vertices the key reads from the current
+ * vertex buffers. If there is none, a new one is set up in place of
+ * the least recently used entry and NULL is returned. */
+static struct u_vbuf_translated *
+u_vbuf_translated_lookup(struct u_vbuf_priv *mgr,
+                         const struct translate_key *key,
+                         uint32_t vb_mask)
+{
+   struct u_vbuf_translated *t, *victim = NULL;
+   boolean victim_free = FALSE;
+   unsigned i, j;
+
+   for (i = 0; i < U_VBUF_TRANSLATED_CACHE_SIZE; i++) {
+      t = &mgr->translated[i];
+
+      if (t->vb_mask == vb_mask &&
+          translate_key_compare(&t->key, key) == 0) {
+         for (j = 0; j < PIPE_MAX_ATTRIBS; j++) {
+            if ((vb_mask & (1 << j)) &&
+                (t->vb[j].buffer != mgr->b.vertex_buffer[j].buffer ||
+                 t->vb[j].buffer_offset !=
+                 mgr->b.vertex_buffer[j].buffer_offset ||
+                 t->vb[j].stride != mgr->b.vertex_buffer[j].stride)) {
+               break;
+            }
+         }
+         if (j == PIPE_MAX_ATTRIBS) {
+            t->last_used = ++mgr->translated_stamp;
+            return t;
+         }
+      }
+
+      /* Prefer entries which are unused or whose source buffers
+       * have been deleted, then the least recently used one. */
+      if (victim_free) {
+         continue;
+      }
+      if (!t->vb_mask || u_vbuf_translated_is_orphaned(t)) {
+         victim = t;
+         victim_free = TRUE;
+      } else if (!victim || t->last_used < victim->last_used) {
+         victim = t;
+      }
+   }
+
+   u_vbuf_translated_release(victim);
+   victim->key = *key;
+   victim->vb_mask = vb_mask;
+   victim->last_used = ++mgr->translated_stamp;
+   u_vbuf_translated_set_sources(mgr, victim);
+   return NULL;
+}
+
+/* Return the highest vertex index which can be fetched by all translated
+ * elements, or ~0 if no element advances with the vertex index. */
+static unsigned
+u_vbuf_translated_max_index(struct u_vbuf_priv *mgr,
+                            const unsigned *tr_elem_index,
+                            unsigned nr_elements)
+{
+   unsigned i, max_index = ~0;
+
+   for (i = 0; i < mgr->ve->count; i++) {
+      struct pipe_vertex_buffer *vb =
+            &mgr->b.vertex_buffer[mgr->ve->ve[i].vertex_buffer_index];
+      unsigned end;
+
+      if (tr_elem_index[i] >= nr_elements || !vb->stride) {
+         continue;
+      }
+
+      end = vb->buffer_offset + mgr->ve->ve[i].src_offset +
+            mgr->ve->src_format_size[i];
+      if (end > vb->buffer->width0) {
+         return 0;
+      }
+
+      max_index = MIN2(max_index, (vb->buffer->width0 - end) / vb->stride);
+   }
+   return max_index;
+}
+
+/* Translate all vertices the source buffers hold into a new buffer
+ * owned by the cache entry. Return FALSE on failure. */
+static boolean
+u_vbuf_translated_fill(struct u_vbuf_priv *mgr, struct u_vbuf_translated *t,
+                       struct translate *tr, unsigned max_index)
+{
+   struct pipe_transfer *transfer;
+   void *map;
+
+   pipe_resource_reference(&t->buffer, NULL);
+
+   t->buffer = pipe_buffer_create(mgr->pipe->screen,
+                                  PIPE_BIND_VERTEX_BUFFER, PIPE_USAGE_STATIC,
+                                  t->key.output_stride * (max_index + 1));
+   if (!t->buffer) {
+      return FALSE;
+   }
+
+   map = pipe_buffer_map(mgr->pipe, t->buffer,
+                         PIPE_TRANSFER_WRITE | PIPE_TRANSFER_DISCARD,
+                         &transfer);
+   if (!map) {
+      pipe_resource_reference(&t->buffer, NULL);
+      return FALSE;
+   }
+
+   u_vbuf_translate_run(mgr, tr, t->vb_mask, 0, max_index + 1, map);
+   pipe_buffer_unmap(mgr->pipe, transfer);
+
+   t->max_index = max_index;
+   return TRUE;
+}
+
 
 static void
 u_vbuf_translate_begin(struct u_vbuf_priv *mgr,
@@ -146,10 +392,10 @@ u_vbuf_translate_begin(struct u_vbuf_priv *mgr,
    struct translate_element *te;
    unsigned tr_elem_index[PIPE_MAX_ATTRIBS];
    struct translate *tr;
-   boolean vb_translated[PIPE_MAX_ATTRIBS] = {0};
-   uint8_t *vb_map[PIPE_MAX_ATTRIBS] = {0}, *out_map;
-   struct pipe_transfer *vb_transfer[PIPE_MAX_ATTRIBS] = {0};
+   uint32_t vb_translated = 0;
+   uint8_t *out_map;
    struct pipe_resource *out_buffer = NULL;
+   struct u_vbuf_translated *cached = NULL;
    unsigned i, num_verts, out_offset;
    struct pipe_vertex_element new_velems[PIPE_MAX_ATTRIBS];
    boolean upload_flushed = FALSE;
@@ -207,7 +453,7 @@ u_vbuf_translate_begin(struct u_vbuf_priv *mgr,
       te->output_offset = key.output_stride;
 
       key.output_stride += output_format_size;
-      vb_translated[mgr->ve->ve[i].vertex_buffer_index] = TRUE;
+      vb_translated |= 1 << mgr->ve->ve[i].vertex_buffer_index;
       tr_elem_index[i] = key.nr_elements;
       key.nr_elements++;
    }
@@ -215,39 +461,57 @@ u_vbuf_translate_begin(struct u_vbuf_priv *mgr,
    /* Get a translate object. */
    tr = translate_cache_find(mgr->translate_cache, &key);
 
-   /* Map buffers we want to translate. */
+   /* Look for the vertices in the cache. User buffers can change
+    * without notice and are never cached. */
    for (i = 0; i < mgr->b.nr_vertex_buffers; i++) {
-      if (vb_translated[i]) {
-         struct pipe_vertex_buffer *vb = &mgr->b.vertex_buffer[i];
-
-         vb_map[i] = pipe_buffer_map(mgr->pipe, vb->buffer,
-                                     PIPE_TRANSFER_READ, &vb_transfer[i]);
-
-         tr->set_buffer(tr, i,
-                        vb_map[i] + vb->buffer_offset + vb->stride * min_index,
-                        vb->stride, ~0);
+      if ((vb_translated & (1 << i)) &&
+          u_vbuf_resource(mgr->b.vertex_buffer[i].buffer)->user_ptr) {
+         break;
       }
    }
+   if (i == mgr->b.nr_vertex_buffers && min_index >= 0) {
+      cached = u_vbuf_translated_lookup(mgr, &key, vb_translated);
+   }
 
-   /* Create and map the output buffer. */
-   num_verts = max_index + 1 - min_index;
+   if (cached) {
+      if (!u_vbuf_translated_is_current(cached)) {
+         /* Written since it was last seen, start over. */
+         pipe_resource_reference(&cached->buffer, NULL);
+         u_vbuf_translated_set_sources(mgr, cached);
+         cached = NULL;
+      } else if (!cached->buffer || max_index > cached->max_index) {
+         /* Seen before and unchanged, translate it once and for all. */
+         unsigned cache_max_index =
+               u_vbuf_translated_max_index(mgr, tr_elem_index,
+                                           key.nr_elements);
+
+         if (cache_max_index == ~0) {
+            cache_max_index = max_index;
+         }
+         if (cache_max_index < max_index ||
+             !u_vbuf_translated_fill(mgr, cached, tr, cache_max_index)) {
+            cached = NULL;
+         }
+      }
+   }
 
-   u_upload_alloc(mgr->b.uploader,
-                  key.output_stride * min_index,
-                  key.output_stride * num_verts,
-                  &out_offset, &out_buffer, &upload_flushed,
-                  (void**)&out_map);
+   if (cached) {
+      pipe_resource_reference(&out_buffer, cached->buffer);
+      out_offset = 0;
+   } else {
+      /* Create and map the output buffer. */
+      num_verts = max_index + 1 - min_index;
 
-   out_offset -= key.output_stride * min_index;
+      u_upload_alloc(mgr->b.uploader,
+                     key.output_stride * min_index,
+                     key.output_stride * num_verts,
+                     &out_offset, &out_buffer, &upload_flushed,
+                     (void**)&out_map);
 
-   /* Translate. */
-   tr->run(tr, 0, num_verts, 0, out_map);
+      out_offset -= key.output_stride * min_index;
 
-   /* Unmap all buffers. */
-   for (i = 0; i < mgr->b.nr_vertex_buffers; i++) {
-      if (vb_translated[i]) {
-         pipe_buffer_unmap(mgr->pipe, vb_transfer[i]);
-      }
+      u_vbuf_translate_run(mgr, tr, vb_translated, min_index, num_verts,
+                           out_map);
    }
 
    /* Setup the new vertex buffer in the first free slot. */
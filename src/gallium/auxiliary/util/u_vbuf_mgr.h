@@ -85,6 +85,11 @@ struct u_vbuf_mgr {
 struct u_vbuf_resource {
    struct u_resource b;
    uint8_t *user_ptr;
+
+   /* Incremented whenever the CPU writes to the buffer, see
+    * u_vbuf_resource_written. Translated copies of the buffer are
+    * only reused while it stays the same. */
+   unsigned write_counter;
 };
 
 /* Opaque type containing information about vertex elements for the manager. */
@@ -137,4 +142,11 @@ static INLINE struct u_vbuf_resource *u_vbuf_resource(struct pipe_resource *r)
    return (struct u_vbuf_resource*)r;
 }
 
+/* Drivers must call this when a buffer is mapped for writing
+ * or written by transfer_inline_write. */
+static INLINE void u_vbuf_resource_written(struct pipe_resource *r)
+{
+   u_vbuf_resource(r)->write_counter++;
+}
+
 #endif
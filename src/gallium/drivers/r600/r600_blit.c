@@ -130,6 +130,10 @@ void r600_blit_uncompress_depth(struct pipe_context *ctx, struct r600_resource_t
 	    rctx->family == CHIP_RV620 || rctx->family == CHIP_RV635)
 		depth = 0.0f;
 
+	/* Save and restore the state once for all levels and layers. */
+	r600_blitter_begin(ctx, R600_DECOMPRESS);
+	util_blitter_begin_batch(rctx->blitter);
+
 	for (level = 0; level <= texture->resource.b.b.b.last_level; level++) {
 		unsigned num_layers = u_num_layers(&texture->resource.b.b.b, level);
 
@@ -149,15 +153,16 @@ void r600_blit_uncompress_depth(struct pipe_context *ctx, struct r600_resource_t
 			cbsurf = ctx->create_surface(ctx,
 					(struct pipe_resource*)texture->flushed_depth_texture, &surf_tmpl);
 
-			r600_blitter_begin(ctx, R600_DECOMPRESS);
 			util_blitter_custom_depth_stencil(rctx->blitter, zsurf, cbsurf, rctx->custom_dsa_flush, depth);
-			r600_blitter_end(ctx);
 
 			pipe_surface_reference(&zsurf, NULL);
 			pipe_surface_reference(&cbsurf, NULL);
 		}
 	}
 
+	util_blitter_end_batch(rctx->blitter);
+	r600_blitter_end(ctx);
+
 	texture->dirty_db = FALSE;
 }
 
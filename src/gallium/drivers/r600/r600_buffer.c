@@ -79,6 +79,9 @@ static void *r600_buffer_transfer_map(struct pipe_context *pipe,
 	struct r600_pipe_context *rctx = (struct r600_pipe_context*)pipe;
 	uint8_t *data;
 
+	if (transfer->usage & PIPE_TRANSFER_WRITE)
+		u_vbuf_resource_written(transfer->resource);
+
 	if (rbuffer->b.user_ptr)
 		return (uint8_t*)rbuffer->b.user_ptr + transfer->box.x;
 
@@ -131,6 +134,8 @@ static void r600_buffer_transfer_inline_write(struct pipe_context *pipe,
 
 	assert(rbuffer->b.user_ptr == NULL);
 
+	u_vbuf_resource_written(resource);
+
 	map = r600_bo_map(radeon, rbuffer->bo, rctx->ctx.cs,
 			  PIPE_TRANSFER_WRITE | PIPE_TRANSFER_DISCARD | usage);
 
@@ -168,6 +173,7 @@ struct pipe_resource *r600_buffer_create(struct pipe_screen *screen,
 	rbuffer->b.b.b.screen = screen;
 	rbuffer->b.b.vtbl = &r600_buffer_vtbl;
 	rbuffer->b.user_ptr = NULL;
+	rbuffer->b.write_counter = 0;
 	rbuffer->size = rbuffer->b.b.b.width0;
 	rbuffer->bo_size = rbuffer->size;
 
@@ -206,6 +212,7 @@ struct pipe_resource *r600_user_buffer_create(struct pipe_screen *screen,
 	rbuffer->b.b.b.array_size = 1;
 	rbuffer->b.b.b.flags = 0;
 	rbuffer->b.user_ptr = ptr;
+	rbuffer->b.write_counter = 0;
 	rbuffer->bo = NULL;
 	rbuffer->bo_size = 0;
 	return &rbuffer->b.b.b;
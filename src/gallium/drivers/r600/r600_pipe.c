@@ -121,10 +121,26 @@ void r600_flush(struct pipe_context *ctx, struct pipe_fence_handle **fence,
 {
 	struct r600_pipe_context *rctx = (struct r600_pipe_context *)ctx;
 	struct r600_fence **rfence = (struct r600_fence**)fence;
+	struct u_upload_mgr *uploader = rctx->vbuf_mgr ? rctx->vbuf_mgr->uploader : NULL;
 
 	if (rfence)
 		*rfence = r600_create_fence(rctx);
 
+	/* Fence the uploads, so that the upload buffer is reused as a ring
+	 * once the GPU is done with it. */
+	if (uploader && u_upload_unfenced(uploader)) {
+		struct pipe_fence_handle *upload_fence = NULL;
+
+		if (rfence) {
+			u_upload_fence(uploader, *fence);
+		} else {
+			upload_fence = (struct pipe_fence_handle*)r600_create_fence(rctx);
+			u_upload_fence(uploader, upload_fence);
+			if (upload_fence)
+				ctx->screen->fence_reference(ctx->screen, &upload_fence, NULL);
+		}
+	}
+
 	r600_context_flush(&rctx->ctx, flags);
 }
 
@@ -28,6 +28,7 @@
 
 #include "os/os_thread.h"
 #include "util/u_format.h"
+#include "util/u_hash.h"
 #include "util/u_string.h"
 #include "util/u_inlines.h"
 #include "util/u_memory.h"
@@ -82,6 +83,30 @@ rbug_get_context_locked(struct rbug_screen *rb_screen, rbug_context_t ctx)
    return rb_context;
 }
 
+/**
+ * Look up a resource and reference the wrapped resource, so that it can be
+ * used once the list lock has been dropped. Returns NULL if not found.
+ */
+static struct pipe_resource *
+rbug_get_resource(struct rbug_screen *rb_screen, rbug_texture_t tex)
+{
+   struct rbug_resource *tr_tex = NULL;
+   struct pipe_resource *resource = NULL;
+   struct rbug_list *ptr;
+
+   pipe_mutex_lock(rb_screen->list_mutex);
+   foreach(ptr, &rb_screen->resources) {
+      tr_tex = container_of(ptr, struct rbug_resource, list);
+      if (tex == VOID2U64(tr_tex)) {
+         pipe_resource_reference(&resource, tr_tex->resource);
+         break;
+      }
+   }
+   pipe_mutex_unlock(rb_screen->list_mutex);
+
+   return resource;
+}
+
 static struct rbug_shader *
 rbug_get_shader_locked(struct rbug_context *rb_context, rbug_shader_t shdr)
 {
@@ -199,25 +224,13 @@ static int
 rbug_texture_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_t serial)
 {
    struct rbug_screen *rb_screen = tr_rbug->rb_screen;
-   struct rbug_resource *tr_tex = NULL;
    struct rbug_proto_texture_info *gpti = (struct rbug_proto_texture_info *)header;
-   struct rbug_list *ptr;
    struct pipe_resource *t;
 
-   pipe_mutex_lock(rb_screen->list_mutex);
-   foreach(ptr, &rb_screen->resources) {
-      tr_tex = container_of(ptr, struct rbug_resource, list);
-      if (gpti->texture == VOID2U64(tr_tex))
-         break;
-      tr_tex = NULL;
-   }
-
-   if (!tr_tex) {
-      pipe_mutex_unlock(rb_screen->list_mutex);
+   t = rbug_get_resource(rb_screen, gpti->texture);
+   if (!t)
       return -ESRCH;
-   }
 
-   t = tr_tex->resource;
    rbug_send_texture_info_reply(tr_rbug->con, serial,
                                t->target, t->format,
                                &t->width0, 1,
@@ -231,7 +244,7 @@ rbug_texture_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_
                                t->bind,
                                NULL);
 
-   pipe_mutex_unlock(rb_screen->list_mutex);
+   pipe_resource_reference(&t, NULL);
 
    return 0;
 }
@@ -242,53 +255,220 @@ rbug_texture_read(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_
    struct rbug_proto_texture_read *gptr = (struct rbug_proto_texture_read *)header;
 
    struct rbug_screen *rb_screen = tr_rbug->rb_screen;
-   struct rbug_resource *tr_tex = NULL;
-   struct rbug_list *ptr;
 
    struct pipe_context *context = rb_screen->private_context;
    struct pipe_resource *tex;
    struct pipe_transfer *t;
+   enum pipe_format format;
+   unsigned stride, size;
+   uint8_t *data;
 
    void *map;
 
-   pipe_mutex_lock(rb_screen->list_mutex);
-   foreach(ptr, &rb_screen->resources) {
-      tr_tex = container_of(ptr, struct rbug_resource, list);
-      if (gptr->texture == VOID2U64(tr_tex))
-         break;
-      tr_tex = NULL;
-   }
-
-   if (!tr_tex) {
-      pipe_mutex_unlock(rb_screen->list_mutex);
+   /* the private context is only used by this thread, so the transfer
+    * needs no lock, and the resource is kept alive by the reference */
+   tex = rbug_get_resource(rb_screen, gptr->texture);
+   if (!tex)
       return -ESRCH;
-   }
 
-   tex = tr_tex->resource;
    t = pipe_get_transfer(context, tex,
                          gptr->level, gptr->face + gptr->zslice,
                          PIPE_TRANSFER_READ,
                          gptr->x, gptr->y, gptr->w, gptr->h);
+   if (!t) {
+      pipe_resource_reference(&tex, NULL);
+      return -ENOMEM;
+   }
 
+   format = t->resource->format;
+   stride = t->stride;
+   size = stride * util_format_get_nblocksy(format, t->box.height);
+
+   /* copy the data out so the resource is not kept mapped while it is sent */
+   data = MALLOC(size);
    map = context->transfer_map(context, t);
+   if (data && map)
+      memcpy(data, map, size);
+   if (map)
+      context->transfer_unmap(context, t);
+   context->transfer_destroy(context, t);
+   pipe_resource_reference(&tex, NULL);
+
+   if (!data || !map) {
+      FREE(data);
+      return -ENOMEM;
+   }
 
    rbug_send_texture_read_reply(tr_rbug->con, serial,
-                                t->resource->format,
-                                util_format_get_blockwidth(t->resource->format),
-                                util_format_get_blockheight(t->resource->format),
-                                util_format_get_blocksize(t->resource->format),
-                                (uint8_t*)map,
-                                t->stride * util_format_get_nblocksy(t->resource->format,
-                                                                     t->box.height),
-                                t->stride,
+                                format,
+                                util_format_get_blockwidth(format),
+                                util_format_get_blockheight(format),
+                                util_format_get_blocksize(format),
+                                data, size, stride,
                                 NULL);
 
+   FREE(data);
+
+   return 0;
+}
+
+static int
+rbug_texture_read_tiles(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_t serial)
+{
+   struct rbug_proto_texture_read_tiles *gptr = (struct rbug_proto_texture_read_tiles *)header;
+
+   struct rbug_screen *rb_screen = tr_rbug->rb_screen;
+
+   struct pipe_context *context = rb_screen->private_context;
+   struct pipe_resource *tex;
+   struct pipe_transfer *t;
+   enum pipe_format format;
+   unsigned blocksize, nblocksx, nblocksy;
+   unsigned level_w, level_h, layers, box_w, box_h;
+   unsigned tile_size, tiles_x, num_tiles;
+   uint64_t data_size, reply_size;
+   unsigned i, tx, ty, row;
+   uint32_t *hashes, *tiles, *sizes;
+   uint8_t *tile, *data;
+   uint32_t num_changed = 0;
+   uint32_t data_len = 0;
+   int ret = 0;
+
+   const uint8_t *map;
+
+   tile_size = gptr->tile_size ? gptr->tile_size : RBUG_TILE_SIZE_DEFAULT;
+   tile_size = MIN2(tile_size, RBUG_TILE_SIZE_MAX);
+
+   tex = rbug_get_resource(rb_screen, gptr->texture);
+   if (!tex)
+      return -ESRCH;
+
+   /* the region comes from the client, keep it inside the mip level */
+   if (gptr->level > tex->last_level) {
+      pipe_resource_reference(&tex, NULL);
+      return -EINVAL;
+   }
+
+   level_w = u_minify(tex->width0, gptr->level);
+   level_h = u_minify(tex->height0, gptr->level);
+   if (tex->target == PIPE_TEXTURE_3D)
+      layers = u_minify(tex->depth0, gptr->level);
+   else
+      layers = tex->array_size;
+
+   if (gptr->x >= level_w || gptr->y >= level_h ||
+       gptr->face >= layers || gptr->zslice >= layers - gptr->face) {
+      pipe_resource_reference(&tex, NULL);
+      return -EINVAL;
+   }
+
+   box_w = MIN2(gptr->w, level_w - gptr->x);
+   box_h = MIN2(gptr->h, level_h - gptr->y);
+
+   format = tex->format;
+   blocksize = util_format_get_blocksize(format);
+   nblocksx = util_format_get_nblocksx(format, box_w);
+   nblocksy = util_format_get_nblocksy(format, box_h);
+
+   tiles_x = (nblocksx + tile_size - 1) / tile_size;
+   num_tiles = rbug_tile_count(nblocksx, nblocksy, tile_size);
+
+   /* worst case, with every tile changed */
+   data_size = 0;
+   for (ty = 0; ty < nblocksy; ty += tile_size) {
+      for (tx = 0; tx < nblocksx; tx += tile_size) {
+         data_size += rbug_tile_encode_max_size(MIN2(tile_size, nblocksx - tx) *
+                                                MIN2(tile_size, nblocksy - ty),
+                                                blocksize);
+      }
+   }
+
+   /* the reply's lengths are 32 bit, header and fields included */
+   reply_size = 64 + 3 * (uint64_t) num_tiles * sizeof(uint32_t) + data_size;
+   if (reply_size > 0xffffffff) {
+      pipe_resource_reference(&tex, NULL);
+      return -E2BIG;
+   }
+
+   t = pipe_get_transfer(context, tex,
+                         gptr->level, gptr->face + gptr->zslice,
+                         PIPE_TRANSFER_READ,
+                         gptr->x, gptr->y, box_w, box_h);
+   if (!t) {
+      pipe_resource_reference(&tex, NULL);
+      return -ENOMEM;
+   }
+
+   hashes = MALLOC(num_tiles * sizeof(uint32_t));
+   tiles = MALLOC(num_tiles * sizeof(uint32_t));
+   sizes = MALLOC(num_tiles * sizeof(uint32_t));
+   tile = MALLOC(tile_size * tile_size * blocksize);
+   data = MALLOC((size_t) data_size);
+   map = context->transfer_map(context, t);
+
+   if (!hashes || !tiles || !sizes || !tile || !data || !map) {
+      ret = -ENOMEM;
+      goto out;
+   }
+
+   for (i = 0; i < num_tiles; i++) {
+      unsigned x = (i % tiles_x) * tile_size;
+      unsigned y = (i / tiles_x) * tile_size;
+      unsigned w = MIN2(tile_size, nblocksx - x);
+      unsigned h = MIN2(tile_size, nblocksy - y);
+      unsigned row_size = w * blocksize;
+
+      for (row = 0; row < h; row++)
+         memcpy(tile + row * row_size,
+                map + (y + row) * t->stride + x * blocksize,
+                row_size);
+
+      hashes[i] = util_hash_crc32(tile, row_size * h);
+
+      /* the client has this tile already */
+      if (gptr->hashes_len == num_tiles && gptr->hashes[i] == hashes[i])
+         continue;
+
+      tiles[num_changed] = i;
+      sizes[num_changed] = rbug_tile_encode(tile, w * h, blocksize,
+                                            data + data_len);
+      data_len += sizes[num_changed];
+      num_changed++;
+   }
+
    context->transfer_unmap(context, t);
-   context->transfer_destroy(context, t);
+   map = NULL;
 
-   pipe_mutex_unlock(rb_screen->list_mutex);
+   /* only the encoded tiles are left, drop the transfer before sending */
+   context->transfer_destroy(context, t);
+   t = NULL;
+   pipe_resource_reference(&tex, NULL);
+
+   rbug_send_texture_read_tiles_reply(tr_rbug->con, serial,
+                                      format,
+                                      util_format_get_blockwidth(format),
+                                      util_format_get_blockheight(format),
+                                      blocksize,
+                                      tile_size,
+                                      hashes, num_tiles,
+                                      tiles, num_changed,
+                                      sizes, num_changed,
+                                      data, data_len,
+                                      NULL);
 
-   return 0;
+out:
+   if (map)
+      context->transfer_unmap(context, t);
+   if (t)
+      context->transfer_destroy(context, t);
+   pipe_resource_reference(&tex, NULL);
+   FREE(hashes);
+   FREE(tiles);
+   FREE(sizes);
+   FREE(tile);
+   FREE(data);
+
+   return ret;
 }
 
 static int
@@ -323,6 +503,10 @@ rbug_context_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_
    struct rbug_context *rb_context = NULL;
    rbug_texture_t cbufs[PIPE_MAX_COLOR_BUFS];
    rbug_texture_t texs[PIPE_MAX_SAMPLERS];
+   rbug_shader_t vs, fs;
+   rbug_texture_t zsbuf;
+   rbug_block_t blocker, blocked;
+   unsigned nr_cbufs, num_fs_views;
    int i;
 
    pipe_mutex_lock(rb_screen->list_mutex);
@@ -337,23 +521,32 @@ rbug_context_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_
    pipe_mutex_lock(rb_context->draw_mutex);
    pipe_mutex_lock(rb_context->call_mutex);
 
-   for (i = 0; i < rb_context->curr.nr_cbufs; i++)
+   nr_cbufs = rb_context->curr.nr_cbufs;
+   for (i = 0; i < nr_cbufs; i++)
       cbufs[i] = VOID2U64(rb_context->curr.cbufs[i]);
 
-   for (i = 0; i < rb_context->curr.num_fs_views; i++)
+   num_fs_views = rb_context->curr.num_fs_views;
+   for (i = 0; i < num_fs_views; i++)
       texs[i] = VOID2U64(rb_context->curr.fs_texs[i]);
 
-   rbug_send_context_info_reply(tr_rbug->con, serial,
-                                VOID2U64(rb_context->curr.vs), VOID2U64(rb_context->curr.fs),
-                                texs, rb_context->curr.num_fs_views,
-                                cbufs, rb_context->curr.nr_cbufs,
-                                VOID2U64(rb_context->curr.zsbuf),
-                                rb_context->draw_blocker, rb_context->draw_blocked, NULL);
+   vs = VOID2U64(rb_context->curr.vs);
+   fs = VOID2U64(rb_context->curr.fs);
+   zsbuf = VOID2U64(rb_context->curr.zsbuf);
+   blocker = rb_context->draw_blocker;
+   blocked = rb_context->draw_blocked;
 
    pipe_mutex_unlock(rb_context->call_mutex);
    pipe_mutex_unlock(rb_context->draw_mutex);
    pipe_mutex_unlock(rb_screen->list_mutex);
 
+   /* don't stall the context while the reply is sent */
+   rbug_send_context_info_reply(tr_rbug->con, serial,
+                                vs, fs,
+                                texs, num_fs_views,
+                                cbufs, nr_cbufs,
+                                zsbuf,
+                                blocker, blocked, NULL);
+
    return 0;
 }
 
@@ -552,6 +745,9 @@ rbug_shader_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_t
    struct rbug_shader *tr_shdr = NULL;
    unsigned original_len;
    unsigned replaced_len;
+   uint32_t *original;
+   uint32_t *replaced = NULL;
+   boolean disabled;
 
    pipe_mutex_lock(rb_screen->list_mutex);
    rb_context = rbug_get_context_locked(rb_screen, info->context);
@@ -574,20 +770,34 @@ rbug_shader_info(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_t
    /* just in case */
    assert(sizeof(struct tgsi_token) == 4);
 
+   /* copy the tokens, a replace could free them while the reply is sent */
    original_len = tgsi_num_tokens(tr_shdr->tokens);
-   if (tr_shdr->replaced_tokens)
+   original = mem_dup(tr_shdr->tokens, original_len * 4);
+   if (tr_shdr->replaced_tokens) {
       replaced_len = tgsi_num_tokens(tr_shdr->replaced_tokens);
-   else
+      replaced = mem_dup(tr_shdr->replaced_tokens, replaced_len * 4);
+   } else {
       replaced_len = 0;
+   }
+   disabled = tr_shdr->disabled;
+
+   pipe_mutex_unlock(rb_context->list_mutex);
+   pipe_mutex_unlock(rb_screen->list_mutex);
+
+   if (!original || (replaced_len && !replaced)) {
+      FREE(original);
+      FREE(replaced);
+      return -ENOMEM;
+   }
 
    rbug_send_shader_info_reply(tr_rbug->con, serial,
-                               (uint32_t*)tr_shdr->tokens, original_len,
-                               (uint32_t*)tr_shdr->replaced_tokens, replaced_len,
-                               tr_shdr->disabled,
+                               original, original_len,
+                               replaced, replaced_len,
+                               disabled,
                                NULL);
 
-   pipe_mutex_unlock(rb_context->list_mutex);
-   pipe_mutex_unlock(rb_screen->list_mutex);
+   FREE(original);
+   FREE(replaced);
 
    return 0;
 }
@@ -728,6 +938,9 @@ rbug_header(struct rbug_rbug *tr_rbug, struct rbug_header *header, uint32_t seri
       case RBUG_OP_TEXTURE_READ:
          ret = rbug_texture_read(tr_rbug, header, serial);
          break;
+      case RBUG_OP_TEXTURE_READ_TILES:
+         ret = rbug_texture_read_tiles(tr_rbug, header, serial);
+         break;
       case RBUG_OP_CONTEXT_LIST:
          ret = rbug_context_list(tr_rbug, header, serial);
          break;
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Binary trace format.
+ *
+ * Written instead of XML when GALLIUM_TRACE_FORMAT=binary. It holds the
+ * same call tree -- calls with named arguments and an optional return
+ * value, made of the values written by the trace_dump_* functions -- as
+ * a stream of one byte tokens, each followed by its payload:
+ *
+ * - unsigned numbers are LEB128 varints, signed numbers zigzag encoded
+ *   varints and floats little endian doubles;
+ *
+ * - names (classes, methods, arguments, structs, members and enums) are
+ *   interned: a name is written as 0 followed by its length and bytes the
+ *   first time, which gives it the next index starting at 1, and as that
+ *   index afterwards;
+ *
+ * - byte blobs of at least TRACE_BIN_BLOB_MIN_SIZE bytes are written once
+ *   (TRACE_BIN_BLOB, which gives them the next index starting at 0) and
+ *   referred to by their index when the same contents are dumped again
+ *   (TRACE_BIN_BLOB_REF). The writer compares the contents, and only keeps
+ *   a bounded amount of them, so a blob may also be written again.
+ *
+ * The file starts with TRACE_BIN_MAGIC followed by TRACE_BIN_VERSION as
+ * a varint.
+ */
+
+#ifndef TR_BINARY_H
+#define TR_BINARY_H
+
+
+#define TRACE_BIN_MAGIC "GTRB"
+#define TRACE_BIN_MAGIC_SIZE 4
+#define TRACE_BIN_VERSION 1
+
+#define TRACE_BIN_BLOB_MIN_SIZE 64
+
+
+enum trace_bin_token {
+   TRACE_BIN_CALL = 1,    /**< call number, class and method names */
+   TRACE_BIN_CALL_END,
+   TRACE_BIN_ARG,         /**< name, value */
+   TRACE_BIN_RET,         /**< value */
+
+   TRACE_BIN_NULL,
+   TRACE_BIN_FALSE,
+   TRACE_BIN_TRUE,
+   TRACE_BIN_INT,         /**< zigzag varint */
+   TRACE_BIN_UINT,        /**< varint */
+   TRACE_BIN_FLOAT,       /**< double */
+   TRACE_BIN_STRING,      /**< length, bytes */
+   TRACE_BIN_ENUM,        /**< name */
+   TRACE_BIN_PTR,         /**< varint */
+   TRACE_BIN_BYTES,       /**< size, bytes */
+   TRACE_BIN_BLOB,        /**< size, bytes */
+   TRACE_BIN_BLOB_REF,    /**< blob index */
+   TRACE_BIN_ARRAY,       /**< values up to TRACE_BIN_ARRAY_END */
+   TRACE_BIN_ARRAY_END,
+   TRACE_BIN_STRUCT,      /**< name, members up to TRACE_BIN_STRUCT_END */
+   TRACE_BIN_MEMBER,      /**< name, value */
+   TRACE_BIN_STRUCT_END
+};
+
+
+#endif /* TR_BINARY_H */
@@ -30,10 +30,10 @@
  * @file
  * Trace dumping functions.
  *
- * For now we just use standard XML for dumping the trace calls, as this is
- * simple to write, parse, and visually inspect, but the actual representation
- * is abstracted out of this file, so that we can switch to a binary
- * representation if/when it becomes justified.
+ * By default we use standard XML for dumping the trace calls, as this is
+ * simple to write, parse, and visually inspect. GALLIUM_TRACE_FORMAT=binary
+ * selects the much more compact binary representation described in
+ * tr_binary.h instead, which is meant for replaying traces.
  *
  * @author Jose Fonseca <jrfonseca@tungstengraphics.com>
  */
@@ -52,7 +52,10 @@
 #include "util/u_string.h"
 #include "util/u_math.h"
 #include "util/u_format.h"
+#include "util/u_hash.h"
+#include "util/u_hash_table.h"
 
+#include "tr_binary.h"
 #include "tr_dump.h"
 #include "tr_screen.h"
 #include "tr_texture.h"
@@ -64,6 +67,27 @@ pipe_static_mutex(call_mutex);
 static long unsigned call_no = 0;
 static boolean dumping = FALSE;
 
+/* Binary format state, see tr_binary.h. */
+static boolean binary = FALSE;
+static boolean binary_flush = FALSE;
+static uint8_t binary_buf[64 * 1024];
+static unsigned binary_used = 0;
+static struct util_hash_table *binary_names = NULL;
+static unsigned binary_num_names = 0;
+static struct util_hash_table *binary_blobs = NULL;
+static unsigned binary_num_blobs = 0;
+static size_t binary_blob_bytes = 0;
+
+/* Blobs are kept to compare the contents of later ones, up to this many
+ * bytes. Blobs dumped past it are written in full every time. */
+#define TRACE_BIN_BLOB_CACHE_SIZE (256 * 1024 * 1024)
+
+struct trace_blob_key {
+   uint64_t hash;
+   size_t size;
+   const uint8_t *data;
+};
+
 
 static INLINE void
 trace_dump_write(const char *buf, size_t size)
@@ -93,6 +117,243 @@ trace_dump_writef(const char *format, ...)
 }
 
 
+/*
+ * Binary format
+ */
+
+static void
+trace_bin_flush(void)
+{
+   if (binary_used) {
+      trace_dump_write((const char *)binary_buf, binary_used);
+      binary_used = 0;
+   }
+}
+
+
+static INLINE void
+trace_bin_write(const void *data, size_t size)
+{
+   if (size > sizeof(binary_buf) - binary_used) {
+      trace_bin_flush();
+      if (size >= sizeof(binary_buf)) {
+         trace_dump_write(data, size);
+         return;
+      }
+   }
+   memcpy(binary_buf + binary_used, data, size);
+   binary_used += size;
+}
+
+
+static INLINE void
+trace_bin_token(enum trace_bin_token token)
+{
+   uint8_t byte = token;
+   trace_bin_write(&byte, 1);
+}
+
+
+static INLINE void
+trace_bin_uint(uint64_t value)
+{
+   uint8_t buf[10];
+   unsigned len = 0;
+
+   while (value >= 0x80) {
+      buf[len++] = (uint8_t)value | 0x80;
+      value >>= 7;
+   }
+   buf[len++] = (uint8_t)value;
+   trace_bin_write(buf, len);
+}
+
+
+static INLINE void
+trace_bin_int(int64_t value)
+{
+   trace_bin_uint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+
+static INLINE void
+trace_bin_float(double value)
+{
+   union { double d; uint64_t u; } tmp;
+   uint8_t buf[8];
+   unsigned i;
+
+   tmp.d = value;
+   for (i = 0; i < 8; ++i)
+      buf[i] = (uint8_t)(tmp.u >> (i * 8));
+   trace_bin_write(buf, 8);
+}
+
+
+static unsigned
+trace_bin_name_hash(void *key)
+{
+   const char *name = key;
+   return util_hash_crc32(name, strlen(name));
+}
+
+
+static int
+trace_bin_name_compare(void *key1, void *key2)
+{
+   return strcmp(key1, key2);
+}
+
+
+static void
+trace_bin_name(const char *name)
+{
+   unsigned index;
+   size_t len;
+   char *copy;
+
+   index = (unsigned)(uintptr_t)util_hash_table_get(binary_names,
+                                                    (void *)name);
+   if (index) {
+      trace_bin_uint(index);
+      return;
+   }
+
+   /* The reader numbers names as they come, keep counting even if we
+    * fail to remember this one. */
+   len = strlen(name);
+   index = ++binary_num_names;
+   copy = MALLOC(len + 1);
+   if (copy) {
+      memcpy(copy, name, len + 1);
+      util_hash_table_set(binary_names, copy, (void *)(uintptr_t)index);
+   }
+
+   trace_bin_uint(0);
+   trace_bin_uint(len);
+   trace_bin_write(name, len);
+}
+
+
+static unsigned
+trace_bin_blob_hash(void *key)
+{
+   const struct trace_blob_key *blob = key;
+   return (unsigned)(blob->hash ^ (blob->hash >> 32));
+}
+
+
+static int
+trace_bin_blob_compare(void *key1, void *key2)
+{
+   const struct trace_blob_key *blob1 = key1;
+   const struct trace_blob_key *blob2 = key2;
+   return blob1->hash != blob2->hash || blob1->size != blob2->size ||
+          memcmp(blob1->data, blob2->data, blob1->size) != 0;
+}
+
+
+static void
+trace_bin_bytes(const void *data, size_t size)
+{
+   struct trace_blob_key key, *new_key;
+   const uint8_t *p = data;
+   uint64_t hash = 0xcbf29ce484222325ULL;
+   unsigned index;
+   size_t i;
+
+   if (size < TRACE_BIN_BLOB_MIN_SIZE) {
+      trace_bin_token(TRACE_BIN_BYTES);
+      trace_bin_uint(size);
+      trace_bin_write(data, size);
+      return;
+   }
+
+   /* FNV-1a */
+   for (i = 0; i < size; ++i) {
+      hash ^= p[i];
+      hash *= 0x100000001b3ULL;
+   }
+
+   key.hash = hash;
+   key.size = size;
+   key.data = data;
+   index = (unsigned)(uintptr_t)util_hash_table_get(binary_blobs, &key);
+   if (index) {
+      trace_bin_token(TRACE_BIN_BLOB_REF);
+      trace_bin_uint(index - 1);
+      return;
+   }
+
+   index = ++binary_num_blobs;
+   if (binary_blob_bytes + size <= TRACE_BIN_BLOB_CACHE_SIZE) {
+      /* keep a copy of the contents, the caller's data may change */
+      new_key = MALLOC(sizeof *new_key + size);
+      if (new_key) {
+         new_key->hash = hash;
+         new_key->size = size;
+         new_key->data = (const uint8_t *)(new_key + 1);
+         memcpy(new_key + 1, data, size);
+         util_hash_table_set(binary_blobs, new_key, (void *)(uintptr_t)index);
+         binary_blob_bytes += size;
+      }
+   }
+
+   trace_bin_token(TRACE_BIN_BLOB);
+   trace_bin_uint(size);
+   trace_bin_write(data, size);
+}
+
+
+static enum pipe_error
+trace_bin_free_key(void *key, void *value, void *data)
+{
+   FREE(key);
+   return PIPE_OK;
+}
+
+
+static boolean
+trace_bin_begin(void)
+{
+   binary_names = util_hash_table_create(trace_bin_name_hash,
+                                         trace_bin_name_compare);
+   binary_blobs = util_hash_table_create(trace_bin_blob_hash,
+                                         trace_bin_blob_compare);
+   if (!binary_names || !binary_blobs)
+      return FALSE;
+
+   trace_bin_write(TRACE_BIN_MAGIC, TRACE_BIN_MAGIC_SIZE);
+   trace_bin_uint(TRACE_BIN_VERSION);
+   return TRUE;
+}
+
+
+static void
+trace_bin_end(void)
+{
+   trace_bin_flush();
+
+   if (binary_names) {
+      util_hash_table_foreach(binary_names, trace_bin_free_key, NULL);
+      util_hash_table_destroy(binary_names);
+      binary_names = NULL;
+   }
+   if (binary_blobs) {
+      util_hash_table_foreach(binary_blobs, trace_bin_free_key, NULL);
+      util_hash_table_destroy(binary_blobs);
+      binary_blobs = NULL;
+   }
+   binary_num_names = 0;
+   binary_num_blobs = 0;
+   binary_blob_bytes = 0;
+}
+
+
+/*
+ * XML format
+ */
+
 static INLINE void
 trace_dump_escape(const char *str)
 {
@@ -219,7 +480,10 @@ static void
 trace_dump_trace_close(void)
 {
    if(stream) {
-      trace_dump_writes("</trace>\n");
+      if (binary)
+         trace_bin_end();
+      else
+         trace_dump_writes("</trace>\n");
       os_stream_close(stream);
       stream = NULL;
       refcount = 0;
@@ -241,9 +505,21 @@ boolean trace_dump_trace_begin()
       if(!stream)
          return FALSE;
 
-      trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
-      trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
-      trace_dump_writes("<trace version='0.1'>\n");
+      binary = strcmp(debug_get_option("GALLIUM_TRACE_FORMAT", "xml"),
+                      "binary") == 0;
+
+      if (binary) {
+         if (!trace_bin_begin()) {
+            trace_bin_end();
+            os_stream_close(stream);
+            stream = NULL;
+            return FALSE;
+         }
+      } else {
+         trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
+         trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
+         trace_dump_writes("<trace version='0.1'>\n");
+      }
 
 #if defined(PIPE_OS_LINUX) || defined(PIPE_OS_BSD) || defined(PIPE_OS_SOLARIS) || defined(PIPE_OS_APPLE)
       /* Linux applications rarely cleanup GL / Gallium resources so catch
@@ -335,6 +611,18 @@ void trace_dump_call_begin_locked(const char *klass, const char *method)
       return;
 
    ++call_no;
+
+   if (binary) {
+      trace_bin_token(TRACE_BIN_CALL);
+      trace_bin_uint(call_no);
+      trace_bin_name(klass);
+      trace_bin_name(method);
+      /* Only write out whole frames, not every call. */
+      binary_flush = strcmp(method, "flush") == 0 ||
+                     strcmp(method, "flush_frontbuffer") == 0;
+      return;
+   }
+
    trace_dump_indent(1);
    trace_dump_writes("<call no=\'");
    trace_dump_writef("%lu", call_no);
@@ -351,6 +639,15 @@ void trace_dump_call_end_locked(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_CALL_END);
+      if (binary_flush) {
+         trace_bin_flush();
+         os_stream_flush(stream);
+      }
+      return;
+   }
+
    trace_dump_indent(1);
    trace_dump_tag_end("call");
    trace_dump_newline();
@@ -374,13 +671,19 @@ void trace_dump_arg_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARG);
+      trace_bin_name(name);
+      return;
+   }
+
    trace_dump_indent(2);
    trace_dump_tag_begin1("arg", "name", name);
 }
 
 void trace_dump_arg_end(void)
 {
-   if (!dumping)
+   if (!dumping || binary)
       return;
 
    trace_dump_tag_end("arg");
@@ -392,13 +695,18 @@ void trace_dump_ret_begin(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_RET);
+      return;
+   }
+
    trace_dump_indent(2);
    trace_dump_tag_begin("ret");
 }
 
 void trace_dump_ret_end(void)
 {
-   if (!dumping)
+   if (!dumping || binary)
       return;
 
    trace_dump_tag_end("ret");
@@ -410,6 +718,11 @@ void trace_dump_bool(int value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(value ? TRACE_BIN_TRUE : TRACE_BIN_FALSE);
+      return;
+   }
+
    trace_dump_writef("<bool>%c</bool>", value ? '1' : '0');
 }
 
@@ -418,6 +731,12 @@ void trace_dump_int(long long int value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_INT);
+      trace_bin_int(value);
+      return;
+   }
+
    trace_dump_writef("<int>%lli</int>", value);
 }
 
@@ -426,6 +745,12 @@ void trace_dump_uint(long long unsigned value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_UINT);
+      trace_bin_uint(value);
+      return;
+   }
+
    trace_dump_writef("<uint>%llu</uint>", value);
 }
 
@@ -434,6 +759,12 @@ void trace_dump_float(double value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_FLOAT);
+      trace_bin_float(value);
+      return;
+   }
+
    trace_dump_writef("<float>%g</float>", value);
 }
 
@@ -447,6 +778,11 @@ void trace_dump_bytes(const void *data,
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_bytes(data, size);
+      return;
+   }
+
    trace_dump_writes("<bytes>");
    for(i = 0; i < size; ++i) {
       uint8_t byte = *p++;
@@ -482,6 +818,13 @@ void trace_dump_string(const char *str)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_STRING);
+      trace_bin_uint(strlen(str));
+      trace_bin_write(str, strlen(str));
+      return;
+   }
+
    trace_dump_writes("<string>");
    trace_dump_escape(str);
    trace_dump_writes("</string>");
@@ -492,6 +835,12 @@ void trace_dump_enum(const char *value)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ENUM);
+      trace_bin_name(value);
+      return;
+   }
+
    trace_dump_writes("<enum>");
    trace_dump_escape(value);
    trace_dump_writes("</enum>");
@@ -502,6 +851,11 @@ void trace_dump_array_begin(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARRAY);
+      return;
+   }
+
    trace_dump_writes("<array>");
 }
 
@@ -510,12 +864,17 @@ void trace_dump_array_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_ARRAY_END);
+      return;
+   }
+
    trace_dump_writes("</array>");
 }
 
 void trace_dump_elem_begin(void)
 {
-   if (!dumping)
+   if (!dumping || binary)
       return;
 
    trace_dump_writes("<elem>");
@@ -523,7 +882,7 @@ void trace_dump_elem_begin(void)
 
 void trace_dump_elem_end(void)
 {
-   if (!dumping)
+   if (!dumping || binary)
       return;
 
    trace_dump_writes("</elem>");
@@ -534,6 +893,12 @@ void trace_dump_struct_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_STRUCT);
+      trace_bin_name(name);
+      return;
+   }
+
    trace_dump_writef("<struct name='%s'>", name);
 }
 
@@ -542,6 +907,11 @@ void trace_dump_struct_end(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_STRUCT_END);
+      return;
+   }
+
    trace_dump_writes("</struct>");
 }
 
@@ -550,12 +920,18 @@ void trace_dump_member_begin(const char *name)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_MEMBER);
+      trace_bin_name(name);
+      return;
+   }
+
    trace_dump_writef("<member name='%s'>", name);
 }
 
 void trace_dump_member_end(void)
 {
-   if (!dumping)
+   if (!dumping || binary)
       return;
 
    trace_dump_writes("</member>");
@@ -566,6 +942,11 @@ void trace_dump_null(void)
    if (!dumping)
       return;
 
+   if (binary) {
+      trace_bin_token(TRACE_BIN_NULL);
+      return;
+   }
+
    trace_dump_writes("<null/>");
 }
 
@@ -574,6 +955,16 @@ void trace_dump_ptr(const void *value)
    if (!dumping)
       return;
 
+   if (binary) {
+      if (value) {
+         trace_bin_token(TRACE_BIN_PTR);
+         trace_bin_uint((uintptr_t)value);
+      } else {
+         trace_bin_token(TRACE_BIN_NULL);
+      }
+      return;
+   }
+
    if(value)
       trace_dump_writef("<ptr>0x%08lx</ptr>", (unsigned long)(uintptr_t)value);
    else
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file drawoverhead.c
+ * Measures the CPU cost of GL calls with the rasterizer out of the
+ * picture.  Run it against the xlib libGL with the noop pipe driver
+ * wrapped around the real one:
+ *
+ *    GALLIUM_NOOP=1 MESA_PROFILE=1 ./drawoverhead [-t seconds] [scenario...]
+ *
+ * Every scenario runs in a fresh context and reports calls per second.
+ * With MESA_PROFILE set, Mesa prints the time spent in vbo, in
+ * _mesa_update_state and in st_validate_state when each context is
+ * destroyed, i.e. after each scenario.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glx.h>
+
+
+#define NUM_TEXTURES 8
+#define BATCH 1000
+
+
+static Display *dpy;
+static Window win;
+static XVisualInfo *visinfo;
+
+static GLuint vbo, ibo, program, dlist;
+static GLint color_uniform;
+static GLuint textures[NUM_TEXTURES];
+
+
+static double
+get_time(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+static void
+setup_arrays(void)
+{
+   static const GLfloat verts[] = {
+      -1, -1,   1, -1,   0, 1,   1, 1
+   };
+   static const GLushort indices[] = { 0, 1, 2, 1, 3, 2 };
+
+   glGenBuffers(1, &vbo);
+   glBindBuffer(GL_ARRAY_BUFFER, vbo);
+   glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+   glVertexPointer(2, GL_FLOAT, 0, NULL);
+   glTexCoordPointer(2, GL_FLOAT, 0, NULL);
+   glEnableClientState(GL_VERTEX_ARRAY);
+
+   glGenBuffers(1, &ibo);
+   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+                GL_STATIC_DRAW);
+}
+
+
+/*
+ * Scenarios.  Each one draws BATCH times per call of its draw function;
+ * the setup function, if any, runs once in the scenario's context.
+ */
+
+static void
+draw_arrays(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++)
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+
+static void
+draw_elements(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++)
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, NULL);
+}
+
+
+static void
+draw_state_change(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++) {
+      if (i & 1) {
+         glEnable(GL_BLEND);
+         glDepthFunc(GL_LEQUAL);
+      }
+      else {
+         glDisable(GL_BLEND);
+         glDepthFunc(GL_LESS);
+      }
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+   }
+}
+
+
+static void
+setup_uniform(void)
+{
+   static const char *vs_source =
+      "void main() { gl_Position = gl_Vertex; }\n";
+   static const char *fs_source =
+      "uniform vec4 color;\n"
+      "void main() { gl_FragColor = color; }\n";
+   GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+   GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+
+   glShaderSource(vs, 1, &vs_source, NULL);
+   glCompileShader(vs);
+   glShaderSource(fs, 1, &fs_source, NULL);
+   glCompileShader(fs);
+
+   program = glCreateProgram();
+   glAttachShader(program, vs);
+   glAttachShader(program, fs);
+   glLinkProgram(program);
+   glUseProgram(program);
+   color_uniform = glGetUniformLocation(program, "color");
+}
+
+
+static void
+draw_uniform(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++) {
+      glUniform4f(color_uniform, (i & 255) / 255.0f, 0.0f, 0.0f, 1.0f);
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+   }
+}
+
+
+static void
+setup_textures(void)
+{
+   static const GLubyte texels[4 * 4 * 4];
+   int i;
+
+   glGenTextures(NUM_TEXTURES, textures);
+   for (i = 0; i < NUM_TEXTURES; i++) {
+      glBindTexture(GL_TEXTURE_2D, textures[i]);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 4, 4, 0, GL_RGBA,
+                   GL_UNSIGNED_BYTE, texels);
+   }
+   glEnable(GL_TEXTURE_2D);
+   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+static void
+draw_texture_bind(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++) {
+      glBindTexture(GL_TEXTURE_2D, textures[i % NUM_TEXTURES]);
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+   }
+}
+
+
+static void
+setup_display_list(void)
+{
+   int i;
+
+   dlist = glGenLists(1);
+   glNewList(dlist, GL_COMPILE);
+   glEnable(GL_DEPTH_TEST);
+   glShadeModel(GL_FLAT);
+   for (i = 0; i < 16; i++) {
+      glColor3f(i / 16.0f, 0.0f, 1.0f);
+      glBegin(GL_TRIANGLES);
+      glVertex2f(-1, -1);
+      glVertex2f(1, -1);
+      glVertex2f(0, 1);
+      glEnd();
+   }
+   glDisable(GL_DEPTH_TEST);
+   glEndList();
+}
+
+
+static void
+draw_display_list(void)
+{
+   int i;
+   for (i = 0; i < BATCH; i++)
+      glCallList(dlist);
+}
+
+
+struct scenario {
+   const char *name;
+   const char *description;
+   void (*setup)(void);
+   void (*draw)(void);
+};
+
+static const struct scenario scenarios[] = {
+   { "draw-arrays", "glDrawArrays", NULL, draw_arrays },
+   { "draw-elements", "glDrawElements", NULL, draw_elements },
+   { "state-change", "glEnable/glDepthFunc + glDrawArrays",
+     NULL, draw_state_change },
+   { "uniform", "glUniform4f + glDrawArrays", setup_uniform, draw_uniform },
+   { "texture-bind", "glBindTexture + glDrawArrays",
+     setup_textures, draw_texture_bind },
+   { "display-list", "glCallList of 16 triangles",
+     setup_display_list, draw_display_list },
+};
+
+
+static void
+run(const struct scenario *s, double duration)
+{
+   GLXContext ctx = glXCreateContext(dpy, visinfo, NULL, True);
+   unsigned long calls = 0;
+   double start, elapsed;
+
+   if (!ctx) {
+      fprintf(stderr, "%s: couldn't create a context\n", s->name);
+      return;
+   }
+   glXMakeCurrent(dpy, win, ctx);
+
+   setup_arrays();
+   if (s->setup)
+      s->setup();
+
+   /* warm up, so one-time validation and shader compiles aren't counted */
+   s->draw();
+   glFinish();
+
+   start = get_time();
+   do {
+      s->draw();
+      calls += BATCH;
+      elapsed = get_time() - start;
+   } while (elapsed < duration);
+   glFinish();
+   elapsed = get_time() - start;
+
+   printf("%-14s %-40s %12.0f calls/s\n", s->name, s->description,
+          calls / elapsed);
+   fflush(stdout);
+
+   glXMakeCurrent(dpy, None, NULL);
+   glXDestroyContext(dpy, ctx);
+}
+
+
+static void
+usage(void)
+{
+   unsigned i;
+
+   fprintf(stderr, "usage: drawoverhead [-t seconds] [scenario...]\n");
+   fprintf(stderr, "scenarios:");
+   for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+      fprintf(stderr, " %s", scenarios[i].name);
+   fprintf(stderr, "\n");
+   exit(1);
+}
+
+
+int
+main(int argc, char **argv)
+{
+   static int attribs[] = { GLX_RGBA, GLX_DOUBLEBUFFER, GLX_DEPTH_SIZE, 1,
+                            None };
+   const unsigned num_scenarios = sizeof(scenarios) / sizeof(scenarios[0]);
+   XSetWindowAttributes attr;
+   double duration = 1.0;
+   int selected = 0;
+   unsigned i;
+   int a;
+
+   dpy = XOpenDisplay(NULL);
+   if (!dpy) {
+      fprintf(stderr, "couldn't open display\n");
+      return 1;
+   }
+
+   visinfo = glXChooseVisual(dpy, DefaultScreen(dpy), attribs);
+   if (!visinfo) {
+      fprintf(stderr, "couldn't get an RGB, double-buffered visual\n");
+      return 1;
+   }
+
+   /* The window is never mapped, nothing is meant to be seen. */
+   attr.colormap = XCreateColormap(dpy, RootWindow(dpy, visinfo->screen),
+                                   visinfo->visual, AllocNone);
+   attr.border_pixel = 0;
+   win = XCreateWindow(dpy, RootWindow(dpy, visinfo->screen), 0, 0, 64, 64,
+                       0, visinfo->depth, InputOutput, visinfo->visual,
+                       CWBorderPixel | CWColormap, &attr);
+
+   for (a = 1; a < argc; a++) {
+      if (strcmp(argv[a], "-t") == 0 && a + 1 < argc)
+         duration = atof(argv[++a]);
+      else if (argv[a][0] == '-')
+         usage();
+      else
+         selected = 1;
+   }
+
+   for (i = 0; i < num_scenarios; i++) {
+      if (selected) {
+         for (a = 1; a < argc; a++) {
+            if (strcmp(argv[a], scenarios[i].name) == 0)
+               break;
+         }
+         if (a == argc)
+            continue;
+      }
+      run(&scenarios[i], duration);
+   }
+
+   XDestroyWindow(dpy, win);
+   XFree(visinfo);
+   XCloseDisplay(dpy);
+   return 0;
+}
@@ -0,0 +1,1504 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Replay a binary trace (GALLIUM_TRACE_FORMAT=binary) on a software or
+ * the noop driver and report how long it took.
+ *
+ * The objects of the trace are recreated as their creation calls are
+ * replayed, and looked up by their traced address afterwards. Queries
+ * about the screen and fences are skipped, as is anything the trace
+ * doesn't record enough of to reproduce.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pipe/p_context.h"
+#include "pipe/p_defines.h"
+#include "pipe/p_screen.h"
+#include "pipe/p_shader_tokens.h"
+#include "pipe/p_state.h"
+
+#include "os/os_time.h"
+#include "tgsi/tgsi_text.h"
+#include "util/u_format.h"
+#include "util/u_hash_table.h"
+#include "util/u_inlines.h"
+#include "util/u_memory.h"
+
+/* sw_screen_create: to get a software pipe driver */
+#include "target-helpers/inline_sw_helper.h"
+/* debug_screen_wrap: to wrap with debug pipe drivers */
+#include "target-helpers/inline_debug_helper.h"
+/* null software winsys */
+#include "sw/null/null_sw_winsys.h"
+
+#include "replay_reader.h"
+
+
+#define REPLAY_MAX_TOKENS 4096
+
+
+struct replay {
+   struct pipe_screen *screen;
+
+   /** Traced address -> struct replay_object */
+   struct util_hash_table *objects;
+
+   struct tgsi_token tokens[REPLAY_MAX_TOKENS];
+
+   boolean verbose;
+
+   unsigned long calls;
+   unsigned long skipped;
+   unsigned long draws;
+   unsigned long frames;
+};
+
+
+typedef void (*replay_release_func)(struct pipe_context *pipe, void *ptr);
+
+
+/** An object created while replaying. */
+struct replay_object {
+   void *ptr;
+
+   /** Context the object belongs to, if any. */
+   struct pipe_context *pipe;
+
+   replay_release_func release;
+
+   /** Contents of a user buffer. */
+   void *data;
+};
+
+
+/*
+ * Values
+ */
+
+static INLINE const struct replay_value *
+arg(const struct replay_call *call, unsigned index)
+{
+   return index < call->num_args ? call->args[index] : NULL;
+}
+
+
+static const struct replay_value *
+member(const struct replay_value *value, const char *name)
+{
+   unsigned i;
+
+   if (!value || value->type != REPLAY_STRUCT)
+      return NULL;
+
+   for (i = 0; i < value->u.s.count; i++)
+      if (strcmp(value->u.s.names[i]->str, name) == 0)
+         return value->u.s.values[i];
+
+   return NULL;
+}
+
+
+static uint64_t
+value_uint(const struct replay_value *value)
+{
+   if (!value)
+      return 0;
+
+   switch (value->type) {
+   case REPLAY_BOOL:
+      return value->u.b;
+   case REPLAY_INT:
+      return (uint64_t)value->u.i;
+   case REPLAY_UINT:
+   case REPLAY_PTR:
+      return value->u.u;
+   case REPLAY_FLOAT:
+      return (uint64_t)(int64_t)value->u.f;
+   default:
+      return 0;
+   }
+}
+
+
+static double
+value_float(const struct replay_value *value)
+{
+   if (!value)
+      return 0.0;
+
+   switch (value->type) {
+   case REPLAY_FLOAT:
+      return value->u.f;
+   case REPLAY_INT:
+      return (double)value->u.i;
+   default:
+      return (double)value_uint(value);
+   }
+}
+
+
+static void
+value_floats(const struct replay_value *value, float *dst, unsigned n)
+{
+   unsigned i;
+
+   for (i = 0; i < n; i++)
+      dst[i] = value && value->type == REPLAY_ARRAY && i < value->u.array.count ?
+               (float)value_float(value->u.array.elems[i]) : 0.0f;
+}
+
+
+static INLINE const struct replay_value *
+elem(const struct replay_value *value, unsigned index)
+{
+   if (!value || value->type != REPLAY_ARRAY || index >= value->u.array.count)
+      return NULL;
+   return value->u.array.elems[index];
+}
+
+
+static INLINE unsigned
+count(const struct replay_value *value, unsigned max)
+{
+   if (!value || value->type != REPLAY_ARRAY)
+      return 0;
+   return MIN2(value->u.array.count, max);
+}
+
+
+static enum pipe_format
+value_format(const struct replay_value *value)
+{
+   struct replay_name *name;
+   unsigned format;
+
+   if (!value || value->type != REPLAY_ENUM)
+      return PIPE_FORMAT_NONE;
+
+   name = value->u.name;
+   if (name->value < 0) {
+      name->value = PIPE_FORMAT_NONE;
+      for (format = 0; format < PIPE_FORMAT_COUNT; format++) {
+         if (strcmp(util_format_name(format), name->str) == 0) {
+            name->value = format;
+            break;
+         }
+      }
+   }
+
+   return (enum pipe_format)name->value;
+}
+
+
+#define GET(_value, _state, _member) \
+   (_state)->_member = value_uint(member(_value, #_member))
+
+#define GETF(_value, _state, _member) \
+   (_state)->_member = (float)value_float(member(_value, #_member))
+
+
+/*
+ * Objects
+ */
+
+static unsigned
+object_hash(void *key)
+{
+   uintptr_t ptr = (uintptr_t)key;
+   return (unsigned)(ptr >> 4) ^ (unsigned)(ptr >> 16);
+}
+
+
+static int
+object_compare(void *key1, void *key2)
+{
+   return key1 != key2;
+}
+
+
+static INLINE void *
+object_key(const struct replay_value *value)
+{
+   if (!value || value->type != REPLAY_PTR)
+      return NULL;
+   return (void *)(uintptr_t)value->u.u;
+}
+
+
+/** Look up the object a traced pointer stands for. */
+static void *
+object(struct replay *r, const struct replay_call *call,
+       const struct replay_value *value)
+{
+   void *key = object_key(value);
+   struct replay_object *obj;
+
+   if (!key)
+      return NULL;
+
+   obj = util_hash_table_get(r->objects, key);
+   if (!obj) {
+      if (r->verbose)
+         fprintf(stderr, "call %lu: %s::%s: unknown object %p\n",
+                 call->no, call->klass->str, call->method->str, key);
+      return NULL;
+   }
+
+   return obj->ptr;
+}
+
+
+static void
+object_add(struct replay *r, const struct replay_value *value, void *ptr,
+           struct pipe_context *pipe, replay_release_func release, void *data)
+{
+   void *key = object_key(value);
+   struct replay_object *obj;
+
+   if (!ptr) {
+      FREE(data);
+      return;
+   }
+
+   obj = key ? CALLOC_STRUCT(replay_object) : NULL;
+   if (!obj) {
+      if (release)
+         release(pipe, ptr);
+      FREE(data);
+      return;
+   }
+
+   obj->ptr = ptr;
+   obj->pipe = pipe;
+   obj->release = release;
+   obj->data = data;
+
+   /* The address may be reused by an object we didn't see go away. */
+   FREE(util_hash_table_get(r->objects, key));
+   util_hash_table_set(r->objects, key, obj);
+}
+
+
+static void
+object_destroy(struct replay *r, const struct replay_value *value)
+{
+   void *key = object_key(value);
+   struct replay_object *obj;
+
+   if (!key)
+      return;
+
+   obj = util_hash_table_get(r->objects, key);
+   if (!obj)
+      return;
+
+   util_hash_table_remove(r->objects, key);
+   if (obj->release)
+      obj->release(obj->pipe, obj->ptr);
+   FREE(obj->data);
+   FREE(obj);
+}
+
+
+static void
+release_resource(struct pipe_context *pipe, void *ptr)
+{
+   struct pipe_resource *resource = ptr;
+   pipe_resource_reference(&resource, NULL);
+}
+
+
+static void
+release_sampler_view(struct pipe_context *pipe, void *ptr)
+{
+   struct pipe_sampler_view *view = ptr;
+   pipe_sampler_view_reference(&view, NULL);
+}
+
+
+static void
+release_surface(struct pipe_context *pipe, void *ptr)
+{
+   struct pipe_surface *surface = ptr;
+   pipe_surface_reference(&surface, NULL);
+}
+
+
+static void
+release_query(struct pipe_context *pipe, void *ptr)
+{
+   pipe->destroy_query(pipe, ptr);
+}
+
+
+static void
+release_context(struct pipe_context *pipe, void *ptr)
+{
+   pipe = ptr;
+   pipe->destroy(pipe);
+}
+
+
+struct release_pass {
+   struct replay *r;
+   unsigned pass;
+};
+
+
+/**
+ * Objects still alive at the end are released in three passes: those
+ * that belong to a context, then resources, then the contexts.
+ */
+static enum pipe_error
+release_cb(void *key, void *value, void *data)
+{
+   struct release_pass *p = data;
+   struct replay_object *obj = value;
+   unsigned pass = obj->release == release_context ? 2 :
+                   obj->release == release_resource ? 1 : 0;
+
+   if (pass == p->pass) {
+      if (obj->release)
+         obj->release(obj->pipe, obj->ptr);
+      FREE(obj->data);
+      obj->release = NULL;
+      obj->data = NULL;
+   }
+   if (p->pass == 2)
+      FREE(obj);
+
+   return PIPE_OK;
+}
+
+
+/*
+ * Screen calls
+ */
+
+static void
+replay_pipe_screen_create(struct replay *r, struct pipe_context *pipe,
+                          const struct replay_call *call)
+{
+   object_add(r, call->ret, r->screen, NULL, NULL, NULL);
+}
+
+
+static void
+replay_context_create(struct replay *r, struct pipe_context *pipe,
+                      const struct replay_call *call)
+{
+   pipe = r->screen->context_create(r->screen, NULL);
+   object_add(r, call->ret, pipe, NULL, release_context, NULL);
+}
+
+
+/** Release what a context being destroyed still owns. */
+static enum pipe_error
+orphan_cb(void *key, void *value, void *data)
+{
+   struct replay_object *obj = value;
+
+   if (obj->pipe && obj->pipe == data) {
+      if (obj->release)
+         obj->release(obj->pipe, obj->ptr);
+      obj->release = NULL;
+      obj->pipe = NULL;
+   }
+
+   return PIPE_OK;
+}
+
+
+static void
+replay_destroy(struct replay *r, struct pipe_context *pipe,
+               const struct replay_call *call)
+{
+   /* The screen lives until the end of the replay. */
+   if (pipe) {
+      util_hash_table_foreach(r->objects, orphan_cb, pipe);
+      object_destroy(r, arg(call, 0));
+   }
+}
+
+
+static void
+replay_flush_frontbuffer(struct replay *r, struct pipe_context *pipe,
+                         const struct replay_call *call)
+{
+   /* Nothing to present to, but this is what ends a frame. */
+   r->frames++;
+}
+
+
+static void
+replay_resource_create(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_resource templat;
+
+   memset(&templat, 0, sizeof templat);
+   templat.target = value_uint(member(v, "target"));
+   templat.format = value_format(member(v, "format"));
+   templat.width0 = value_uint(member(v, "width"));
+   templat.height0 = value_uint(member(v, "height"));
+   templat.depth0 = value_uint(member(v, "depth"));
+   templat.array_size = value_uint(member(v, "array_size"));
+   GET(v, &templat, last_level);
+   GET(v, &templat, usage);
+   GET(v, &templat, bind);
+   GET(v, &templat, flags);
+
+   /* There is no window system to share or display anything with. */
+   templat.bind &= ~(PIPE_BIND_DISPLAY_TARGET |
+                     PIPE_BIND_SCANOUT |
+                     PIPE_BIND_SHARED);
+
+   object_add(r, call->ret, r->screen->resource_create(r->screen, &templat),
+              NULL, release_resource, NULL);
+}
+
+
+static void
+replay_user_buffer_create(struct replay *r, struct pipe_context *pipe,
+                          const struct replay_call *call)
+{
+   const struct replay_value *data = arg(call, 1);
+   unsigned size = value_uint(arg(call, 2));
+   unsigned bind = value_uint(arg(call, 3));
+   void *copy;
+
+   /* The buffer may be read at any later draw, so it needs its own copy. */
+   copy = CALLOC(1, MAX2(size, 1));
+   if (!copy)
+      return;
+   if (data && data->type == REPLAY_BYTES)
+      memcpy(copy, data->u.bytes.data, MIN2(size, data->u.bytes.size));
+
+   object_add(r, call->ret,
+              r->screen->user_buffer_create(r->screen, copy, size, bind),
+              NULL, release_resource, copy);
+}
+
+
+static void
+replay_resource_destroy(struct replay *r, struct pipe_context *pipe,
+                        const struct replay_call *call)
+{
+   object_destroy(r, arg(call, 1));
+}
+
+
+/*
+ * State objects
+ */
+
+static void
+replay_delete(struct replay *r, struct pipe_context *pipe,
+              const struct replay_call *call)
+{
+   object_destroy(r, arg(call, 1));
+}
+
+
+static void
+replay_create_blend_state(struct replay *r, struct pipe_context *pipe,
+                          const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_blend_state state;
+   unsigned i;
+
+   memset(&state, 0, sizeof state);
+   GET(v, &state, dither);
+   GET(v, &state, logicop_enable);
+   GET(v, &state, logicop_func);
+   GET(v, &state, independent_blend_enable);
+   for (i = 0; i < count(member(v, "rt"), PIPE_MAX_COLOR_BUFS); i++) {
+      const struct replay_value *rt = elem(member(v, "rt"), i);
+      GET(rt, &state.rt[i], blend_enable);
+      GET(rt, &state.rt[i], rgb_func);
+      GET(rt, &state.rt[i], rgb_src_factor);
+      GET(rt, &state.rt[i], rgb_dst_factor);
+      GET(rt, &state.rt[i], alpha_func);
+      GET(rt, &state.rt[i], alpha_src_factor);
+      GET(rt, &state.rt[i], alpha_dst_factor);
+      GET(rt, &state.rt[i], colormask);
+   }
+
+   object_add(r, call->ret, pipe->create_blend_state(pipe, &state),
+              pipe, pipe->delete_blend_state, NULL);
+}
+
+
+static void
+replay_create_sampler_state(struct replay *r, struct pipe_context *pipe,
+                            const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_sampler_state state;
+
+   memset(&state, 0, sizeof state);
+   GET(v, &state, wrap_s);
+   GET(v, &state, wrap_t);
+   GET(v, &state, wrap_r);
+   GET(v, &state, min_img_filter);
+   GET(v, &state, min_mip_filter);
+   GET(v, &state, mag_img_filter);
+   GET(v, &state, compare_mode);
+   GET(v, &state, compare_func);
+   GET(v, &state, normalized_coords);
+   GET(v, &state, max_anisotropy);
+   GETF(v, &state, lod_bias);
+   GETF(v, &state, min_lod);
+   GETF(v, &state, max_lod);
+   value_floats(member(v, "border_color.f"), state.border_color.f, 4);
+
+   object_add(r, call->ret, pipe->create_sampler_state(pipe, &state),
+              pipe, pipe->delete_sampler_state, NULL);
+}
+
+
+static void
+replay_create_rasterizer_state(struct replay *r, struct pipe_context *pipe,
+                               const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_rasterizer_state state;
+
+   memset(&state, 0, sizeof state);
+   GET(v, &state, flatshade);
+   GET(v, &state, light_twoside);
+   GET(v, &state, front_ccw);
+   GET(v, &state, cull_face);
+   GET(v, &state, fill_front);
+   GET(v, &state, fill_back);
+   GET(v, &state, offset_point);
+   GET(v, &state, offset_line);
+   GET(v, &state, offset_tri);
+   GET(v, &state, scissor);
+   GET(v, &state, poly_smooth);
+   GET(v, &state, poly_stipple_enable);
+   GET(v, &state, point_smooth);
+   GET(v, &state, sprite_coord_enable);
+   GET(v, &state, sprite_coord_mode);
+   GET(v, &state, point_quad_rasterization);
+   GET(v, &state, point_size_per_vertex);
+   GET(v, &state, multisample);
+   GET(v, &state, line_smooth);
+   GET(v, &state, line_stipple_enable);
+   GET(v, &state, line_stipple_factor);
+   GET(v, &state, line_stipple_pattern);
+   GET(v, &state, line_last_pixel);
+   GET(v, &state, flatshade_first);
+   GET(v, &state, gl_rasterization_rules);
+   GETF(v, &state, line_width);
+   GETF(v, &state, point_size);
+   GETF(v, &state, offset_units);
+   GETF(v, &state, offset_scale);
+   GETF(v, &state, offset_clamp);
+
+   object_add(r, call->ret, pipe->create_rasterizer_state(pipe, &state),
+              pipe, pipe->delete_rasterizer_state, NULL);
+}
+
+
+static void
+replay_create_depth_stencil_alpha_state(struct replay *r,
+                                        struct pipe_context *pipe,
+                                        const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   const struct replay_value *depth = member(v, "depth");
+   const struct replay_value *alpha = member(v, "alpha");
+   struct pipe_depth_stencil_alpha_state state;
+   unsigned i;
+
+   memset(&state, 0, sizeof state);
+   GET(depth, &state.depth, enabled);
+   GET(depth, &state.depth, writemask);
+   GET(depth, &state.depth, func);
+   for (i = 0; i < count(member(v, "stencil"), 2); i++) {
+      const struct replay_value *stencil = elem(member(v, "stencil"), i);
+      GET(stencil, &state.stencil[i], enabled);
+      GET(stencil, &state.stencil[i], func);
+      GET(stencil, &state.stencil[i], fail_op);
+      GET(stencil, &state.stencil[i], zpass_op);
+      GET(stencil, &state.stencil[i], zfail_op);
+      GET(stencil, &state.stencil[i], valuemask);
+      GET(stencil, &state.stencil[i], writemask);
+   }
+   GET(alpha, &state.alpha, enabled);
+   GET(alpha, &state.alpha, func);
+   GETF(alpha, &state.alpha, ref_value);
+
+   object_add(r, call->ret,
+              pipe->create_depth_stencil_alpha_state(pipe, &state),
+              pipe, pipe->delete_depth_stencil_alpha_state, NULL);
+}
+
+
+/** Rebuild the tokens of a shader from their text dump. */
+static boolean
+shader_state(struct replay *r, const struct replay_call *call,
+             struct pipe_shader_state *state)
+{
+   const struct replay_value *text = member(arg(call, 1), "tokens");
+
+   if (!text || text->type != REPLAY_STRING ||
+       !tgsi_text_translate(text->u.str, r->tokens, REPLAY_MAX_TOKENS)) {
+      fprintf(stderr, "call %lu: %s: couldn't translate the shader\n",
+              call->no, call->method->str);
+      return FALSE;
+   }
+
+   state->tokens = r->tokens;
+   return TRUE;
+}
+
+
+static void
+replay_create_fs_state(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   struct pipe_shader_state state;
+
+   if (shader_state(r, call, &state))
+      object_add(r, call->ret, pipe->create_fs_state(pipe, &state),
+                 pipe, pipe->delete_fs_state, NULL);
+}
+
+
+static void
+replay_create_vs_state(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   struct pipe_shader_state state;
+
+   if (shader_state(r, call, &state))
+      object_add(r, call->ret, pipe->create_vs_state(pipe, &state),
+                 pipe, pipe->delete_vs_state, NULL);
+}
+
+
+static void
+replay_create_vertex_elements_state(struct replay *r,
+                                    struct pipe_context *pipe,
+                                    const struct replay_call *call)
+{
+   const struct replay_value *elements = arg(call, 2);
+   struct pipe_vertex_element state[PIPE_MAX_ATTRIBS];
+   unsigned num = count(elements, PIPE_MAX_ATTRIBS);
+   unsigned i;
+
+   memset(state, 0, sizeof state);
+   for (i = 0; i < num; i++) {
+      const struct replay_value *v = elem(elements, i);
+      GET(v, &state[i], src_offset);
+      GET(v, &state[i], vertex_buffer_index);
+      state[i].src_format = value_format(member(v, "src_format"));
+   }
+
+   object_add(r, call->ret,
+              pipe->create_vertex_elements_state(pipe, num, state),
+              pipe, pipe->delete_vertex_elements_state, NULL);
+}
+
+
+static void
+replay_bind_blend_state(struct replay *r, struct pipe_context *pipe,
+                        const struct replay_call *call)
+{
+   pipe->bind_blend_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static void
+replay_bind_rasterizer_state(struct replay *r, struct pipe_context *pipe,
+                             const struct replay_call *call)
+{
+   pipe->bind_rasterizer_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static void
+replay_bind_depth_stencil_alpha_state(struct replay *r,
+                                      struct pipe_context *pipe,
+                                      const struct replay_call *call)
+{
+   pipe->bind_depth_stencil_alpha_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static void
+replay_bind_fs_state(struct replay *r, struct pipe_context *pipe,
+                     const struct replay_call *call)
+{
+   pipe->bind_fs_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static void
+replay_bind_vs_state(struct replay *r, struct pipe_context *pipe,
+                     const struct replay_call *call)
+{
+   pipe->bind_vs_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static void
+replay_bind_vertex_elements_state(struct replay *r, struct pipe_context *pipe,
+                                  const struct replay_call *call)
+{
+   pipe->bind_vertex_elements_state(pipe, object(r, call, arg(call, 1)));
+}
+
+
+static unsigned
+objects(struct replay *r, const struct replay_call *call,
+        const struct replay_value *array, void **ptrs, unsigned max)
+{
+   unsigned num = count(array, max);
+   unsigned i;
+
+   for (i = 0; i < num; i++)
+      ptrs[i] = object(r, call, elem(array, i));
+   return num;
+}
+
+
+static void
+replay_bind_fragment_sampler_states(struct replay *r,
+                                    struct pipe_context *pipe,
+                                    const struct replay_call *call)
+{
+   void *states[PIPE_MAX_SAMPLERS];
+   unsigned num = objects(r, call, arg(call, 2), states, PIPE_MAX_SAMPLERS);
+
+   pipe->bind_fragment_sampler_states(pipe, num, states);
+}
+
+
+static void
+replay_bind_vertex_sampler_states(struct replay *r, struct pipe_context *pipe,
+                                  const struct replay_call *call)
+{
+   void *states[PIPE_MAX_VERTEX_SAMPLERS];
+   unsigned num = objects(r, call, arg(call, 2), states,
+                          PIPE_MAX_VERTEX_SAMPLERS);
+
+   pipe->bind_vertex_sampler_states(pipe, num, states);
+}
+
+
+/*
+ * Parameter-like state
+ */
+
+static void
+replay_set_blend_color(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   struct pipe_blend_color state;
+
+   value_floats(member(arg(call, 1), "color"), state.color, 4);
+   pipe->set_blend_color(pipe, &state);
+}
+
+
+static void
+replay_set_stencil_ref(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   const struct replay_value *ref = member(arg(call, 1), "ref_value");
+   struct pipe_stencil_ref state;
+
+   state.ref_value[0] = value_uint(elem(ref, 0));
+   state.ref_value[1] = value_uint(elem(ref, 1));
+   pipe->set_stencil_ref(pipe, &state);
+}
+
+
+static void
+replay_set_clip_state(struct replay *r, struct pipe_context *pipe,
+                      const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_clip_state state;
+   unsigned i;
+
+   memset(&state, 0, sizeof state);
+   for (i = 0; i < count(member(v, "ucp"), PIPE_MAX_CLIP_PLANES); i++)
+      value_floats(elem(member(v, "ucp"), i), state.ucp[i], 4);
+   GET(v, &state, nr);
+   GET(v, &state, depth_clamp);
+   pipe->set_clip_state(pipe, &state);
+}
+
+
+static void
+replay_set_sample_mask(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   pipe->set_sample_mask(pipe, value_uint(arg(call, 1)));
+}
+
+
+static void
+replay_set_constant_buffer(struct replay *r, struct pipe_context *pipe,
+                           const struct replay_call *call)
+{
+   pipe->set_constant_buffer(pipe,
+                             value_uint(arg(call, 1)),
+                             value_uint(arg(call, 2)),
+                             object(r, call, arg(call, 3)));
+}
+
+
+static void
+replay_set_framebuffer_state(struct replay *r, struct pipe_context *pipe,
+                             const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_framebuffer_state state;
+
+   memset(&state, 0, sizeof state);
+   GET(v, &state, width);
+   GET(v, &state, height);
+   GET(v, &state, nr_cbufs);
+   state.nr_cbufs = MIN2(state.nr_cbufs, PIPE_MAX_COLOR_BUFS);
+   objects(r, call, member(v, "cbufs"), (void **)state.cbufs,
+           state.nr_cbufs);
+   state.zsbuf = object(r, call, member(v, "zsbuf"));
+   pipe->set_framebuffer_state(pipe, &state);
+}
+
+
+static void
+replay_set_polygon_stipple(struct replay *r, struct pipe_context *pipe,
+                           const struct replay_call *call)
+{
+   const struct replay_value *stipple = member(arg(call, 1), "stipple");
+   struct pipe_poly_stipple state;
+   unsigned i;
+
+   for (i = 0; i < 32; i++)
+      state.stipple[i] = value_uint(elem(stipple, i));
+   pipe->set_polygon_stipple(pipe, &state);
+}
+
+
+static void
+replay_set_scissor_state(struct replay *r, struct pipe_context *pipe,
+                         const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_scissor_state state;
+
+   GET(v, &state, minx);
+   GET(v, &state, miny);
+   GET(v, &state, maxx);
+   GET(v, &state, maxy);
+   pipe->set_scissor_state(pipe, &state);
+}
+
+
+static void
+replay_set_viewport_state(struct replay *r, struct pipe_context *pipe,
+                          const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_viewport_state state;
+
+   value_floats(member(v, "scale"), state.scale, 4);
+   value_floats(member(v, "translate"), state.translate, 4);
+   pipe->set_viewport_state(pipe, &state);
+}
+
+
+/*
+ * Views
+ */
+
+static void
+replay_create_sampler_view(struct replay *r, struct pipe_context *pipe,
+                           const struct replay_call *call)
+{
+   struct pipe_resource *resource = object(r, call, arg(call, 1));
+   const struct replay_value *v = arg(call, 2);
+   const struct replay_value *u = member(v, "u");
+   const struct replay_value *tex = member(u, "tex");
+   const struct replay_value *buf = member(u, "buf");
+   struct pipe_sampler_view templ;
+
+   if (!resource)
+      return;
+
+   memset(&templ, 0, sizeof templ);
+   templ.format = value_format(member(v, "format"));
+   if (tex) {
+      GET(tex, &templ.u.tex, first_layer);
+      GET(tex, &templ.u.tex, last_layer);
+      GET(tex, &templ.u.tex, first_level);
+      GET(tex, &templ.u.tex, last_level);
+   }
+   else {
+      GET(buf, &templ.u.buf, first_element);
+      GET(buf, &templ.u.buf, last_element);
+   }
+   GET(v, &templ, swizzle_r);
+   GET(v, &templ, swizzle_g);
+   GET(v, &templ, swizzle_b);
+   GET(v, &templ, swizzle_a);
+
+   object_add(r, call->ret, pipe->create_sampler_view(pipe, resource, &templ),
+              pipe, release_sampler_view, NULL);
+}
+
+
+static void
+replay_create_surface(struct replay *r, struct pipe_context *pipe,
+                      const struct replay_call *call)
+{
+   struct pipe_resource *resource = object(r, call, arg(call, 1));
+   const struct replay_value *v = arg(call, 2);
+   const struct replay_value *u = member(v, "u");
+   const struct replay_value *tex = member(u, "tex");
+   const struct replay_value *buf = member(u, "buf");
+   struct pipe_surface templ;
+
+   if (!resource)
+      return;
+
+   memset(&templ, 0, sizeof templ);
+   templ.format = value_format(member(v, "format"));
+   GET(v, &templ, width);
+   GET(v, &templ, height);
+   GET(v, &templ, usage);
+   if (tex) {
+      GET(tex, &templ.u.tex, level);
+      GET(tex, &templ.u.tex, first_layer);
+      GET(tex, &templ.u.tex, last_layer);
+   }
+   else {
+      GET(buf, &templ.u.buf, first_element);
+      GET(buf, &templ.u.buf, last_element);
+   }
+
+   object_add(r, call->ret, pipe->create_surface(pipe, resource, &templ),
+              pipe, release_surface, NULL);
+}
+
+
+static void
+replay_set_fragment_sampler_views(struct replay *r, struct pipe_context *pipe,
+                                  const struct replay_call *call)
+{
+   struct pipe_sampler_view *views[PIPE_MAX_SAMPLERS];
+   unsigned num = objects(r, call, arg(call, 2), (void **)views,
+                          PIPE_MAX_SAMPLERS);
+
+   pipe->set_fragment_sampler_views(pipe, num, views);
+}
+
+
+static void
+replay_set_vertex_sampler_views(struct replay *r, struct pipe_context *pipe,
+                                const struct replay_call *call)
+{
+   struct pipe_sampler_view *views[PIPE_MAX_VERTEX_SAMPLERS];
+   unsigned num = objects(r, call, arg(call, 2), (void **)views,
+                          PIPE_MAX_VERTEX_SAMPLERS);
+
+   pipe->set_vertex_sampler_views(pipe, num, views);
+}
+
+
+/*
+ * Vertices and drawing
+ */
+
+static void
+replay_set_vertex_buffers(struct replay *r, struct pipe_context *pipe,
+                          const struct replay_call *call)
+{
+   const struct replay_value *buffers = arg(call, 2);
+   struct pipe_vertex_buffer vbs[PIPE_MAX_ATTRIBS];
+   unsigned num = count(buffers, PIPE_MAX_ATTRIBS);
+   unsigned i;
+
+   memset(vbs, 0, sizeof vbs);
+   for (i = 0; i < num; i++) {
+      const struct replay_value *v = elem(buffers, i);
+      GET(v, &vbs[i], stride);
+      GET(v, &vbs[i], buffer_offset);
+      vbs[i].buffer = object(r, call, member(v, "buffer"));
+   }
+
+   pipe->set_vertex_buffers(pipe, num, vbs);
+}
+
+
+static void
+replay_set_index_buffer(struct replay *r, struct pipe_context *pipe,
+                        const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_index_buffer ib;
+
+   if (!v || v->type != REPLAY_STRUCT) {
+      pipe->set_index_buffer(pipe, NULL);
+      return;
+   }
+
+   GET(v, &ib, index_size);
+   GET(v, &ib, offset);
+   ib.buffer = object(r, call, member(v, "buffer"));
+   pipe->set_index_buffer(pipe, &ib);
+}
+
+
+static void
+replay_redefine_user_buffer(struct replay *r, struct pipe_context *pipe,
+                            const struct replay_call *call)
+{
+   struct pipe_resource *resource = object(r, call, arg(call, 1));
+
+   if (resource)
+      pipe->redefine_user_buffer(pipe, resource,
+                                 value_uint(arg(call, 2)),
+                                 value_uint(arg(call, 3)));
+}
+
+
+static void
+replay_draw_vbo(struct replay *r, struct pipe_context *pipe,
+                const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 1);
+   struct pipe_draw_info info;
+
+   memset(&info, 0, sizeof info);
+   GET(v, &info, indexed);
+   GET(v, &info, mode);
+   GET(v, &info, start);
+   GET(v, &info, count);
+   GET(v, &info, start_instance);
+   GET(v, &info, instance_count);
+   GET(v, &info, index_bias);
+   GET(v, &info, min_index);
+   GET(v, &info, max_index);
+   GET(v, &info, primitive_restart);
+   GET(v, &info, restart_index);
+
+   pipe->draw_vbo(pipe, &info);
+   r->draws++;
+}
+
+
+/*
+ * Transfers, copies and clears
+ */
+
+static void
+value_box(const struct replay_value *v, struct pipe_box *box)
+{
+   GET(v, box, x);
+   GET(v, box, y);
+   GET(v, box, z);
+   GET(v, box, width);
+   GET(v, box, height);
+   GET(v, box, depth);
+}
+
+
+static void
+replay_transfer_inline_write(struct replay *r, struct pipe_context *pipe,
+                             const struct replay_call *call)
+{
+   struct pipe_resource *resource = object(r, call, arg(call, 1));
+   const struct replay_value *data = arg(call, 5);
+   struct pipe_box box;
+
+   if (!resource || !data || data->type != REPLAY_BYTES)
+      return;
+
+   value_box(arg(call, 4), &box);
+   pipe->transfer_inline_write(pipe, resource,
+                               value_uint(arg(call, 2)),
+                               value_uint(arg(call, 3)),
+                               &box, data->u.bytes.data,
+                               value_uint(arg(call, 6)),
+                               value_uint(arg(call, 7)));
+}
+
+
+static void
+replay_resource_copy_region(struct replay *r, struct pipe_context *pipe,
+                            const struct replay_call *call)
+{
+   struct pipe_resource *dst = object(r, call, arg(call, 1));
+   struct pipe_resource *src = object(r, call, arg(call, 6));
+   struct pipe_box box;
+
+   if (!dst || !src)
+      return;
+
+   value_box(arg(call, 8), &box);
+   pipe->resource_copy_region(pipe, dst,
+                              value_uint(arg(call, 2)),
+                              value_uint(arg(call, 3)),
+                              value_uint(arg(call, 4)),
+                              value_uint(arg(call, 5)),
+                              src,
+                              value_uint(arg(call, 7)),
+                              &box);
+}
+
+
+static void
+replay_clear(struct replay *r, struct pipe_context *pipe,
+             const struct replay_call *call)
+{
+   const struct replay_value *v = arg(call, 2);
+   union pipe_color_union color;
+
+   value_floats(v, color.f, 4);
+   pipe->clear(pipe, value_uint(arg(call, 1)),
+               v && v->type == REPLAY_ARRAY ? &color : NULL,
+               value_float(arg(call, 3)),
+               value_uint(arg(call, 4)));
+}
+
+
+static void
+replay_clear_render_target(struct replay *r, struct pipe_context *pipe,
+                           const struct replay_call *call)
+{
+   struct pipe_surface *dst = object(r, call, arg(call, 1));
+   union pipe_color_union color;
+
+   if (!dst)
+      return;
+
+   value_floats(arg(call, 2), color.f, 4);
+   pipe->clear_render_target(pipe, dst, &color,
+                             value_uint(arg(call, 3)),
+                             value_uint(arg(call, 4)),
+                             value_uint(arg(call, 5)),
+                             value_uint(arg(call, 6)));
+}
+
+
+static void
+replay_clear_depth_stencil(struct replay *r, struct pipe_context *pipe,
+                           const struct replay_call *call)
+{
+   struct pipe_surface *dst = object(r, call, arg(call, 1));
+
+   if (!dst)
+      return;
+
+   pipe->clear_depth_stencil(pipe, dst,
+                             value_uint(arg(call, 2)),
+                             value_float(arg(call, 3)),
+                             value_uint(arg(call, 4)),
+                             value_uint(arg(call, 5)),
+                             value_uint(arg(call, 6)),
+                             value_uint(arg(call, 7)),
+                             value_uint(arg(call, 8)));
+}
+
+
+/*
+ * Queries and the rest
+ */
+
+static void
+replay_create_query(struct replay *r, struct pipe_context *pipe,
+                    const struct replay_call *call)
+{
+   object_add(r, call->ret,
+              pipe->create_query(pipe, value_uint(arg(call, 1))),
+              pipe, release_query, NULL);
+}
+
+
+static void
+replay_begin_query(struct replay *r, struct pipe_context *pipe,
+                   const struct replay_call *call)
+{
+   struct pipe_query *query = object(r, call, arg(call, 1));
+
+   if (query)
+      pipe->begin_query(pipe, query);
+}
+
+
+static void
+replay_end_query(struct replay *r, struct pipe_context *pipe,
+                 const struct replay_call *call)
+{
+   struct pipe_query *query = object(r, call, arg(call, 1));
+
+   if (query)
+      pipe->end_query(pipe, query);
+}
+
+
+static void
+replay_render_condition(struct replay *r, struct pipe_context *pipe,
+                        const struct replay_call *call)
+{
+   if (pipe->render_condition)
+      pipe->render_condition(pipe, object(r, call, arg(call, 1)),
+                             value_uint(arg(call, 2)));
+}
+
+
+static void
+replay_flush(struct replay *r, struct pipe_context *pipe,
+             const struct replay_call *call)
+{
+   pipe->flush(pipe, NULL);
+}
+
+
+static void
+replay_texture_barrier(struct replay *r, struct pipe_context *pipe,
+                       const struct replay_call *call)
+{
+   if (pipe->texture_barrier)
+      pipe->texture_barrier(pipe);
+}
+
+
+typedef void (*replay_func)(struct replay *r, struct pipe_context *pipe,
+                            const struct replay_call *call);
+
+static const struct {
+   const char *method;
+   replay_func func;
+} replay_funcs[] = {
+   { "pipe_screen_create", replay_pipe_screen_create },
+   { "context_create", replay_context_create },
+   { "destroy", replay_destroy },
+   { "flush_frontbuffer", replay_flush_frontbuffer },
+   { "resource_create", replay_resource_create },
+   { "user_buffer_create", replay_user_buffer_create },
+   { "resource_destroy", replay_resource_destroy },
+
+   { "create_blend_state", replay_create_blend_state },
+   { "bind_blend_state", replay_bind_blend_state },
+   { "delete_blend_state", replay_delete },
+   { "create_sampler_state", replay_create_sampler_state },
+   { "bind_fragment_sampler_states", replay_bind_fragment_sampler_states },
+   { "bind_vertex_sampler_states", replay_bind_vertex_sampler_states },
+   { "delete_sampler_state", replay_delete },
+   { "create_rasterizer_state", replay_create_rasterizer_state },
+   { "bind_rasterizer_state", replay_bind_rasterizer_state },
+   { "delete_rasterizer_state", replay_delete },
+   { "create_depth_stencil_alpha_state",
+     replay_create_depth_stencil_alpha_state },
+   { "bind_depth_stencil_alpha_state", replay_bind_depth_stencil_alpha_state },
+   { "delete_depth_stencil_alpha_state", replay_delete },
+   { "create_fs_state", replay_create_fs_state },
+   { "bind_fs_state", replay_bind_fs_state },
+   { "delete_fs_state", replay_delete },
+   { "create_vs_state", replay_create_vs_state },
+   { "bind_vs_state", replay_bind_vs_state },
+   { "delete_vs_state", replay_delete },
+   { "create_vertex_elements_state", replay_create_vertex_elements_state },
+   { "bind_vertex_elements_state", replay_bind_vertex_elements_state },
+   { "delete_vertex_elements_state", replay_delete },
+
+   { "set_blend_color", replay_set_blend_color },
+   { "set_stencil_ref", replay_set_stencil_ref },
+   { "set_clip_state", replay_set_clip_state },
+   { "set_sample_mask", replay_set_sample_mask },
+   { "set_constant_buffer", replay_set_constant_buffer },
+   { "set_framebuffer_state", replay_set_framebuffer_state },
+   { "set_polygon_stipple", replay_set_polygon_stipple },
+   { "set_scissor_state", replay_set_scissor_state },
+   { "set_viewport_state", replay_set_viewport_state },
+
+   { "create_sampler_view", replay_create_sampler_view },
+   { "sampler_view_destroy", replay_delete },
+   { "create_surface", replay_create_surface },
+   { "surface_destroy", replay_delete },
+   { "set_fragment_sampler_views", replay_set_fragment_sampler_views },
+   { "set_vertex_sampler_views", replay_set_vertex_sampler_views },
+
+   { "set_vertex_buffers", replay_set_vertex_buffers },
+   { "set_index_buffer", replay_set_index_buffer },
+   { "redefine_user_buffer", replay_redefine_user_buffer },
+   { "draw_vbo", replay_draw_vbo },
+
+   { "transfer_inline_write", replay_transfer_inline_write },
+   { "resource_copy_region", replay_resource_copy_region },
+   { "clear", replay_clear },
+   { "clear_render_target", replay_clear_render_target },
+   { "clear_depth_stencil", replay_clear_depth_stencil },
+
+   { "create_query", replay_create_query },
+   { "destroy_query", replay_delete },
+   { "begin_query", replay_begin_query },
+   { "end_query", replay_end_query },
+   { "render_condition", replay_render_condition },
+   { "flush", replay_flush },
+   { "texture_barrier", replay_texture_barrier },
+};
+
+
+static void
+replay_call(struct replay *r, const struct replay_call *call)
+{
+   struct replay_name *klass = call->klass;
+   struct replay_name *method = call->method;
+   struct pipe_context *pipe = NULL;
+   unsigned i;
+
+   r->calls++;
+
+   /* Names are interned, so the lookups are done once per name. */
+   if (method->value < 0) {
+      method->value = Elements(replay_funcs);
+      for (i = 0; i < Elements(replay_funcs); i++) {
+         if (strcmp(replay_funcs[i].method, method->str) == 0) {
+            method->value = i;
+            break;
+         }
+      }
+   }
+   if (klass->value < 0)
+      klass->value = strcmp(klass->str, "pipe_context") == 0;
+
+   if (method->value == Elements(replay_funcs)) {
+      r->skipped++;
+      return;
+   }
+
+   if (klass->value) {
+      pipe = object(r, call, arg(call, 0));
+      if (!pipe) {
+         r->skipped++;
+         return;
+      }
+   }
+
+   replay_funcs[method->value].func(r, pipe, call);
+}
+
+
+static void
+usage(void)
+{
+   fprintf(stderr, "usage: replay [-v] trace\n");
+   fprintf(stderr, "Replays a binary trace, or one read from the standard "
+           "input if trace is -.\n");
+   exit(1);
+}
+
+
+int
+main(int argc, char **argv)
+{
+   struct replay r;
+   struct replay_reader *reader;
+   struct replay_call call;
+   struct release_pass pass;
+   const char *filename = NULL;
+   FILE *file;
+   int64_t start, end;
+   double secs;
+   boolean failed;
+   int i;
+
+   memset(&r, 0, sizeof r);
+
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-v") == 0)
+         r.verbose = TRUE;
+      else if (!filename)
+         filename = argv[i];
+      else
+         usage();
+   }
+   if (!filename)
+      usage();
+
+   file = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "rb");
+   if (!file) {
+      fprintf(stderr, "couldn't open %s\n", filename);
+      return 1;
+   }
+
+   reader = replay_reader_create(file);
+   if (!reader) {
+      fprintf(stderr, "%s is not a binary trace\n", filename);
+      return 1;
+   }
+
+   r.screen = sw_screen_create(null_sw_create());
+   /* wrap the screen with any debugger */
+   r.screen = debug_screen_wrap(r.screen);
+   if (!r.screen) {
+      fprintf(stderr, "couldn't create a screen\n");
+      return 1;
+   }
+
+   r.objects = util_hash_table_create(object_hash, object_compare);
+
+   start = os_time_get();
+   while (replay_reader_next(reader, &call))
+      replay_call(&r, &call);
+   end = os_time_get();
+
+   failed = replay_reader_error(reader) != NULL;
+   if (failed)
+      fprintf(stderr, "%s: %s\n", filename, replay_reader_error(reader));
+
+   secs = (end - start) / 1000000.0;
+   printf("%lu calls (%lu skipped), %lu draws, %lu frames in %.3f s\n",
+          r.calls, r.skipped, r.draws, r.frames, secs);
+   if (secs > 0.0)
+      printf("%.0f calls/s, %.1f frames/s\n",
+             r.calls / secs, r.frames / secs);
+
+   pass.r = &r;
+   for (pass.pass = 0; pass.pass < 3; pass.pass++)
+      util_hash_table_foreach(r.objects, release_cb, &pass);
+   util_hash_table_destroy(r.objects);
+
+   r.screen->destroy(r.screen);
+   replay_reader_destroy(reader);
+   if (file != stdin)
+      fclose(file);
+
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,669 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Streaming reader of binary traces.
+ *
+ * The values of a call are allocated from an arena which is reset when
+ * the next call is read. Names and blobs are kept for the whole trace,
+ * as later calls may refer to them.
+ */
+
+#include <string.h>
+
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "trace/tr_binary.h"
+
+#include "replay_reader.h"
+
+
+#define REPLAY_BUFFER_SIZE (1024 * 1024)
+#define REPLAY_ARENA_SIZE (64 * 1024)
+#define REPLAY_MAX_DEPTH 32
+
+
+struct replay_chunk {
+   struct replay_chunk *next;
+   size_t size;
+   size_t used;
+};
+
+
+struct replay_blob {
+   void *data;
+   size_t size;
+};
+
+
+struct replay_reader {
+   FILE *file;
+   uint8_t *buf;
+   size_t pos;
+   size_t end;
+
+   const char *error;
+
+   /* Names, by index - 1. */
+   struct replay_name **names;
+   unsigned num_names;
+   unsigned max_names;
+
+   struct replay_blob *blobs;
+   unsigned num_blobs;
+   unsigned max_blobs;
+
+   /* Arena for the values of the current call. */
+   struct replay_chunk *chunks;
+
+   /* Elements and members of the arrays and structs being read. */
+   void **stack;
+   unsigned stack_size;
+   unsigned stack_max;
+};
+
+
+/*
+ * Memory
+ */
+
+static void *
+arena_alloc(struct replay_reader *r, size_t size)
+{
+   struct replay_chunk *chunk = r->chunks;
+   void *ptr;
+
+   size = (size + 7) & ~(size_t)7;
+
+   if (!chunk || chunk->used + size > chunk->size) {
+      size_t chunk_size = MAX2(REPLAY_ARENA_SIZE, size);
+
+      chunk = MALLOC(sizeof(*chunk) + chunk_size);
+      if (!chunk) {
+         r->error = "out of memory";
+         return NULL;
+      }
+      chunk->size = chunk_size;
+      chunk->used = 0;
+      chunk->next = r->chunks;
+      r->chunks = chunk;
+   }
+
+   ptr = (uint8_t *)(chunk + 1) + chunk->used;
+   chunk->used += size;
+   return ptr;
+}
+
+
+static void
+arena_reset(struct replay_reader *r)
+{
+   struct replay_chunk *chunk, *next;
+   size_t total = 0;
+
+   if (!r->chunks)
+      return;
+
+   if (!r->chunks->next) {
+      r->chunks->used = 0;
+      return;
+   }
+
+   /* Replace the chunks by one big enough for all of them, so that we
+    * end up allocating from a single chunk.
+    */
+   for (chunk = r->chunks; chunk; chunk = next) {
+      next = chunk->next;
+      total += chunk->size;
+      FREE(chunk);
+   }
+   r->chunks = NULL;
+
+   chunk = MALLOC(sizeof(*chunk) + total);
+   if (chunk) {
+      chunk->size = total;
+      chunk->used = 0;
+      chunk->next = NULL;
+      r->chunks = chunk;
+   }
+}
+
+
+static boolean
+stack_push(struct replay_reader *r, void *ptr)
+{
+   if (r->stack_size == r->stack_max) {
+      unsigned max = r->stack_max ? r->stack_max * 2 : 256;
+      void **stack = REALLOC(r->stack, r->stack_max * sizeof(void *),
+                             max * sizeof(void *));
+      if (!stack) {
+         r->error = "out of memory";
+         return FALSE;
+      }
+      r->stack = stack;
+      r->stack_max = max;
+   }
+   r->stack[r->stack_size++] = ptr;
+   return TRUE;
+}
+
+
+/* Move the last count pointers of the stack into the arena. */
+static void **
+stack_pop(struct replay_reader *r, unsigned count)
+{
+   void **ptrs = arena_alloc(r, MAX2(count, 1) * sizeof(void *));
+
+   if (ptrs) {
+      r->stack_size -= count;
+      memcpy(ptrs, &r->stack[r->stack_size], count * sizeof(void *));
+   }
+   return ptrs;
+}
+
+
+/*
+ * Input
+ */
+
+static boolean
+fill(struct replay_reader *r)
+{
+   r->pos = 0;
+   r->end = fread(r->buf, 1, REPLAY_BUFFER_SIZE, r->file);
+   return r->end != 0;
+}
+
+
+static INLINE int
+read_byte(struct replay_reader *r)
+{
+   if (r->pos == r->end && !fill(r))
+      return -1;
+   return r->buf[r->pos++];
+}
+
+
+static boolean
+read_data(struct replay_reader *r, void *data, size_t size)
+{
+   uint8_t *dst = data;
+
+   while (size) {
+      size_t n;
+
+      if (r->pos == r->end && !fill(r)) {
+         r->error = "unexpected end of trace";
+         return FALSE;
+      }
+
+      n = MIN2(size, r->end - r->pos);
+      memcpy(dst, r->buf + r->pos, n);
+      r->pos += n;
+      dst += n;
+      size -= n;
+   }
+   return TRUE;
+}
+
+
+static boolean
+read_uint(struct replay_reader *r, uint64_t *value)
+{
+   unsigned shift = 0;
+   int byte;
+
+   *value = 0;
+   do {
+      byte = read_byte(r);
+      if (byte < 0 || shift > 63) {
+         r->error = byte < 0 ? "unexpected end of trace" : "bad number";
+         return FALSE;
+      }
+      *value |= (uint64_t)(byte & 0x7f) << shift;
+      shift += 7;
+   } while (byte & 0x80);
+
+   return TRUE;
+}
+
+
+static boolean
+read_size(struct replay_reader *r, size_t *size)
+{
+   uint64_t value;
+
+   if (!read_uint(r, &value))
+      return FALSE;
+   if (value != (size_t)value) {
+      r->error = "bad size";
+      return FALSE;
+   }
+   *size = (size_t)value;
+   return TRUE;
+}
+
+
+static struct replay_name *
+read_name(struct replay_reader *r)
+{
+   struct replay_name *name;
+   uint64_t index;
+   size_t len;
+   char *str;
+
+   if (!read_uint(r, &index))
+      return NULL;
+
+   if (index) {
+      if (index > r->num_names) {
+         r->error = "bad name index";
+         return NULL;
+      }
+      return r->names[index - 1];
+   }
+
+   if (!read_size(r, &len))
+      return NULL;
+
+   if (r->num_names == r->max_names) {
+      unsigned max = r->max_names ? r->max_names * 2 : 256;
+      struct replay_name **names =
+         REALLOC(r->names, r->max_names * sizeof(*names),
+                 max * sizeof(*names));
+      if (!names) {
+         r->error = "out of memory";
+         return NULL;
+      }
+      r->names = names;
+      r->max_names = max;
+   }
+
+   name = MALLOC(sizeof(*name) + len + 1);
+   if (!name) {
+      r->error = "out of memory";
+      return NULL;
+   }
+   str = (char *)(name + 1);
+   if (!read_data(r, str, len)) {
+      FREE(name);
+      return NULL;
+   }
+   str[len] = '\0';
+   name->str = str;
+   name->value = -1;
+
+   r->names[r->num_names++] = name;
+   return name;
+}
+
+
+static boolean
+read_blob(struct replay_reader *r, struct replay_value *value)
+{
+   struct replay_blob *blob;
+   size_t size;
+
+   if (!read_size(r, &size))
+      return FALSE;
+
+   if (r->num_blobs == r->max_blobs) {
+      unsigned max = r->max_blobs ? r->max_blobs * 2 : 256;
+      struct replay_blob *blobs =
+         REALLOC(r->blobs, r->max_blobs * sizeof(*blobs),
+                 max * sizeof(*blobs));
+      if (!blobs) {
+         r->error = "out of memory";
+         return FALSE;
+      }
+      r->blobs = blobs;
+      r->max_blobs = max;
+   }
+
+   blob = &r->blobs[r->num_blobs];
+   blob->size = size;
+   blob->data = MALLOC(MAX2(size, 1));
+   if (!blob->data) {
+      r->error = "out of memory";
+      return FALSE;
+   }
+   if (!read_data(r, blob->data, size)) {
+      FREE(blob->data);
+      return FALSE;
+   }
+   r->num_blobs++;
+
+   value->type = REPLAY_BYTES;
+   value->u.bytes.data = blob->data;
+   value->u.bytes.size = size;
+   return TRUE;
+}
+
+
+static struct replay_value *
+read_value(struct replay_reader *r, int token, unsigned depth);
+
+
+static boolean
+read_array(struct replay_reader *r, struct replay_value *value,
+           unsigned depth)
+{
+   unsigned count = 0;
+   int token;
+
+   while ((token = read_byte(r)) != TRACE_BIN_ARRAY_END) {
+      struct replay_value *elem = read_value(r, token, depth + 1);
+      if (!elem || !stack_push(r, elem))
+         return FALSE;
+      count++;
+   }
+
+   value->type = REPLAY_ARRAY;
+   value->u.array.count = count;
+   value->u.array.elems = (struct replay_value **)stack_pop(r, count);
+   return value->u.array.elems != NULL;
+}
+
+
+static boolean
+read_struct(struct replay_reader *r, struct replay_value *value,
+            unsigned depth)
+{
+   unsigned count = 0;
+   int token;
+
+   value->type = REPLAY_STRUCT;
+   value->u.s.name = read_name(r);
+   if (!value->u.s.name)
+      return FALSE;
+
+   while ((token = read_byte(r)) != TRACE_BIN_STRUCT_END) {
+      struct replay_name *name;
+      struct replay_value *member;
+
+      if (token != TRACE_BIN_MEMBER) {
+         r->error = token < 0 ? "unexpected end of trace" : "bad struct";
+         return FALSE;
+      }
+
+      name = read_name(r);
+      member = name ? read_value(r, read_byte(r), depth + 1) : NULL;
+      if (!member || !stack_push(r, name) || !stack_push(r, member))
+         return FALSE;
+      count++;
+   }
+
+   value->u.s.count = count;
+   value->u.s.names = arena_alloc(r, MAX2(count, 1) * sizeof(void *));
+   value->u.s.values = arena_alloc(r, MAX2(count, 1) * sizeof(void *));
+   if (!value->u.s.names || !value->u.s.values)
+      return FALSE;
+
+   while (count--) {
+      value->u.s.values[count] = r->stack[--r->stack_size];
+      value->u.s.names[count] = r->stack[--r->stack_size];
+   }
+   return TRUE;
+}
+
+
+static struct replay_value *
+read_value(struct replay_reader *r, int token, unsigned depth)
+{
+   struct replay_value *value;
+   uint64_t u;
+   size_t size;
+   char *str;
+
+   if (depth > REPLAY_MAX_DEPTH) {
+      r->error = "values nested too deep";
+      return NULL;
+   }
+
+   value = arena_alloc(r, sizeof(*value));
+   if (!value)
+      return NULL;
+
+   switch (token) {
+   case TRACE_BIN_NULL:
+      value->type = REPLAY_NULL;
+      return value;
+
+   case TRACE_BIN_FALSE:
+   case TRACE_BIN_TRUE:
+      value->type = REPLAY_BOOL;
+      value->u.b = token == TRACE_BIN_TRUE;
+      return value;
+
+   case TRACE_BIN_INT:
+      if (!read_uint(r, &u))
+         return NULL;
+      value->type = REPLAY_INT;
+      value->u.i = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+      return value;
+
+   case TRACE_BIN_UINT:
+   case TRACE_BIN_PTR:
+      if (!read_uint(r, &value->u.u))
+         return NULL;
+      value->type = token == TRACE_BIN_UINT ? REPLAY_UINT : REPLAY_PTR;
+      return value;
+
+   case TRACE_BIN_FLOAT:
+   {
+      union { double d; uint64_t u; } tmp;
+      uint8_t buf[8];
+      unsigned i;
+
+      if (!read_data(r, buf, 8))
+         return NULL;
+      tmp.u = 0;
+      for (i = 0; i < 8; ++i)
+         tmp.u |= (uint64_t)buf[i] << (i * 8);
+      value->type = REPLAY_FLOAT;
+      value->u.f = tmp.d;
+      return value;
+   }
+
+   case TRACE_BIN_STRING:
+      if (!read_size(r, &size) ||
+          !(str = arena_alloc(r, size + 1)) ||
+          !read_data(r, str, size))
+         return NULL;
+      str[size] = '\0';
+      value->type = REPLAY_STRING;
+      value->u.str = str;
+      return value;
+
+   case TRACE_BIN_ENUM:
+      value->type = REPLAY_ENUM;
+      value->u.name = read_name(r);
+      return value->u.name ? value : NULL;
+
+   case TRACE_BIN_BYTES:
+      if (!read_size(r, &size) ||
+          !(str = arena_alloc(r, MAX2(size, 1))) ||
+          !read_data(r, str, size))
+         return NULL;
+      value->type = REPLAY_BYTES;
+      value->u.bytes.data = str;
+      value->u.bytes.size = size;
+      return value;
+
+   case TRACE_BIN_BLOB:
+      return read_blob(r, value) ? value : NULL;
+
+   case TRACE_BIN_BLOB_REF:
+      if (!read_uint(r, &u))
+         return NULL;
+      if (u >= r->num_blobs) {
+         r->error = "bad blob index";
+         return NULL;
+      }
+      value->type = REPLAY_BYTES;
+      value->u.bytes.data = r->blobs[u].data;
+      value->u.bytes.size = r->blobs[u].size;
+      return value;
+
+   case TRACE_BIN_ARRAY:
+      return read_array(r, value, depth) ? value : NULL;
+
+   case TRACE_BIN_STRUCT:
+      return read_struct(r, value, depth) ? value : NULL;
+
+   case -1:
+      r->error = "unexpected end of trace";
+      return NULL;
+
+   default:
+      r->error = "bad value";
+      return NULL;
+   }
+}
+
+
+/*
+ * Interface
+ */
+
+struct replay_reader *
+replay_reader_create(FILE *file)
+{
+   struct replay_reader *r = CALLOC_STRUCT(replay_reader);
+   char magic[TRACE_BIN_MAGIC_SIZE];
+   uint64_t version;
+
+   if (!r)
+      return NULL;
+
+   r->file = file;
+   r->buf = MALLOC(REPLAY_BUFFER_SIZE);
+   if (!r->buf ||
+       !read_data(r, magic, sizeof(magic)) ||
+       memcmp(magic, TRACE_BIN_MAGIC, sizeof(magic)) != 0 ||
+       !read_uint(r, &version) ||
+       version != TRACE_BIN_VERSION) {
+      replay_reader_destroy(r);
+      return NULL;
+   }
+
+   return r;
+}
+
+
+boolean
+replay_reader_next(struct replay_reader *r, struct replay_call *call)
+{
+   uint64_t no;
+   int token;
+
+   if (r->error)
+      return FALSE;
+
+   arena_reset(r);
+   r->stack_size = 0;
+
+   token = read_byte(r);
+   if (token < 0)
+      return FALSE;
+   if (token != TRACE_BIN_CALL) {
+      r->error = "bad call";
+      return FALSE;
+   }
+
+   if (!read_uint(r, &no))
+      return FALSE;
+   call->no = (unsigned long)no;
+   call->klass = read_name(r);
+   call->method = call->klass ? read_name(r) : NULL;
+   if (!call->method)
+      return FALSE;
+   call->num_args = 0;
+   call->ret = NULL;
+
+   while ((token = read_byte(r)) != TRACE_BIN_CALL_END) {
+      struct replay_name *name = NULL;
+      struct replay_value *value;
+
+      switch (token) {
+      case TRACE_BIN_ARG:
+         name = read_name(r);
+         if (!name)
+            return FALSE;
+         /* fall through */
+      default:
+         value = read_value(r, token == TRACE_BIN_ARG ? read_byte(r) : token, 0);
+         if (!value)
+            return FALSE;
+         if (call->num_args == REPLAY_MAX_ARGS) {
+            r->error = "too many arguments";
+            return FALSE;
+         }
+         call->arg_names[call->num_args] = name;
+         call->args[call->num_args] = value;
+         call->num_args++;
+         break;
+
+      case TRACE_BIN_RET:
+         call->ret = read_value(r, read_byte(r), 0);
+         if (!call->ret)
+            return FALSE;
+         break;
+      }
+   }
+
+   return TRUE;
+}
+
+
+const char *
+replay_reader_error(struct replay_reader *r)
+{
+   return r->error;
+}
+
+
+void
+replay_reader_destroy(struct replay_reader *r)
+{
+   struct replay_chunk *chunk, *next;
+   unsigned i;
+
+   for (i = 0; i < r->num_names; i++)
+      FREE(r->names[i]);
+   FREE(r->names);
+
+   for (i = 0; i < r->num_blobs; i++)
+      FREE(r->blobs[i].data);
+   FREE(r->blobs);
+
+   for (chunk = r->chunks; chunk; chunk = next) {
+      next = chunk->next;
+      FREE(chunk);
+   }
+
+   FREE(r->stack);
+   FREE(r->buf);
+   FREE(r);
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Streaming reader of binary traces (see trace/tr_binary.h).
+ *
+ * Calls are decoded one at a time. The values of a call stay valid
+ * until the next call is read, except for names, which live as long
+ * as the reader.
+ */
+
+#ifndef REPLAY_READER_H
+#define REPLAY_READER_H
+
+#include <stdio.h>
+
+#include "pipe/p_compiler.h"
+
+
+#define REPLAY_MAX_ARGS 16
+
+
+enum replay_type {
+   REPLAY_NULL,
+   REPLAY_BOOL,
+   REPLAY_INT,
+   REPLAY_UINT,
+   REPLAY_FLOAT,
+   REPLAY_STRING,
+   REPLAY_ENUM,
+   REPLAY_PTR,
+   REPLAY_BYTES,
+   REPLAY_ARRAY,
+   REPLAY_STRUCT
+};
+
+
+/** An interned name. */
+struct replay_name {
+   const char *str;
+
+   /** Free for the replayer to cache what the name stands for. */
+   int value;
+};
+
+
+struct replay_value {
+   enum replay_type type;
+   union {
+      boolean b;
+      int64_t i;
+      uint64_t u;       /**< REPLAY_UINT and REPLAY_PTR */
+      double f;
+      const char *str;
+      struct replay_name *name;
+      struct {
+         const void *data;
+         size_t size;
+      } bytes;
+      struct {
+         unsigned count;
+         struct replay_value **elems;
+      } array;
+      struct {
+         struct replay_name *name;
+         unsigned count;
+         struct replay_name **names;
+         struct replay_value **values;
+      } s;
+   } u;
+};
+
+
+struct replay_call {
+   unsigned long no;
+   struct replay_name *klass;
+   struct replay_name *method;
+
+   /** Arguments. Values dumped outside of an argument have no name. */
+   unsigned num_args;
+   struct replay_name *arg_names[REPLAY_MAX_ARGS];
+   struct replay_value *args[REPLAY_MAX_ARGS];
+
+   struct replay_value *ret;
+};
+
+
+struct replay_reader;
+
+
+struct replay_reader *
+replay_reader_create(FILE *file);
+
+/**
+ * Read the next call. Returns FALSE at the end of the trace or on
+ * error, see replay_reader_error.
+ */
+boolean
+replay_reader_next(struct replay_reader *reader, struct replay_call *call);
+
+const char *
+replay_reader_error(struct replay_reader *reader);
+
+void
+replay_reader_destroy(struct replay_reader *reader);
+
+
+#endif /* REPLAY_READER_H */
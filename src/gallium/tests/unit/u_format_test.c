@@ -28,9 +28,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
+#include "os/os_time.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_half.h"
+#include "util/u_memory.h"
 #include "util/u_format.h"
 #include "util/u_format_tests.h"
 #include "util/u_format_s3tc.h"
@@ -704,13 +708,267 @@ test_all(void)
 }
 
 
+/*
+ * Whole rows go through the SSE variants of the generated functions when
+ * the CPU supports them. Check those against the C code, which runs with
+ * util_cpu_caps cleared, on random data and a width that leaves a tail.
+ */
+
+#define ROW_WIDTH 37
+#define ROW_HEIGHT 3
+#define ROW_PIXELS (ROW_WIDTH * ROW_HEIGHT)
+
+
+static void
+fill_random(void *data, unsigned size)
+{
+   uint8_t *bytes = data;
+   unsigned i;
+
+   for (i = 0; i < size; ++i)
+      bytes[i] = rand() >> 7;
+}
+
+
+/**
+ * Mostly values in [-0.25, 1.25], with random bit patterns in between to
+ * cover denormals, infinities and NaNs.
+ */
+static void
+fill_random_float(float *data, unsigned count)
+{
+   unsigned i;
+
+   for (i = 0; i < count; ++i) {
+      if (rand() % 8) {
+         data[i] = (float)rand() / RAND_MAX * 1.5f - 0.25f;
+      }
+      else {
+         fill_random(&data[i], sizeof data[i]);
+      }
+   }
+}
+
+
+static boolean
+test_format_rows(const struct util_format_description *format_desc)
+{
+   struct util_cpu_caps caps = util_cpu_caps;
+   uint8_t packed[ROW_PIXELS * 32];
+   uint8_t packed_ref[ROW_PIXELS * 32];
+   uint8_t unorm[ROW_PIXELS * 4];
+   uint8_t unorm_ref[ROW_PIXELS * 4];
+   float rgba[ROW_PIXELS * 4];
+   float rgba_ref[ROW_PIXELS * 4];
+   unsigned packed_stride = ROW_WIDTH * format_desc->block.bits / 8;
+   boolean success = TRUE;
+
+   if (format_desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       format_desc->block.width != 1 || format_desc->block.height != 1) {
+      return TRUE;
+   }
+
+#  define CHECK_ROWS(name, dst, dst_ref, dst_stride, src, src_stride) \
+   if (format_desc->name) { \
+      memset(dst_ref, 0, sizeof dst_ref); \
+      memset(dst, 0, sizeof dst); \
+      memset(&util_cpu_caps, 0, sizeof util_cpu_caps); \
+      format_desc->name(dst_ref, dst_stride, src, src_stride, \
+                        ROW_WIDTH, ROW_HEIGHT); \
+      util_cpu_caps = caps; \
+      format_desc->name(dst, dst_stride, src, src_stride, \
+                        ROW_WIDTH, ROW_HEIGHT); \
+      if (memcmp(dst, dst_ref, sizeof dst)) { \
+         printf("FAILED: util_format_%s_%s rows differ from the C code\n", \
+                format_desc->short_name, #name); \
+         success = FALSE; \
+      } \
+   }
+
+   fill_random(packed, sizeof packed);
+   CHECK_ROWS(unpack_rgba_8unorm, unorm, unorm_ref, ROW_WIDTH * 4,
+              packed, packed_stride);
+   CHECK_ROWS(unpack_rgba_float, rgba, rgba_ref, ROW_WIDTH * 16,
+              packed, packed_stride);
+
+   fill_random(unorm, sizeof unorm);
+   CHECK_ROWS(pack_rgba_8unorm, packed, packed_ref, packed_stride,
+              unorm, ROW_WIDTH * 4);
+
+   fill_random_float(rgba, ROW_PIXELS * 4);
+   CHECK_ROWS(pack_rgba_float, packed, packed_ref, packed_stride,
+              rgba, ROW_WIDTH * 16);
+
+#  undef CHECK_ROWS
+
+   return success;
+}
+
+
+static boolean
+test_all_rows(void)
+{
+   enum pipe_format format;
+   boolean success = TRUE;
+
+   for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_description *format_desc;
+
+      format_desc = util_format_description(format);
+      if (!format_desc) {
+         continue;
+      }
+
+      if (!test_format_rows(format_desc)) {
+         success = FALSE;
+      }
+   }
+
+   return success;
+}
+
+
+/*
+ * Throughput of every function, in pixels per second, with and without
+ * the SSE variants. Only run when asked for with -b.
+ */
+
+#define BENCH_SIZE 64
+#define BENCH_PIXELS (BENCH_SIZE * BENCH_SIZE)
+#define BENCH_USECS 20000
+
+
+struct bench_buffers
+{
+   uint8_t packed[BENCH_PIXELS * 32];
+   uint8_t unorm[BENCH_PIXELS * 4];
+   float rgba[BENCH_PIXELS * 4];
+   float z_float[BENCH_PIXELS];
+   uint32_t z_32unorm[BENCH_PIXELS];
+   uint8_t s_8uscaled[BENCH_PIXELS];
+};
+
+
+/**
+ * Run the conversion over a BENCH_SIZE x BENCH_SIZE image until
+ * BENCH_USECS have passed, and return the number of pixels per second.
+ */
+#define BENCH_RATE(rate, call) \
+   do { \
+      int64_t start = os_time_get(); \
+      int64_t elapsed; \
+      unsigned n = 0; \
+      do { \
+         call; \
+         ++n; \
+         elapsed = os_time_get() - start; \
+      } while (elapsed < BENCH_USECS); \
+      rate = (double)n * BENCH_PIXELS * 1e6 / (double)elapsed; \
+   } while (0)
+
+
+static void
+bench_format(const struct util_format_description *format_desc,
+             struct bench_buffers *buf)
+{
+   struct util_cpu_caps caps = util_cpu_caps;
+   unsigned packed_stride = BENCH_SIZE / format_desc->block.width *
+                            format_desc->block.bits / 8;
+   double rate, rate_c;
+
+#  define BENCH_ONE_FUNC(name, dst, dst_stride, src, src_stride) \
+   if (format_desc->name) { \
+      BENCH_RATE(rate, format_desc->name(dst, dst_stride, src, src_stride, \
+                                         BENCH_SIZE, BENCH_SIZE)); \
+      memset(&util_cpu_caps, 0, sizeof util_cpu_caps); \
+      BENCH_RATE(rate_c, format_desc->name(dst, dst_stride, src, src_stride, \
+                                           BENCH_SIZE, BENCH_SIZE)); \
+      util_cpu_caps = caps; \
+      printf("util_format_%s_%s: %.1f Mpixels/s (C code %.1f Mpixels/s)\n", \
+             format_desc->short_name, #name, rate / 1e6, rate_c / 1e6); \
+   }
+
+   BENCH_ONE_FUNC(unpack_rgba_8unorm, buf->unorm, BENCH_SIZE * 4,
+                  buf->packed, packed_stride);
+   BENCH_ONE_FUNC(pack_rgba_8unorm, buf->packed, packed_stride,
+                  buf->unorm, BENCH_SIZE * 4);
+   BENCH_ONE_FUNC(unpack_rgba_float, buf->rgba, BENCH_SIZE * 16,
+                  buf->packed, packed_stride);
+   BENCH_ONE_FUNC(pack_rgba_float, buf->packed, packed_stride,
+                  buf->rgba, BENCH_SIZE * 16);
+   BENCH_ONE_FUNC(unpack_z_32unorm, buf->z_32unorm, BENCH_SIZE * 4,
+                  buf->packed, packed_stride);
+   BENCH_ONE_FUNC(pack_z_32unorm, buf->packed, packed_stride,
+                  buf->z_32unorm, BENCH_SIZE * 4);
+   BENCH_ONE_FUNC(unpack_z_float, buf->z_float, BENCH_SIZE * 4,
+                  buf->packed, packed_stride);
+   BENCH_ONE_FUNC(pack_z_float, buf->packed, packed_stride,
+                  buf->z_float, BENCH_SIZE * 4);
+   BENCH_ONE_FUNC(unpack_s_8uscaled, buf->s_8uscaled, BENCH_SIZE,
+                  buf->packed, packed_stride);
+   BENCH_ONE_FUNC(pack_s_8uscaled, buf->packed, packed_stride,
+                  buf->s_8uscaled, BENCH_SIZE);
+
+#  undef BENCH_ONE_FUNC
+}
+
+
+static void
+bench_all(void)
+{
+   struct bench_buffers *buf = CALLOC_STRUCT(bench_buffers);
+   enum pipe_format format;
+
+   if (!buf)
+      return;
+
+   for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_description *format_desc;
+
+      format_desc = util_format_description(format);
+      if (!format_desc) {
+         continue;
+      }
+
+      if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC &&
+          !util_format_s3tc_enabled) {
+         continue;
+      }
+
+      /* some of the RGTC functions are still stubs */
+      if (format_desc->layout == UTIL_FORMAT_LAYOUT_RGTC) {
+         continue;
+      }
+
+      /* fresh inputs for every format, as packing overwrites them */
+      fill_random(buf->packed, sizeof buf->packed);
+      fill_random(buf->unorm, sizeof buf->unorm);
+      fill_random_float(buf->rgba, BENCH_PIXELS * 4);
+
+      bench_format(format_desc, buf);
+   }
+
+   FREE(buf);
+}
+
+
 int main(int argc, char **argv)
 {
    boolean success;
 
+   util_cpu_detect();
    util_format_s3tc_init();
 
+   if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+      bench_all();
+      return 0;
+   }
+
    success = test_all();
 
+   if (!test_all_rows()) {
+      success = FALSE;
+   }
+
    return success ? 0 : 1;
 }
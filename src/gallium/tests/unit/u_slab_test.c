@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Stress test and benchmark of the multithreaded util_slab mode.
+ *
+ * Several threads allocate and free blocks, both their own and blocks
+ * allocated by another thread.  Every block is stamped with its owner and
+ * checked before it's freed, so a block handed out twice is detected.  With
+ * more threads than UTIL_SLAB_NUM_CACHES some threads use the locked
+ * fallback, alongside the others' caches.  The same workloads are run on a
+ * singlethreaded pool behind one mutex, which is how the multithreaded mode
+ * used to work.
+ */
+
+
+#include <stdio.h>
+
+#include "os/os_thread.h"
+#include "os/os_time.h"
+#include "util/u_memory.h"
+#include "util/u_slab.h"
+
+
+#define MAX_THREADS 16
+#define BATCH 64
+#define ROUNDS 20000
+
+struct item {
+   unsigned thread;
+   unsigned serial;
+   unsigned pad[6];
+};
+
+struct test_pool {
+   struct util_slab_mempool slab;
+   boolean locked;   /* singlethreaded pool behind lock */
+   pipe_mutex lock;
+};
+
+struct thread_data {
+   struct test_pool *pool;
+   unsigned id;
+   unsigned num_threads;
+   boolean cross;
+   unsigned errors;
+};
+
+static pipe_barrier barrier;
+static struct item *handoff[MAX_THREADS][BATCH];
+
+
+static struct item *
+test_alloc(struct test_pool *pool)
+{
+   struct item *item;
+
+   if (pool->locked) {
+      pipe_mutex_lock(pool->lock);
+      item = util_slab_alloc(&pool->slab);
+      pipe_mutex_unlock(pool->lock);
+   }
+   else {
+      item = util_slab_alloc(&pool->slab);
+   }
+   return item;
+}
+
+static void
+test_free(struct test_pool *pool, struct item *item)
+{
+   if (pool->locked) {
+      pipe_mutex_lock(pool->lock);
+      util_slab_free(&pool->slab, item);
+      pipe_mutex_unlock(pool->lock);
+   }
+   else {
+      util_slab_free(&pool->slab, item);
+   }
+}
+
+
+static PIPE_THREAD_ROUTINE(thread_function, thread_data)
+{
+   struct thread_data *data = (struct thread_data *) thread_data;
+   struct item *items[BATCH];
+   unsigned round, i;
+
+   for (round = 0; round < ROUNDS; round++) {
+      for (i = 0; i < BATCH; i++) {
+         items[i] = test_alloc(data->pool);
+         items[i]->thread = data->id;
+         items[i]->serial = round * BATCH + i;
+      }
+
+      if (data->cross) {
+         /* free the blocks of the next thread instead of our own */
+         const unsigned next = (data->id + 1) % data->num_threads;
+
+         for (i = 0; i < BATCH; i++)
+            handoff[data->id][i] = items[i];
+         pipe_barrier_wait(&barrier);
+         for (i = 0; i < BATCH; i++) {
+            struct item *item = handoff[next][i];
+            if (item->thread != next || item->serial != round * BATCH + i)
+               data->errors++;
+            test_free(data->pool, item);
+         }
+         pipe_barrier_wait(&barrier);
+      }
+      else {
+         for (i = 0; i < BATCH; i++) {
+            if (items[i]->thread != data->id ||
+                items[i]->serial != round * BATCH + i)
+               data->errors++;
+            test_free(data->pool, items[i]);
+         }
+      }
+   }
+
+   return NULL;
+}
+
+
+/* Run one workload, return the time in seconds and add up the errors. */
+static double
+run(boolean locked, unsigned num_threads, boolean cross, unsigned *errors)
+{
+   struct test_pool pool;
+   pipe_thread threads[MAX_THREADS];
+   struct thread_data data[MAX_THREADS];
+   int64_t start;
+   unsigned i;
+
+   pool.locked = locked;
+   pipe_mutex_init(pool.lock);
+   util_slab_create(&pool.slab, sizeof(struct item), 64,
+                    locked ? UTIL_SLAB_SINGLETHREADED : UTIL_SLAB_MULTITHREADED);
+   pipe_barrier_init(&barrier, num_threads);
+
+   start = os_time_get();
+
+   for (i = 0; i < num_threads; i++) {
+      data[i].pool = &pool;
+      data[i].id = i;
+      data[i].num_threads = num_threads;
+      data[i].cross = cross;
+      data[i].errors = 0;
+      threads[i] = pipe_thread_create(thread_function, &data[i]);
+   }
+   for (i = 0; i < num_threads; i++) {
+      pipe_thread_wait(threads[i]);
+      *errors += data[i].errors;
+   }
+
+   start = os_time_get() - start;
+
+   pipe_barrier_destroy(&barrier);
+   util_slab_destroy(&pool.slab);
+   pipe_mutex_destroy(pool.lock);
+
+   return start * 1e-6;
+}
+
+
+int main()
+{
+   static const unsigned thread_counts[] = { 1, 2, 4, 8, 16 };
+   unsigned errors = 0;
+   unsigned cross, i;
+
+   printf("%u allocations per thread\n", ROUNDS * BATCH);
+   printf("%-8s %-8s %12s %12s %8s\n",
+          "threads", "frees", "mutex (s)", "magazine (s)", "speedup");
+
+   for (cross = 0; cross < 2; cross++) {
+      for (i = 0; i < Elements(thread_counts); i++) {
+         const unsigned n = thread_counts[i];
+         double t_locked, t_mt;
+
+         if (cross && n == 1)
+            continue;
+
+         t_locked = run(TRUE, n, cross, &errors);
+         t_mt = run(FALSE, n, cross, &errors);
+
+         printf("%-8u %-8s %12.4f %12.4f %7.2fx\n",
+                n, cross ? "other" : "own", t_locked, t_mt,
+                t_locked / t_mt);
+      }
+   }
+
+   if (errors) {
+      printf("FAILED: %u blocks were handed out twice\n", errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -198,6 +198,11 @@ read_builtins(GLenum target, const char *protos, const char **functions, unsigne
     print """
 void *builtin_mem_ctx = NULL;
 
+/* Built-in profiles are read on first use, possibly from several compiler
+ * threads at once (MESA_GLSL=async).
+ */
+_glthread_DECLARE_STATIC_MUTEX(builtins_mutex);
+
 void
 _mesa_glsl_release_functions(void)
 {
@@ -232,6 +237,8 @@ _mesa_glsl_initialize_functions(struct _mesa_glsl_parse_state *state)
    if (state->num_builtins_to_link > 0)
       return;
 
+   _glthread_LOCK_MUTEX(builtins_mutex);
+
    if (builtin_mem_ctx == NULL) {
       builtin_mem_ctx = ralloc_context(NULL); // "GLSL built-in functions"
       memset(&builtin_profiles, 0, sizeof(builtin_profiles));
@@ -259,5 +266,6 @@ _mesa_glsl_initialize_functions(struct _mesa_glsl_parse_state *state)
         print '   }'
         print
         i = i + 1
+    print '   _glthread_UNLOCK_MUTEX(builtins_mutex);'
     print '}'
 
@@ -75,9 +75,9 @@ _argument_list_length (argument_list_t *list);
 static token_list_t *
 _argument_list_member_at (argument_list_t *list, int index);
 
-/* Note: This function ralloc_steal()s the str pointer. */
+/* Note: The str pointer must be an atom from glcpp_parser_intern. */
 static token_t *
-_token_create_str (void *ctx, int type, char *str);
+_token_create_str (void *ctx, int type, const char *str);
 
 static token_t *
 _token_create_ival (void *ctx, int type, int ival);
@@ -85,7 +85,7 @@ _token_create_ival (void *ctx, int type, int ival);
 static token_list_t *
 _token_list_create (void *ctx);
 
-/* Note: This function calls ralloc_steal on token. */
+/* Note: This function copies token, which the caller keeps ownership of. */
 static void
 _token_list_append (token_list_t *list, token_t *token);
 
@@ -221,7 +221,6 @@ control_line:
 			hash_table_remove (parser->defines, $2);
 			ralloc_free (macro);
 		}
-		ralloc_free ($2);
 	}
 |	HASH_IF conditional_tokens NEWLINE {
 		/* Be careful to only evaluate the 'if' expression if
@@ -254,12 +253,10 @@ control_line:
 	}
 |	HASH_IFDEF IDENTIFIER junk NEWLINE {
 		macro_t *macro = hash_table_find (parser->defines, $2);
-		ralloc_free ($2);
 		_glcpp_parser_skip_stack_push_if (parser, & @1, macro != NULL);
 	}
 |	HASH_IFNDEF IDENTIFIER junk NEWLINE {
 		macro_t *macro = hash_table_find (parser->defines, $2);
-		ralloc_free ($2);
 		_glcpp_parser_skip_stack_push_if (parser, & @1, macro == NULL);
 	}
 |	HASH_ELIF conditional_tokens NEWLINE {
@@ -303,9 +300,10 @@ control_line:
 		_glcpp_parser_skip_stack_pop (parser, & @1);
 	}
 |	HASH_VERSION integer_constant NEWLINE {
-		macro_t *macro = hash_table_find (parser->defines, "__VERSION__");
+		const char *version = glcpp_parser_intern (parser, "__VERSION__");
+		macro_t *macro = hash_table_find (parser->defines, version);
 		if (macro) {
-			hash_table_remove (parser->defines, "__VERSION__");
+			hash_table_remove (parser->defines, version);
 			ralloc_free (macro);
 		}
 		add_builtin_define (parser, "__VERSION__", $2);
@@ -427,12 +425,10 @@ identifier_list:
 	IDENTIFIER {
 		$$ = _string_list_create (parser);
 		_string_list_append_item ($$, $1);
-		ralloc_steal ($$, $1);
 	}
 |	identifier_list ',' IDENTIFIER {
 		$$ = $1;	
 		_string_list_append_item ($$, $3);
-		ralloc_steal ($$, $3);
 	}
 ;
 
@@ -477,10 +473,12 @@ conditional_tokens:
 	conditional_token {
 		$$ = _token_list_create (parser);
 		_token_list_append ($$, $1);
+		ralloc_free ($1);
 	}
 |	conditional_tokens conditional_token {
 		$$ = $1;
 		_token_list_append ($$, $2);
+		ralloc_free ($2);
 	}
 ;
 
@@ -489,10 +487,12 @@ pp_tokens:
 		parser->space_tokens = 1;
 		$$ = _token_list_create (parser);
 		_token_list_append ($$, $1);
+		ralloc_free ($1);
 	}
 |	pp_tokens preprocessing_token {
 		$$ = $1;
 		_token_list_append ($$, $2);
+		ralloc_free ($2);
 	}
 ;
 
@@ -573,7 +573,7 @@ _string_list_append_item (string_list_t *list, const char *str)
 	string_node_t *node;
 
 	node = ralloc (list, string_node_t);
-	node->str = ralloc_strdup (node, str);
+	node->str = str;
 
 	node->next = NULL;
 
@@ -596,7 +596,7 @@ _string_list_contains (string_list_t *list, const char *member, int *index)
 		return 0;
 
 	for (i = 0, node = list->head; node; i++, node = node->next) {
-		if (strcmp (node->str, member) == 0) {
+		if (node->str == member) {
 			if (index)
 				*index = i;
 			return 1;
@@ -636,7 +636,7 @@ _string_list_equal (string_list_t *a, string_list_t *b)
 	     node_a && node_b;
 	     node_a = node_a->next, node_b = node_b->next)
 	{
-		if (strcmp (node_a->str, node_b->str))
+		if (node_a->str != node_b->str)
 			return 0;
 	}
 
@@ -714,9 +714,9 @@ _argument_list_member_at (argument_list_t *list, int index)
 	return NULL;
 }
 
-/* Note: This function ralloc_steal()s the str pointer. */
+/* Note: The str pointer must be an atom from glcpp_parser_intern. */
 token_t *
-_token_create_str (void *ctx, int type, char *str)
+_token_create_str (void *ctx, int type, const char *str)
 {
 	token_t *token;
 
@@ -724,8 +724,6 @@ _token_create_str (void *ctx, int type, char *str)
 	token->type = type;
 	token->value.str = str;
 
-	ralloc_steal (token, str);
-
 	return token;
 }
 
@@ -760,11 +758,9 @@ _token_list_append (token_list_t *list, token_t *token)
 	token_node_t *node;
 
 	node = ralloc (list, token_node_t);
-	node->token = token;
+	node->token = *token;
 	node->next = NULL;
 
-	ralloc_steal (list, token);
-
 	if (list->head == NULL) {
 		list->head = node;
 	} else {
@@ -796,36 +792,46 @@ static token_list_t *
 _token_list_copy (void *ctx, token_list_t *other)
 {
 	token_list_t *copy;
-	token_node_t *node;
+	token_node_t *node, *nodes;
+	unsigned i, count;
 
 	if (other == NULL)
 		return NULL;
 
 	copy = _token_list_create (ctx);
-	for (node = other->head; node; node = node->next) {
-		token_t *new_token = ralloc (copy, token_t);
-		*new_token = *node->token;
-		_token_list_append (copy, new_token);
+
+	count = 0;
+	for (node = other->head; node; node = node->next)
+		count++;
+
+	if (count == 0)
+		return copy;
+
+	/* Copy the whole list into one array of nodes rather than
+	 * allocating each of them separately. */
+	nodes = ralloc_array (copy, token_node_t, count);
+	for (i = 0, node = other->head; node; i++, node = node->next) {
+		nodes[i].token = node->token;
+		nodes[i].next = &nodes[i + 1];
+		if (node->token.type != SPACE)
+			copy->non_space_tail = &nodes[i];
 	}
+	nodes[count - 1].next = NULL;
+
+	copy->head = &nodes[0];
+	copy->tail = &nodes[count - 1];
 
 	return copy;
 }
 
+/* The trimmed nodes are only unlinked: they may live in an array
+ * allocated by _token_list_copy and are freed along with the list. */
 static void
 _token_list_trim_trailing_space (token_list_t *list)
 {
-	token_node_t *tail, *next;
-
 	if (list->non_space_tail) {
-		tail = list->non_space_tail->next;
 		list->non_space_tail->next = NULL;
 		list->tail = list->non_space_tail;
-
-		while (tail) {
-			next = tail->next;
-			ralloc_free (tail);
-			tail = next;
-		}
 	}
 }
 
@@ -838,7 +844,7 @@ _token_list_is_empty_ignoring_space (token_list_t *l)
 		return 1;
 
 	n = l->head;
-	while (n != NULL && n->token->type == SPACE)
+	while (n != NULL && n->token.type == SPACE)
 		n = n->next;
 
 	return n == NULL;
@@ -866,23 +872,23 @@ _token_list_equal_ignoring_space (token_list_t *a, token_list_t *b)
 		if (node_a == NULL || node_b == NULL)
 			return 0;
 
-		if (node_a->token->type == SPACE) {
+		if (node_a->token.type == SPACE) {
 			node_a = node_a->next;
 			continue;
 		}
 
-		if (node_b->token->type == SPACE) {
+		if (node_b->token.type == SPACE) {
 			node_b = node_b->next;
 			continue;
 		}
 
-		if (node_a->token->type != node_b->token->type)
+		if (node_a->token.type != node_b->token.type)
 			return 0;
 
-		switch (node_a->token->type) {
+		switch (node_a->token.type) {
 		case INTEGER:
-			if (node_a->token->value.ival != 
-			    node_b->token->value.ival)
+			if (node_a->token.value.ival != 
+			    node_b->token.value.ival)
 			{
 				return 0;
 			}
@@ -890,11 +896,8 @@ _token_list_equal_ignoring_space (token_list_t *a, token_list_t *b)
 		case IDENTIFIER:
 		case INTEGER_STRING:
 		case OTHER:
-			if (strcmp (node_a->token->value.str,
-				    node_b->token->value.str))
-			{
+			if (node_a->token.value.str != node_b->token.value.str)
 				return 0;
-			}
 			break;
 		}
 
@@ -964,7 +967,7 @@ _token_print (char **out, token_t *token)
 	}
 }
 
-/* Return a new token (ralloc()ed off of 'token') formed by pasting
+/* Return a new token (ralloc()ed off of 'parser') formed by pasting
  * 'token' and 'other'. Note that this function may return 'token' or
  * 'other' directly rather than allocating anything new.
  *
@@ -988,31 +991,31 @@ _token_paste (glcpp_parser_t *parser, token_t *token, token_t *other)
 	switch (token->type) {
 	case '<':
 		if (other->type == '<')
-			combined = _token_create_ival (token, LEFT_SHIFT, LEFT_SHIFT);
+			combined = _token_create_ival (parser, LEFT_SHIFT, LEFT_SHIFT);
 		else if (other->type == '=')
-			combined = _token_create_ival (token, LESS_OR_EQUAL, LESS_OR_EQUAL);
+			combined = _token_create_ival (parser, LESS_OR_EQUAL, LESS_OR_EQUAL);
 		break;
 	case '>':
 		if (other->type == '>')
-			combined = _token_create_ival (token, RIGHT_SHIFT, RIGHT_SHIFT);
+			combined = _token_create_ival (parser, RIGHT_SHIFT, RIGHT_SHIFT);
 		else if (other->type == '=')
-			combined = _token_create_ival (token, GREATER_OR_EQUAL, GREATER_OR_EQUAL);
+			combined = _token_create_ival (parser, GREATER_OR_EQUAL, GREATER_OR_EQUAL);
 		break;
 	case '=':
 		if (other->type == '=')
-			combined = _token_create_ival (token, EQUAL, EQUAL);
+			combined = _token_create_ival (parser, EQUAL, EQUAL);
 		break;
 	case '!':
 		if (other->type == '=')
-			combined = _token_create_ival (token, NOT_EQUAL, NOT_EQUAL);
+			combined = _token_create_ival (parser, NOT_EQUAL, NOT_EQUAL);
 		break;
 	case '&':
 		if (other->type == '&')
-			combined = _token_create_ival (token, AND, AND);
+			combined = _token_create_ival (parser, AND, AND);
 		break;
 	case '|':
 		if (other->type == '|')
-			combined = _token_create_ival (token, OR, OR);
+			combined = _token_create_ival (parser, OR, OR);
 		break;
 	}
 
@@ -1035,9 +1038,11 @@ _token_paste (glcpp_parser_t *parser, token_t *token, token_t *other)
 	{
 		char *str;
 
-		str = ralloc_asprintf (token, "%s%s", token->value.str,
+		str = ralloc_asprintf (parser, "%s%s", token->value.str,
 				       other->value.str);
-		combined = _token_create_str (token, token->type, str);
+		combined = _token_create_str (parser, token->type,
+					      glcpp_parser_intern (parser, str));
+		ralloc_free (str);
 		combined->location = token->location;
 		return combined;
 	}
@@ -1061,7 +1066,7 @@ _token_list_print (glcpp_parser_t *parser, token_list_t *list)
 		return;
 
 	for (node = list->head; node; node = node->next)
-		_token_print (&parser->output, node->token);
+		_token_print (&parser->output, &node->token);
 }
 
 void
@@ -1076,11 +1081,11 @@ static void add_builtin_define(glcpp_parser_t *parser,
    token_t *tok;
    token_list_t *list;
 
-   tok = _token_create_ival (parser, INTEGER, value);
-
    list = _token_list_create(parser);
+   tok = _token_create_ival (list, INTEGER, value);
    _token_list_append(list, tok);
-   _define_object_macro(parser, NULL, name, list);
+   _define_object_macro(parser, NULL, glcpp_parser_intern(parser, name),
+			list);
 }
 
 glcpp_parser_t *
@@ -1092,8 +1097,10 @@ glcpp_parser_create (const struct gl_extensions *extensions, int api)
 	parser = ralloc (NULL, glcpp_parser_t);
 
 	glcpp_lex_init_extra (parser, &parser->scanner);
-	parser->defines = hash_table_ctor (32, hash_table_string_hash,
-					   hash_table_string_compare);
+	parser->atoms = hash_table_ctor (256, hash_table_string_hash,
+					 hash_table_string_compare);
+	parser->defines = hash_table_ctor (32, hash_table_pointer_hash,
+					   hash_table_pointer_compare);
 	parser->active = NULL;
 	parser->lexing_if = 0;
 	parser->space_tokens = 1;
@@ -1150,10 +1157,29 @@ glcpp_parser_parse (glcpp_parser_t *parser)
 	return yyparse (parser);
 }
 
+/* Return the single copy of 'str' owned by the parser, creating it the
+ * first time the string is seen.  All token strings go through here,
+ * so tokens never own their strings and identifiers can be compared,
+ * and looked up in the macro table, by pointer. */
+const char *
+glcpp_parser_intern (glcpp_parser_t *parser, const char *str)
+{
+	char *atom;
+
+	atom = hash_table_find (parser->atoms, str);
+	if (atom == NULL) {
+		atom = ralloc_strdup (parser, str);
+		hash_table_insert (parser->atoms, atom, atom);
+	}
+
+	return atom;
+}
+
 void
 glcpp_parser_destroy (glcpp_parser_t *parser)
 {
 	glcpp_lex_destroy (parser->scanner);
+	hash_table_dtor (parser->atoms);
 	hash_table_dtor (parser->defines);
 	ralloc_free (parser);
 }
@@ -1199,10 +1225,10 @@ _arguments_parse (argument_list_t *arguments,
 	node = node->next;
 
 	/* Ignore whitespace before first parenthesis. */
-	while (node && node->token->type == SPACE)
+	while (node && node->token.type == SPACE)
 		node = node->next;
 
-	if (node == NULL || node->token->type != '(')
+	if (node == NULL || node->token.type != '(')
 		return FUNCTION_NOT_A_FUNCTION;
 
 	node = node->next;
@@ -1211,18 +1237,18 @@ _arguments_parse (argument_list_t *arguments,
 	_argument_list_append (arguments, argument);
 
 	for (paren_count = 1; node; node = node->next) {
-		if (node->token->type == '(')
+		if (node->token.type == '(')
 		{
 			paren_count++;
 		}
-		else if (node->token->type == ')')
+		else if (node->token.type == ')')
 		{
 			paren_count--;
 			if (paren_count == 0)
 				break;
 		}
 
-		if (node->token->type == ',' &&
+		if (node->token.type == ',' &&
 			 paren_count == 1)
 		{
 			_token_list_trim_trailing_space (argument);
@@ -1233,10 +1259,10 @@ _arguments_parse (argument_list_t *arguments,
 			if (argument->head == NULL) {
 				/* Don't treat initial whitespace as
 				 * part of the arguement. */
-				if (node->token->type == SPACE)
+				if (node->token.type == SPACE)
 					continue;
 			}
-			_token_list_append (argument, node->token);
+			_token_list_append (argument, &node->token);
 		}
 	}
 
@@ -1268,7 +1294,7 @@ _glcpp_parser_expand_if (glcpp_parser_t *parser, int type, token_list_t *list)
 	token_t *token;
 
 	expanded = _token_list_create (parser);
-	token = _token_create_ival (parser, type, type);
+	token = _token_create_ival (expanded, type, type);
 	_token_list_append (expanded, token);
 	_glcpp_parser_expand_token_list (parser, list);
 	_token_list_append_list (expanded, list);
@@ -1305,7 +1331,7 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 	token_list_t *substituted;
 	int parameter_index;
 
-	identifier = node->token->value.str;
+	identifier = node->token.value.str;
 
 	macro = hash_table_find (parser->defines, identifier);
 
@@ -1320,7 +1346,7 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 	case FUNCTION_NOT_A_FUNCTION:
 		return NULL;
 	case FUNCTION_UNBALANCED_PARENTHESES:
-		glcpp_error (&node->token->location, parser, "Macro %s call has unbalanced parentheses\n", identifier);
+		glcpp_error (&node->token.location, parser, "Macro %s call has unbalanced parentheses\n", identifier);
 		return NULL;
 	}
 
@@ -1336,7 +1362,7 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 		_argument_list_length (arguments) == 1 &&
 		arguments->head->argument->head == NULL)))
 	{
-		glcpp_error (&node->token->location, parser,
+		glcpp_error (&node->token.location, parser,
 			      "Error: macro %s invoked with %d arguments (expected %d)\n",
 			      identifier,
 			      _argument_list_length (arguments),
@@ -1349,9 +1375,9 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 
 	for (node = macro->replacements->head; node; node = node->next)
 	{
-		if (node->token->type == IDENTIFIER &&
+		if (node->token.type == IDENTIFIER &&
 		    _string_list_contains (macro->parameters,
-					   node->token->value.str,
+					   node->token.value.str,
 					   &parameter_index))
 		{
 			token_list_t *argument;
@@ -1377,7 +1403,7 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 				_token_list_append (substituted, new_token);
 			}
 		} else {
-			_token_list_append (substituted, node->token);
+			_token_list_append (substituted, &node->token);
 		}
 	}
 
@@ -1393,28 +1419,29 @@ _glcpp_parser_expand_function (glcpp_parser_t *parser,
 
 		/* Look ahead for a PASTE token, skipping space. */
 		next_non_space = node->next;
-		while (next_non_space && next_non_space->token->type == SPACE)
+		while (next_non_space && next_non_space->token.type == SPACE)
 			next_non_space = next_non_space->next;
 
 		if (next_non_space == NULL)
 			break;
 
-		if (next_non_space->token->type != PASTE) {
+		if (next_non_space->token.type != PASTE) {
 			node = next_non_space;
 			continue;
 		}
 
 		/* Now find the next non-space token after the PASTE. */
 		next_non_space = next_non_space->next;
-		while (next_non_space && next_non_space->token->type == SPACE)
+		while (next_non_space && next_non_space->token.type == SPACE)
 			next_non_space = next_non_space->next;
 
 		if (next_non_space == NULL) {
-			yyerror (&node->token->location, parser, "'##' cannot appear at either end of a macro expansion\n");
+			yyerror (&node->token.location, parser, "'##' cannot appear at either end of a macro expansion\n");
 			return NULL;
 		}
 
-		node->token = _token_paste (parser, node->token, next_non_space->token);
+		node->token = *_token_paste (parser, &node->token,
+					      &next_non_space->token);
 		node->next = next_non_space->next;
 		if (next_non_space == substituted->tail)
 			substituted->tail = node;
@@ -1447,7 +1474,7 @@ _glcpp_parser_expand_node (glcpp_parser_t *parser,
 			   token_node_t *node,
 			   token_node_t **last)
 {
-	token_t *token = node->token;
+	token_t *token = &node->token;
 	const char *identifier;
 	macro_t *macro;
 
@@ -1478,13 +1505,11 @@ _glcpp_parser_expand_node (glcpp_parser_t *parser,
 		/* We change the token type here from IDENTIFIER to
 		 * OTHER to prevent any future expansion of this
 		 * unexpanded token. */
-		char *str;
 		token_list_t *expansion;
 		token_t *final;
 
-		str = ralloc_strdup (parser, token->value.str);
-		final = _token_create_str (parser, OTHER, str);
 		expansion = _token_list_create (parser);
+		final = _token_create_str (expansion, OTHER, token->value.str);
 		_token_list_append (expansion, final);
 		*last = node;
 		return expansion;
@@ -1519,7 +1544,7 @@ _parser_active_list_push (glcpp_parser_t *parser,
 	active_list_t *node;
 
 	node = ralloc (parser->active, active_list_t);
-	node->identifier = ralloc_strdup (node, identifier);
+	node->identifier = identifier;
 	node->marker = marker;
 	node->next = parser->active;
 
@@ -1551,7 +1576,7 @@ _parser_active_list_contains (glcpp_parser_t *parser, const char *identifier)
 		return 0;
 
 	for (node = parser->active; node; node = node->next)
-		if (strcmp (node->identifier, identifier) == 0)
+		if (node->identifier == identifier)
 			return 1;
 
 	return 0;
@@ -1596,7 +1621,7 @@ _glcpp_parser_expand_token_list (glcpp_parser_t *parser,
 				}
 
 			_parser_active_list_push (parser,
-						  node->token->value.str,
+						  node->token.value.str,
 						  last->next);
 			
 			/* Splice expansion into list, supporting a
@@ -1692,9 +1717,10 @@ _define_object_macro (glcpp_parser_t *parser,
 
 	macro->is_function = 0;
 	macro->parameters = NULL;
-	macro->identifier = ralloc_strdup (macro, identifier);
-	macro->replacements = replacements;
-	ralloc_steal (macro, replacements);
+	macro->identifier = identifier;
+	/* Store a compact copy, which is what every expansion reads. */
+	macro->replacements = _token_list_copy (macro, replacements);
+	ralloc_free (replacements);
 
 	previous = hash_table_find (parser->defines, identifier);
 	if (previous) {
@@ -1722,12 +1748,12 @@ _define_function_macro (glcpp_parser_t *parser,
 
 	macro = ralloc (parser, macro_t);
 	ralloc_steal (macro, parameters);
-	ralloc_steal (macro, replacements);
 
 	macro->is_function = 1;
 	macro->parameters = parameters;
-	macro->identifier = ralloc_strdup (macro, identifier);
-	macro->replacements = replacements;
+	macro->identifier = identifier;
+	macro->replacements = _token_list_copy (macro, replacements);
+	ralloc_free (replacements);
 	previous = hash_table_find (parser->defines, identifier);
 	if (previous) {
 		if (_macro_equal (macro, previous)) {
@@ -1812,8 +1838,8 @@ glcpp_parser_lex (YYSTYPE *yylval, YYLTYPE *yylloc, glcpp_parser_t *parser)
 		return NEWLINE;
 	}
 
-	*yylval = node->token->value;
-	ret = node->token->type;
+	*yylval = node->token.value;
+	ret = node->token.type;
 
 	parser->lex_from_node = node->next;
 
@@ -1831,9 +1857,9 @@ glcpp_parser_lex_from (glcpp_parser_t *parser, token_list_t *list)
 	parser->lex_from_list = _token_list_create (parser);
 
 	for (node = list->head; node; node = node->next) {
-		if (node->token->type == SPACE)
+		if (node->token.type == SPACE)
 			continue;
-		_token_list_append (parser->lex_from_list, node->token);
+		_token_list_append (parser->lex_from_list, &node->token);
 	}
 
 	ralloc_free (list);
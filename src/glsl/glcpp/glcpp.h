@@ -50,7 +50,7 @@ typedef struct token_list token_list_t;
 typedef union YYSTYPE
 {
 	intmax_t ival;
-	char *str;
+	const char *str;
 	string_list_t *string_list;
 	token_t *token;
 	token_list_t *token_list;
@@ -94,8 +94,12 @@ struct token {
 	YYLTYPE location;
 };
 
+/* Tokens are stored by value in the list nodes, so appending a token
+ * to a list copies it and a list can be copied with a single
+ * allocation.  String values are atoms (see glcpp_parser_intern) and
+ * are shared, never copied, between tokens. */
 typedef struct token_node {
-	token_t *token;
+	token_t token;
 	struct token_node *next;
 } token_node_t;
 
@@ -162,6 +166,9 @@ typedef struct active_list {
 
 struct glcpp_parser {
 	yyscan_t scanner;
+	/* Interned token strings, so each spelling is stored once. */
+	struct hash_table *atoms;
+	/* Macros, keyed by their (interned) identifier pointer. */
 	struct hash_table *defines;
 	active_list_t *active;
 	int lexing_if;
@@ -185,6 +192,9 @@ glcpp_parser_create (const struct gl_extensions *extensions, int api);
 int
 glcpp_parser_parse (glcpp_parser_t *parser);
 
+const char *
+glcpp_parser_intern (glcpp_parser_t *parser, const char *str);
+
 void
 glcpp_parser_destroy (glcpp_parser_t *parser);
 
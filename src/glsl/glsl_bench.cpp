@@ -0,0 +1,499 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glsl_bench.cpp
+ * Compile-time benchmark for the GLSL compiler.
+ *
+ * Runs every shader of a corpus through the compiler one phase at a time
+ * and prints, for each shader and phase, the wall time, the number of heap
+ * allocations and the peak heap growth as CSV:
+ *
+ *    shader,phase,usec,allocs,peak_bytes
+ *
+ * Shaders are given as files or directories.  Files in the same directory
+ * sharing a base name (foo.vert, foo.frag) form a program, which is linked
+ * after its shaders are compiled.  The driver back-ends (ir_to_mesa,
+ * glsl_to_tgsi) need a full Mesa context and are not part of the
+ * standalone build, so they are not measured here.
+ *
+ * With --repeat N every shader is processed N times and the fastest run is
+ * reported, which keeps the numbers stable enough to compare two builds.
+ */
+#include <getopt.h>
+#include <dirent.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "glsl_parser_extras.h"
+#include "ir_optimization.h"
+#include "program.h"
+#include "standalone_scaffolding.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+/* Count allocations by interposing the allocator.  glibc exports its own
+ * implementation under these names for exactly this purpose.
+ */
+extern "C" {
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+}
+
+static unsigned long num_allocs;
+static size_t live_bytes;
+static size_t peak_bytes;
+
+static inline void
+track_alloc(void *ptr)
+{
+   if (ptr != NULL) {
+      num_allocs++;
+      live_bytes += malloc_usable_size(ptr);
+      if (live_bytes > peak_bytes)
+	 peak_bytes = live_bytes;
+   }
+}
+
+static inline void
+track_free(void *ptr)
+{
+   if (ptr != NULL)
+      live_bytes -= malloc_usable_size(ptr);
+}
+
+extern "C" void *
+malloc(size_t size)
+{
+   void *ptr = __libc_malloc(size);
+   track_alloc(ptr);
+   return ptr;
+}
+
+extern "C" void *
+calloc(size_t nmemb, size_t size)
+{
+   void *ptr = __libc_calloc(nmemb, size);
+   track_alloc(ptr);
+   return ptr;
+}
+
+extern "C" void *
+realloc(void *ptr, size_t size)
+{
+   size_t old_size = ptr != NULL ? malloc_usable_size(ptr) : 0;
+   void *new_ptr = __libc_realloc(ptr, size);
+
+   /* On failure the old block is still live, unless it was a realloc to
+    * size 0, which frees it.
+    */
+   if (new_ptr != NULL || size == 0)
+      live_bytes -= old_size;
+   track_alloc(new_ptr);
+   return new_ptr;
+}
+
+extern "C" void
+free(void *ptr)
+{
+   track_free(ptr);
+   __libc_free(ptr);
+}
+#else
+/* Without a way to hook the allocator only times are reported. */
+static unsigned long num_allocs;
+static size_t live_bytes;
+static size_t peak_bytes;
+#endif
+
+enum phase {
+   PHASE_PREPROCESS,
+   PHASE_PARSE,
+   PHASE_AST_TO_HIR,
+   PHASE_OPTIMIZE,
+   PHASE_LINK,
+   NUM_PHASES
+};
+
+static const char *const phase_names[NUM_PHASES] = {
+   "glcpp",
+   "parse",
+   "ast_to_hir",
+   "do_common_optimization",
+   "link_shaders",
+};
+
+struct phase_stats {
+   double usec;
+   unsigned long allocs;
+   size_t peak_bytes;
+};
+
+struct phase_timer {
+   double start_usec;
+   unsigned long start_allocs;
+   size_t start_bytes;
+};
+
+static double
+get_usec(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static void
+phase_begin(struct phase_timer *t)
+{
+   t->start_allocs = num_allocs;
+   t->start_bytes = live_bytes;
+   peak_bytes = live_bytes;
+   t->start_usec = get_usec();
+}
+
+static void
+phase_end(const struct phase_timer *t, struct phase_stats *stats)
+{
+   stats->usec = get_usec() - t->start_usec;
+   stats->allocs = num_allocs - t->start_allocs;
+   stats->peak_bytes = peak_bytes - t->start_bytes;
+}
+
+/**
+ * Keep the fastest of several runs.
+ */
+static void
+merge_stats(struct phase_stats *best, const struct phase_stats *run, bool first)
+{
+   if (first || run->usec < best->usec)
+      *best = *run;
+}
+
+
+struct corpus_program {
+   std::string name;
+   std::vector<std::string> files;
+};
+
+static bool
+shader_type_for_file(const std::string &file, GLenum *type)
+{
+   if (file.size() < 6)
+      return false;
+
+   const std::string ext = file.substr(file.size() - 5);
+   if (ext == ".vert")
+      *type = GL_VERTEX_SHADER;
+   else if (ext == ".geom")
+      *type = GL_GEOMETRY_SHADER;
+   else if (ext == ".frag")
+      *type = GL_FRAGMENT_SHADER;
+   else
+      return false;
+
+   return true;
+}
+
+static void
+add_file(std::vector<corpus_program> &programs, const std::string &file)
+{
+   GLenum type;
+   if (!shader_type_for_file(file, &type))
+      return;
+
+   const std::string base = file.substr(0, file.size() - 5);
+   for (unsigned i = 0; i < programs.size(); i++) {
+      if (programs[i].name == base) {
+	 programs[i].files.push_back(file);
+	 return;
+      }
+   }
+
+   corpus_program p;
+   p.name = base;
+   p.files.push_back(file);
+   programs.push_back(p);
+}
+
+static void
+add_path(std::vector<corpus_program> &programs, const char *path)
+{
+   DIR *dir = opendir(path);
+   if (dir == NULL) {
+      add_file(programs, path);
+      return;
+   }
+
+   std::vector<std::string> files;
+   struct dirent *entry;
+   while ((entry = readdir(dir)) != NULL) {
+      if (entry->d_name[0] != '.')
+	 files.push_back(std::string(path) + "/" + entry->d_name);
+   }
+   closedir(dir);
+
+   /* Keep the output order independent of the file system. */
+   std::sort(files.begin(), files.end());
+   for (unsigned i = 0; i < files.size(); i++)
+      add_file(programs, files[i]);
+}
+
+static char *
+load_text_file(void *ctx, const char *file_name)
+{
+   FILE *fp = fopen(file_name, "rb");
+   if (fp == NULL)
+      return NULL;
+
+   fseek(fp, 0L, SEEK_END);
+   const long size = ftell(fp);
+   fseek(fp, 0L, SEEK_SET);
+
+   char *text = (char *) ralloc_size(ctx, size + 1);
+   const size_t bytes = fread(text, 1, size, fp);
+   text[bytes] = '\0';
+
+   fclose(fp);
+   return text;
+}
+
+
+/**
+ * Compile a shader the way main.cpp does, timing each phase.
+ */
+static void
+compile_shader(struct gl_context *ctx, struct gl_shader *shader,
+	       struct phase_stats *stats)
+{
+   struct phase_timer t;
+   void *arena = ralloc_arena_context(shader);
+   struct _mesa_glsl_parse_state *state =
+      new(arena) _mesa_glsl_parse_state(ctx, shader->Type, shader);
+   const char *source = shader->Source;
+
+   phase_begin(&t);
+   state->error = preprocess(state, &source, &state->info_log,
+			     state->extensions, ctx->API) != 0;
+   phase_end(&t, &stats[PHASE_PREPROCESS]);
+
+   phase_begin(&t);
+   if (!state->error) {
+      _mesa_glsl_lexer_ctor(state, source);
+      _mesa_glsl_parse(state);
+      _mesa_glsl_lexer_dtor(state);
+   }
+   phase_end(&t, &stats[PHASE_PARSE]);
+
+   phase_begin(&t);
+   shader->ir = new(shader) exec_list;
+   if (!state->error && !state->translation_unit.is_empty())
+      _mesa_ast_to_hir(shader->ir, state);
+   phase_end(&t, &stats[PHASE_AST_TO_HIR]);
+
+   phase_begin(&t);
+   if (!state->error && !shader->ir->is_empty()) {
+      while (do_common_optimization(shader->ir, false, 32))
+	 ;
+   }
+   phase_end(&t, &stats[PHASE_OPTIMIZE]);
+
+   shader->symbols = state->symbols;
+   shader->CompileStatus = !state->error;
+   shader->Version = state->language_version;
+   memcpy(shader->builtins_to_link, state->builtins_to_link,
+	  sizeof(shader->builtins_to_link[0]) * state->num_builtins_to_link);
+   shader->num_builtins_to_link = state->num_builtins_to_link;
+   shader->InfoLog = state->info_log;
+
+   _mesa_glsl_copy_ir_from_arena(shader);
+   ralloc_free(arena);
+}
+
+/**
+ * Compile and link one program.  Returns false if anything failed.
+ */
+static bool
+run_program(struct gl_context *ctx, const corpus_program &p,
+	    std::vector<phase_stats> &stats)
+{
+   struct gl_shader_program *prog = rzalloc(NULL, struct gl_shader_program);
+   bool ok = true;
+
+   prog->InfoLog = ralloc_strdup(prog, "");
+   prog->Shaders = ralloc_array(prog, struct gl_shader *, p.files.size());
+
+   for (unsigned i = 0; i < p.files.size(); i++) {
+      struct gl_shader *shader = rzalloc(prog, gl_shader);
+
+      shader_type_for_file(p.files[i], &shader->Type);
+      shader->Source = load_text_file(shader, p.files[i].c_str());
+      prog->Shaders[prog->NumShaders++] = shader;
+
+      if (shader->Source == NULL) {
+	 fprintf(stderr, "%s: can't read file\n", p.files[i].c_str());
+	 ok = false;
+	 continue;
+      }
+
+      compile_shader(ctx, shader, &stats[i * NUM_PHASES]);
+      if (!shader->CompileStatus) {
+	 fprintf(stderr, "%s: compile failed\n%s\n", p.files[i].c_str(),
+		 shader->InfoLog);
+	 ok = false;
+      }
+   }
+
+   struct phase_stats &link = stats[p.files.size() * NUM_PHASES];
+   memset(&link, 0, sizeof(link));
+   if (ok) {
+      struct phase_timer t;
+
+      phase_begin(&t);
+      link_shaders(ctx, prog);
+      phase_end(&t, &link);
+
+      if (!prog->LinkStatus) {
+	 fprintf(stderr, "%s: link failed\n%s\n", p.name.c_str(),
+		 prog->InfoLog);
+	 ok = false;
+      }
+   }
+
+   for (unsigned i = 0; i < MESA_SHADER_TYPES; i++)
+      ralloc_free(prog->_LinkedShaders[i]);
+   ralloc_free(prog);
+
+   return ok;
+}
+
+static void
+print_row(const char *name, const char *phase, const struct phase_stats *s)
+{
+   printf("%s,%s,%.1f,%lu,%lu\n", name, phase, s->usec, s->allocs,
+	  (unsigned long) s->peak_bytes);
+}
+
+
+int glsl_es = 0;
+int repeat = 1;
+
+static void
+usage_fail(const char *name)
+{
+   printf("usage: %s [--glsl-es] [--repeat N] <directory | shader file>...\n",
+	  name);
+   exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+   static const struct option opts[] = {
+      { "glsl-es", 0, &glsl_es, 1 },
+      { "repeat",  1, NULL,    'r' },
+      { NULL, 0, NULL, 0 }
+   };
+   struct gl_context local_ctx;
+   struct gl_context *ctx = &local_ctx;
+   int status = EXIT_SUCCESS;
+   int c;
+
+   while ((c = getopt_long(argc, argv, "", opts, NULL)) != -1) {
+      if (c == 'r')
+	 repeat = MAX2(atoi(optarg), 1);
+      else if (c == '?')
+	 usage_fail(argv[0]);
+   }
+
+   if (argc <= optind)
+      usage_fail(argv[0]);
+
+   std::vector<corpus_program> programs;
+   for (int i = optind; i < argc; i++)
+      add_path(programs, argv[i]);
+
+   initialize_context_to_defaults(ctx, glsl_es ? API_OPENGLES2 : API_OPENGL);
+   ctx->Const.GLSLVersion = 130;
+   ctx->Const.MaxClipPlanes = 8;
+   ctx->Const.MaxDrawBuffers = 2;
+   ctx->Const.MaxTextureCoordUnits = 4;
+   ctx->Driver.NewShader = _mesa_new_shader;
+
+   struct phase_stats totals[NUM_PHASES];
+   memset(totals, 0, sizeof(totals));
+
+   printf("shader,phase,usec,allocs,peak_bytes\n");
+
+   for (unsigned i = 0; i < programs.size(); i++) {
+      const corpus_program &p = programs[i];
+      const unsigned count = p.files.size() * NUM_PHASES + 1;
+      std::vector<phase_stats> best(count), run(count);
+      bool ok = true;
+
+      for (int r = 0; r < repeat && ok; r++) {
+	 ok = run_program(ctx, p, run);
+	 for (unsigned j = 0; j < count; j++)
+	    merge_stats(&best[j], &run[j], r == 0);
+      }
+
+      if (!ok) {
+	 status = EXIT_FAILURE;
+	 continue;
+      }
+
+      for (unsigned f = 0; f < p.files.size(); f++) {
+	 for (unsigned ph = 0; ph < PHASE_LINK; ph++) {
+	    const struct phase_stats *s = &best[f * NUM_PHASES + ph];
+	    print_row(p.files[f].c_str(), phase_names[ph], s);
+
+	    totals[ph].usec += s->usec;
+	    totals[ph].allocs += s->allocs;
+	    totals[ph].peak_bytes = MAX2(totals[ph].peak_bytes, s->peak_bytes);
+	 }
+      }
+
+      const struct phase_stats *link = &best[p.files.size() * NUM_PHASES];
+      print_row(p.name.c_str(), phase_names[PHASE_LINK], link);
+      totals[PHASE_LINK].usec += link->usec;
+      totals[PHASE_LINK].allocs += link->allocs;
+      totals[PHASE_LINK].peak_bytes = MAX2(totals[PHASE_LINK].peak_bytes,
+					   link->peak_bytes);
+   }
+
+   /* Times and allocations are summed, peaks are the largest seen. */
+   for (unsigned ph = 0; ph < NUM_PHASES; ph++)
+      print_row("TOTAL", phase_names[ph], &totals[ph]);
+
+   _mesa_glsl_release_types();
+   _mesa_glsl_release_functions();
+
+   return status;
+}
@@ -35,6 +35,7 @@ extern "C" {
 #include "glsl_parser.h"
 #include "ir_optimization.h"
 #include "loop_analysis.h"
+#include "linker.h"
 
 _mesa_glsl_parse_state::_mesa_glsl_parse_state(struct gl_context *ctx,
 					       GLenum target, void *mem_ctx)
@@ -929,6 +930,19 @@ do_common_optimization(exec_list *ir, bool linked, unsigned max_unroll_iteration
    return progress;
 }
 
+void
+_mesa_glsl_copy_ir_from_arena(struct gl_shader *shader)
+{
+   exec_list *ir = new(shader) exec_list;
+
+   clone_ir_list(ir, ir, shader->ir);
+   ralloc_free(shader->ir);
+   shader->ir = ir;
+
+   ralloc_free(shader->symbols);
+   populate_symbol_table(shader);
+}
+
 extern "C" {
 
 /**
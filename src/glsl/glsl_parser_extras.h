@@ -266,6 +266,17 @@ extern bool _mesa_glsl_process_extension(const char *name, YYLTYPE *name_locp,
 extern const char *
 _mesa_glsl_shader_target_name(enum _mesa_glsl_parser_targets target);
 
+/**
+ * Replace the IR of a shader compiled in an arena context by a copy
+ * allocated outside of it.
+ *
+ * Stealing the live IR would keep every arena chunk it lives in allocated
+ * for the lifetime of the shader.  The symbol table is rebuilt to refer to
+ * the copy.
+ */
+extern void
+_mesa_glsl_copy_ir_from_arena(struct gl_shader *shader);
+
 
 #endif /* __cplusplus */
 
@@ -36,6 +36,11 @@ hash_table *glsl_type::array_types = NULL;
 hash_table *glsl_type::record_types = NULL;
 void *glsl_type::mem_ctx = NULL;
 
+/* Shaders may be compiled on several threads at once (MESA_GLSL=async), so
+ * the tables of array and record types are guarded by this mutex.
+ */
+_glthread_DECLARE_STATIC_MUTEX(glsl_type_mutex);
+
 void
 glsl_type::init_ralloc_type_ctx(void)
 {
@@ -364,6 +369,7 @@ glsl_type::get_instance(unsigned base_type, unsigned rows, unsigned columns)
 const glsl_type *
 glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
 {
+   _glthread_LOCK_MUTEX(glsl_type_mutex);
 
    if (array_types == NULL) {
       array_types = hash_table_ctor(64, hash_table_string_hash,
@@ -385,6 +391,8 @@ glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
       hash_table_insert(array_types, (void *) t, ralloc_strdup(mem_ctx, key));
    }
 
+   _glthread_UNLOCK_MUTEX(glsl_type_mutex);
+
    assert(t->base_type == GLSL_TYPE_ARRAY);
    assert(t->length == array_size);
    assert(t->fields.array == base);
@@ -446,6 +454,8 @@ glsl_type::get_record_instance(const glsl_struct_field *fields,
 			       unsigned num_fields,
 			       const char *name)
 {
+   _glthread_LOCK_MUTEX(glsl_type_mutex);
+
    const glsl_type key(fields, num_fields, name);
 
    if (record_types == NULL) {
@@ -459,6 +469,8 @@ glsl_type::get_record_instance(const glsl_struct_field *fields,
       hash_table_insert(record_types, (void *) t, t);
    }
 
+   _glthread_UNLOCK_MUTEX(glsl_type_mutex);
+
    assert(t->base_type == GLSL_TYPE_STRUCT);
    assert(t->length == num_fields);
    assert(strcmp(t->name, name) == 0);
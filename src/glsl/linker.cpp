@@ -71,6 +71,7 @@
 #include "program/hash_table.h"
 #include "linker.h"
 #include "ir_optimization.h"
+#include "glsl_parser_extras.h"
 
 extern "C" {
 #include "main/shaderobj.h"
@@ -624,7 +625,7 @@ cross_validate_outputs_to_inputs(struct gl_shader_program *prog,
 /**
  * Populates a shaders symbol table with all global declarations
  */
-static void
+void
 populate_symbol_table(gl_shader *sh)
 {
    sh->symbols = new(sh) glsl_symbol_table;
@@ -889,7 +890,11 @@ link_intrastage_shaders(void *mem_ctx,
       return NULL;
    }
 
-   gl_shader *linked = ctx->Driver.NewShader(NULL, 0, main->Type);
+   /* This is a plain gl_shader rather than a driver shader object, so that
+    * linking doesn't call into the driver and may run on another thread.
+    * The caller replaces it with a driver shader once linking is done.
+    */
+   gl_shader *linked = _mesa_new_shader(NULL, 0, main->Type);
    linked->ir = new(linked) exec_list;
    clone_ir_list(mem_ctx, linked->ir, main->ir);
 
@@ -938,7 +943,7 @@ link_intrastage_shaders(void *mem_ctx,
 
    if (!link_function_calls(prog, linked, linking_shaders,
 			    num_linking_shaders)) {
-      ctx->Driver.DeleteShader(ctx, linked);
+      ralloc_free(linked);
       linked = NULL;
    }
 
@@ -1606,7 +1611,7 @@ assign_varying_locations(struct gl_context *ctx,
 void
 link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
 {
-   void *mem_ctx = ralloc_context(NULL); // temporary linker context
+   void *mem_ctx = ralloc_arena_context(NULL); // temporary linker context
 
    prog->LinkStatus = false;
    prog->Validated = false;
@@ -1665,12 +1670,9 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
 
    prog->Version = max_version;
 
-   for (unsigned int i = 0; i < MESA_SHADER_TYPES; i++) {
-      if (prog->_LinkedShaders[i] != NULL)
-	 ctx->Driver.DeleteShader(ctx, prog->_LinkedShaders[i]);
-
-      prog->_LinkedShaders[i] = NULL;
-   }
+   /* The caller released the results of any previous link. */
+   for (unsigned int i = 0; i < MESA_SHADER_TYPES; i++)
+      assert(prog->_LinkedShaders[i] == NULL);
 
    /* Link all shaders for a particular stage and validate the result.
     */
@@ -1830,7 +1832,7 @@ done:
 	 continue;
 
       /* Retain any live IR, but trash the rest. */
-      reparent_ir(prog->_LinkedShaders[i]->ir, prog->_LinkedShaders[i]->ir);
+      _mesa_glsl_copy_ir_from_arena(prog->_LinkedShaders[i]);
    }
 
    ralloc_free(mem_ctx);
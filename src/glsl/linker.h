@@ -29,4 +29,7 @@ extern bool
 link_function_calls(gl_shader_program *prog, gl_shader *main,
 		    gl_shader **shader_list, unsigned num_shaders);
 
+extern void
+populate_symbol_table(gl_shader *sh);
+
 #endif /* GLSL_LINKER_H */
@@ -131,8 +131,9 @@ usage_fail(const char *name)
 void
 compile_shader(struct gl_context *ctx, struct gl_shader *shader)
 {
+   void *arena = ralloc_arena_context(shader);
    struct _mesa_glsl_parse_state *state =
-      new(shader) _mesa_glsl_parse_state(ctx, shader->Type, shader);
+      new(arena) _mesa_glsl_parse_state(ctx, shader->Type, shader);
 
    const char *source = shader->Source;
    state->error = preprocess(state, &source, &state->info_log,
@@ -191,9 +192,9 @@ compile_shader(struct gl_context *ctx, struct gl_shader *shader)
    shader->InfoLog = state->info_log;
 
    /* Retain any live IR, but trash the rest. */
-   reparent_ir(shader->ir, shader);
+   _mesa_glsl_copy_ir_from_arena(shader);
 
-   ralloc_free(state);
+   ralloc_free(arena);
 
    return;
 }
@@ -53,6 +53,15 @@
 
 #define CANARY 0x5A1106
 
+/* Canary of the blocks preceded by a ralloc_arena_header. */
+#define ARENA_CANARY 0x5A1107
+
+/* Arena contexts carve their descendants out of chunks of this size.
+ * Anything larger than a quarter of a chunk is allocated separately.
+ */
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN(x) (((x) + 7) & ~((size_t) 7))
+
 struct ralloc_header
 {
    /* A canary value used to determine whether a pointer is ralloc'd. */
@@ -72,19 +81,186 @@ struct ralloc_header
 
 typedef struct ralloc_header ralloc_header;
 
+struct ralloc_arena
+{
+   /* Number of blocks allocating their children from this arena, plus one
+    * for every chunk that still holds blocks.
+    */
+   unsigned refcount;
+
+   /* The arena context the arena was created with. */
+   ralloc_header *context;
+
+   /* The chunk new allocations are carved from. */
+   struct ralloc_chunk *current;
+};
+
+struct ralloc_chunk
+{
+   struct ralloc_arena *arena;
+
+   /* Number of blocks still living in this chunk. */
+   unsigned live;
+
+   size_t used;
+   size_t size;
+};
+
+/* The arena bookkeeping of a block allocated out of an arena, or of an
+ * arena context, stored right before its ralloc_header.  Other blocks
+ * don't have one.
+ */
+struct ralloc_arena_header
+{
+   /* The arena new children are allocated from, or NULL. */
+   struct ralloc_arena *arena;
+
+   /* The arena chunk holding this block, or NULL if it was malloc'd. */
+   struct ralloc_chunk *chunk;
+
+   /* Size of the block. */
+   size_t size;
+};
+
+#define HEADER_SIZE ARENA_ALIGN(sizeof(ralloc_header))
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(struct ralloc_arena_header))
+#define ARENA_BLOCK_SIZE(size) \
+   ARENA_ALIGN(ARENA_HEADER_SIZE + HEADER_SIZE + (size))
+
+#define ARENA_HEADER(info) \
+   ((struct ralloc_arena_header *) (((char *) (info)) - ARENA_HEADER_SIZE))
+#define HEADER_FROM_ARENA_HEADER(ainfo) \
+   ((ralloc_header *) (((char *) (ainfo)) + ARENA_HEADER_SIZE))
+#define CHUNK_DATA(chunk) \
+   (((char *) (chunk)) + ARENA_ALIGN(sizeof(struct ralloc_chunk)))
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
 static ralloc_header *
 get_header(const void *ptr)
 {
-   ralloc_header *info = (ralloc_header *) (((char *) ptr) -
-					    sizeof(ralloc_header));
-   assert(info->canary == CANARY);
+   ralloc_header *info = (ralloc_header *) (((char *) ptr) - HEADER_SIZE);
+   assert(info->canary == CANARY || info->canary == ARENA_CANARY);
    return info;
 }
 
-#define PTR_FROM_HEADER(info) (((char *) info) + sizeof(ralloc_header))
+#define PTR_FROM_HEADER(info) (((char *) info) + HEADER_SIZE)
+
+/* The arena the children of a block are allocated from, or NULL. */
+static struct ralloc_arena *
+child_arena(const ralloc_header *info)
+{
+   if (info->canary != ARENA_CANARY)
+      return NULL;
+   return ARENA_HEADER(info)->arena;
+}
+
+/* Allocate the storage of a block out of an arena.  The caller sets the
+ * arena its children are allocated from.
+ */
+static struct ralloc_arena_header *
+arena_alloc(struct ralloc_arena *arena, size_t size)
+{
+   size_t total = ARENA_BLOCK_SIZE(size);
+   struct ralloc_chunk *chunk = arena->current;
+   struct ralloc_arena_header *ainfo;
+
+   if (unlikely(total > ARENA_CHUNK_SIZE / 4)) {
+      /* Large blocks get their own allocation. */
+      ainfo = calloc(1, ARENA_HEADER_SIZE + HEADER_SIZE + size);
+      if (unlikely(ainfo == NULL))
+	 return NULL;
+   } else {
+      if (chunk == NULL || chunk->used + total > chunk->size) {
+	 chunk = malloc(ARENA_ALIGN(sizeof(struct ralloc_chunk)) +
+			ARENA_CHUNK_SIZE);
+	 if (unlikely(chunk == NULL))
+	    return NULL;
+
+	 chunk->arena = arena;
+	 chunk->live = 0;
+	 chunk->used = 0;
+	 chunk->size = ARENA_CHUNK_SIZE;
+
+	 /* A retired chunk is freed by its last block, if it has any. */
+	 if (arena->current != NULL && arena->current->live == 0)
+	    free(arena->current);
+	 arena->current = chunk;
+      }
+
+      ainfo = (struct ralloc_arena_header *) (CHUNK_DATA(chunk) + chunk->used);
+      memset(ainfo, 0, total);
+      chunk->used += total;
+      if (chunk->live++ == 0)
+	 arena->refcount++;
+
+      ainfo->chunk = chunk;
+   }
+
+   ainfo->size = size;
+   return ainfo;
+}
+
+static void
+arena_unref(struct ralloc_arena *arena)
+{
+   if (--arena->refcount == 0) {
+      /* Every other chunk was freed when its last block went away. */
+      assert(arena->current == NULL || arena->current->live == 0);
+      free(arena->current);
+      free(arena);
+   }
+}
+
+/* Return a chunk-resident block's storage to its chunk. */
+static void
+chunk_release(struct ralloc_arena_header *ainfo)
+{
+   struct ralloc_chunk *chunk = ainfo->chunk;
+   struct ralloc_arena *arena = chunk->arena;
+   char *end = ((char *) ainfo) + ARENA_BLOCK_SIZE(ainfo->size);
+
+   /* Hand the space back if this was the most recent allocation. */
+   if (end == CHUNK_DATA(chunk) + chunk->used)
+      chunk->used = ((char *) ainfo) - CHUNK_DATA(chunk);
+
+   if (--chunk->live == 0) {
+      if (chunk == arena->current)
+	 chunk->used = 0;
+      else
+	 free(chunk);
+      arena_unref(arena);
+   }
+}
+
+/* Free a block's own storage, wherever it came from. */
+static void
+release_block(ralloc_header *info)
+{
+   struct ralloc_arena_header *ainfo;
+   struct ralloc_arena *arena;
+
+   if (info->canary != ARENA_CANARY) {
+      free(info);
+      return;
+   }
+
+   ainfo = ARENA_HEADER(info);
+   arena = ainfo->arena;
+
+   /* Blocks stolen out of the arena may keep it alive. */
+   if (arena != NULL && arena->context == info)
+      arena->context = NULL;
+
+   if (ainfo->chunk != NULL)
+      chunk_release(ainfo);
+   else
+      free(ainfo);
+
+   if (arena != NULL)
+      arena_unref(arena);
+}
 
 static void
 add_child(ralloc_header *parent, ralloc_header *info)
@@ -106,16 +282,60 @@ ralloc_context(const void *ctx)
 }
 
 void *
-ralloc_size(const void *ctx, size_t size)
+ralloc_arena_context(const void *ctx)
 {
-   void *block = calloc(1, size + sizeof(ralloc_header));
-
-   ralloc_header *info = (ralloc_header *) block;
+   struct ralloc_arena_header *ainfo;
+   ralloc_header *info;
    ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+   struct ralloc_arena *arena = calloc(1, sizeof(struct ralloc_arena));
+
+   if (unlikely(arena == NULL))
+      return NULL;
+
+   ainfo = calloc(1, ARENA_HEADER_SIZE + HEADER_SIZE);
+   if (unlikely(ainfo == NULL)) {
+      free(arena);
+      return NULL;
+   }
 
+   info = HEADER_FROM_ARENA_HEADER(ainfo);
    add_child(parent, info);
 
-   info->canary = CANARY;
+   info->canary = ARENA_CANARY;
+   ainfo->arena = arena;
+   arena->refcount = 1;
+   arena->context = info;
+
+   return PTR_FROM_HEADER(info);
+}
+
+void *
+ralloc_size(const void *ctx, size_t size)
+{
+   ralloc_header *info;
+   ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+   struct ralloc_arena *arena = parent != NULL ? child_arena(parent) : NULL;
+
+   if (arena != NULL) {
+      struct ralloc_arena_header *ainfo = arena_alloc(arena, size);
+      if (unlikely(ainfo == NULL))
+	 return NULL;
+
+      /* Its children come from the same arena. */
+      ainfo->arena = arena;
+      arena->refcount++;
+
+      info = HEADER_FROM_ARENA_HEADER(ainfo);
+      info->canary = ARENA_CANARY;
+   } else {
+      info = calloc(1, size + HEADER_SIZE);
+      if (unlikely(info == NULL))
+	 return NULL;
+
+      info->canary = CANARY;
+   }
+
+   add_child(parent, info);
 
    return PTR_FROM_HEADER(info);
 }
@@ -129,6 +349,43 @@ rzalloc_size(const void *ctx, size_t size)
    return ptr;
 }
 
+/* helper function for resizing a block living in an arena chunk */
+static ralloc_header *
+arena_resize(ralloc_header *old, size_t size)
+{
+   struct ralloc_arena_header *old_ainfo = ARENA_HEADER(old);
+   struct ralloc_chunk *chunk = old_ainfo->chunk;
+   char *start = (char *) old_ainfo;
+   char *end = start + ARENA_BLOCK_SIZE(old_ainfo->size);
+   size_t offset = start - CHUNK_DATA(chunk);
+   size_t total = ARENA_BLOCK_SIZE(size);
+   struct ralloc_arena_header *ainfo;
+   ralloc_header *info;
+
+   /* The most recent allocation of a chunk can simply grow in place. */
+   if (end == CHUNK_DATA(chunk) + chunk->used && offset + total <= chunk->size) {
+      chunk->used = offset + total;
+      old_ainfo->size = size;
+      return old;
+   }
+
+   ainfo = arena_alloc(chunk->arena, size);
+   if (unlikely(ainfo == NULL))
+      return NULL;
+
+   info = HEADER_FROM_ARENA_HEADER(ainfo);
+   memcpy(PTR_FROM_HEADER(info), PTR_FROM_HEADER(old),
+	  old_ainfo->size < size ? old_ainfo->size : size);
+
+   /* The new block takes over the reference to the children's arena. */
+   ainfo->arena = old_ainfo->arena;
+   *info = *old;
+
+   chunk_release(old_ainfo);
+
+   return info;
+}
+
 /* helper function - assumes ptr != NULL */
 static void *
 resize(void *ptr, size_t size)
@@ -136,7 +393,17 @@ resize(void *ptr, size_t size)
    ralloc_header *child, *old, *info;
 
    old = get_header(ptr);
-   info = realloc(old, size + sizeof(ralloc_header));
+   if (old->canary != ARENA_CANARY) {
+      info = realloc(old, size + HEADER_SIZE);
+   } else if (ARENA_HEADER(old)->chunk != NULL) {
+      info = arena_resize(old, size);
+   } else {
+      struct ralloc_arena_header *ainfo =
+	 realloc(ARENA_HEADER(old), ARENA_HEADER_SIZE + HEADER_SIZE + size);
+      if (ainfo != NULL)
+	 ainfo->size = size;
+      info = ainfo != NULL ? HEADER_FROM_ARENA_HEADER(ainfo) : NULL;
+   }
 
    if (info == NULL)
       return NULL;
@@ -244,7 +511,7 @@ unsafe_free(ralloc_header *info)
    if (info->destructor != NULL)
       info->destructor(PTR_FROM_HEADER(info));
 
-   free(info);
+   release_block(info);
 }
 
 void
@@ -261,6 +528,22 @@ ralloc_steal(const void *new_ctx, void *ptr)
    unlink_block(info);
 
    add_child(parent, info);
+
+   /* New children of the block follow its new context, unless it is an
+    * arena context itself.
+    */
+   if (info->canary == ARENA_CANARY) {
+      struct ralloc_arena_header *ainfo = ARENA_HEADER(info);
+      struct ralloc_arena *arena = child_arena(parent);
+
+      if (ainfo->arena == NULL || ainfo->arena->context != info) {
+	 if (arena != NULL)
+	    arena->refcount++;
+	 if (ainfo->arena != NULL)
+	    arena_unref(ainfo->arena);
+	 ainfo->arena = arena;
+      }
+   }
 }
 
 void *
@@ -90,6 +90,21 @@ extern "C" {
  */
 void *ralloc_context(const void *ctx);
 
+/**
+ * Allocate a new arena-backed ralloc context.
+ *
+ * Every allocation made under the returned context (directly or through any
+ * of its descendants) is carved out of large chunks rather than getting its
+ * own \c malloc, which makes the many tiny allocations of a compiler pass
+ * much cheaper.  Freeing the context releases the chunks in bulk.
+ *
+ * ralloc_free, ralloc_steal and the resize functions keep working as usual.
+ * A block stolen out of the arena keeps the chunk it lives in allocated
+ * until the block itself is freed, and allocates its new children the way
+ * its new context does.  Blocks below it keep allocating from the arena.
+ */
+void *ralloc_arena_context(const void *ctx);
+
 /**
  * Allocate memory chained off of the given context.
  *
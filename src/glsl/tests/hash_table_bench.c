@@ -0,0 +1,307 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file hash_table_bench.c
+ * Micro-benchmark of program/hash_table.c against the fixed-size chained
+ * table it replaced.
+ *
+ * Each workload mirrors a compiler use: pointer keys (ir_variable_refcount,
+ * copy propagation, ir_validate) and string keys (glcpp macros, the symbol
+ * table), with the bucket count the callers pass to hash_table_ctor.
+ * The tables are also cross-checked against each other.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "program/hash_table.h"
+
+
+/* The chained implementation, as it was before the switch to open
+ * addressing.
+ */
+struct chained_node {
+   struct chained_node *next;
+   const void *key;
+   void *data;
+};
+
+struct chained_table {
+   hash_func_t hash;
+   hash_compare_func_t compare;
+   unsigned num_buckets;
+   struct chained_node **buckets;
+};
+
+static struct chained_table *
+chained_ctor(unsigned num_buckets, hash_func_t hash,
+             hash_compare_func_t compare)
+{
+   struct chained_table *ht = malloc(sizeof(*ht));
+
+   if (num_buckets < 16)
+      num_buckets = 16;
+
+   ht->hash = hash;
+   ht->compare = compare;
+   ht->num_buckets = num_buckets;
+   ht->buckets = calloc(num_buckets, sizeof(*ht->buckets));
+   return ht;
+}
+
+static void
+chained_dtor(struct chained_table *ht)
+{
+   unsigned i;
+
+   for (i = 0; i < ht->num_buckets; i++) {
+      struct chained_node *node = ht->buckets[i];
+      while (node != NULL) {
+         struct chained_node *next = node->next;
+         free(node);
+         node = next;
+      }
+   }
+   free(ht->buckets);
+   free(ht);
+}
+
+static void *
+chained_find(struct chained_table *ht, const void *key)
+{
+   const unsigned bucket = ht->hash(key) % ht->num_buckets;
+   struct chained_node *node;
+
+   for (node = ht->buckets[bucket]; node != NULL; node = node->next) {
+      if (ht->compare(node->key, key) == 0)
+         return node->data;
+   }
+   return NULL;
+}
+
+static void
+chained_insert(struct chained_table *ht, void *data, const void *key)
+{
+   const unsigned bucket = ht->hash(key) % ht->num_buckets;
+   struct chained_node *node = calloc(1, sizeof(*node));
+
+   node->key = key;
+   node->data = data;
+   node->next = ht->buckets[bucket];
+   ht->buckets[bucket] = node;
+}
+
+static void
+chained_remove(struct chained_table *ht, const void *key)
+{
+   const unsigned bucket = ht->hash(key) % ht->num_buckets;
+   struct chained_node **prev = &ht->buckets[bucket];
+
+   for (; *prev != NULL; prev = &(*prev)->next) {
+      if (ht->compare((*prev)->key, key) == 0) {
+         struct chained_node *node = *prev;
+         *prev = node->next;
+         free(node);
+         return;
+      }
+   }
+}
+
+
+static double
+get_time(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+struct workload {
+   const char *name;
+   unsigned num_buckets;
+   unsigned num_keys;
+   int string_keys;
+};
+
+static const struct workload workloads[] = {
+   { "pointer, 100 keys",        0,   100, 0 },
+   { "pointer, 10000 keys",      0, 10000, 0 },
+   { "pointer, 30000 keys",      0, 30000, 0 },
+   { "string, 100 keys",        32,   100, 1 },
+   { "string, 10000 keys",      32, 10000, 1 },
+};
+
+
+/**
+ * Insert all keys, look each of them up a few times plus as many misses,
+ * then remove half of them.  Returns a checksum of the lookups.
+ */
+static uintptr_t
+run_new(const struct workload *w, void **keys, void **misses)
+{
+   struct hash_table *ht;
+   uintptr_t sum = 0;
+   unsigned i, pass;
+
+   ht = w->string_keys
+      ? hash_table_ctor(w->num_buckets, hash_table_string_hash,
+                        hash_table_string_compare)
+      : hash_table_ctor(w->num_buckets, hash_table_pointer_hash,
+                        hash_table_pointer_compare);
+
+   for (i = 0; i < w->num_keys; i++)
+      hash_table_insert(ht, (void *) (uintptr_t) (i + 1), keys[i]);
+
+   for (pass = 0; pass < 4; pass++) {
+      for (i = 0; i < w->num_keys; i++) {
+         sum += (uintptr_t) hash_table_find(ht, keys[i]);
+         sum += (uintptr_t) hash_table_find(ht, misses[i]);
+      }
+   }
+
+   for (i = 0; i < w->num_keys; i += 2)
+      hash_table_remove(ht, keys[i]);
+
+   for (i = 0; i < w->num_keys; i++)
+      sum += (uintptr_t) hash_table_find(ht, keys[i]);
+
+   hash_table_dtor(ht);
+   return sum;
+}
+
+static uintptr_t
+run_chained(const struct workload *w, void **keys, void **misses)
+{
+   struct chained_table *ht;
+   uintptr_t sum = 0;
+   unsigned i, pass;
+
+   ht = w->string_keys
+      ? chained_ctor(w->num_buckets, hash_table_string_hash,
+                     hash_table_string_compare)
+      : chained_ctor(w->num_buckets, hash_table_pointer_hash,
+                     hash_table_pointer_compare);
+
+   for (i = 0; i < w->num_keys; i++)
+      chained_insert(ht, (void *) (uintptr_t) (i + 1), keys[i]);
+
+   for (pass = 0; pass < 4; pass++) {
+      for (i = 0; i < w->num_keys; i++) {
+         sum += (uintptr_t) chained_find(ht, keys[i]);
+         sum += (uintptr_t) chained_find(ht, misses[i]);
+      }
+   }
+
+   for (i = 0; i < w->num_keys; i += 2)
+      chained_remove(ht, keys[i]);
+
+   for (i = 0; i < w->num_keys; i++)
+      sum += (uintptr_t) chained_find(ht, keys[i]);
+
+   chained_dtor(ht);
+   return sum;
+}
+
+
+static void **
+make_keys(const struct workload *w, const char *prefix)
+{
+   void **keys = malloc(w->num_keys * sizeof(*keys));
+   unsigned i;
+
+   for (i = 0; i < w->num_keys; i++) {
+      if (w->string_keys) {
+         char *str = malloc(32);
+         snprintf(str, 32, "%s_var%u", prefix, i);
+         keys[i] = str;
+      } else {
+         /* Small allocations, like the IR nodes used as keys. */
+         keys[i] = malloc(48);
+      }
+   }
+
+   return keys;
+}
+
+static void
+free_keys(const struct workload *w, void **keys)
+{
+   unsigned i;
+
+   for (i = 0; i < w->num_keys; i++)
+      free(keys[i]);
+   free(keys);
+}
+
+
+int
+main(int argc, char **argv)
+{
+   unsigned i;
+   int fail = 0;
+
+   (void) argc;
+   (void) argv;
+
+   printf("%-24s %12s %12s %8s\n", "workload", "chained (s)", "open (s)",
+          "speedup");
+
+   for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+      const struct workload *w = &workloads[i];
+      void **keys = make_keys(w, "in");
+      void **misses = make_keys(w, "out");
+      const unsigned reps = 20000 / w->num_keys + 1;
+      uintptr_t sum_chained = 0, sum_new = 0;
+      double t0, t_chained, t_new;
+      unsigned rep;
+
+      t0 = get_time();
+      for (rep = 0; rep < reps; rep++)
+         sum_chained += run_chained(w, keys, misses);
+      t_chained = get_time() - t0;
+
+      t0 = get_time();
+      for (rep = 0; rep < reps; rep++)
+         sum_new += run_new(w, keys, misses);
+      t_new = get_time() - t0;
+
+      printf("%-24s %12.4f %12.4f %7.2fx\n", w->name, t_chained, t_new,
+             t_chained / t_new);
+
+      if (sum_chained != sum_new) {
+         printf("  MISMATCH: lookups returned different results\n");
+         fail = 1;
+      }
+
+      free_keys(w, keys);
+      free_keys(w, misses);
+   }
+
+   return fail;
+}
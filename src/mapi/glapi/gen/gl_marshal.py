@@ -0,0 +1,571 @@
+#!/usr/bin/python2
+
+# Copyright 2026 agent <agent@local>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Generate the marshalling code used by the threaded dispatch
+(main/glthread.c).
+
+For every GL function this emits a command structure, a marshal function
+that is installed in the application thread's dispatch table and records
+the call in the current batch, and an unmarshal function that the worker
+thread uses to replay it through the context's real dispatch table.
+
+A call is queued without waiting whenever everything it needs can be
+copied into the command: scalar arguments and arrays whose size the XML
+describes.  Anything else (return values, output parameters, pointers of
+unknown size) waits for the worker to execute the call, so the caller's
+memory stays valid for as long as the driver looks at it.
+"""
+
+import gl_XML
+import license
+import sys, getopt, re
+
+
+# Functions whose pointer arguments are not dereferenced during the call:
+# they are either offsets into a buffer object or client memory that is
+# only read when drawing.  The pointer is passed on as a value.
+pointer_by_value = set([
+	'ColorPointer',
+	'ColorPointerEXT',
+	'EdgeFlagPointer',
+	'EdgeFlagPointerEXT',
+	'FogCoordPointerEXT',
+	'IndexPointer',
+	'IndexPointerEXT',
+	'InterleavedArrays',
+	'NormalPointer',
+	'NormalPointerEXT',
+	'SecondaryColorPointerEXT',
+	'TexCoordPointer',
+	'TexCoordPointerEXT',
+	'VertexAttribIPointerEXT',
+	'VertexAttribPointerARB',
+	'VertexAttribPointerNV',
+	'VertexPointer',
+	'VertexPointerEXT',
+
+	'DrawElements',
+	'DrawElementsBaseVertex',
+	'DrawElementsInstancedARB',
+	'DrawElementsInstancedBaseVertex',
+	'DrawRangeElements',
+	'DrawRangeElementsBaseVertex',
+])
+
+
+# Calls that read vertex arrays.  They have to wait for the worker when
+# the arrays (or the indices) live in client memory, since the application
+# may change that memory as soon as the call returns.
+draw_arrays = set([
+	'ArrayElement',
+	'DrawArrays',
+	'DrawArraysInstancedARB',
+	'DrawTransformFeedback',
+	'MultiDrawArraysEXT',
+])
+
+draw_elements = set([
+	'DrawElements',
+	'DrawElementsBaseVertex',
+	'DrawElementsInstancedARB',
+	'DrawElementsInstancedBaseVertex',
+	'DrawRangeElements',
+	'DrawRangeElementsBaseVertex',
+	'MultiDrawElementsBaseVertex',
+	'MultiDrawElementsEXT',
+])
+
+
+# Calls that always wait even though they could be queued.  The pixel
+# functions read from a pixel unpack buffer when one is bound, in which
+# case their pointer is an offset that can't be copied.
+always_sync = set([
+	'CompressedTexImage1DARB',
+	'CompressedTexImage2DARB',
+	'CompressedTexImage3DARB',
+	'CompressedTexSubImage1DARB',
+	'CompressedTexSubImage2DARB',
+	'CompressedTexSubImage3DARB',
+	'Finish',
+	'PixelMapfv',
+	'PixelMapuiv',
+	'PixelMapusv',
+])
+
+
+# Code run on the application thread after the call has been marshalled,
+# to keep glthread's view of the vertex array state up to date.
+call_after = {
+	'ColorPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_COLOR, pointer);',
+	'ColorPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_COLOR, pointer);',
+	'EdgeFlagPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_EDGEFLAG, pointer);',
+	'EdgeFlagPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_EDGEFLAG, pointer);',
+	'FogCoordPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_FOGCOORD, pointer);',
+	'IndexPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_INDEX, pointer);',
+	'IndexPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_INDEX, pointer);',
+	'NormalPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_NORMAL, pointer);',
+	'NormalPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_NORMAL, pointer);',
+	'SecondaryColorPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_COLOR2, pointer);',
+	'TexCoordPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_TEXCOORD(ctx->GLThread->ClientActiveTexture), pointer);',
+	'TexCoordPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_TEXCOORD(ctx->GLThread->ClientActiveTexture), pointer);',
+	'VertexAttribIPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_GENERIC(index), pointer);',
+	'VertexAttribPointerARB':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_GENERIC(index), pointer);',
+	'VertexAttribPointerNV':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_GENERIC(index), pointer);',
+	'VertexPointer':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_VERTEX, pointer);',
+	'VertexPointerEXT':
+		'_mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_VERTEX, pointer);',
+	'InterleavedArrays':
+		'_mesa_glthread_InterleavedArrays(ctx, format, pointer);',
+
+	'Enable':
+		'_mesa_glthread_ClientState(ctx, cap, GL_TRUE);',
+	'Disable':
+		'_mesa_glthread_ClientState(ctx, cap, GL_FALSE);',
+	'EnableClientState':
+		'_mesa_glthread_ClientState(ctx, array, GL_TRUE);',
+	'DisableClientState':
+		'_mesa_glthread_ClientState(ctx, array, GL_FALSE);',
+	'EnableVertexAttribArrayARB':
+		'_mesa_glthread_VertexAttribArray(ctx, index, GL_TRUE);',
+	'DisableVertexAttribArrayARB':
+		'_mesa_glthread_VertexAttribArray(ctx, index, GL_FALSE);',
+	'ClientActiveTextureARB':
+		'_mesa_glthread_ClientActiveTexture(ctx, texture);',
+	'PushClientAttrib':
+		'_mesa_glthread_PushClientAttrib(ctx, mask);',
+	'PopClientAttrib':
+		'_mesa_glthread_PopClientAttrib(ctx);',
+
+	'BindBufferARB':
+		'_mesa_glthread_BindBuffer(ctx, target, buffer);',
+	'DeleteBuffersARB':
+		'_mesa_glthread_DeleteBuffers(ctx, n, buffer);',
+
+	'BindVertexArray':
+		'_mesa_glthread_BindVertexArray(ctx, array);',
+	'BindVertexArrayAPPLE':
+		'_mesa_glthread_BindVertexArray(ctx, array);',
+	'GenVertexArrays':
+		'_mesa_glthread_GenVertexArrays(ctx, n, arrays);',
+	'GenVertexArraysAPPLE':
+		'_mesa_glthread_GenVertexArrays(ctx, n, arrays);',
+	'DeleteVertexArraysAPPLE':
+		'_mesa_glthread_DeleteVertexArrays(ctx, n, arrays);',
+
+	'Flush':
+		'_mesa_glthread_flush_batch(ctx);',
+}
+
+
+def extra_count(func, param):
+	"""Return (counter, scale) for array parameters whose size is known
+	but isn't described in the XML, or None."""
+
+	if param.name != 'value':
+		return None
+
+	m = re.match(r'Uniform([1-4])(f|i|ui)v', func.name)
+	if m:
+		return ('count', int(m.group(1)))
+
+	m = re.match(r'UniformMatrix([2-4])(x([2-4]))?fv', func.name)
+	if m:
+		cols = int(m.group(1))
+		rows = cols
+		if m.group(3):
+			rows = int(m.group(3))
+		return ('count', cols * rows)
+
+	return None
+
+
+class marshal_param:
+	"""Marshalling information for one parameter of a function."""
+
+	def __init__(self, func, p):
+		self.p = p
+		self.name = p.name
+		self.type = p.type_string()
+
+		# Arrays copied into the command: either a fixed size or a
+		# size computed from another parameter.
+		self.copy = 0
+		self.fixed_size = 0
+		self.counter = None
+		self.scale = 1
+
+		# Set if the parameter makes the call synchronous.
+		self.sync = 0
+
+		if not p.is_pointer():
+			return
+
+		if func.name in pointer_by_value:
+			return
+
+		if p.is_output or not self.type.startswith('const ') or \
+		   p.is_image() or p.count_parameter_list or \
+		   self.type.count('*') > 1:
+			self.sync = 1
+			return
+
+		elem_size = p.type_expr.get_base_type_node().size
+		extra = extra_count(func, p)
+
+		if p.count:
+			self.copy = 1
+			self.fixed_size = p.count * p.count_scale * elem_size
+		elif p.counter:
+			self.copy = 1
+			self.counter = p.counter
+			self.scale = p.count_scale * elem_size
+		elif extra:
+			self.copy = 1
+			(self.counter, scale) = extra
+			self.scale = scale * elem_size
+		else:
+			self.sync = 1
+
+
+	def size_expr(self, prefix):
+		"""C expression for the number of bytes to copy, or -1 if the
+		array can't be copied."""
+
+		if self.fixed_size:
+			return '%u' % (self.fixed_size)
+		else:
+			return '_mesa_marshal_array_size(%s%s, %u)' \
+				% (prefix, self.counter, self.scale)
+
+
+class marshal_function:
+	"""Marshalling information for one function."""
+
+	def __init__(self, func):
+		self.func = func
+		self.name = func.name
+		self.params = []
+		for p in func.parameterIterator():
+			if not p.is_padding:
+				self.params.append(marshal_param(func, p))
+
+		self.returns = func.return_type != 'void'
+
+		self.sync = self.returns or self.name in always_sync
+		for p in self.params:
+			if p.sync:
+				self.sync = 1
+
+		# Synchronous calls use the caller's memory directly.
+		if self.sync:
+			self.copies = []
+		else:
+			self.copies = [p for p in self.params if p.copy]
+
+		if self.name in draw_elements:
+			self.sync_if = '!_mesa_glthread_can_queue_draw(ctx, GL_TRUE)'
+		elif self.name in draw_arrays:
+			self.sync_if = '!_mesa_glthread_can_queue_draw(ctx, GL_FALSE)'
+		else:
+			self.sync_if = None
+
+		self.call_after = call_after.get(self.name)
+
+
+	def print_struct(self):
+		print 'struct marshal_cmd_%s' % (self.name)
+		print '{'
+		print '   struct marshal_cmd_base cmd_base;'
+		for p in self.params:
+			print '   %s %s;' % (p.type, p.name)
+		if self.copies:
+			print '   GLboolean data_inline;  /**< arrays follow the command */'
+		if self.returns:
+			print '   %s *result;' % (self.func.return_type)
+		print '};'
+		print ''
+
+
+	def print_unmarshal(self):
+		print 'static void'
+		print '_mesa_unmarshal_%s(struct gl_context *ctx, const struct marshal_cmd_%s *cmd)' % (self.name, self.name)
+		print '{'
+		args = []
+		for p in self.params:
+			if p in self.copies:
+				print '   %s %s = cmd->%s;' % (p.type, p.name, p.name)
+				args.append(p.name)
+			else:
+				args.append('cmd->' + p.name)
+
+		if self.copies:
+			print '   if (cmd->data_inline) {'
+			print '      const char *variable_data = (const char *) (cmd + 1);'
+			for p in self.copies:
+				print '      if (%s) {' % (p.name)
+				print '         %s = (%s) variable_data;' % (p.name, p.type)
+				print '         variable_data += %s;' % (p.size_expr('cmd->'))
+				print '      }'
+			print '      (void) variable_data;'
+			print '   }'
+
+		call = 'CALL_%s(GET_DISPATCH(), (%s))' % (self.name, ', '.join(args))
+		if self.returns:
+			print '   *cmd->result = %s;' % (call)
+		else:
+			print '   %s;' % (call)
+		print '}'
+		print ''
+
+
+	def print_marshal(self):
+		print 'static %s GLAPIENTRY' % (self.func.return_type)
+		print '_mesa_marshal_%s(%s)' % (self.name, self.func.get_parameter_string())
+		print '{'
+		print '   GET_CURRENT_CONTEXT(ctx);'
+		if self.params or self.returns:
+			print '   struct marshal_cmd_%s *cmd;' % (self.name)
+		print '   size_t cmd_size = sizeof(struct marshal_cmd_%s);' % (self.name)
+		if self.returns:
+			print '   %s result;' % (self.func.return_type)
+
+		if self.copies:
+			print '   GLboolean data_inline = GL_TRUE;'
+			for p in self.copies:
+				print '   int %s_size = %s ? %s : 0;' % (p.name, p.name, p.size_expr(''))
+			print '   if (%s)' % (' || '.join(['%s_size < 0' % p.name for p in self.copies]))
+			print '      data_inline = GL_FALSE;'
+			print '   else'
+			print '      cmd_size += %s;' % (' + '.join(['%s_size' % p.name for p in self.copies]))
+			print '   if (cmd_size > MARSHAL_MAX_CMD_SIZE) {'
+			print '      data_inline = GL_FALSE;'
+			print '      cmd_size = sizeof(struct marshal_cmd_%s);' % (self.name)
+			print '   }'
+
+		print ''
+		if self.params or self.returns:
+			print '   cmd = _mesa_glthread_allocate_command(ctx, DISPATCH_CMD_%s, cmd_size);' % (self.name)
+		else:
+			# nothing to store, the command is just its header
+			print '   _mesa_glthread_allocate_command(ctx, DISPATCH_CMD_%s, cmd_size);' % (self.name)
+		for p in self.params:
+			print '   cmd->%s = %s;' % (p.name, p.name)
+		if self.returns:
+			print '   cmd->result = &result;'
+
+		if self.copies:
+			print '   cmd->data_inline = data_inline;'
+			print '   if (data_inline) {'
+			print '      char *variable_data = (char *) (cmd + 1);'
+			for p in self.copies:
+				print '      if (%s) {' % (p.name)
+				print '         memcpy(variable_data, %s, %s_size);' % (p.name, p.name)
+				print '         variable_data += %s_size;' % (p.name)
+				print '      }'
+			print '      (void) variable_data;'
+			print '   }'
+
+		conds = []
+		if self.sync:
+			conds = None
+		else:
+			if self.copies:
+				conds.append('!data_inline')
+			if self.sync_if:
+				conds.append(self.sync_if)
+
+		if conds is None:
+			print '   _mesa_glthread_finish(ctx);'
+		elif conds:
+			print '   if (%s)' % (' || '.join(conds))
+			print '      _mesa_glthread_finish(ctx);'
+
+		if self.call_after:
+			print '   %s' % (self.call_after)
+
+		if self.returns:
+			print '   return result;'
+		print '}'
+		print ''
+
+
+class PrintMarshalHeader(gl_XML.gl_print_base):
+	def __init__(self):
+		gl_XML.gl_print_base.__init__(self)
+
+		self.name = "gl_marshal.py (from Mesa)"
+		self.header_tag = "MARSHAL_GENERATED_H"
+		self.license = license.bsd_license_template % ( \
+"""Copyright 2026 agent <agent@local>""", "THE AUTHORS")
+		return
+
+
+	def printRealHeader(self):
+		print '/**'
+		print ' * \\file marshal_generated.h'
+		print ' * Command IDs of the threaded dispatch, see main/glthread.c.'
+		print ' */'
+		print ''
+		return
+
+
+	def printBody(self, api):
+		print 'enum marshal_dispatch_cmd_id'
+		print '{'
+		for f in api.functionIterateByOffset():
+			print '   DISPATCH_CMD_%s,' % (f.name)
+		print '   NUM_DISPATCH_CMD'
+		print '};'
+		print ''
+		print 'struct gl_context;'
+		print 'struct _glapi_table;'
+		print ''
+		print 'typedef void (*_mesa_unmarshal_func)(struct gl_context *ctx, const void *cmd);'
+		print ''
+		print 'extern const _mesa_unmarshal_func _mesa_unmarshal_dispatch[NUM_DISPATCH_CMD];'
+		print ''
+		print 'extern struct _glapi_table *'
+		print '_mesa_create_marshal_table(void);'
+		return
+
+
+class PrintMarshalCode(gl_XML.gl_print_base):
+	def __init__(self):
+		gl_XML.gl_print_base.__init__(self)
+
+		self.name = "gl_marshal.py (from Mesa)"
+		self.license = license.bsd_license_template % ( \
+"""Copyright 2026 agent <agent@local>""", "THE AUTHORS")
+		return
+
+
+	def printRealHeader(self):
+		print '/**'
+		print ' * \\file marshal_generated.c'
+		print ' * Marshal and unmarshal functions of the threaded dispatch.'
+		print ' */'
+		print ''
+		print '#include "main/glheader.h"'
+		print '#include "main/api_exec.h"'
+		print '#include "main/context.h"'
+		print '#include "main/dispatch.h"'
+		print '#include "main/glthread.h"'
+		print '#include "main/marshal.h"'
+		print '#include "main/marshal_generated.h"'
+		print ''
+		print '#ifdef PTHREADS'
+		print ''
+		return
+
+
+	def printRealFooter(self):
+		print '#endif /* PTHREADS */'
+		return
+
+
+	def printBody(self, api):
+		functions = []
+		for f in api.functionIterateByOffset():
+			functions.append(marshal_function(f))
+
+		for m in functions:
+			print '/* %s: %s */' % (m.name, m.sync and 'synchronous' or 'queued')
+			m.print_struct()
+			m.print_unmarshal()
+			m.print_marshal()
+			print ''
+
+		print 'const _mesa_unmarshal_func _mesa_unmarshal_dispatch[NUM_DISPATCH_CMD] = {'
+		for m in functions:
+			print '   (_mesa_unmarshal_func) _mesa_unmarshal_%s,' % (m.name)
+		print '};'
+		print ''
+		print ''
+		print '/**'
+		print ' * Create the dispatch table installed in the application thread.'
+		print ' */'
+		print 'struct _glapi_table *'
+		print '_mesa_create_marshal_table(void)'
+		print '{'
+		print '   struct _glapi_table *table;'
+		print ''
+		print '   table = _mesa_alloc_dispatch_table(_gloffset_COUNT);'
+		print '   if (table == NULL)'
+		print '      return NULL;'
+		print ''
+		for m in functions:
+			print '   SET_%s(table, _mesa_marshal_%s);' % (m.name, m.name)
+		print ''
+		print '   return table;'
+		print '}'
+		print ''
+		return
+
+
+def show_usage():
+	print "Usage: %s [-f input_file_name] [-m mode]" % sys.argv[0]
+	print "    -m mode   Mode can be 'code' or 'header'."
+	sys.exit(1)
+
+
+if __name__ == '__main__':
+	file_name = "gl_API.xml"
+
+	try:
+		(args, trail) = getopt.getopt(sys.argv[1:], "f:m:")
+	except Exception,e:
+		show_usage()
+
+	mode = "code"
+	for (arg,val) in args:
+		if arg == "-f":
+			file_name = val
+		elif arg == "-m":
+			mode = val
+
+	if mode == "code":
+		printer = PrintMarshalCode()
+	elif mode == "header":
+		printer = PrintMarshalHeader()
+	else:
+		show_usage()
+
+	api = gl_XML.parse_GL_API( file_name )
+
+	printer.Print( api )
@@ -32,6 +32,7 @@
 #include "main/renderbuffer.h"
 #include "main/hash.h"
 #include "main/fbobject.h"
+#include "main/glthread.h"
 #include "main/mfeatures.h"
 
 #include "utils.h"
@@ -108,6 +109,8 @@ intelDRI2Flush(__DRIdrawable *drawable)
    GET_CURRENT_CONTEXT(ctx);
    struct intel_context *intel = intel_context(ctx);
 
+   _mesa_glthread_finish(ctx);
+
    if (intel->gen < 4)
       INTEL_FIREVERTICES(intel);
 
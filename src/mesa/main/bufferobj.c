@@ -600,6 +600,14 @@ bind_buffer_object(struct gl_context *ctx, GLenum target, GLuint buffer)
       }
    }
    
+   /* Buffers that glReadPixels or transform feedback may write to are
+    * changed by the driver directly, not through the API functions which
+    * invalidate the cached index ranges.
+    */
+   if (target == GL_PIXEL_PACK_BUFFER_EXT ||
+       target == GL_TRANSFORM_FEEDBACK_BUFFER)
+      newBufObj->GPUWritten = GL_TRUE;
+
    /* bind new buffer */
    _mesa_reference_buffer_object(ctx, bindTarget, newBufObj);
 
@@ -903,6 +911,7 @@ _mesa_BufferDataARB(GLenum target, GLsizeiptrARB size,
    FLUSH_VERTICES(ctx, _NEW_BUFFER_OBJECT);
 
    bufObj->Written = GL_TRUE;
+   _mesa_bufferobj_invalidate_index_ranges(bufObj);
 
 #ifdef VBO_DEBUG
    printf("glBufferDataARB(%u, sz %ld, from %p, usage 0x%x)\n",
@@ -939,6 +948,7 @@ _mesa_BufferSubDataARB(GLenum target, GLintptrARB offset,
       return;
 
    bufObj->Written = GL_TRUE;
+   _mesa_bufferobj_invalidate_index_ranges(bufObj);
 
    ASSERT(ctx->Driver.BufferSubData);
    ctx->Driver.BufferSubData( ctx, offset, size, data, bufObj );
@@ -1027,8 +1037,10 @@ _mesa_MapBufferARB(GLenum target, GLenum access)
       bufObj->AccessFlags = accessFlags;
    }
 
-   if (access == GL_WRITE_ONLY_ARB || access == GL_READ_WRITE_ARB)
+   if (access == GL_WRITE_ONLY_ARB || access == GL_READ_WRITE_ARB) {
       bufObj->Written = GL_TRUE;
+      _mesa_bufferobj_invalidate_index_ranges(bufObj);
+   }
 
 #ifdef VBO_DEBUG
    printf("glMapBufferARB(%u, sz %ld, access 0x%x)\n",
@@ -1341,6 +1353,8 @@ _mesa_CopyBufferSubData(GLenum readTarget, GLenum writeTarget,
       }
    }
 
+   _mesa_bufferobj_invalidate_index_ranges(dst);
+
    ctx->Driver.CopyBufferSubData(ctx, src, dst, readOffset, writeOffset, size);
 }
 
@@ -1434,6 +1448,9 @@ _mesa_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
       return NULL;
    }
 
+   if (access & GL_MAP_WRITE_BIT)
+      _mesa_bufferobj_invalidate_index_ranges(bufObj);
+
    /* Mapping zero bytes should return a non-null pointer. */
    if (!length) {
       static long dummy = 0;
@@ -1557,6 +1574,8 @@ buffer_object_purgeable(struct gl_context *ctx, GLuint name, GLenum option)
    }
 
    bufObj->Purgeable = GL_TRUE;
+   /* the contents may be discarded */
+   _mesa_bufferobj_invalidate_index_ranges(bufObj);
 
    retval = GL_VOLATILE_APPLE;
    if (ctx->Driver.BufferObjectPurgeable)
@@ -56,6 +56,20 @@ _mesa_is_bufferobj(const struct gl_buffer_object *obj)
    return obj->Name != 0;
 }
 
+/**
+ * Forget the index ranges cached for the buffer object's contents.
+ * Must be called whenever the contents may have changed.
+ */
+static INLINE void
+_mesa_bufferobj_invalidate_index_ranges(struct gl_buffer_object *obj)
+{
+   GLuint i;
+   _glthread_LOCK_MUTEX(obj->Mutex);
+   for (i = 0; i < MAX_INDEX_RANGE_CACHE; i++)
+      obj->IndexRanges[i].Count = 0;
+   _glthread_UNLOCK_MUTEX(obj->Mutex);
+}
+
 
 extern void
 _mesa_init_buffer_objects( struct gl_context *ctx );
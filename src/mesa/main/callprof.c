@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file callprof.c
+ * Call profile, see callprof.h.
+ */
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#include "main/callprof.h"
+#include "main/imports.h"
+
+
+static const char *section_names[MESA_PROF_NUM_SECTIONS] = {
+   "vbo draw arrays",
+   "vbo draw elements",
+   "call list",
+   "_mesa_update_state",
+   "driver validate"
+};
+
+/** Names of the _NEW_* bits, see mtypes.h */
+static const char *state_names[32] = {
+   "MODELVIEW",
+   "PROJECTION",
+   "TEXTURE_MATRIX",
+   "COLOR",
+   "DEPTH",
+   "EVAL",
+   "FOG",
+   "HINT",
+   "LIGHT",
+   "LINE",
+   "PIXEL",
+   "POINT",
+   "POLYGON",
+   "POLYGONSTIPPLE",
+   "SCISSOR",
+   "STENCIL",
+   "TEXTURE",
+   "TRANSFORM",
+   "VIEWPORT",
+   "PACKUNPACK",
+   "ARRAY",
+   "RENDERMODE",
+   "BUFFERS",
+   "CURRENT_ATTRIB",
+   "MULTISAMPLE",
+   "TRACK_MATRIX",
+   "PROGRAM",
+   "PROGRAM_CONSTANTS",
+   "BUFFER_OBJECT",
+   "FRAG_CLAMP",
+   "bit 30",
+   "bit 31"
+};
+
+
+/**
+ * Monotonic time in nanoseconds.
+ */
+GLuint64
+_mesa_call_profile_time(void)
+{
+#if defined(_WIN32)
+   static LARGE_INTEGER frequency;
+   LARGE_INTEGER counter;
+
+   if (!frequency.QuadPart)
+      QueryPerformanceFrequency(&frequency);
+   QueryPerformanceCounter(&counter);
+   return (GLuint64) (counter.QuadPart * (1e9 / frequency.QuadPart));
+#elif defined(CLOCK_MONOTONIC)
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (GLuint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+   return (GLuint64) tv.tv_sec * 1000000000 + tv.tv_usec * 1000;
+#endif
+}
+
+
+void
+_mesa_init_call_profile(struct gl_context *ctx)
+{
+   memset(&ctx->Profile, 0, sizeof(ctx->Profile));
+   ctx->Profile.Enabled = _mesa_getenv("MESA_PROFILE") != NULL;
+}
+
+
+void
+_mesa_call_profile_state_bits(struct gl_context *ctx, GLbitfield new_state,
+                              GLuint64 time)
+{
+   while (new_state) {
+      const GLuint bit = _mesa_ffs(new_state) - 1;
+
+      ctx->Profile.StateCalls[bit]++;
+      ctx->Profile.StateTime[bit] += time;
+      new_state &= ~(1u << bit);
+   }
+}
+
+
+/**
+ * Print the counters to stderr.  Does nothing unless MESA_PROFILE is set.
+ */
+void
+_mesa_print_call_profile(struct gl_context *ctx)
+{
+   GLuint i;
+
+   if (!ctx->Profile.Enabled)
+      return;
+
+   fprintf(stderr, "Mesa call profile for context %p:\n", (void *) ctx);
+   fprintf(stderr, "  %-20s %12s %12s %10s\n",
+           "section", "calls", "total ms", "ns/call");
+
+   for (i = 0; i < MESA_PROF_NUM_SECTIONS; i++) {
+      const GLuint64 calls = ctx->Profile.Calls[i];
+      const GLuint64 time = ctx->Profile.Time[i];
+
+      fprintf(stderr, "  %-20s %12llu %12.3f %10.1f\n",
+              section_names[i], (unsigned long long) calls, time * 1e-6,
+              calls ? (double) time / calls : 0.0);
+   }
+
+   /* A validation is counted for every bit it was done for, so these add
+    * up to more than the _mesa_update_state time.
+    */
+   fprintf(stderr, "  %-20s %12s %12s %10s\n",
+           "validation by _NEW_*", "calls", "total ms", "ns/call");
+
+   for (i = 0; i < 32; i++) {
+      const GLuint64 calls = ctx->Profile.StateCalls[i];
+      const GLuint64 time = ctx->Profile.StateTime[i];
+
+      if (!calls)
+         continue;
+
+      fprintf(stderr, "  %-20s %12llu %12.3f %10.1f\n",
+              state_names[i], (unsigned long long) calls, time * 1e-6,
+              (double) time / calls);
+   }
+}
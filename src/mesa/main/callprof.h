@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file callprof.h
+ * Optional call counting and timing of a few hot driver paths, for
+ * measuring API overhead.  Enabled with the MESA_PROFILE environment
+ * variable; the results are printed when the context is destroyed.
+ *
+ * Sections nest: the draw sections include the state validation done
+ * while drawing.
+ */
+
+#ifndef CALLPROF_H
+#define CALLPROF_H
+
+#include "main/mtypes.h"
+
+
+extern void
+_mesa_init_call_profile(struct gl_context *ctx);
+
+extern void
+_mesa_print_call_profile(struct gl_context *ctx);
+
+extern GLuint64
+_mesa_call_profile_time(void);
+
+extern void
+_mesa_call_profile_state_bits(struct gl_context *ctx, GLbitfield new_state,
+                              GLuint64 time);
+
+
+/**
+ * Start timing a section.  Returns the value to pass to
+ * _mesa_call_profile_end().
+ */
+static INLINE GLuint64
+_mesa_call_profile_begin(const struct gl_context *ctx)
+{
+   return ctx->Profile.Enabled ? _mesa_call_profile_time() : 0;
+}
+
+static INLINE void
+_mesa_call_profile_end(struct gl_context *ctx, gl_prof_section section,
+                       GLuint64 start)
+{
+   if (ctx->Profile.Enabled) {
+      ctx->Profile.Calls[section]++;
+      ctx->Profile.Time[section] += _mesa_call_profile_time() - start;
+   }
+}
+
+
+/**
+ * End timing a state validation and account it to each of the _NEW_*
+ * bits in \p new_state.
+ */
+static INLINE void
+_mesa_call_profile_state(struct gl_context *ctx, GLbitfield new_state,
+                         GLuint64 start)
+{
+   if (ctx->Profile.Enabled) {
+      _mesa_call_profile_state_bits(ctx, new_state,
+                                    _mesa_call_profile_time() - start);
+   }
+}
+
+
+#endif /* CALLPROF_H */
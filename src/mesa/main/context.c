@@ -86,6 +86,7 @@
 #include "blend.h"
 #include "buffers.h"
 #include "bufferobj.h"
+#include "callprof.h"
 #include "context.h"
 #include "cpuinfo.h"
 #include "debug.h"
@@ -98,6 +99,7 @@
 #include "fog.h"
 #include "formats.h"
 #include "framebuffer.h"
+#include "glthread.h"
 #include "hint.h"
 #include "hash.h"
 #include "light.h"
@@ -169,6 +171,7 @@ _mesa_notifySwapBuffers(struct gl_context *ctx)
 {
    if (MESA_VERBOSE & VERBOSE_SWAPBUFFERS)
       _mesa_debug(ctx, "SwapBuffers\n");
+   _mesa_glthread_finish(ctx);
    FLUSH_CURRENT( ctx, 0 );
    if (ctx->Driver.Flush) {
       ctx->Driver.Flush(ctx);
@@ -979,6 +982,8 @@ _mesa_initialize_context(struct gl_context *ctx,
 #endif
    ctx->CurrentDispatch = ctx->Exec;
 
+   _mesa_init_call_profile(ctx);
+
    ctx->FragmentProgram._MaintainTexEnvProgram
       = (_mesa_getenv("MESA_TEX_PROG") != NULL);
 
@@ -1097,6 +1102,11 @@ _mesa_free_context_data( struct gl_context *ctx )
       _mesa_make_current(ctx, NULL, NULL);
    }
 
+   /* execute any queued calls and stop the dispatch thread */
+   _mesa_glthread_destroy(ctx);
+
+   _mesa_print_call_profile(ctx);
+
    /* unreference WinSysDraw/Read buffers */
    _mesa_reference_framebuffer(&ctx->WinSysDrawBuffer, NULL);
    _mesa_reference_framebuffer(&ctx->WinSysReadBuffer, NULL);
@@ -1237,6 +1247,7 @@ _mesa_copy_context( const struct gl_context *src, struct gl_context *dst,
             insert_at_tail(&(dst->Light.EnabledList), &(dst->Light.Light[i]));
          }
       }
+      dst->Light._DirtyLights = ~0;
    }
    if (mask & GL_LINE_BIT) {
       /* OK to memcpy */
@@ -1430,6 +1441,14 @@ _mesa_make_current( struct gl_context *newCtx,
       }
    }
 
+   /* With threaded dispatch, the contexts may still be in use by their
+    * dispatch threads.
+    */
+   if (curCtx)
+      _mesa_glthread_finish(curCtx);
+   if (newCtx && newCtx != curCtx)
+      _mesa_glthread_finish(newCtx);
+
    if (curCtx && 
       (curCtx->WinSysDrawBuffer || curCtx->WinSysReadBuffer) &&
        /* make sure this context is valid for flushing */
@@ -1525,8 +1544,17 @@ _mesa_make_current( struct gl_context *newCtx,
 	    _mesa_print_info();
 	 }
 
+         /* Set MESA_GLTHREAD to execute GL calls in a separate thread. */
+         if (newCtx->API == API_OPENGL && _mesa_getenv("MESA_GLTHREAD")) {
+            _mesa_glthread_init(newCtx);
+         }
+
 	 newCtx->FirstTimeCurrent = GL_FALSE;
       }
+
+      if (newCtx->GLThread) {
+         _glapi_set_dispatch(newCtx->MarshalExec);
+      }
    }
    
    return GL_TRUE;
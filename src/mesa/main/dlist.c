@@ -42,6 +42,7 @@
 #include "mfeatures.h"
 #if FEATURE_ARB_vertex_buffer_object
 #include "bufferobj.h"
+#include "callprof.h"
 #endif
 #include "arrayobj.h"
 #include "context.h"
@@ -86,6 +87,7 @@ struct gl_list_instruction
    void (*Execute)( struct gl_context *ctx, void *data );
    void (*Destroy)( struct gl_context *ctx, void *data );
    void (*Print)( struct gl_context *ctx, void *data );
+   GLboolean (*Merge)( struct gl_context *ctx, void *data, void *next );
 };
 
 
@@ -464,7 +466,8 @@ typedef enum
    OPCODE_BEGIN_CONDITIONAL_RENDER,
    OPCODE_END_CONDITIONAL_RENDER,
 
-   /* The following three are meta instructions */
+   /* The following four are meta instructions */
+   OPCODE_NOP,                  /* removed instruction, n[1].ui = size */
    OPCODE_ERROR,                /* raise compiled-in error */
    OPCODE_CONTINUE,
    OPCODE_END_OF_LIST,
@@ -769,6 +772,9 @@ _mesa_delete_list(struct gl_context *ctx, struct gl_display_list *dlist)
             n += InstSize[n[0].opcode];
             break;
 
+         case OPCODE_NOP:
+            n += n[1].ui;
+            break;
          case OPCODE_CONTINUE:
             n = (Node *) n[1].next;
             free(block);
@@ -1012,6 +1018,8 @@ _mesa_dlist_alloc(struct gl_context *ctx, GLuint opcode, GLuint bytes)
  * \param execute  function to execute the new display list command
  * \param destroy  function to destroy the new display list command
  * \param print  function to print the new display list command
+ * \param merge  optional function to fold a command into the same kind
+ *               of command just before it, see optimize_list()
  * \return  the new opcode number or -1 if error
  */
 GLint
@@ -1019,7 +1027,9 @@ _mesa_dlist_alloc_opcode(struct gl_context *ctx,
                          GLuint size,
                          void (*execute) (struct gl_context *, void *),
                          void (*destroy) (struct gl_context *, void *),
-                         void (*print) (struct gl_context *, void *))
+                         void (*print) (struct gl_context *, void *),
+                         GLboolean (*merge) (struct gl_context *, void *,
+                                             void *))
 {
    if (ctx->ListExt->NumOpcodes < MAX_DLIST_EXT_OPCODES) {
       const GLuint i = ctx->ListExt->NumOpcodes++;
@@ -1028,6 +1038,7 @@ _mesa_dlist_alloc_opcode(struct gl_context *ctx,
       ctx->ListExt->Opcode[i].Execute = execute;
       ctx->ListExt->Opcode[i].Destroy = destroy;
       ctx->ListExt->Opcode[i].Print = print;
+      ctx->ListExt->Opcode[i].Merge = merge;
       return i + OPCODE_EXT_0;
    }
    return -1;
@@ -1300,6 +1311,21 @@ static void invalidate_saved_current_state( struct gl_context *ctx )
    ctx->Driver.CurrentSavePrimitive = PRIM_UNKNOWN;
 }
 
+/**
+ * Called for commands that change the current attributes or material in
+ * ways the values tracked in ListState can't follow, such as glPopAttrib
+ * or the evaluators.  Unlike invalidate_saved_current_state(), we still
+ * know whether we're inside a begin/end pair.
+ */
+static void
+forget_saved_current_values(struct gl_context *ctx)
+{
+   memset(ctx->ListState.ActiveAttribSize, 0,
+          sizeof ctx->ListState.ActiveAttribSize);
+   memset(ctx->ListState.ActiveMaterialSize, 0,
+          sizeof ctx->ListState.ActiveMaterialSize);
+}
+
 static void GLAPIENTRY
 save_CallList(GLuint list)
 {
@@ -2298,6 +2324,7 @@ save_EvalMesh1(GLenum mode, GLint i1, GLint i2)
       n[2].i = i1;
       n[3].i = i2;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalMesh1(ctx->Exec, (mode, i1, i2));
    }
@@ -2318,6 +2345,7 @@ save_EvalMesh2(GLenum mode, GLint i1, GLint i2, GLint j1, GLint j2)
       n[4].i = j1;
       n[5].i = j2;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalMesh2(ctx->Exec, (mode, i1, i2, j1, j2));
    }
@@ -3300,6 +3328,7 @@ save_PopAttrib(void)
    GET_CURRENT_CONTEXT(ctx);
    ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
    (void) alloc_instruction(ctx, OPCODE_POP_ATTRIB, 0);
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_PopAttrib(ctx->Exec, ());
    }
@@ -5397,11 +5426,39 @@ save_SetFragmentShaderConstantATI(GLuint dst, const GLfloat *value)
 }
 #endif
 
+/**
+ * Would setting vertex attribute \p attr to the given value leave it
+ * unchanged, as far as the list being compiled knows?  Like the
+ * glMaterial check in save_Materialfv(), this lets us drop the command,
+ * and more importantly avoid flushing the vertices compiled so far, so
+ * that the primitives around it end up in the same vertex list.
+ * Setting the position emits a vertex, so it is never redundant.
+ */
+static INLINE GLboolean
+is_redundant_attr(struct gl_context *ctx, GLenum attr, GLuint size,
+                  GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+   GLfloat v[4];
+
+   if (attr == VERT_ATTRIB_POS ||
+       ctx->ListState.ActiveAttribSize[attr] != size)
+      return GL_FALSE;
+
+   ASSIGN_4V(v, x, y, z, w);
+   return memcmp(ctx->ListState.CurrentAttrib[attr], v, sizeof(v)) == 0;
+}
+
 static void GLAPIENTRY
 save_Attr1fNV(GLenum attr, GLfloat x)
 {
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
+   if (is_redundant_attr(ctx, attr, 1, x, 0, 0, 1)) {
+      if (ctx->ExecuteFlag) {
+         CALL_VertexAttrib1fNV(ctx->Exec, (attr, x));
+      }
+      return;
+   }
    SAVE_FLUSH_VERTICES(ctx);
    n = alloc_instruction(ctx, OPCODE_ATTR_1F_NV, 2);
    if (n) {
@@ -5423,6 +5480,12 @@ save_Attr2fNV(GLenum attr, GLfloat x, GLfloat y)
 {
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
+   if (is_redundant_attr(ctx, attr, 2, x, y, 0, 1)) {
+      if (ctx->ExecuteFlag) {
+         CALL_VertexAttrib2fNV(ctx->Exec, (attr, x, y));
+      }
+      return;
+   }
    SAVE_FLUSH_VERTICES(ctx);
    n = alloc_instruction(ctx, OPCODE_ATTR_2F_NV, 3);
    if (n) {
@@ -5445,6 +5508,12 @@ save_Attr3fNV(GLenum attr, GLfloat x, GLfloat y, GLfloat z)
 {
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
+   if (is_redundant_attr(ctx, attr, 3, x, y, z, 1)) {
+      if (ctx->ExecuteFlag) {
+         CALL_VertexAttrib3fNV(ctx->Exec, (attr, x, y, z));
+      }
+      return;
+   }
    SAVE_FLUSH_VERTICES(ctx);
    n = alloc_instruction(ctx, OPCODE_ATTR_3F_NV, 4);
    if (n) {
@@ -5468,6 +5537,12 @@ save_Attr4fNV(GLenum attr, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
+   if (is_redundant_attr(ctx, attr, 4, x, y, z, w)) {
+      if (ctx->ExecuteFlag) {
+         CALL_VertexAttrib4fNV(ctx->Exec, (attr, x, y, z, w));
+      }
+      return;
+   }
    SAVE_FLUSH_VERTICES(ctx);
    n = alloc_instruction(ctx, OPCODE_ATTR_4F_NV, 5);
    if (n) {
@@ -5589,6 +5664,7 @@ save_EvalCoord1f(GLfloat x)
    if (n) {
       n[1].f = x;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalCoord1f(ctx->Exec, (x));
    }
@@ -5611,6 +5687,7 @@ save_EvalCoord2f(GLfloat x, GLfloat y)
       n[1].f = x;
       n[2].f = y;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalCoord2f(ctx->Exec, (x, y));
    }
@@ -5633,6 +5710,7 @@ save_EvalPoint1(GLint x)
    if (n) {
       n[1].i = x;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalPoint1(ctx->Exec, (x));
    }
@@ -5649,6 +5727,7 @@ save_EvalPoint2(GLint x, GLint y)
       n[1].i = x;
       n[2].i = y;
    }
+   forget_saved_current_values(ctx);
    if (ctx->ExecuteFlag) {
       CALL_EvalPoint2(ctx->Exec, (x, y));
    }
@@ -8691,6 +8770,9 @@ execute_list(struct gl_context *ctx, GLuint list)
             CALL_EndConditionalRenderNV(ctx->Exec, ());
             break;
 
+         case OPCODE_NOP:
+            n += n[1].ui;
+            break;
          case OPCODE_CONTINUE:
             n = (Node *) n[1].next;
             break;
@@ -8708,7 +8790,7 @@ execute_list(struct gl_context *ctx, GLuint list)
          }
 
          /* increment n to point to next compiled command */
-         if (opcode != OPCODE_CONTINUE) {
+         if (opcode != OPCODE_CONTINUE && opcode != OPCODE_NOP) {
             n += InstSize[opcode];
          }
       }
@@ -8851,6 +8933,209 @@ _mesa_NewList(GLuint name, GLenum mode)
 }
 
 
+/**
+ * Instructions that just set a piece of GL state, for optimize_list().
+ * The first \c NumKeys parameters select which piece of state is set, the
+ * others are the new value.  Instructions of the same class set the same
+ * state, so glEnable and glDisable of a given cap are compared.
+ */
+struct state_instruction
+{
+   OpCode Opcode;
+   OpCode Class;
+   GLuint NumKeys;
+};
+
+static const struct state_instruction state_instructions[] = {
+   { OPCODE_ACTIVE_TEXTURE, OPCODE_ACTIVE_TEXTURE, 0 },
+   { OPCODE_ALPHA_FUNC, OPCODE_ALPHA_FUNC, 0 },
+   { OPCODE_BIND_TEXTURE, OPCODE_BIND_TEXTURE, 1 },
+   { OPCODE_BLEND_COLOR, OPCODE_BLEND_COLOR, 0 },
+   { OPCODE_BLEND_EQUATION, OPCODE_BLEND_EQUATION, 0 },
+   { OPCODE_BLEND_FUNC_SEPARATE, OPCODE_BLEND_FUNC_SEPARATE, 0 },
+   { OPCODE_CULL_FACE, OPCODE_CULL_FACE, 0 },
+   { OPCODE_DEPTH_FUNC, OPCODE_DEPTH_FUNC, 0 },
+   { OPCODE_DISABLE, OPCODE_ENABLE, 1 },
+   { OPCODE_ENABLE, OPCODE_ENABLE, 1 },
+   { OPCODE_FRONT_FACE, OPCODE_FRONT_FACE, 0 },
+   { OPCODE_LINE_WIDTH, OPCODE_LINE_WIDTH, 0 },
+   { OPCODE_POINT_SIZE, OPCODE_POINT_SIZE, 0 },
+   { OPCODE_SHADE_MODEL, OPCODE_SHADE_MODEL, 0 },
+   { OPCODE_USE_PROGRAM, OPCODE_USE_PROGRAM, 0 }
+};
+
+/** Number of state settings optimize_list() remembers at a time. */
+#define MAX_KNOWN_STATE 32
+
+
+static const struct state_instruction *
+find_state_instruction(OpCode opcode)
+{
+   GLuint i;
+
+   for (i = 0; i < Elements(state_instructions); i++) {
+      if (state_instructions[i].Opcode == opcode)
+         return &state_instructions[i];
+   }
+   return NULL;
+}
+
+
+/**
+ * Do instructions \p a and \p b set the same piece of state?  If so,
+ * \p same_value tells whether they also set it to the same value.
+ */
+static GLboolean
+same_state(const Node *a, const Node *b, GLboolean *same_value)
+{
+   const struct state_instruction *sa = find_state_instruction(a[0].opcode);
+   const struct state_instruction *sb = find_state_instruction(b[0].opcode);
+   GLuint i;
+
+   if (sa->Class != sb->Class)
+      return GL_FALSE;
+
+   for (i = 1; i <= sa->NumKeys; i++) {
+      if (a[i].ui != b[i].ui)
+         return GL_FALSE;
+   }
+
+   *same_value = a[0].opcode == b[0].opcode;
+   for (i = sa->NumKeys + 1; i < InstSize[a[0].opcode]; i++) {
+      if (a[i].ui != b[i].ui)
+         *same_value = GL_FALSE;
+   }
+   return GL_TRUE;
+}
+
+
+/** Turn the \p size nodes at \p n into a no-op. */
+static void
+make_nop(Node *n, GLuint size)
+{
+   ASSERT(size >= 2);
+   n[0].opcode = OPCODE_NOP;
+   n[1].ui = size;
+}
+
+
+/**
+ * Clean up a display list after it has been compiled.
+ *
+ * Instructions that set a piece of state to the value it already has from
+ * an earlier instruction in the list are removed.  Anything we don't know
+ * the effect of makes us forget what we know; glActiveTexture does too,
+ * since texture bindings and enables depend on it.
+ *
+ * After that, consecutive draws of the same extension opcode (normally
+ * vbo vertex lists) that only had removed state changes between them are
+ * merged with the opcode's Merge callback, so that the list replays with
+ * fewer, larger draws and less state validation.
+ *
+ * Removed instructions become OPCODE_NOP; the list's memory isn't moved.
+ */
+static void
+optimize_list(struct gl_context *ctx, struct gl_display_list *dlist)
+{
+   const Node *known[MAX_KNOWN_STATE];
+   GLuint num_known = 0;
+   Node *draw = NULL;   /* last draw, if nothing but NOPs came after it */
+   GLuint num_removed = 0, num_merged = 0;
+   Node *n = dlist->Head;
+   GLboolean done = GL_FALSE;
+
+   while (!done) {
+      const OpCode opcode = n[0].opcode;
+
+      if (is_ext_opcode(opcode)) {
+         const struct gl_list_instruction *inst =
+            &ctx->ListExt->Opcode[opcode - OPCODE_EXT_0];
+
+         if (!inst->Merge) {
+            num_known = 0;
+            draw = NULL;
+         }
+         else if (draw && draw[0].opcode == opcode &&
+                  inst->Merge(ctx, &draw[1], &n[1])) {
+            /* n is now part of draw */
+            make_nop(n, inst->Size);
+            num_merged++;
+         }
+         else {
+            draw = n;
+         }
+         n += inst->Size;
+         continue;
+      }
+
+      switch (opcode) {
+      case OPCODE_NOP:
+         n += n[1].ui;
+         continue;
+      case OPCODE_CONTINUE:
+         n = (Node *) n[1].next;
+         continue;
+      case OPCODE_END_OF_LIST:
+         done = GL_TRUE;
+         continue;
+
+      case OPCODE_ATTR_1F_NV:
+      case OPCODE_ATTR_2F_NV:
+      case OPCODE_ATTR_3F_NV:
+      case OPCODE_ATTR_4F_NV:
+      case OPCODE_ATTR_1F_ARB:
+      case OPCODE_ATTR_2F_ARB:
+      case OPCODE_ATTR_3F_ARB:
+      case OPCODE_ATTR_4F_ARB:
+      case OPCODE_MATERIAL:
+         /* these don't touch the state we track, but the draw after them
+          * must stay separate
+          */
+         draw = NULL;
+         break;
+
+      default:
+         if (!find_state_instruction(opcode)) {
+            num_known = 0;
+            draw = NULL;
+         }
+         else {
+            GLboolean same_value = GL_FALSE;
+            GLuint i;
+
+            for (i = 0; i < num_known; i++) {
+               if (same_state(known[i], n, &same_value))
+                  break;
+            }
+
+            if (i < num_known && same_value) {
+               make_nop(n, InstSize[opcode]);
+               num_removed++;
+               continue;
+            }
+
+            draw = NULL;
+
+            if (opcode == OPCODE_ACTIVE_TEXTURE)
+               num_known = i = 0;
+
+            if (i < num_known)
+               known[i] = n;
+            else if (num_known < MAX_KNOWN_STATE)
+               known[num_known++] = n;
+         }
+         break;
+      }
+
+      n += InstSize[opcode];
+   }
+
+   if (MESA_VERBOSE & VERBOSE_DISPLAY_LIST)
+      _mesa_debug(ctx, "list %u: removed %u state changes, merged %u draws\n",
+                  dlist->Name, num_removed, num_merged);
+}
+
+
 /**
  * End definition of current display list. 
  */
@@ -8877,6 +9162,8 @@ _mesa_EndList(void)
 
    (void) alloc_instruction(ctx, OPCODE_END_OF_LIST, 0);
 
+   optimize_list(ctx, ctx->ListState.CurrentList);
+
    /* Destroy old list, if any */
    destroy_list(ctx, ctx->ListState.CurrentList->Name);
 
@@ -8902,6 +9189,7 @@ void GLAPIENTRY
 _mesa_CallList(GLuint list)
 {
    GLboolean save_compile_flag;
+   GLuint64 start;
    GET_CURRENT_CONTEXT(ctx);
    FLUSH_CURRENT(ctx, 0);
 
@@ -8924,7 +9212,9 @@ _mesa_CallList(GLuint list)
       ctx->CompileFlag = GL_FALSE;
    }
 
+   start = _mesa_call_profile_begin(ctx);
    execute_list(ctx, list);
+   _mesa_call_profile_end(ctx, MESA_PROF_CALL_LIST, start);
    ctx->CompileFlag = save_compile_flag;
 
    /* also restore API function pointers to point to "save" versions */
@@ -8944,6 +9234,7 @@ _mesa_CallLists(GLsizei n, GLenum type, const GLvoid * lists)
    GET_CURRENT_CONTEXT(ctx);
    GLint i;
    GLboolean save_compile_flag;
+   GLuint64 start;
 
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glCallLists %d\n", n);
@@ -8972,10 +9263,12 @@ _mesa_CallLists(GLsizei n, GLenum type, const GLvoid * lists)
    save_compile_flag = ctx->CompileFlag;
    ctx->CompileFlag = GL_FALSE;
 
+   start = _mesa_call_profile_begin(ctx);
    for (i = 0; i < n; i++) {
       GLuint list = (GLuint) (ctx->List.ListBase + translate_id(i, type, lists));
       execute_list(ctx, list);
    }
+   _mesa_call_profile_end(ctx, MESA_PROF_CALL_LIST, start);
 
    ctx->CompileFlag = save_compile_flag;
 
@@ -10649,6 +10942,10 @@ print_list(struct gl_context *ctx, GLuint list)
             printf("Error: %s %s\n",
                          enum_string(n[1].e), (const char *) n[2].data);
             break;
+         case OPCODE_NOP:
+            printf("NOP (%u nodes)\n", n[1].ui);
+            n += n[1].ui;
+            break;
          case OPCODE_CONTINUE:
             printf("DISPLAY-LIST-CONTINUE\n");
             n = (Node *) n[1].next;
@@ -10670,7 +10967,7 @@ print_list(struct gl_context *ctx, GLuint list)
             }
          }
          /* increment n to point to next compiled command */
-         if (opcode != OPCODE_CONTINUE) {
+         if (opcode != OPCODE_CONTINUE && opcode != OPCODE_NOP) {
             n += InstSize[opcode];
          }
       }
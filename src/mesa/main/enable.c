@@ -372,6 +372,7 @@ _mesa_set_enable(struct gl_context *ctx, GLenum cap, GLboolean state)
             return;
          FLUSH_VERTICES(ctx, _NEW_LIGHT);
          ctx->Light.Light[cap-GL_LIGHT0].Enabled = state;
+         ctx->Light._DirtyLights |= 1 << (cap - GL_LIGHT0);
          if (state) {
             insert_at_tail(&ctx->Light.EnabledList,
                            &ctx->Light.Light[cap-GL_LIGHT0]);
@@ -385,6 +386,8 @@ _mesa_set_enable(struct gl_context *ctx, GLenum cap, GLboolean state)
             return;
          FLUSH_VERTICES(ctx, _NEW_LIGHT);
          ctx->Light.Enabled = state;
+         /* positions aren't kept up to date while lighting is off */
+         ctx->Light._DirtyLights = ~0;
          if (ctx->Light.Enabled && ctx->Light.Model.TwoSide)
             ctx->_TriangleCaps |= DD_TRI_LIGHT_TWOSIDE;
          else
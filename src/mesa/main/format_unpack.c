@@ -28,6 +28,10 @@
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 /**
  * Convert an 8-bit sRGB value from non-linear space to a
@@ -1243,18 +1247,310 @@ get_unpack_rgba_function(gl_format format)
 }
 
 
+/**
+ * Unpack a row of texels to float RGBA.  Unlike the per-texel functions
+ * above, these let the compiler inline and vectorize the conversion.
+ */
+typedef void (*unpack_rgba_row_func)(const void *src, GLuint n,
+                                     GLuint srcStride, GLfloat dst[][4]);
+
+#define UNPACK_ROW(NAME)                                                \
+static void                                                             \
+unpack_row_##NAME(const void *src, GLuint n, GLuint srcStride,          \
+                  GLfloat dst[][4])                                     \
+{                                                                       \
+   const GLubyte *s = (const GLubyte *) src;                            \
+   GLuint i;                                                            \
+   for (i = 0; i < n; i++, s += srcStride)                              \
+      unpack_##NAME(s, dst[i]);                                         \
+}
+
+UNPACK_ROW(RGB888)
+UNPACK_ROW(BGR888)
+UNPACK_ROW(RGB565)
+UNPACK_ROW(RGB565_REV)
+UNPACK_ROW(ARGB4444)
+UNPACK_ROW(ARGB4444_REV)
+UNPACK_ROW(RGBA5551)
+UNPACK_ROW(ARGB1555)
+UNPACK_ROW(ARGB1555_REV)
+UNPACK_ROW(AL44)
+UNPACK_ROW(AL88)
+UNPACK_ROW(AL88_REV)
+UNPACK_ROW(AL1616)
+UNPACK_ROW(AL1616_REV)
+UNPACK_ROW(RGB332)
+UNPACK_ROW(A8)
+UNPACK_ROW(A16)
+UNPACK_ROW(L8)
+UNPACK_ROW(L16)
+UNPACK_ROW(I8)
+UNPACK_ROW(I16)
+UNPACK_ROW(YCBCR)
+UNPACK_ROW(YCBCR_REV)
+UNPACK_ROW(R8)
+UNPACK_ROW(RG88)
+UNPACK_ROW(RG88_REV)
+UNPACK_ROW(R16)
+UNPACK_ROW(RG1616)
+UNPACK_ROW(RG1616_REV)
+UNPACK_ROW(ARGB2101010)
+UNPACK_ROW(Z24_S8)
+UNPACK_ROW(S8_Z24)
+UNPACK_ROW(Z16)
+UNPACK_ROW(X8_Z24)
+UNPACK_ROW(Z24_X8)
+UNPACK_ROW(Z32)
+UNPACK_ROW(S8)
+UNPACK_ROW(SRGB8)
+UNPACK_ROW(SRGBA8)
+UNPACK_ROW(SARGB8)
+UNPACK_ROW(SL8)
+UNPACK_ROW(SLA8)
+UNPACK_ROW(RGBA_FLOAT32)
+UNPACK_ROW(RGBA_FLOAT16)
+UNPACK_ROW(RGB_FLOAT32)
+UNPACK_ROW(RGB_FLOAT16)
+UNPACK_ROW(ALPHA_FLOAT32)
+UNPACK_ROW(ALPHA_FLOAT16)
+UNPACK_ROW(LUMINANCE_FLOAT32)
+UNPACK_ROW(LUMINANCE_FLOAT16)
+UNPACK_ROW(LUMINANCE_ALPHA_FLOAT32)
+UNPACK_ROW(LUMINANCE_ALPHA_FLOAT16)
+UNPACK_ROW(INTENSITY_FLOAT32)
+UNPACK_ROW(INTENSITY_FLOAT16)
+UNPACK_ROW(R_FLOAT32)
+UNPACK_ROW(R_FLOAT16)
+UNPACK_ROW(RG_FLOAT32)
+UNPACK_ROW(RG_FLOAT16)
+UNPACK_ROW(RGBA_INT8)
+UNPACK_ROW(RGBA_INT16)
+UNPACK_ROW(RGBA_INT32)
+UNPACK_ROW(RGBA_UINT8)
+UNPACK_ROW(RGBA_UINT16)
+UNPACK_ROW(RGBA_UINT32)
+UNPACK_ROW(DUDV8)
+UNPACK_ROW(SIGNED_R8)
+UNPACK_ROW(SIGNED_RG88_REV)
+UNPACK_ROW(SIGNED_RGBX8888)
+UNPACK_ROW(SIGNED_RGBA8888)
+UNPACK_ROW(SIGNED_RGBA8888_REV)
+UNPACK_ROW(SIGNED_R16)
+UNPACK_ROW(SIGNED_GR1616)
+UNPACK_ROW(SIGNED_RGB_16)
+UNPACK_ROW(SIGNED_RGBA_16)
+UNPACK_ROW(RGBA_16)
+UNPACK_ROW(SIGNED_A8)
+UNPACK_ROW(SIGNED_L8)
+UNPACK_ROW(SIGNED_AL88)
+UNPACK_ROW(SIGNED_I8)
+UNPACK_ROW(SIGNED_A16)
+UNPACK_ROW(SIGNED_L16)
+UNPACK_ROW(SIGNED_AL1616)
+UNPACK_ROW(SIGNED_I16)
+UNPACK_ROW(RGB9_E5_FLOAT)
+UNPACK_ROW(R11_G11_B10_FLOAT)
+UNPACK_ROW(Z32_FLOAT)
+UNPACK_ROW(Z32_FLOAT_X24S8)
+
+#undef UNPACK_ROW
+
+
+#ifdef __SSE2__
+/**
+ * Unpack four texels of four 8-bit unorm channels to float at a time.
+ * R, G, B and A are the byte offsets of the channels in a texel (on this
+ * little-endian CPU), A < 0 meaning opaque.  Returns the number of texels
+ * done.  Dividing by 255 gives the same values as UBYTE_TO_FLOAT.
+ */
+#define UNPACK_8888_ROW_SSE2(src, n, dst, R, G, B, A)                   \
+   do {                                                                 \
+      const __m128i zero = _mm_setzero_si128();                         \
+      const __m128 scale = _mm_set1_ps(255.0F);                         \
+      const __m128 rgbMask =                                            \
+         _mm_castsi128_ps(_mm_set_epi32(0, ~0, ~0, ~0));                \
+      const __m128 alphaOne = _mm_set_ps(1.0F, 0.0F, 0.0F, 0.0F);       \
+      const GLubyte *s = (const GLubyte *) (src);                       \
+      for (i = 0; i + 4 <= (n); i += 4) {                               \
+         const __m128i p = _mm_loadu_si128((const __m128i *) (s + i * 4)); \
+         const __m128i lo = _mm_unpacklo_epi8(p, zero);                 \
+         const __m128i hi = _mm_unpackhi_epi8(p, zero);                 \
+         __m128 t[4];                                                   \
+         GLuint k;                                                      \
+         t[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));          \
+         t[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));          \
+         t[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));          \
+         t[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));          \
+         for (k = 0; k < 4; k++) {                                      \
+            __m128 v = _mm_shuffle_ps(t[k], t[k],                       \
+                                      _MM_SHUFFLE((A) < 0 ? 0 : (A),    \
+                                                  B, G, R));            \
+            v = _mm_div_ps(v, scale);                                   \
+            if ((A) < 0)                                                \
+               v = _mm_or_ps(_mm_and_ps(v, rgbMask), alphaOne);         \
+            _mm_storeu_ps((dst)[i + k], v);                             \
+         }                                                              \
+      }                                                                 \
+   } while (0)
+#else
+#define UNPACK_8888_ROW_SSE2(src, n, dst, R, G, B, A)
+#endif
+
+#define UNPACK_ROW_8888(NAME, R, G, B, A)                               \
+static void                                                             \
+unpack_row_##NAME(const void *src, GLuint n, GLuint srcStride,          \
+                  GLfloat dst[][4])                                     \
+{                                                                       \
+   const GLubyte *s = (const GLubyte *) src;                            \
+   GLuint i = 0;                                                        \
+   (void) srcStride;                                                    \
+   UNPACK_8888_ROW_SSE2(src, n, dst, R, G, B, A);                       \
+   for (; i < n; i++)                                                   \
+      unpack_##NAME(s + i * 4, dst[i]);                                 \
+}
+
+UNPACK_ROW_8888(RGBA8888, 3, 2, 1, 0)
+UNPACK_ROW_8888(RGBA8888_REV, 0, 1, 2, 3)
+UNPACK_ROW_8888(ARGB8888, 2, 1, 0, 3)
+UNPACK_ROW_8888(ARGB8888_REV, 1, 2, 3, 0)
+UNPACK_ROW_8888(XRGB8888, 2, 1, 0, -1)
+UNPACK_ROW_8888(XRGB8888_REV, 1, 2, 3, -1)
+
+#undef UNPACK_ROW_8888
+#undef UNPACK_8888_ROW_SSE2
+
+
+/**
+ * Return the row unpacker function for the given format, or NULL if
+ * there's none (compressed formats).
+ */
+static unpack_rgba_row_func
+get_unpack_rgba_row_function(gl_format format)
+{
+   static unpack_rgba_row_func table[MESA_FORMAT_COUNT];
+   static GLboolean initialized = GL_FALSE;
+
+   if (!initialized) {
+      table[MESA_FORMAT_RGBA8888] = unpack_row_RGBA8888;
+      table[MESA_FORMAT_RGBA8888_REV] = unpack_row_RGBA8888_REV;
+      table[MESA_FORMAT_ARGB8888] = unpack_row_ARGB8888;
+      table[MESA_FORMAT_ARGB8888_REV] = unpack_row_ARGB8888_REV;
+      table[MESA_FORMAT_XRGB8888] = unpack_row_XRGB8888;
+      table[MESA_FORMAT_XRGB8888_REV] = unpack_row_XRGB8888_REV;
+      table[MESA_FORMAT_RGB888] = unpack_row_RGB888;
+      table[MESA_FORMAT_BGR888] = unpack_row_BGR888;
+      table[MESA_FORMAT_RGB565] = unpack_row_RGB565;
+      table[MESA_FORMAT_RGB565_REV] = unpack_row_RGB565_REV;
+      table[MESA_FORMAT_ARGB4444] = unpack_row_ARGB4444;
+      table[MESA_FORMAT_ARGB4444_REV] = unpack_row_ARGB4444_REV;
+      table[MESA_FORMAT_RGBA5551] = unpack_row_RGBA5551;
+      table[MESA_FORMAT_ARGB1555] = unpack_row_ARGB1555;
+      table[MESA_FORMAT_ARGB1555_REV] = unpack_row_ARGB1555_REV;
+      table[MESA_FORMAT_AL44] = unpack_row_AL44;
+      table[MESA_FORMAT_AL88] = unpack_row_AL88;
+      table[MESA_FORMAT_AL88_REV] = unpack_row_AL88_REV;
+      table[MESA_FORMAT_AL1616] = unpack_row_AL1616;
+      table[MESA_FORMAT_AL1616_REV] = unpack_row_AL1616_REV;
+      table[MESA_FORMAT_RGB332] = unpack_row_RGB332;
+      table[MESA_FORMAT_A8] = unpack_row_A8;
+      table[MESA_FORMAT_A16] = unpack_row_A16;
+      table[MESA_FORMAT_L8] = unpack_row_L8;
+      table[MESA_FORMAT_L16] = unpack_row_L16;
+      table[MESA_FORMAT_I8] = unpack_row_I8;
+      table[MESA_FORMAT_I16] = unpack_row_I16;
+      table[MESA_FORMAT_YCBCR] = unpack_row_YCBCR;
+      table[MESA_FORMAT_YCBCR_REV] = unpack_row_YCBCR_REV;
+      table[MESA_FORMAT_R8] = unpack_row_R8;
+      table[MESA_FORMAT_RG88] = unpack_row_RG88;
+      table[MESA_FORMAT_RG88_REV] = unpack_row_RG88_REV;
+      table[MESA_FORMAT_R16] = unpack_row_R16;
+      table[MESA_FORMAT_RG1616] = unpack_row_RG1616;
+      table[MESA_FORMAT_RG1616_REV] = unpack_row_RG1616_REV;
+      table[MESA_FORMAT_ARGB2101010] = unpack_row_ARGB2101010;
+      table[MESA_FORMAT_Z24_S8] = unpack_row_Z24_S8;
+      table[MESA_FORMAT_S8_Z24] = unpack_row_S8_Z24;
+      table[MESA_FORMAT_Z16] = unpack_row_Z16;
+      table[MESA_FORMAT_X8_Z24] = unpack_row_X8_Z24;
+      table[MESA_FORMAT_Z24_X8] = unpack_row_Z24_X8;
+      table[MESA_FORMAT_Z32] = unpack_row_Z32;
+      table[MESA_FORMAT_S8] = unpack_row_S8;
+      table[MESA_FORMAT_SRGB8] = unpack_row_SRGB8;
+      table[MESA_FORMAT_SRGBA8] = unpack_row_SRGBA8;
+      table[MESA_FORMAT_SARGB8] = unpack_row_SARGB8;
+      table[MESA_FORMAT_SL8] = unpack_row_SL8;
+      table[MESA_FORMAT_SLA8] = unpack_row_SLA8;
+      table[MESA_FORMAT_RGBA_FLOAT32] = unpack_row_RGBA_FLOAT32;
+      table[MESA_FORMAT_RGBA_FLOAT16] = unpack_row_RGBA_FLOAT16;
+      table[MESA_FORMAT_RGB_FLOAT32] = unpack_row_RGB_FLOAT32;
+      table[MESA_FORMAT_RGB_FLOAT16] = unpack_row_RGB_FLOAT16;
+      table[MESA_FORMAT_ALPHA_FLOAT32] = unpack_row_ALPHA_FLOAT32;
+      table[MESA_FORMAT_ALPHA_FLOAT16] = unpack_row_ALPHA_FLOAT16;
+      table[MESA_FORMAT_LUMINANCE_FLOAT32] = unpack_row_LUMINANCE_FLOAT32;
+      table[MESA_FORMAT_LUMINANCE_FLOAT16] = unpack_row_LUMINANCE_FLOAT16;
+      table[MESA_FORMAT_LUMINANCE_ALPHA_FLOAT32] = unpack_row_LUMINANCE_ALPHA_FLOAT32;
+      table[MESA_FORMAT_LUMINANCE_ALPHA_FLOAT16] = unpack_row_LUMINANCE_ALPHA_FLOAT16;
+      table[MESA_FORMAT_INTENSITY_FLOAT32] = unpack_row_INTENSITY_FLOAT32;
+      table[MESA_FORMAT_INTENSITY_FLOAT16] = unpack_row_INTENSITY_FLOAT16;
+      table[MESA_FORMAT_R_FLOAT32] = unpack_row_R_FLOAT32;
+      table[MESA_FORMAT_R_FLOAT16] = unpack_row_R_FLOAT16;
+      table[MESA_FORMAT_RG_FLOAT32] = unpack_row_RG_FLOAT32;
+      table[MESA_FORMAT_RG_FLOAT16] = unpack_row_RG_FLOAT16;
+      table[MESA_FORMAT_RGBA_INT8] = unpack_row_RGBA_INT8;
+      table[MESA_FORMAT_RGBA_INT16] = unpack_row_RGBA_INT16;
+      table[MESA_FORMAT_RGBA_INT32] = unpack_row_RGBA_INT32;
+      table[MESA_FORMAT_RGBA_UINT8] = unpack_row_RGBA_UINT8;
+      table[MESA_FORMAT_RGBA_UINT16] = unpack_row_RGBA_UINT16;
+      table[MESA_FORMAT_RGBA_UINT32] = unpack_row_RGBA_UINT32;
+      table[MESA_FORMAT_DUDV8] = unpack_row_DUDV8;
+      table[MESA_FORMAT_SIGNED_R8] = unpack_row_SIGNED_R8;
+      table[MESA_FORMAT_SIGNED_RG88_REV] = unpack_row_SIGNED_RG88_REV;
+      table[MESA_FORMAT_SIGNED_RGBX8888] = unpack_row_SIGNED_RGBX8888;
+      table[MESA_FORMAT_SIGNED_RGBA8888] = unpack_row_SIGNED_RGBA8888;
+      table[MESA_FORMAT_SIGNED_RGBA8888_REV] = unpack_row_SIGNED_RGBA8888_REV;
+      table[MESA_FORMAT_SIGNED_R16] = unpack_row_SIGNED_R16;
+      table[MESA_FORMAT_SIGNED_GR1616] = unpack_row_SIGNED_GR1616;
+      table[MESA_FORMAT_SIGNED_RGB_16] = unpack_row_SIGNED_RGB_16;
+      table[MESA_FORMAT_SIGNED_RGBA_16] = unpack_row_SIGNED_RGBA_16;
+      table[MESA_FORMAT_RGBA_16] = unpack_row_RGBA_16;
+      table[MESA_FORMAT_SIGNED_A8] = unpack_row_SIGNED_A8;
+      table[MESA_FORMAT_SIGNED_L8] = unpack_row_SIGNED_L8;
+      table[MESA_FORMAT_SIGNED_AL88] = unpack_row_SIGNED_AL88;
+      table[MESA_FORMAT_SIGNED_I8] = unpack_row_SIGNED_I8;
+      table[MESA_FORMAT_SIGNED_A16] = unpack_row_SIGNED_A16;
+      table[MESA_FORMAT_SIGNED_L16] = unpack_row_SIGNED_L16;
+      table[MESA_FORMAT_SIGNED_AL1616] = unpack_row_SIGNED_AL1616;
+      table[MESA_FORMAT_SIGNED_I16] = unpack_row_SIGNED_I16;
+      table[MESA_FORMAT_RGB9_E5_FLOAT] = unpack_row_RGB9_E5_FLOAT;
+      table[MESA_FORMAT_R11_G11_B10_FLOAT] = unpack_row_R11_G11_B10_FLOAT;
+      table[MESA_FORMAT_Z32_FLOAT] = unpack_row_Z32_FLOAT;
+      table[MESA_FORMAT_Z32_FLOAT_X24S8] = unpack_row_Z32_FLOAT_X24S8;
+
+      initialized = GL_TRUE;
+   }
+
+   return table[format];
+}
+
+
 void
 _mesa_unpack_rgba_row(gl_format format, GLuint n,
                       const void *src, GLfloat dst[][4])
 {
-   unpack_rgba_func unpack = get_unpack_rgba_function(format);
+   unpack_rgba_row_func unpackRow = get_unpack_rgba_row_function(format);
    GLuint srcStride = _mesa_get_format_bytes(format);
-   const GLubyte *srcPtr = (GLubyte *) src;
-   GLuint i;
 
-   for (i = 0; i < n; i++) {
-      unpack(srcPtr, dst[i]);
-      srcPtr += srcStride;
+   if (unpackRow) {
+      unpackRow(src, n, srcStride, dst);
+   }
+   else {
+      unpack_rgba_func unpack = get_unpack_rgba_function(format);
+      const GLubyte *srcPtr = (GLubyte *) src;
+      GLuint i;
+
+      for (i = 0; i < n; i++) {
+         unpack(srcPtr, dst[i]);
+         srcPtr += srcStride;
+      }
    }
 }
 
@@ -1278,13 +1574,11 @@ _mesa_unpack_rgba_block(gl_format format,
                         GLfloat dst[][4], GLint dstRowStride,
                         GLuint x, GLuint y, GLuint width, GLuint height)
 {
-   unpack_rgba_func unpack = get_unpack_rgba_function(format);
    const GLuint srcPixStride = _mesa_get_format_bytes(format);
    const GLuint dstPixStride = 4 * sizeof(GLfloat);
-   const GLubyte *srcRow, *srcPix;
+   const GLubyte *srcRow;
    GLubyte *dstRow;
-   GLfloat *dstPix;
-   GLuint i, j;
+   GLuint i;
 
    /* XXX needs to be fixed for compressed formats */
 
@@ -1292,14 +1586,7 @@ _mesa_unpack_rgba_block(gl_format format,
    dstRow = ((GLubyte *) dst) + dstRowStride * y + dstPixStride * x;
 
    for (i = 0; i < height; i++) {
-      srcPix = srcRow;
-      dstPix = (GLfloat *) dstRow;
-
-      for (j = 0; j < width; j++) {
-         unpack(srcPix, dstPix);
-         srcPix += srcPixStride;
-         dstPix += dstPixStride;
-      }
+      _mesa_unpack_rgba_row(format, width, srcRow, (GLfloat (*)[4]) dstRow);
 
       dstRow += dstRowStride;
       srcRow += srcRowStride;
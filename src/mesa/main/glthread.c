@@ -0,0 +1,586 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glthread.c
+ * Threaded dispatch.
+ *
+ * When the MESA_GLTHREAD environment variable is set, each context gets a
+ * worker thread the first time it is made current, and the application
+ * thread's dispatch table is replaced by the marshalling functions
+ * generated by gl_marshal.py.  Those append a command to the current batch
+ * and return; full batches are handed to the worker, which replays them
+ * through the context's own dispatch.
+ *
+ * Calls that return data, or whose arguments can't be copied, flush the
+ * batch and wait for the worker to execute them (_mesa_glthread_finish()).
+ * All GL state lives on the worker thread; the little the application
+ * thread needs to decide whether a draw can be queued is tracked below.
+ */
+
+#include "main/glheader.h"
+#include "main/imports.h"
+#include "main/context.h"
+#include "main/hash.h"
+#include "main/mtypes.h"
+#include "main/glthread.h"
+#include "main/marshal_generated.h"
+#include "glapi/glapi.h"
+
+#ifdef PTHREADS
+
+
+static void
+glthread_execute_batch(struct gl_context *ctx, struct glthread_batch *batch)
+{
+   const GLubyte *pos = (const GLubyte *) batch->Buffer;
+   const GLubyte *end = pos + batch->Used;
+
+   while (pos < end) {
+      const struct marshal_cmd_base *cmd = (const struct marshal_cmd_base *) pos;
+      _mesa_unmarshal_dispatch[cmd->cmd_id](ctx, cmd);
+      pos += cmd->cmd_size;
+   }
+
+   batch->Used = 0;
+}
+
+
+static void *
+glthread_worker(void *data)
+{
+   struct gl_context *ctx = (struct gl_context *) data;
+   struct glthread_state *glthread = ctx->GLThread;
+
+   _glapi_check_multithread();
+   _glapi_set_context(ctx);
+   _glapi_set_dispatch(ctx->CurrentDispatch);
+
+   pthread_mutex_lock(&glthread->Mutex);
+   for (;;) {
+      struct glthread_batch *batch;
+
+      while (!glthread->Queue && !glthread->Shutdown)
+         pthread_cond_wait(&glthread->NewWork, &glthread->Mutex);
+
+      if (!glthread->Queue)
+         break;
+
+      batch = glthread->Queue;
+      glthread->Queue = batch->Next;
+      if (!glthread->Queue)
+         glthread->QueueTail = NULL;
+      glthread->Busy = GL_TRUE;
+      pthread_mutex_unlock(&glthread->Mutex);
+
+      glthread_execute_batch(ctx, batch);
+
+      pthread_mutex_lock(&glthread->Mutex);
+      batch->Next = glthread->FreeList;
+      glthread->FreeList = batch;
+      glthread->Busy = GL_FALSE;
+      pthread_cond_broadcast(&glthread->WorkDone);
+   }
+   pthread_mutex_unlock(&glthread->Mutex);
+
+   return NULL;
+}
+
+
+static void
+free_vao_cb(GLuint id, void *data, void *userData)
+{
+   (void) id;
+   (void) userData;
+   free(data);
+}
+
+
+static void
+glthread_free(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_batch *batch;
+
+   free(glthread->Current);
+   while ((batch = glthread->FreeList)) {
+      glthread->FreeList = batch->Next;
+      free(batch);
+   }
+
+   if (glthread->VAOs) {
+      _mesa_HashDeleteAll(glthread->VAOs, free_vao_cb, NULL);
+      _mesa_DeleteHashTable(glthread->VAOs);
+   }
+
+   pthread_mutex_destroy(&glthread->Mutex);
+   pthread_cond_destroy(&glthread->NewWork);
+   pthread_cond_destroy(&glthread->WorkDone);
+
+   free(ctx->MarshalExec);
+   ctx->MarshalExec = NULL;
+
+   free(glthread);
+   ctx->GLThread = NULL;
+}
+
+
+/**
+ * Start the worker thread of a context.  Called from _mesa_make_current()
+ * the first time the context is bound.  On failure the context simply
+ * keeps executing calls directly.
+ */
+void
+_mesa_glthread_init(struct gl_context *ctx)
+{
+   struct glthread_state *glthread;
+   GLuint i;
+
+   glthread = (struct glthread_state *) calloc(1, sizeof(*glthread));
+   if (!glthread)
+      return;
+
+   pthread_mutex_init(&glthread->Mutex, NULL);
+   pthread_cond_init(&glthread->NewWork, NULL);
+   pthread_cond_init(&glthread->WorkDone, NULL);
+   ctx->GLThread = glthread;
+
+   for (i = 0; i < GLTHREAD_NUM_BATCHES; i++) {
+      struct glthread_batch *batch =
+         (struct glthread_batch *) malloc(sizeof(*batch));
+      if (!batch)
+         break;
+      batch->Used = 0;
+      batch->Next = glthread->FreeList;
+      glthread->FreeList = batch;
+   }
+
+   glthread->VAOs = _mesa_NewHashTable();
+   glthread->CurrentVAO = &glthread->DefaultVAO;
+   ctx->MarshalExec = _mesa_create_marshal_table();
+
+   /* one batch being filled, at least one being executed */
+   if (i < 2 || !glthread->VAOs || !ctx->MarshalExec) {
+      glthread_free(ctx);
+      return;
+   }
+
+   glthread->Current = glthread->FreeList;
+   glthread->FreeList = glthread->Current->Next;
+
+   if (pthread_create(&glthread->Thread, NULL, glthread_worker, ctx) != 0) {
+      _mesa_warning(ctx, "couldn't start the GL dispatch thread");
+      glthread_free(ctx);
+      return;
+   }
+}
+
+
+/**
+ * Execute everything that is queued and stop the worker thread.
+ */
+void
+_mesa_glthread_destroy(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (!glthread)
+      return;
+
+   _mesa_glthread_finish(ctx);
+
+   pthread_mutex_lock(&glthread->Mutex);
+   glthread->Shutdown = GL_TRUE;
+   pthread_cond_signal(&glthread->NewWork);
+   pthread_mutex_unlock(&glthread->Mutex);
+
+   pthread_join(glthread->Thread, NULL);
+
+   glthread_free(ctx);
+}
+
+
+/**
+ * Hand the current batch to the worker and start a new one, waiting for
+ * the worker if all batches are in use.
+ */
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_batch *batch;
+
+   if (!glthread)
+      return;
+
+   batch = glthread->Current;
+   if (batch->Used == 0)
+      return;
+
+   pthread_mutex_lock(&glthread->Mutex);
+
+   batch->Next = NULL;
+   if (glthread->QueueTail)
+      glthread->QueueTail->Next = batch;
+   else
+      glthread->Queue = batch;
+   glthread->QueueTail = batch;
+   pthread_cond_signal(&glthread->NewWork);
+
+   while (!glthread->FreeList)
+      pthread_cond_wait(&glthread->WorkDone, &glthread->Mutex);
+
+   glthread->Current = glthread->FreeList;
+   glthread->FreeList = glthread->Current->Next;
+
+   pthread_mutex_unlock(&glthread->Mutex);
+}
+
+
+/**
+ * Wait until the worker has executed every command recorded so far.
+ * Does nothing when called on the worker thread itself, e.g. by a driver
+ * flushing from within a GL call.
+ */
+void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (!glthread || pthread_equal(pthread_self(), glthread->Thread))
+      return;
+
+   _mesa_glthread_flush_batch(ctx);
+
+   pthread_mutex_lock(&glthread->Mutex);
+   while (glthread->Queue || glthread->Busy)
+      pthread_cond_wait(&glthread->WorkDone, &glthread->Mutex);
+   pthread_mutex_unlock(&glthread->Mutex);
+}
+
+
+/**
+ * \name Vertex array tracking on the application thread
+ *
+ * These are called after the corresponding call has been marshalled.
+ * Errors in the calls are not checked; where the outcome isn't known the
+ * state errs on the side of arrays being in client memory.
+ */
+/*@{*/
+
+void
+_mesa_glthread_array_pointer(struct gl_context *ctx, GLuint array,
+                             const GLvoid *pointer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   (void) pointer;
+
+   if (array >= GLTHREAD_ARRAY_MAX)
+      return;
+
+   if (glthread->ArrayBuffer)
+      glthread->CurrentVAO->UserPointerMask &= ~(1u << array);
+   else
+      glthread->CurrentVAO->UserPointerMask |= 1u << array;
+}
+
+
+/**
+ * glInterleavedArrays sets (and enables) at most the vertex, normal, color
+ * and current texture coordinate arrays.  Treating all four as set and
+ * enabled is safe whatever \p format says.
+ */
+void
+_mesa_glthread_InterleavedArrays(struct gl_context *ctx, GLenum format,
+                                 const GLvoid *pointer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   const GLuint texcoord = GLTHREAD_ARRAY_TEXCOORD(glthread->ClientActiveTexture);
+   const GLbitfield arrays = (1u << GLTHREAD_ARRAY_VERTEX) |
+                             (1u << GLTHREAD_ARRAY_NORMAL) |
+                             (1u << GLTHREAD_ARRAY_COLOR) |
+                             (1u << texcoord);
+
+   (void) format;
+
+   _mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_VERTEX, pointer);
+   _mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_NORMAL, pointer);
+   _mesa_glthread_array_pointer(ctx, GLTHREAD_ARRAY_COLOR, pointer);
+   _mesa_glthread_array_pointer(ctx, texcoord, pointer);
+   glthread->CurrentVAO->EnabledMask |= arrays;
+}
+
+
+/**
+ * Called by glEnable/Disable and glEnable/DisableClientState.  Caps that
+ * aren't vertex arrays are ignored.
+ */
+void
+_mesa_glthread_ClientState(struct gl_context *ctx, GLenum cap,
+                           GLboolean enable)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLuint array;
+
+   switch (cap) {
+   case GL_VERTEX_ARRAY:
+      array = GLTHREAD_ARRAY_VERTEX;
+      break;
+   case GL_NORMAL_ARRAY:
+      array = GLTHREAD_ARRAY_NORMAL;
+      break;
+   case GL_COLOR_ARRAY:
+      array = GLTHREAD_ARRAY_COLOR;
+      break;
+   case GL_SECONDARY_COLOR_ARRAY_EXT:
+      array = GLTHREAD_ARRAY_COLOR2;
+      break;
+   case GL_FOG_COORDINATE_ARRAY_EXT:
+      array = GLTHREAD_ARRAY_FOGCOORD;
+      break;
+   case GL_INDEX_ARRAY:
+      array = GLTHREAD_ARRAY_INDEX;
+      break;
+   case GL_EDGE_FLAG_ARRAY:
+      array = GLTHREAD_ARRAY_EDGEFLAG;
+      break;
+   case GL_POINT_SIZE_ARRAY_OES:
+      array = GLTHREAD_ARRAY_POINTSIZE;
+      break;
+   case GL_TEXTURE_COORD_ARRAY:
+      array = GLTHREAD_ARRAY_TEXCOORD(glthread->ClientActiveTexture);
+      break;
+   default:
+      if (cap >= GL_VERTEX_ATTRIB_ARRAY0_NV &&
+          cap <= GL_VERTEX_ATTRIB_ARRAY15_NV) {
+         array = GLTHREAD_ARRAY_GENERIC(cap - GL_VERTEX_ATTRIB_ARRAY0_NV);
+         break;
+      }
+      return;
+   }
+
+   if (enable)
+      glthread->CurrentVAO->EnabledMask |= 1u << array;
+   else
+      glthread->CurrentVAO->EnabledMask &= ~(1u << array);
+}
+
+
+void
+_mesa_glthread_VertexAttribArray(struct gl_context *ctx, GLuint index,
+                                 GLboolean enable)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   const GLuint array = GLTHREAD_ARRAY_GENERIC(index);
+
+   if (index >= MAX_VERTEX_GENERIC_ATTRIBS)
+      return;
+
+   if (enable)
+      glthread->CurrentVAO->EnabledMask |= 1u << array;
+   else
+      glthread->CurrentVAO->EnabledMask &= ~(1u << array);
+}
+
+
+void
+_mesa_glthread_ClientActiveTexture(struct gl_context *ctx, GLenum texture)
+{
+   const GLuint unit = texture - GL_TEXTURE0;
+
+   if (unit < MAX_TEXTURE_COORD_UNITS)
+      ctx->GLThread->ClientActiveTexture = unit;
+}
+
+
+void
+_mesa_glthread_PushClientAttrib(struct gl_context *ctx, GLbitfield mask)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_client_attrib *attrib;
+
+   if (glthread->AttribStackDepth >= MAX_CLIENT_ATTRIB_STACK_DEPTH)
+      return;
+
+   attrib = &glthread->AttribStack[glthread->AttribStackDepth++];
+   attrib->Valid = (mask & GL_CLIENT_VERTEX_ARRAY_BIT) != 0;
+   if (attrib->Valid) {
+      attrib->VAO = *glthread->CurrentVAO;
+      attrib->ArrayBuffer = glthread->ArrayBuffer;
+      attrib->ElementBuffer = glthread->ElementBuffer;
+      attrib->ClientActiveTexture = glthread->ClientActiveTexture;
+   }
+}
+
+
+void
+_mesa_glthread_PopClientAttrib(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_client_attrib *attrib;
+
+   if (glthread->AttribStackDepth == 0)
+      return;
+
+   attrib = &glthread->AttribStack[--glthread->AttribStackDepth];
+   if (!attrib->Valid)
+      return;
+
+   /* Mesa rebinds the saved array object and restores its contents */
+   _mesa_glthread_BindVertexArray(ctx, attrib->VAO.Name);
+   glthread->CurrentVAO->UserPointerMask = attrib->VAO.UserPointerMask;
+   glthread->CurrentVAO->EnabledMask = attrib->VAO.EnabledMask;
+   glthread->ArrayBuffer = attrib->ArrayBuffer;
+   glthread->ElementBuffer = attrib->ElementBuffer;
+   glthread->ClientActiveTexture = attrib->ClientActiveTexture;
+}
+
+
+void
+_mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                          GLuint buffer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   switch (target) {
+   case GL_ARRAY_BUFFER_ARB:
+      glthread->ArrayBuffer = buffer;
+      break;
+   case GL_ELEMENT_ARRAY_BUFFER_ARB:
+      glthread->ElementBuffer = buffer;
+      break;
+   }
+}
+
+
+void
+_mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                             const GLuint *buffers)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLsizei i;
+
+   if (n < 0 || !buffers)
+      return;
+
+   /* deleting a bound buffer unbinds it */
+   for (i = 0; i < n; i++) {
+      if (buffers[i] == 0)
+         continue;
+      if (buffers[i] == glthread->ArrayBuffer)
+         glthread->ArrayBuffer = 0;
+      if (buffers[i] == glthread->ElementBuffer)
+         glthread->ElementBuffer = 0;
+   }
+}
+
+
+void
+_mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint id)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao;
+
+   if (id == 0) {
+      glthread->CurrentVAO = &glthread->DefaultVAO;
+      return;
+   }
+
+   vao = (struct glthread_vao *) _mesa_HashLookup(glthread->VAOs, id);
+   if (!vao) {
+      /* Not generated by us: either an error, or APPLE_vertex_array_object
+       * creating the object on bind.  Assume the worst.
+       */
+      vao = (struct glthread_vao *) malloc(sizeof(*vao));
+      if (!vao)
+         return;
+      vao->Name = id;
+      vao->UserPointerMask = ~0u;
+      vao->EnabledMask = ~0u;
+      _mesa_HashInsert(glthread->VAOs, id, vao);
+   }
+
+   glthread->CurrentVAO = vao;
+}
+
+
+void
+_mesa_glthread_GenVertexArrays(struct gl_context *ctx, GLsizei n,
+                               const GLuint *arrays)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLsizei i;
+
+   if (n < 0 || !arrays)
+      return;
+
+   for (i = 0; i < n; i++) {
+      struct glthread_vao *vao =
+         (struct glthread_vao *) _mesa_HashLookup(glthread->VAOs, arrays[i]);
+
+      if (!vao) {
+         vao = (struct glthread_vao *) malloc(sizeof(*vao));
+         if (!vao)
+            return;
+         vao->Name = arrays[i];
+         _mesa_HashInsert(glthread->VAOs, arrays[i], vao);
+      }
+      vao->UserPointerMask = 0;
+      vao->EnabledMask = 0;
+   }
+}
+
+
+void
+_mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *arrays)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLsizei i;
+
+   if (n < 0 || !arrays)
+      return;
+
+   for (i = 0; i < n; i++) {
+      struct glthread_vao *vao;
+
+      if (arrays[i] == 0)
+         continue;
+
+      vao = (struct glthread_vao *) _mesa_HashLookup(glthread->VAOs, arrays[i]);
+      if (!vao)
+         continue;
+
+      /* deleting the bound array object binds the default one */
+      if (glthread->CurrentVAO == vao)
+         glthread->CurrentVAO = &glthread->DefaultVAO;
+
+      _mesa_HashRemove(glthread->VAOs, arrays[i]);
+      free(vao);
+   }
+}
+
+/*@}*/
+
+#endif /* PTHREADS */
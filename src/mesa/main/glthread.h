@@ -0,0 +1,268 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glthread.h
+ * Threaded dispatch: GL calls are recorded by the application thread and
+ * executed by a per-context worker thread.
+ */
+
+#ifndef MESA_GLTHREAD_H
+#define MESA_GLTHREAD_H
+
+#include "main/glheader.h"
+#include "main/config.h"
+#include "main/marshal.h"
+#include "main/mtypes.h"
+
+struct gl_context;
+struct _mesa_HashTable;
+
+
+/**
+ * Vertex arrays tracked by the application thread, as bit numbers of
+ * glthread_vao::UserPointerMask and EnabledMask.
+ */
+enum {
+   GLTHREAD_ARRAY_VERTEX,
+   GLTHREAD_ARRAY_NORMAL,
+   GLTHREAD_ARRAY_COLOR,
+   GLTHREAD_ARRAY_COLOR2,
+   GLTHREAD_ARRAY_FOGCOORD,
+   GLTHREAD_ARRAY_INDEX,
+   GLTHREAD_ARRAY_EDGEFLAG,
+   GLTHREAD_ARRAY_POINTSIZE,
+   GLTHREAD_ARRAY_TEXCOORD0,
+   GLTHREAD_ARRAY_GENERIC0 = GLTHREAD_ARRAY_TEXCOORD0 + MAX_TEXTURE_COORD_UNITS,
+   GLTHREAD_ARRAY_MAX = GLTHREAD_ARRAY_GENERIC0 + MAX_VERTEX_GENERIC_ATTRIBS
+};
+
+#define GLTHREAD_ARRAY_TEXCOORD(unit) (GLTHREAD_ARRAY_TEXCOORD0 + (unit))
+#define GLTHREAD_ARRAY_GENERIC(index) (GLTHREAD_ARRAY_GENERIC0 + (index))
+
+
+#ifdef PTHREADS
+
+#include <pthread.h>
+
+/** Size of a batch of commands in bytes. */
+#define GLTHREAD_BATCH_SIZE (256 * 1024)
+
+/** Number of batches; the application blocks when all of them are full. */
+#define GLTHREAD_NUM_BATCHES 4
+
+
+struct glthread_batch
+{
+   struct glthread_batch *Next;
+   GLuint Used;   /**< bytes of Buffer holding commands */
+   uint64_t Buffer[GLTHREAD_BATCH_SIZE / 8];
+};
+
+
+/**
+ * What the application thread knows about a vertex array object.
+ */
+struct glthread_vao
+{
+   GLuint Name;
+   GLbitfield UserPointerMask;   /**< arrays in client memory */
+   GLbitfield EnabledMask;
+};
+
+
+/** Saved by glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT). */
+struct glthread_client_attrib
+{
+   GLboolean Valid;
+   struct glthread_vao VAO;
+   GLuint ArrayBuffer;
+   GLuint ElementBuffer;
+   GLuint ClientActiveTexture;
+};
+
+
+struct glthread_state
+{
+   /** Batch the application thread is currently filling. */
+   struct glthread_batch *Current;
+
+   /** \name Shared with the worker thread, protected by Mutex */
+   /*@{*/
+   pthread_t Thread;
+   pthread_mutex_t Mutex;
+   pthread_cond_t NewWork;    /**< a batch was queued, or shutdown */
+   pthread_cond_t WorkDone;   /**< a batch was executed */
+   struct glthread_batch *Queue, *QueueTail;
+   struct glthread_batch *FreeList;
+   GLboolean Busy;            /**< worker is executing a batch */
+   GLboolean Shutdown;
+   /*@}*/
+
+   /**
+    * \name Vertex array state, as seen by the application thread
+    *
+    * Draw calls are only queued when none of the enabled arrays and no
+    * indices live in client memory.  The state is tracked conservatively:
+    * anything glthread doesn't know about makes draws synchronous.
+    */
+   /*@{*/
+   struct _mesa_HashTable *VAOs;
+   struct glthread_vao DefaultVAO;
+   struct glthread_vao *CurrentVAO;
+   GLuint ArrayBuffer;
+   GLuint ElementBuffer;
+   GLuint ClientActiveTexture;
+   struct glthread_client_attrib AttribStack[MAX_CLIENT_ATTRIB_STACK_DEPTH];
+   GLuint AttribStackDepth;
+   /*@}*/
+};
+
+
+extern void
+_mesa_glthread_init(struct gl_context *ctx);
+
+extern void
+_mesa_glthread_destroy(struct gl_context *ctx);
+
+extern void
+_mesa_glthread_flush_batch(struct gl_context *ctx);
+
+extern void
+_mesa_glthread_finish(struct gl_context *ctx);
+
+extern void
+_mesa_glthread_array_pointer(struct gl_context *ctx, GLuint array,
+                             const GLvoid *pointer);
+
+extern void
+_mesa_glthread_InterleavedArrays(struct gl_context *ctx, GLenum format,
+                                 const GLvoid *pointer);
+
+extern void
+_mesa_glthread_ClientState(struct gl_context *ctx, GLenum cap,
+                           GLboolean enable);
+
+extern void
+_mesa_glthread_VertexAttribArray(struct gl_context *ctx, GLuint index,
+                                 GLboolean enable);
+
+extern void
+_mesa_glthread_ClientActiveTexture(struct gl_context *ctx, GLenum texture);
+
+extern void
+_mesa_glthread_PushClientAttrib(struct gl_context *ctx, GLbitfield mask);
+
+extern void
+_mesa_glthread_PopClientAttrib(struct gl_context *ctx);
+
+extern void
+_mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                          GLuint buffer);
+
+extern void
+_mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                             const GLuint *buffers);
+
+extern void
+_mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint id);
+
+extern void
+_mesa_glthread_GenVertexArrays(struct gl_context *ctx, GLsizei n,
+                               const GLuint *arrays);
+
+extern void
+_mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *arrays);
+
+
+/**
+ * Reserve \p size bytes for a command in the current batch and fill in
+ * its header.  The caller fills in the rest.
+ */
+static INLINE void *
+_mesa_glthread_allocate_command(struct gl_context *ctx, GLushort cmd_id,
+                                size_t size)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_batch *batch = glthread->Current;
+   struct marshal_cmd_base *cmd;
+
+   /* keep every command 8-byte aligned */
+   size = (size + 7) & ~(size_t) 7;
+
+   if (batch->Used + size > GLTHREAD_BATCH_SIZE) {
+      _mesa_glthread_flush_batch(ctx);
+      batch = glthread->Current;
+   }
+
+   cmd = (struct marshal_cmd_base *) ((GLubyte *) batch->Buffer + batch->Used);
+   batch->Used += size;
+   cmd->cmd_id = cmd_id;
+   cmd->cmd_size = size;
+   return cmd;
+}
+
+
+/**
+ * Return true if a draw call can be queued, i.e. the worker will not read
+ * any client memory the application could change after the call returns.
+ */
+static INLINE GLboolean
+_mesa_glthread_can_queue_draw(struct gl_context *ctx, GLboolean indexed)
+{
+   const struct glthread_state *glthread = ctx->GLThread;
+   const struct glthread_vao *vao = glthread->CurrentVAO;
+
+   if (vao->UserPointerMask & vao->EnabledMask)
+      return GL_FALSE;
+   if (indexed && glthread->ElementBuffer == 0)
+      return GL_FALSE;
+   return GL_TRUE;
+}
+
+#else /* PTHREADS */
+
+static INLINE void
+_mesa_glthread_init(struct gl_context *ctx)
+{
+}
+
+static INLINE void
+_mesa_glthread_destroy(struct gl_context *ctx)
+{
+}
+
+static INLINE void
+_mesa_glthread_flush_batch(struct gl_context *ctx)
+{
+}
+
+static INLINE void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+}
+
+#endif /* PTHREADS */
+
+#endif /* MESA_GLTHREAD_H */
@@ -41,13 +41,34 @@
 #include "hash.h"
 
 
-#define TABLE_SIZE 1023  /**< Size of lookup table/array */
+/**
+ * Keys below this always get a slot in the directly indexed array.
+ * Above it the array only grows while it stays reasonably full, see
+ * dense_should_grow().
+ */
+#define DENSE_FREE_SIZE  (64 * 1024)
+
+/** Keys at or above this always go to the overflow table. */
+#define DENSE_MAX_SIZE   (4 * 1024 * 1024)
 
-#define HASH_FUNC(K)  ((K) % TABLE_SIZE)
+#define DENSE_MIN_SIZE   64
+#define SPARSE_MIN_SIZE  16
 
+#define SPARSE_HASH(K, SIZE)  (((K) ^ ((K) >> 16)) & ((SIZE) - 1))
 
 /**
- * An entry in the hash table.  
+ * Make the stores that fill in an object or array visible to other
+ * threads before the store that publishes the pointer to it.
+ */
+#if defined(__GNUC__)
+#define PUBLISH_BARRIER()  __sync_synchronize()
+#else
+#define PUBLISH_BARRIER()
+#endif
+
+
+/**
+ * An entry in the overflow table.
  */
 struct HashEntry {
    GLuint Key;             /**< the entry's key */
@@ -57,17 +78,54 @@ struct HashEntry {
 
 
 /**
- * The hash table data structure.  
+ * Array of data pointers directly indexed by key.
+ *
+ * When the array grows, the old one is kept on the Retired list until the
+ * table is deleted, since a reader may still be looking at it.  As the
+ * size doubles each time, the retired arrays never take more memory than
+ * the current one.
+ */
+struct DenseArray {
+   GLuint Size;                 /**< number of slots in Data */
+   struct DenseArray *Retired;  /**< the previous (smaller) array */
+   void *Data[1];               /**< NULL where there is no entry */
+};
+
+
+/**
+ * The hash table data structure.
+ *
+ * GL object names are normally handed out in increasing order by
+ * _mesa_HashFindFreeKeyBlock, so most keys are small and dense.  Those
+ * live in a directly indexed array which is read without taking the lock.
+ * The remaining keys go to a chained overflow table that grows with the
+ * number of entries and is only accessed with the lock held.
  */
 struct _mesa_HashTable {
-   struct HashEntry *Table[TABLE_SIZE];  /**< the lookup table */
+   struct DenseArray * volatile Dense;   /**< entries for keys < Dense->Size */
+   struct HashEntry **Sparse;            /**< overflow table buckets */
+   GLuint SparseSize;                    /**< number of buckets (pow2 or 0) */
+   GLuint SparseCount;                   /**< entries in the overflow table */
+   GLuint NumEntries;                    /**< total number of entries */
    GLuint MaxKey;                        /**< highest key inserted so far */
    _glthread_Mutex Mutex;                /**< mutual exclusion lock */
    _glthread_Mutex WalkMutex;            /**< for _mesa_HashWalk() */
+   GLuint Walking;                       /**< walks in progress, no growth */
    GLboolean InDeleteAll;                /**< Debug check */
 };
 
 
+static struct DenseArray *
+dense_alloc(GLuint size)
+{
+   struct DenseArray *dense = (struct DenseArray *)
+      calloc(1, sizeof(struct DenseArray) + (size - 1) * sizeof(void *));
+   if (dense)
+      dense->Size = size;
+   return dense;
+}
+
+
 
 /**
  * Create a new hash table.
@@ -79,6 +137,11 @@ _mesa_NewHashTable(void)
 {
    struct _mesa_HashTable *table = CALLOC_STRUCT(_mesa_HashTable);
    if (table) {
+      table->Dense = dense_alloc(DENSE_MIN_SIZE);
+      if (!table->Dense) {
+         free(table);
+         return NULL;
+      }
       _glthread_INIT_MUTEX(table->Mutex);
       _glthread_INIT_MUTEX(table->WalkMutex);
    }
@@ -98,20 +161,31 @@ _mesa_NewHashTable(void)
 void
 _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 {
+   struct DenseArray *dense;
    GLuint pos;
    assert(table);
-   for (pos = 0; pos < TABLE_SIZE; pos++) {
-      struct HashEntry *entry = table->Table[pos];
+
+   if (table->NumEntries) {
+      _mesa_problem(NULL, "In _mesa_DeleteHashTable, found non-freed data");
+   }
+
+   for (pos = 0; pos < table->SparseSize; pos++) {
+      struct HashEntry *entry = table->Sparse[pos];
       while (entry) {
 	 struct HashEntry *next = entry->Next;
-         if (entry->Data) {
-            _mesa_problem(NULL,
-                          "In _mesa_DeleteHashTable, found non-freed data");
-         }
 	 free(entry);
 	 entry = next;
       }
    }
+   free(table->Sparse);
+
+   dense = table->Dense;
+   while (dense) {
+      struct DenseArray *retired = dense->Retired;
+      free(dense);
+      dense = retired;
+   }
+
    _glthread_DESTROY_MUTEX(table->Mutex);
    _glthread_DESTROY_MUTEX(table->WalkMutex);
    free(table);
@@ -119,6 +193,26 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 
 
 
+/**
+ * Find an entry of the overflow table.  Must be called with the lock held.
+ */
+static struct HashEntry *
+sparse_find(const struct _mesa_HashTable *table, GLuint key)
+{
+   struct HashEntry *entry;
+
+   if (!table->SparseSize)
+      return NULL;
+
+   for (entry = table->Sparse[SPARSE_HASH(key, table->SparseSize)];
+        entry; entry = entry->Next) {
+      if (entry->Key == key)
+         return entry;
+   }
+   return NULL;
+}
+
+
 /**
  * Lookup an entry in the hash table, without locking.
  * \sa _mesa_HashLookup
@@ -126,26 +220,24 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 static INLINE void *
 _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 {
-   GLuint pos;
+   const struct DenseArray *dense = table->Dense;
    const struct HashEntry *entry;
 
    assert(table);
    assert(key);
 
-   pos = HASH_FUNC(key);
-   entry = table->Table[pos];
-   while (entry) {
-      if (entry->Key == key) {
-         return entry->Data;
-      }
-      entry = entry->Next;
-   }
-   return NULL;
+   if (key < dense->Size)
+      return dense->Data[key];
+
+   entry = sparse_find(table, key);
+   return entry ? entry->Data : NULL;
 }
 
 
 /**
  * Lookup an entry in the hash table.
+ *
+ * Keys in the directly indexed array are looked up without locking.
  * 
  * \param table the hash table.
  * \param key the key.
@@ -155,8 +247,18 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
 void *
 _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
+   const struct DenseArray *dense;
    void *res;
    assert(table);
+   assert(key);
+
+   dense = table->Dense;
+   if (key < dense->Size)
+      return dense->Data[key];
+
+   /* The array may have grown to cover the key since we looked at it, so
+    * _mesa_HashLookup_unlocked checks it again.
+    */
    _glthread_LOCK_MUTEX(table->Mutex);
    res = _mesa_HashLookup_unlocked(table, key);
    _glthread_UNLOCK_MUTEX(table->Mutex);
@@ -164,9 +266,136 @@ _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 }
 
 
+/**
+ * Whether inserting \p key should grow the directly indexed array rather
+ * than use the overflow table.  The array is kept to within a small
+ * multiple of the number of entries, so a few stray large names can't
+ * blow it up.
+ */
+static GLboolean
+dense_should_grow(const struct _mesa_HashTable *table, GLuint key)
+{
+   if (key >= DENSE_MAX_SIZE)
+      return GL_FALSE;
+
+   return key < DENSE_FREE_SIZE || key / 4 < table->NumEntries + 1;
+}
+
+
+/**
+ * Replace the directly indexed array with one large enough for \p key and
+ * move the overflow entries it now covers into it.
+ */
+static GLboolean
+dense_grow(struct _mesa_HashTable *table, GLuint key)
+{
+   struct DenseArray *old = table->Dense;
+   struct DenseArray *dense;
+   GLuint size = old->Size;
+   GLuint pos;
+
+   while (size <= key)
+      size *= 2;
+
+   dense = dense_alloc(size);
+   if (!dense)
+      return GL_FALSE;
+
+   memcpy(dense->Data, old->Data, old->Size * sizeof(void *));
+
+   for (pos = 0; pos < table->SparseSize; pos++) {
+      struct HashEntry **link = &table->Sparse[pos];
+      while (*link) {
+         struct HashEntry *entry = *link;
+         if (entry->Key < size) {
+            dense->Data[entry->Key] = entry->Data;
+            *link = entry->Next;
+            table->SparseCount--;
+            free(entry);
+         }
+         else {
+            link = &entry->Next;
+         }
+      }
+   }
+
+   dense->Retired = old;
+
+   PUBLISH_BARRIER();
+   table->Dense = dense;
+   return GL_TRUE;
+}
+
+
+/**
+ * Double the number of overflow buckets.
+ */
+static void
+sparse_grow(struct _mesa_HashTable *table)
+{
+   GLuint size = table->SparseSize ? table->SparseSize * 2 : SPARSE_MIN_SIZE;
+   struct HashEntry **buckets;
+   GLuint pos;
+
+   buckets = (struct HashEntry **) calloc(size, sizeof(struct HashEntry *));
+   if (!buckets)
+      return;
+
+   for (pos = 0; pos < table->SparseSize; pos++) {
+      struct HashEntry *entry = table->Sparse[pos];
+      while (entry) {
+         struct HashEntry *next = entry->Next;
+         GLuint newPos = SPARSE_HASH(entry->Key, size);
+         entry->Next = buckets[newPos];
+         buckets[newPos] = entry;
+         entry = next;
+      }
+   }
+
+   free(table->Sparse);
+   table->Sparse = buckets;
+   table->SparseSize = size;
+}
+
+
+/**
+ * Remove an entry from the table.  Must be called with the lock held.
+ */
+static void
+remove_unlocked(struct _mesa_HashTable *table, GLuint key)
+{
+   struct DenseArray *dense = table->Dense;
+   struct HashEntry **link;
+
+   if (key < dense->Size) {
+      if (dense->Data[key]) {
+         dense->Data[key] = NULL;
+         table->NumEntries--;
+      }
+      return;
+   }
+
+   if (!table->SparseSize)
+      return;
+
+   for (link = &table->Sparse[SPARSE_HASH(key, table->SparseSize)];
+        *link; link = &(*link)->Next) {
+      struct HashEntry *entry = *link;
+      if (entry->Key == key) {
+         *link = entry->Next;
+         free(entry);
+         table->SparseCount--;
+         table->NumEntries--;
+         return;
+      }
+   }
+}
+
+
 /**
  * Insert a key/pointer pair into the hash table.  
  * If an entry with this key already exists we'll replace the existing entry.
+ * Inserting a NULL data pointer is the same as removing the key.
  * 
  * \param table the hash table.
  * \param key the key (not zero).
@@ -175,9 +404,9 @@ _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 void
 _mesa_HashInsert(struct _mesa_HashTable *table, GLuint key, void *data)
 {
-   /* search for existing entry with this key */
-   GLuint pos;
+   struct DenseArray *dense;
    struct HashEntry *entry;
+   GLuint pos;
 
    assert(table);
    assert(key);
@@ -187,30 +416,54 @@ _mesa_HashInsert(struct _mesa_HashTable *table, GLuint key, void *data)
    if (key > table->MaxKey)
       table->MaxKey = key;
 
-   pos = HASH_FUNC(key);
+   if (!data) {
+      remove_unlocked(table, key);
+      _glthread_UNLOCK_MUTEX(table->Mutex);
+      return;
+   }
+
+   /* growing frees or moves the overflow entries a walk may be visiting,
+    * leave it to the first insertion after the walk */
+   dense = table->Dense;
+   if (key >= dense->Size && !table->Walking &&
+       dense_should_grow(table, key) && dense_grow(table, key))
+      dense = table->Dense;
+
+   if (key < dense->Size) {
+      if (!dense->Data[key])
+         table->NumEntries++;
+      /* make the object visible before its name */
+      PUBLISH_BARRIER();
+      dense->Data[key] = data;
+      _glthread_UNLOCK_MUTEX(table->Mutex);
+      return;
+   }
 
    /* check if replacing an existing entry with same key */
-   for (entry = table->Table[pos]; entry; entry = entry->Next) {
-      if (entry->Key == key) {
-         /* replace entry's data */
-#if 0 /* not sure this check is always valid */
-         if (entry->Data) {
-            _mesa_problem(NULL, "Memory leak detected in _mesa_HashInsert");
-         }
-#endif
-	 entry->Data = data;
-         _glthread_UNLOCK_MUTEX(table->Mutex);
-	 return;
-      }
+   entry = sparse_find(table, key);
+   if (entry) {
+      entry->Data = data;
+      _glthread_UNLOCK_MUTEX(table->Mutex);
+      return;
    }
 
+   if (table->SparseCount >= table->SparseSize &&
+       (!table->Walking || !table->SparseSize))
+      sparse_grow(table);
+
    /* alloc and insert new table entry */
    entry = MALLOC_STRUCT(HashEntry);
-   if (entry) {
+   if (entry && table->SparseSize) {
+      pos = SPARSE_HASH(key, table->SparseSize);
       entry->Key = key;
       entry->Data = data;
-      entry->Next = table->Table[pos];
-      table->Table[pos] = entry;
+      entry->Next = table->Sparse[pos];
+      table->Sparse[pos] = entry;
+      table->SparseCount++;
+      table->NumEntries++;
+   }
+   else {
+      free(entry);
    }
 
    _glthread_UNLOCK_MUTEX(table->Mutex);
@@ -230,9 +483,6 @@ _mesa_HashInsert(struct _mesa_HashTable *table, GLuint key, void *data)
 void
 _mesa_HashRemove(struct _mesa_HashTable *table, GLuint key)
 {
-   GLuint pos;
-   struct HashEntry *entry, *prev;
-
    assert(table);
    assert(key);
 
@@ -244,27 +494,7 @@ _mesa_HashRemove(struct _mesa_HashTable *table, GLuint key)
    }
 
    _glthread_LOCK_MUTEX(table->Mutex);
-
-   pos = HASH_FUNC(key);
-   prev = NULL;
-   entry = table->Table[pos];
-   while (entry) {
-      if (entry->Key == key) {
-         /* found it! */
-         if (prev) {
-            prev->Next = entry->Next;
-         }
-         else {
-            table->Table[pos] = entry->Next;
-         }
-         free(entry);
-         _glthread_UNLOCK_MUTEX(table->Mutex);
-	 return;
-      }
-      prev = entry;
-      entry = entry->Next;
-   }
-
+   remove_unlocked(table, key);
    _glthread_UNLOCK_MUTEX(table->Mutex);
 }
 
@@ -284,20 +514,31 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
                     void (*callback)(GLuint key, void *data, void *userData),
                     void *userData)
 {
+   struct DenseArray *dense;
    GLuint pos;
    ASSERT(table);
    ASSERT(callback);
    _glthread_LOCK_MUTEX(table->Mutex);
    table->InDeleteAll = GL_TRUE;
-   for (pos = 0; pos < TABLE_SIZE; pos++) {
+   dense = table->Dense;
+   for (pos = 1; pos < dense->Size; pos++) {
+      void *data = dense->Data[pos];
+      if (data) {
+         dense->Data[pos] = NULL;
+         callback(pos, data, userData);
+      }
+   }
+   for (pos = 0; pos < table->SparseSize; pos++) {
       struct HashEntry *entry, *next;
-      for (entry = table->Table[pos]; entry; entry = next) {
+      for (entry = table->Sparse[pos]; entry; entry = next) {
          callback(entry->Key, entry->Data, userData);
          next = entry->Next;
          free(entry);
       }
-      table->Table[pos] = NULL;
+      table->Sparse[pos] = NULL;
    }
+   table->SparseCount = 0;
+   table->NumEntries = 0;
    table->InDeleteAll = GL_FALSE;
    _glthread_UNLOCK_MUTEX(table->Mutex);
 }
@@ -310,6 +551,8 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
  * prevent multiple threads/contexts from getting tangled up.
  * A lock-less version of this function could be used when the table will
  * not be modified.
+ * The table does not grow during the walk, so the callback may insert
+ * entries, which may or may not be visited.
  * \param table  the hash table to walk
  * \param callback  the callback function
  * \param userData  arbitrary pointer to pass along to the callback
@@ -326,18 +569,59 @@ _mesa_HashWalk(const struct _mesa_HashTable *table,
    ASSERT(table);
    ASSERT(callback);
    _glthread_LOCK_MUTEX(table2->WalkMutex);
-   for (pos = 0; pos < TABLE_SIZE; pos++) {
+   _glthread_LOCK_MUTEX(table2->Mutex);
+   table2->Walking++;
+   _glthread_UNLOCK_MUTEX(table2->Mutex);
+   for (pos = 1; pos < table->Dense->Size; pos++) {
+      void *data = table->Dense->Data[pos];
+      if (data)
+         callback(pos, data, userData);
+   }
+   for (pos = 0; pos < table->SparseSize; pos++) {
       struct HashEntry *entry, *next;
-      for (entry = table->Table[pos]; entry; entry = next) {
+      for (entry = table->Sparse[pos]; entry; entry = next) {
          /* save 'next' pointer now in case the callback deletes the entry */
          next = entry->Next;
          callback(entry->Key, entry->Data, userData);
       }
    }
+   _glthread_LOCK_MUTEX(table2->Mutex);
+   table2->Walking--;
+   _glthread_UNLOCK_MUTEX(table2->Mutex);
    _glthread_UNLOCK_MUTEX(table2->WalkMutex);
 }
 
 
+/**
+ * Return the first key of the overflow table at or after bucket \p pos,
+ * or 0 if there is none.
+ */
+static GLuint
+sparse_first_key(const struct _mesa_HashTable *table, GLuint pos)
+{
+   for (; pos < table->SparseSize; pos++) {
+      if (table->Sparse[pos])
+         return table->Sparse[pos]->Key;
+   }
+   return 0;
+}
+
+
+/**
+ * Return the first key of the directly indexed array after \p key, or 0
+ * if there is none.
+ */
+static GLuint
+dense_next_key(const struct DenseArray *dense, GLuint key)
+{
+   for (key++; key < dense->Size; key++) {
+      if (dense->Data[key])
+         return key;
+   }
+   return 0;
+}
+
+
 /**
  * Return the key of the "first" entry in the hash table.
  * While holding the lock, walks through all table positions until finding
@@ -349,17 +633,14 @@ _mesa_HashWalk(const struct _mesa_HashTable *table,
 GLuint
 _mesa_HashFirstEntry(struct _mesa_HashTable *table)
 {
-   GLuint pos;
+   GLuint key;
    assert(table);
    _glthread_LOCK_MUTEX(table->Mutex);
-   for (pos = 0; pos < TABLE_SIZE; pos++) {
-      if (table->Table[pos]) {
-         _glthread_UNLOCK_MUTEX(table->Mutex);
-         return table->Table[pos]->Key;
-      }
-   }
+   key = dense_next_key(table->Dense, 0);
+   if (!key)
+      key = sparse_first_key(table, 0);
    _glthread_UNLOCK_MUTEX(table->Mutex);
-   return 0;
+   return key;
 }
 
 
@@ -372,20 +653,24 @@ _mesa_HashFirstEntry(struct _mesa_HashTable *table)
 GLuint
 _mesa_HashNextEntry(const struct _mesa_HashTable *table, GLuint key)
 {
+   const struct DenseArray *dense = table->Dense;
    const struct HashEntry *entry;
-   GLuint pos;
+   GLuint next;
 
    assert(table);
    assert(key);
 
-   /* Find the entry with given key */
-   pos = HASH_FUNC(key);
-   for (entry = table->Table[pos]; entry ; entry = entry->Next) {
-      if (entry->Key == key) {
-         break;
-      }
+   if (key < dense->Size) {
+      /* the given key was not found, so we can't find the next entry */
+      if (!dense->Data[key])
+         return 0;
+
+      next = dense_next_key(dense, key);
+      return next ? next : sparse_first_key(table, 0);
    }
 
+   /* Find the entry with given key */
+   entry = sparse_find(table, key);
    if (!entry) {
       /* the given key was not found, so we can't find the next entry */
       return 0;
@@ -397,14 +682,7 @@ _mesa_HashNextEntry(const struct _mesa_HashTable *table, GLuint key)
    }
    else {
       /* look for next non-empty table slot */
-      pos++;
-      while (pos < TABLE_SIZE) {
-         if (table->Table[pos]) {
-            return table->Table[pos]->Key;
-         }
-         pos++;
-      }
-      return 0;
+      return sparse_first_key(table, SPARSE_HASH(key, table->SparseSize) + 1);
    }
 }
 
@@ -419,8 +697,12 @@ _mesa_HashPrint(const struct _mesa_HashTable *table)
 {
    GLuint pos;
    assert(table);
-   for (pos = 0; pos < TABLE_SIZE; pos++) {
-      const struct HashEntry *entry = table->Table[pos];
+   for (pos = 1; pos < table->Dense->Size; pos++) {
+      if (table->Dense->Data[pos])
+	 _mesa_debug(NULL, "%u %p\n", pos, table->Dense->Data[pos]);
+   }
+   for (pos = 0; pos < table->SparseSize; pos++) {
+      const struct HashEntry *entry = table->Sparse[pos];
       while (entry) {
 	 _mesa_debug(NULL, "%u %p\n", entry->Key, entry->Data);
 	 entry = entry->Next;
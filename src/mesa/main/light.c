@@ -198,6 +198,8 @@ _mesa_light(struct gl_context *ctx, GLuint lnum, GLenum pname, const GLfloat *pa
       return;
    }
 
+   ctx->Light._DirtyLights |= 1 << lnum;
+
    if (ctx->Driver.Lightfv)
       ctx->Driver.Lightfv( ctx, GL_LIGHT0 + lnum, pname, params );
 }
@@ -478,6 +480,7 @@ _mesa_LightModelfv( GLenum pname, const GLfloat *params )
 	    return;
 	 FLUSH_VERTICES(ctx, _NEW_LIGHT);
 	 ctx->Light.Model.LocalViewer = newbool;
+         ctx->Light._DirtyLights = ~0;
          break;
       case GL_LIGHT_MODEL_TWO_SIDE:
          newbool = (params[0]!=0.0);
@@ -1121,9 +1124,12 @@ _mesa_update_lighting( struct gl_context *ctx )
  *
  * Update on (_NEW_MODELVIEW | _NEW_LIGHT) when lighting is enabled.
  * Also update on lighting space changes.
+ *
+ * \param lights  bitmask of the lights to update, the others are known
+ *                to be up to date (see gl_light_attrib::_DirtyLights)
  */
 static void
-compute_light_positions( struct gl_context *ctx )
+compute_light_positions( struct gl_context *ctx, GLbitfield lights )
 {
    struct gl_light *light;
    static const GLfloat eye_z[3] = { 0, 0, 1 };
@@ -1131,6 +1137,8 @@ compute_light_positions( struct gl_context *ctx )
    if (!ctx->Light.Enabled)
       return;
 
+   ctx->Light._DirtyLights = 0;
+
    if (ctx->_NeedEyeCoords) {
       COPY_3V( ctx->_EyeZDir, eye_z );
    }
@@ -1140,6 +1148,9 @@ compute_light_positions( struct gl_context *ctx )
 
    foreach (light, &ctx->Light.EnabledList) {
 
+      if (!(lights & (1 << (light - ctx->Light.Light))))
+         continue;
+
       if (ctx->_NeedEyeCoords) {
          /* _Position is in eye coordinate space */
 	 COPY_4FV( light->_Position, light->EyePosition );
@@ -1253,7 +1264,7 @@ _mesa_update_tnl_spaces( struct gl_context *ctx, GLuint new_state )
       /* Recalculate all state that depends on _NeedEyeCoords.
        */
       update_modelview_scale(ctx);
-      compute_light_positions( ctx );
+      compute_light_positions( ctx, ~0 );
 
       if (ctx->Driver.LightingSpaceChange)
 	 ctx->Driver.LightingSpaceChange( ctx );
@@ -1267,8 +1278,13 @@ _mesa_update_tnl_spaces( struct gl_context *ctx, GLuint new_state )
       if (new_state2 & _NEW_MODELVIEW)
 	 update_modelview_scale(ctx);
 
-      if (new_state2 & (_NEW_LIGHT|_NEW_MODELVIEW))
-	 compute_light_positions( ctx );
+      /* Without a new modelview matrix, only the lights which were changed
+       * or enabled need their positions recomputed.
+       */
+      if (new_state2 & _NEW_MODELVIEW)
+	 compute_light_positions( ctx, ~0 );
+      else if (new_state2 & _NEW_LIGHT)
+	 compute_light_positions( ctx, ctx->Light._DirtyLights );
    }
 }
 
@@ -1394,6 +1410,7 @@ _mesa_init_lighting( struct gl_context *ctx )
 
    ctx->Light.ColorMaterialEnabled = GL_FALSE;
    ctx->Light.ClampVertexColor = GL_TRUE;
+   ctx->Light._DirtyLights = ~0;
 
    /* Lighting miscellaneous */
    ctx->_ShineTabList = MALLOC_STRUCT( gl_shine_tab );
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file marshal.h
+ * Command layout shared by glthread.c and the generated marshal code.
+ */
+
+#ifndef MARSHAL_H
+#define MARSHAL_H
+
+#include "main/glheader.h"
+
+
+/**
+ * Header of every command in a glthread batch.  The command structure of
+ * each GL function (see marshal_generated.c) starts with this.
+ */
+struct marshal_cmd_base
+{
+   /** One of the DISPATCH_CMD_* values. */
+   GLushort cmd_id;
+
+   /** Size of the command in bytes, including any array data. */
+   GLuint cmd_size;
+};
+
+
+/**
+ * Largest command, array data included.  Calls with larger arrays don't
+ * copy them and wait for the worker thread instead.
+ */
+#define MARSHAL_MAX_CMD_SIZE (64 * 1024)
+
+
+/**
+ * Return the number of bytes of an array of \p count elements of
+ * \p elem_size bytes, or -1 if it is too large to copy (or \p count is
+ * negative, which the GL call will reject anyway).
+ */
+static INLINE int
+_mesa_marshal_array_size(GLsizei count, size_t elem_size)
+{
+   if (count < 0 || (size_t) count > MARSHAL_MAX_CMD_SIZE / elem_size)
+      return -1;
+   return count * elem_size;
+}
+
+
+#endif /* MARSHAL_H */
@@ -0,0 +1,1018 @@
+/* DO NOT EDIT - This file generated automatically by gl_marshal.py (from Mesa) script */
+
+/*
+ * Copyright 2026 agent <agent@local>
+ * All Rights Reserved.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sub license,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS,
+ * AND/OR THEIR SUPPLIERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#if !defined( MARSHAL_GENERATED_H )
+#  define MARSHAL_GENERATED_H
+
+/**
+ * \file marshal_generated.h
+ * Command IDs of the threaded dispatch, see main/glthread.c.
+ */
+
+enum marshal_dispatch_cmd_id
+{
+   DISPATCH_CMD_NewList,
+   DISPATCH_CMD_EndList,
+   DISPATCH_CMD_CallList,
+   DISPATCH_CMD_CallLists,
+   DISPATCH_CMD_DeleteLists,
+   DISPATCH_CMD_GenLists,
+   DISPATCH_CMD_ListBase,
+   DISPATCH_CMD_Begin,
+   DISPATCH_CMD_Bitmap,
+   DISPATCH_CMD_Color3b,
+   DISPATCH_CMD_Color3bv,
+   DISPATCH_CMD_Color3d,
+   DISPATCH_CMD_Color3dv,
+   DISPATCH_CMD_Color3f,
+   DISPATCH_CMD_Color3fv,
+   DISPATCH_CMD_Color3i,
+   DISPATCH_CMD_Color3iv,
+   DISPATCH_CMD_Color3s,
+   DISPATCH_CMD_Color3sv,
+   DISPATCH_CMD_Color3ub,
+   DISPATCH_CMD_Color3ubv,
+   DISPATCH_CMD_Color3ui,
+   DISPATCH_CMD_Color3uiv,
+   DISPATCH_CMD_Color3us,
+   DISPATCH_CMD_Color3usv,
+   DISPATCH_CMD_Color4b,
+   DISPATCH_CMD_Color4bv,
+   DISPATCH_CMD_Color4d,
+   DISPATCH_CMD_Color4dv,
+   DISPATCH_CMD_Color4f,
+   DISPATCH_CMD_Color4fv,
+   DISPATCH_CMD_Color4i,
+   DISPATCH_CMD_Color4iv,
+   DISPATCH_CMD_Color4s,
+   DISPATCH_CMD_Color4sv,
+   DISPATCH_CMD_Color4ub,
+   DISPATCH_CMD_Color4ubv,
+   DISPATCH_CMD_Color4ui,
+   DISPATCH_CMD_Color4uiv,
+   DISPATCH_CMD_Color4us,
+   DISPATCH_CMD_Color4usv,
+   DISPATCH_CMD_EdgeFlag,
+   DISPATCH_CMD_EdgeFlagv,
+   DISPATCH_CMD_End,
+   DISPATCH_CMD_Indexd,
+   DISPATCH_CMD_Indexdv,
+   DISPATCH_CMD_Indexf,
+   DISPATCH_CMD_Indexfv,
+   DISPATCH_CMD_Indexi,
+   DISPATCH_CMD_Indexiv,
+   DISPATCH_CMD_Indexs,
+   DISPATCH_CMD_Indexsv,
+   DISPATCH_CMD_Normal3b,
+   DISPATCH_CMD_Normal3bv,
+   DISPATCH_CMD_Normal3d,
+   DISPATCH_CMD_Normal3dv,
+   DISPATCH_CMD_Normal3f,
+   DISPATCH_CMD_Normal3fv,
+   DISPATCH_CMD_Normal3i,
+   DISPATCH_CMD_Normal3iv,
+   DISPATCH_CMD_Normal3s,
+   DISPATCH_CMD_Normal3sv,
+   DISPATCH_CMD_RasterPos2d,
+   DISPATCH_CMD_RasterPos2dv,
+   DISPATCH_CMD_RasterPos2f,
+   DISPATCH_CMD_RasterPos2fv,
+   DISPATCH_CMD_RasterPos2i,
+   DISPATCH_CMD_RasterPos2iv,
+   DISPATCH_CMD_RasterPos2s,
+   DISPATCH_CMD_RasterPos2sv,
+   DISPATCH_CMD_RasterPos3d,
+   DISPATCH_CMD_RasterPos3dv,
+   DISPATCH_CMD_RasterPos3f,
+   DISPATCH_CMD_RasterPos3fv,
+   DISPATCH_CMD_RasterPos3i,
+   DISPATCH_CMD_RasterPos3iv,
+   DISPATCH_CMD_RasterPos3s,
+   DISPATCH_CMD_RasterPos3sv,
+   DISPATCH_CMD_RasterPos4d,
+   DISPATCH_CMD_RasterPos4dv,
+   DISPATCH_CMD_RasterPos4f,
+   DISPATCH_CMD_RasterPos4fv,
+   DISPATCH_CMD_RasterPos4i,
+   DISPATCH_CMD_RasterPos4iv,
+   DISPATCH_CMD_RasterPos4s,
+   DISPATCH_CMD_RasterPos4sv,
+   DISPATCH_CMD_Rectd,
+   DISPATCH_CMD_Rectdv,
+   DISPATCH_CMD_Rectf,
+   DISPATCH_CMD_Rectfv,
+   DISPATCH_CMD_Recti,
+   DISPATCH_CMD_Rectiv,
+   DISPATCH_CMD_Rects,
+   DISPATCH_CMD_Rectsv,
+   DISPATCH_CMD_TexCoord1d,
+   DISPATCH_CMD_TexCoord1dv,
+   DISPATCH_CMD_TexCoord1f,
+   DISPATCH_CMD_TexCoord1fv,
+   DISPATCH_CMD_TexCoord1i,
+   DISPATCH_CMD_TexCoord1iv,
+   DISPATCH_CMD_TexCoord1s,
+   DISPATCH_CMD_TexCoord1sv,
+   DISPATCH_CMD_TexCoord2d,
+   DISPATCH_CMD_TexCoord2dv,
+   DISPATCH_CMD_TexCoord2f,
+   DISPATCH_CMD_TexCoord2fv,
+   DISPATCH_CMD_TexCoord2i,
+   DISPATCH_CMD_TexCoord2iv,
+   DISPATCH_CMD_TexCoord2s,
+   DISPATCH_CMD_TexCoord2sv,
+   DISPATCH_CMD_TexCoord3d,
+   DISPATCH_CMD_TexCoord3dv,
+   DISPATCH_CMD_TexCoord3f,
+   DISPATCH_CMD_TexCoord3fv,
+   DISPATCH_CMD_TexCoord3i,
+   DISPATCH_CMD_TexCoord3iv,
+   DISPATCH_CMD_TexCoord3s,
+   DISPATCH_CMD_TexCoord3sv,
+   DISPATCH_CMD_TexCoord4d,
+   DISPATCH_CMD_TexCoord4dv,
+   DISPATCH_CMD_TexCoord4f,
+   DISPATCH_CMD_TexCoord4fv,
+   DISPATCH_CMD_TexCoord4i,
+   DISPATCH_CMD_TexCoord4iv,
+   DISPATCH_CMD_TexCoord4s,
+   DISPATCH_CMD_TexCoord4sv,
+   DISPATCH_CMD_Vertex2d,
+   DISPATCH_CMD_Vertex2dv,
+   DISPATCH_CMD_Vertex2f,
+   DISPATCH_CMD_Vertex2fv,
+   DISPATCH_CMD_Vertex2i,
+   DISPATCH_CMD_Vertex2iv,
+   DISPATCH_CMD_Vertex2s,
+   DISPATCH_CMD_Vertex2sv,
+   DISPATCH_CMD_Vertex3d,
+   DISPATCH_CMD_Vertex3dv,
+   DISPATCH_CMD_Vertex3f,
+   DISPATCH_CMD_Vertex3fv,
+   DISPATCH_CMD_Vertex3i,
+   DISPATCH_CMD_Vertex3iv,
+   DISPATCH_CMD_Vertex3s,
+   DISPATCH_CMD_Vertex3sv,
+   DISPATCH_CMD_Vertex4d,
+   DISPATCH_CMD_Vertex4dv,
+   DISPATCH_CMD_Vertex4f,
+   DISPATCH_CMD_Vertex4fv,
+   DISPATCH_CMD_Vertex4i,
+   DISPATCH_CMD_Vertex4iv,
+   DISPATCH_CMD_Vertex4s,
+   DISPATCH_CMD_Vertex4sv,
+   DISPATCH_CMD_ClipPlane,
+   DISPATCH_CMD_ColorMaterial,
+   DISPATCH_CMD_CullFace,
+   DISPATCH_CMD_Fogf,
+   DISPATCH_CMD_Fogfv,
+   DISPATCH_CMD_Fogi,
+   DISPATCH_CMD_Fogiv,
+   DISPATCH_CMD_FrontFace,
+   DISPATCH_CMD_Hint,
+   DISPATCH_CMD_Lightf,
+   DISPATCH_CMD_Lightfv,
+   DISPATCH_CMD_Lighti,
+   DISPATCH_CMD_Lightiv,
+   DISPATCH_CMD_LightModelf,
+   DISPATCH_CMD_LightModelfv,
+   DISPATCH_CMD_LightModeli,
+   DISPATCH_CMD_LightModeliv,
+   DISPATCH_CMD_LineStipple,
+   DISPATCH_CMD_LineWidth,
+   DISPATCH_CMD_Materialf,
+   DISPATCH_CMD_Materialfv,
+   DISPATCH_CMD_Materiali,
+   DISPATCH_CMD_Materialiv,
+   DISPATCH_CMD_PointSize,
+   DISPATCH_CMD_PolygonMode,
+   DISPATCH_CMD_PolygonStipple,
+   DISPATCH_CMD_Scissor,
+   DISPATCH_CMD_ShadeModel,
+   DISPATCH_CMD_TexParameterf,
+   DISPATCH_CMD_TexParameterfv,
+   DISPATCH_CMD_TexParameteri,
+   DISPATCH_CMD_TexParameteriv,
+   DISPATCH_CMD_TexImage1D,
+   DISPATCH_CMD_TexImage2D,
+   DISPATCH_CMD_TexEnvf,
+   DISPATCH_CMD_TexEnvfv,
+   DISPATCH_CMD_TexEnvi,
+   DISPATCH_CMD_TexEnviv,
+   DISPATCH_CMD_TexGend,
+   DISPATCH_CMD_TexGendv,
+   DISPATCH_CMD_TexGenf,
+   DISPATCH_CMD_TexGenfv,
+   DISPATCH_CMD_TexGeni,
+   DISPATCH_CMD_TexGeniv,
+   DISPATCH_CMD_FeedbackBuffer,
+   DISPATCH_CMD_SelectBuffer,
+   DISPATCH_CMD_RenderMode,
+   DISPATCH_CMD_InitNames,
+   DISPATCH_CMD_LoadName,
+   DISPATCH_CMD_PassThrough,
+   DISPATCH_CMD_PopName,
+   DISPATCH_CMD_PushName,
+   DISPATCH_CMD_DrawBuffer,
+   DISPATCH_CMD_Clear,
+   DISPATCH_CMD_ClearAccum,
+   DISPATCH_CMD_ClearIndex,
+   DISPATCH_CMD_ClearColor,
+   DISPATCH_CMD_ClearStencil,
+   DISPATCH_CMD_ClearDepth,
+   DISPATCH_CMD_StencilMask,
+   DISPATCH_CMD_ColorMask,
+   DISPATCH_CMD_DepthMask,
+   DISPATCH_CMD_IndexMask,
+   DISPATCH_CMD_Accum,
+   DISPATCH_CMD_Disable,
+   DISPATCH_CMD_Enable,
+   DISPATCH_CMD_Finish,
+   DISPATCH_CMD_Flush,
+   DISPATCH_CMD_PopAttrib,
+   DISPATCH_CMD_PushAttrib,
+   DISPATCH_CMD_Map1d,
+   DISPATCH_CMD_Map1f,
+   DISPATCH_CMD_Map2d,
+   DISPATCH_CMD_Map2f,
+   DISPATCH_CMD_MapGrid1d,
+   DISPATCH_CMD_MapGrid1f,
+   DISPATCH_CMD_MapGrid2d,
+   DISPATCH_CMD_MapGrid2f,
+   DISPATCH_CMD_EvalCoord1d,
+   DISPATCH_CMD_EvalCoord1dv,
+   DISPATCH_CMD_EvalCoord1f,
+   DISPATCH_CMD_EvalCoord1fv,
+   DISPATCH_CMD_EvalCoord2d,
+   DISPATCH_CMD_EvalCoord2dv,
+   DISPATCH_CMD_EvalCoord2f,
+   DISPATCH_CMD_EvalCoord2fv,
+   DISPATCH_CMD_EvalMesh1,
+   DISPATCH_CMD_EvalPoint1,
+   DISPATCH_CMD_EvalMesh2,
+   DISPATCH_CMD_EvalPoint2,
+   DISPATCH_CMD_AlphaFunc,
+   DISPATCH_CMD_BlendFunc,
+   DISPATCH_CMD_LogicOp,
+   DISPATCH_CMD_StencilFunc,
+   DISPATCH_CMD_StencilOp,
+   DISPATCH_CMD_DepthFunc,
+   DISPATCH_CMD_PixelZoom,
+   DISPATCH_CMD_PixelTransferf,
+   DISPATCH_CMD_PixelTransferi,
+   DISPATCH_CMD_PixelStoref,
+   DISPATCH_CMD_PixelStorei,
+   DISPATCH_CMD_PixelMapfv,
+   DISPATCH_CMD_PixelMapuiv,
+   DISPATCH_CMD_PixelMapusv,
+   DISPATCH_CMD_ReadBuffer,
+   DISPATCH_CMD_CopyPixels,
+   DISPATCH_CMD_ReadPixels,
+   DISPATCH_CMD_DrawPixels,
+   DISPATCH_CMD_GetBooleanv,
+   DISPATCH_CMD_GetClipPlane,
+   DISPATCH_CMD_GetDoublev,
+   DISPATCH_CMD_GetError,
+   DISPATCH_CMD_GetFloatv,
+   DISPATCH_CMD_GetIntegerv,
+   DISPATCH_CMD_GetLightfv,
+   DISPATCH_CMD_GetLightiv,
+   DISPATCH_CMD_GetMapdv,
+   DISPATCH_CMD_GetMapfv,
+   DISPATCH_CMD_GetMapiv,
+   DISPATCH_CMD_GetMaterialfv,
+   DISPATCH_CMD_GetMaterialiv,
+   DISPATCH_CMD_GetPixelMapfv,
+   DISPATCH_CMD_GetPixelMapuiv,
+   DISPATCH_CMD_GetPixelMapusv,
+   DISPATCH_CMD_GetPolygonStipple,
+   DISPATCH_CMD_GetString,
+   DISPATCH_CMD_GetTexEnvfv,
+   DISPATCH_CMD_GetTexEnviv,
+   DISPATCH_CMD_GetTexGendv,
+   DISPATCH_CMD_GetTexGenfv,
+   DISPATCH_CMD_GetTexGeniv,
+   DISPATCH_CMD_GetTexImage,
+   DISPATCH_CMD_GetTexParameterfv,
+   DISPATCH_CMD_GetTexParameteriv,
+   DISPATCH_CMD_GetTexLevelParameterfv,
+   DISPATCH_CMD_GetTexLevelParameteriv,
+   DISPATCH_CMD_IsEnabled,
+   DISPATCH_CMD_IsList,
+   DISPATCH_CMD_DepthRange,
+   DISPATCH_CMD_Frustum,
+   DISPATCH_CMD_LoadIdentity,
+   DISPATCH_CMD_LoadMatrixf,
+   DISPATCH_CMD_LoadMatrixd,
+   DISPATCH_CMD_MatrixMode,
+   DISPATCH_CMD_MultMatrixf,
+   DISPATCH_CMD_MultMatrixd,
+   DISPATCH_CMD_Ortho,
+   DISPATCH_CMD_PopMatrix,
+   DISPATCH_CMD_PushMatrix,
+   DISPATCH_CMD_Rotated,
+   DISPATCH_CMD_Rotatef,
+   DISPATCH_CMD_Scaled,
+   DISPATCH_CMD_Scalef,
+   DISPATCH_CMD_Translated,
+   DISPATCH_CMD_Translatef,
+   DISPATCH_CMD_Viewport,
+   DISPATCH_CMD_ArrayElement,
+   DISPATCH_CMD_BindTexture,
+   DISPATCH_CMD_ColorPointer,
+   DISPATCH_CMD_DisableClientState,
+   DISPATCH_CMD_DrawArrays,
+   DISPATCH_CMD_DrawElements,
+   DISPATCH_CMD_EdgeFlagPointer,
+   DISPATCH_CMD_EnableClientState,
+   DISPATCH_CMD_IndexPointer,
+   DISPATCH_CMD_Indexub,
+   DISPATCH_CMD_Indexubv,
+   DISPATCH_CMD_InterleavedArrays,
+   DISPATCH_CMD_NormalPointer,
+   DISPATCH_CMD_PolygonOffset,
+   DISPATCH_CMD_TexCoordPointer,
+   DISPATCH_CMD_VertexPointer,
+   DISPATCH_CMD_AreTexturesResident,
+   DISPATCH_CMD_CopyTexImage1D,
+   DISPATCH_CMD_CopyTexImage2D,
+   DISPATCH_CMD_CopyTexSubImage1D,
+   DISPATCH_CMD_CopyTexSubImage2D,
+   DISPATCH_CMD_DeleteTextures,
+   DISPATCH_CMD_GenTextures,
+   DISPATCH_CMD_GetPointerv,
+   DISPATCH_CMD_IsTexture,
+   DISPATCH_CMD_PrioritizeTextures,
+   DISPATCH_CMD_TexSubImage1D,
+   DISPATCH_CMD_TexSubImage2D,
+   DISPATCH_CMD_PopClientAttrib,
+   DISPATCH_CMD_PushClientAttrib,
+   DISPATCH_CMD_BlendColor,
+   DISPATCH_CMD_BlendEquation,
+   DISPATCH_CMD_DrawRangeElements,
+   DISPATCH_CMD_ColorTable,
+   DISPATCH_CMD_ColorTableParameterfv,
+   DISPATCH_CMD_ColorTableParameteriv,
+   DISPATCH_CMD_CopyColorTable,
+   DISPATCH_CMD_GetColorTable,
+   DISPATCH_CMD_GetColorTableParameterfv,
+   DISPATCH_CMD_GetColorTableParameteriv,
+   DISPATCH_CMD_ColorSubTable,
+   DISPATCH_CMD_CopyColorSubTable,
+   DISPATCH_CMD_ConvolutionFilter1D,
+   DISPATCH_CMD_ConvolutionFilter2D,
+   DISPATCH_CMD_ConvolutionParameterf,
+   DISPATCH_CMD_ConvolutionParameterfv,
+   DISPATCH_CMD_ConvolutionParameteri,
+   DISPATCH_CMD_ConvolutionParameteriv,
+   DISPATCH_CMD_CopyConvolutionFilter1D,
+   DISPATCH_CMD_CopyConvolutionFilter2D,
+   DISPATCH_CMD_GetConvolutionFilter,
+   DISPATCH_CMD_GetConvolutionParameterfv,
+   DISPATCH_CMD_GetConvolutionParameteriv,
+   DISPATCH_CMD_GetSeparableFilter,
+   DISPATCH_CMD_SeparableFilter2D,
+   DISPATCH_CMD_GetHistogram,
+   DISPATCH_CMD_GetHistogramParameterfv,
+   DISPATCH_CMD_GetHistogramParameteriv,
+   DISPATCH_CMD_GetMinmax,
+   DISPATCH_CMD_GetMinmaxParameterfv,
+   DISPATCH_CMD_GetMinmaxParameteriv,
+   DISPATCH_CMD_Histogram,
+   DISPATCH_CMD_Minmax,
+   DISPATCH_CMD_ResetHistogram,
+   DISPATCH_CMD_ResetMinmax,
+   DISPATCH_CMD_TexImage3D,
+   DISPATCH_CMD_TexSubImage3D,
+   DISPATCH_CMD_CopyTexSubImage3D,
+   DISPATCH_CMD_ActiveTextureARB,
+   DISPATCH_CMD_ClientActiveTextureARB,
+   DISPATCH_CMD_MultiTexCoord1dARB,
+   DISPATCH_CMD_MultiTexCoord1dvARB,
+   DISPATCH_CMD_MultiTexCoord1fARB,
+   DISPATCH_CMD_MultiTexCoord1fvARB,
+   DISPATCH_CMD_MultiTexCoord1iARB,
+   DISPATCH_CMD_MultiTexCoord1ivARB,
+   DISPATCH_CMD_MultiTexCoord1sARB,
+   DISPATCH_CMD_MultiTexCoord1svARB,
+   DISPATCH_CMD_MultiTexCoord2dARB,
+   DISPATCH_CMD_MultiTexCoord2dvARB,
+   DISPATCH_CMD_MultiTexCoord2fARB,
+   DISPATCH_CMD_MultiTexCoord2fvARB,
+   DISPATCH_CMD_MultiTexCoord2iARB,
+   DISPATCH_CMD_MultiTexCoord2ivARB,
+   DISPATCH_CMD_MultiTexCoord2sARB,
+   DISPATCH_CMD_MultiTexCoord2svARB,
+   DISPATCH_CMD_MultiTexCoord3dARB,
+   DISPATCH_CMD_MultiTexCoord3dvARB,
+   DISPATCH_CMD_MultiTexCoord3fARB,
+   DISPATCH_CMD_MultiTexCoord3fvARB,
+   DISPATCH_CMD_MultiTexCoord3iARB,
+   DISPATCH_CMD_MultiTexCoord3ivARB,
+   DISPATCH_CMD_MultiTexCoord3sARB,
+   DISPATCH_CMD_MultiTexCoord3svARB,
+   DISPATCH_CMD_MultiTexCoord4dARB,
+   DISPATCH_CMD_MultiTexCoord4dvARB,
+   DISPATCH_CMD_MultiTexCoord4fARB,
+   DISPATCH_CMD_MultiTexCoord4fvARB,
+   DISPATCH_CMD_MultiTexCoord4iARB,
+   DISPATCH_CMD_MultiTexCoord4ivARB,
+   DISPATCH_CMD_MultiTexCoord4sARB,
+   DISPATCH_CMD_MultiTexCoord4svARB,
+   DISPATCH_CMD_AttachShader,
+   DISPATCH_CMD_CreateProgram,
+   DISPATCH_CMD_CreateShader,
+   DISPATCH_CMD_DeleteProgram,
+   DISPATCH_CMD_DeleteShader,
+   DISPATCH_CMD_DetachShader,
+   DISPATCH_CMD_GetAttachedShaders,
+   DISPATCH_CMD_GetProgramInfoLog,
+   DISPATCH_CMD_GetProgramiv,
+   DISPATCH_CMD_GetShaderInfoLog,
+   DISPATCH_CMD_GetShaderiv,
+   DISPATCH_CMD_IsProgram,
+   DISPATCH_CMD_IsShader,
+   DISPATCH_CMD_StencilFuncSeparate,
+   DISPATCH_CMD_StencilMaskSeparate,
+   DISPATCH_CMD_StencilOpSeparate,
+   DISPATCH_CMD_UniformMatrix2x3fv,
+   DISPATCH_CMD_UniformMatrix2x4fv,
+   DISPATCH_CMD_UniformMatrix3x2fv,
+   DISPATCH_CMD_UniformMatrix3x4fv,
+   DISPATCH_CMD_UniformMatrix4x2fv,
+   DISPATCH_CMD_UniformMatrix4x3fv,
+   DISPATCH_CMD_ClampColor,
+   DISPATCH_CMD_ClearBufferfi,
+   DISPATCH_CMD_ClearBufferfv,
+   DISPATCH_CMD_ClearBufferiv,
+   DISPATCH_CMD_ClearBufferuiv,
+   DISPATCH_CMD_GetStringi,
+   DISPATCH_CMD_TexBuffer,
+   DISPATCH_CMD_FramebufferTexture,
+   DISPATCH_CMD_GetBufferParameteri64v,
+   DISPATCH_CMD_GetInteger64i_v,
+   DISPATCH_CMD_VertexAttribDivisor,
+   DISPATCH_CMD_LoadTransposeMatrixdARB,
+   DISPATCH_CMD_LoadTransposeMatrixfARB,
+   DISPATCH_CMD_MultTransposeMatrixdARB,
+   DISPATCH_CMD_MultTransposeMatrixfARB,
+   DISPATCH_CMD_SampleCoverageARB,
+   DISPATCH_CMD_CompressedTexImage1DARB,
+   DISPATCH_CMD_CompressedTexImage2DARB,
+   DISPATCH_CMD_CompressedTexImage3DARB,
+   DISPATCH_CMD_CompressedTexSubImage1DARB,
+   DISPATCH_CMD_CompressedTexSubImage2DARB,
+   DISPATCH_CMD_CompressedTexSubImage3DARB,
+   DISPATCH_CMD_GetCompressedTexImageARB,
+   DISPATCH_CMD_DisableVertexAttribArrayARB,
+   DISPATCH_CMD_EnableVertexAttribArrayARB,
+   DISPATCH_CMD_GetProgramEnvParameterdvARB,
+   DISPATCH_CMD_GetProgramEnvParameterfvARB,
+   DISPATCH_CMD_GetProgramLocalParameterdvARB,
+   DISPATCH_CMD_GetProgramLocalParameterfvARB,
+   DISPATCH_CMD_GetProgramStringARB,
+   DISPATCH_CMD_GetProgramivARB,
+   DISPATCH_CMD_GetVertexAttribdvARB,
+   DISPATCH_CMD_GetVertexAttribfvARB,
+   DISPATCH_CMD_GetVertexAttribivARB,
+   DISPATCH_CMD_ProgramEnvParameter4dARB,
+   DISPATCH_CMD_ProgramEnvParameter4dvARB,
+   DISPATCH_CMD_ProgramEnvParameter4fARB,
+   DISPATCH_CMD_ProgramEnvParameter4fvARB,
+   DISPATCH_CMD_ProgramLocalParameter4dARB,
+   DISPATCH_CMD_ProgramLocalParameter4dvARB,
+   DISPATCH_CMD_ProgramLocalParameter4fARB,
+   DISPATCH_CMD_ProgramLocalParameter4fvARB,
+   DISPATCH_CMD_ProgramStringARB,
+   DISPATCH_CMD_VertexAttrib1dARB,
+   DISPATCH_CMD_VertexAttrib1dvARB,
+   DISPATCH_CMD_VertexAttrib1fARB,
+   DISPATCH_CMD_VertexAttrib1fvARB,
+   DISPATCH_CMD_VertexAttrib1sARB,
+   DISPATCH_CMD_VertexAttrib1svARB,
+   DISPATCH_CMD_VertexAttrib2dARB,
+   DISPATCH_CMD_VertexAttrib2dvARB,
+   DISPATCH_CMD_VertexAttrib2fARB,
+   DISPATCH_CMD_VertexAttrib2fvARB,
+   DISPATCH_CMD_VertexAttrib2sARB,
+   DISPATCH_CMD_VertexAttrib2svARB,
+   DISPATCH_CMD_VertexAttrib3dARB,
+   DISPATCH_CMD_VertexAttrib3dvARB,
+   DISPATCH_CMD_VertexAttrib3fARB,
+   DISPATCH_CMD_VertexAttrib3fvARB,
+   DISPATCH_CMD_VertexAttrib3sARB,
+   DISPATCH_CMD_VertexAttrib3svARB,
+   DISPATCH_CMD_VertexAttrib4NbvARB,
+   DISPATCH_CMD_VertexAttrib4NivARB,
+   DISPATCH_CMD_VertexAttrib4NsvARB,
+   DISPATCH_CMD_VertexAttrib4NubARB,
+   DISPATCH_CMD_VertexAttrib4NubvARB,
+   DISPATCH_CMD_VertexAttrib4NuivARB,
+   DISPATCH_CMD_VertexAttrib4NusvARB,
+   DISPATCH_CMD_VertexAttrib4bvARB,
+   DISPATCH_CMD_VertexAttrib4dARB,
+   DISPATCH_CMD_VertexAttrib4dvARB,
+   DISPATCH_CMD_VertexAttrib4fARB,
+   DISPATCH_CMD_VertexAttrib4fvARB,
+   DISPATCH_CMD_VertexAttrib4ivARB,
+   DISPATCH_CMD_VertexAttrib4sARB,
+   DISPATCH_CMD_VertexAttrib4svARB,
+   DISPATCH_CMD_VertexAttrib4ubvARB,
+   DISPATCH_CMD_VertexAttrib4uivARB,
+   DISPATCH_CMD_VertexAttrib4usvARB,
+   DISPATCH_CMD_VertexAttribPointerARB,
+   DISPATCH_CMD_BindBufferARB,
+   DISPATCH_CMD_BufferDataARB,
+   DISPATCH_CMD_BufferSubDataARB,
+   DISPATCH_CMD_DeleteBuffersARB,
+   DISPATCH_CMD_GenBuffersARB,
+   DISPATCH_CMD_GetBufferParameterivARB,
+   DISPATCH_CMD_GetBufferPointervARB,
+   DISPATCH_CMD_GetBufferSubDataARB,
+   DISPATCH_CMD_IsBufferARB,
+   DISPATCH_CMD_MapBufferARB,
+   DISPATCH_CMD_UnmapBufferARB,
+   DISPATCH_CMD_BeginQueryARB,
+   DISPATCH_CMD_DeleteQueriesARB,
+   DISPATCH_CMD_EndQueryARB,
+   DISPATCH_CMD_GenQueriesARB,
+   DISPATCH_CMD_GetQueryObjectivARB,
+   DISPATCH_CMD_GetQueryObjectuivARB,
+   DISPATCH_CMD_GetQueryivARB,
+   DISPATCH_CMD_IsQueryARB,
+   DISPATCH_CMD_AttachObjectARB,
+   DISPATCH_CMD_CompileShaderARB,
+   DISPATCH_CMD_CreateProgramObjectARB,
+   DISPATCH_CMD_CreateShaderObjectARB,
+   DISPATCH_CMD_DeleteObjectARB,
+   DISPATCH_CMD_DetachObjectARB,
+   DISPATCH_CMD_GetActiveUniformARB,
+   DISPATCH_CMD_GetAttachedObjectsARB,
+   DISPATCH_CMD_GetHandleARB,
+   DISPATCH_CMD_GetInfoLogARB,
+   DISPATCH_CMD_GetObjectParameterfvARB,
+   DISPATCH_CMD_GetObjectParameterivARB,
+   DISPATCH_CMD_GetShaderSourceARB,
+   DISPATCH_CMD_GetUniformLocationARB,
+   DISPATCH_CMD_GetUniformfvARB,
+   DISPATCH_CMD_GetUniformivARB,
+   DISPATCH_CMD_LinkProgramARB,
+   DISPATCH_CMD_ShaderSourceARB,
+   DISPATCH_CMD_Uniform1fARB,
+   DISPATCH_CMD_Uniform1fvARB,
+   DISPATCH_CMD_Uniform1iARB,
+   DISPATCH_CMD_Uniform1ivARB,
+   DISPATCH_CMD_Uniform2fARB,
+   DISPATCH_CMD_Uniform2fvARB,
+   DISPATCH_CMD_Uniform2iARB,
+   DISPATCH_CMD_Uniform2ivARB,
+   DISPATCH_CMD_Uniform3fARB,
+   DISPATCH_CMD_Uniform3fvARB,
+   DISPATCH_CMD_Uniform3iARB,
+   DISPATCH_CMD_Uniform3ivARB,
+   DISPATCH_CMD_Uniform4fARB,
+   DISPATCH_CMD_Uniform4fvARB,
+   DISPATCH_CMD_Uniform4iARB,
+   DISPATCH_CMD_Uniform4ivARB,
+   DISPATCH_CMD_UniformMatrix2fvARB,
+   DISPATCH_CMD_UniformMatrix3fvARB,
+   DISPATCH_CMD_UniformMatrix4fvARB,
+   DISPATCH_CMD_UseProgramObjectARB,
+   DISPATCH_CMD_ValidateProgramARB,
+   DISPATCH_CMD_BindAttribLocationARB,
+   DISPATCH_CMD_GetActiveAttribARB,
+   DISPATCH_CMD_GetAttribLocationARB,
+   DISPATCH_CMD_DrawBuffersARB,
+   DISPATCH_CMD_ClampColorARB,
+   DISPATCH_CMD_DrawArraysInstancedARB,
+   DISPATCH_CMD_DrawElementsInstancedARB,
+   DISPATCH_CMD_RenderbufferStorageMultisample,
+   DISPATCH_CMD_FramebufferTextureARB,
+   DISPATCH_CMD_FramebufferTextureFaceARB,
+   DISPATCH_CMD_ProgramParameteriARB,
+   DISPATCH_CMD_VertexAttribDivisorARB,
+   DISPATCH_CMD_FlushMappedBufferRange,
+   DISPATCH_CMD_MapBufferRange,
+   DISPATCH_CMD_TexBufferARB,
+   DISPATCH_CMD_BindVertexArray,
+   DISPATCH_CMD_GenVertexArrays,
+   DISPATCH_CMD_CopyBufferSubData,
+   DISPATCH_CMD_ClientWaitSync,
+   DISPATCH_CMD_DeleteSync,
+   DISPATCH_CMD_FenceSync,
+   DISPATCH_CMD_GetInteger64v,
+   DISPATCH_CMD_GetSynciv,
+   DISPATCH_CMD_IsSync,
+   DISPATCH_CMD_WaitSync,
+   DISPATCH_CMD_DrawElementsBaseVertex,
+   DISPATCH_CMD_DrawElementsInstancedBaseVertex,
+   DISPATCH_CMD_DrawRangeElementsBaseVertex,
+   DISPATCH_CMD_MultiDrawElementsBaseVertex,
+   DISPATCH_CMD_BlendEquationSeparateiARB,
+   DISPATCH_CMD_BlendEquationiARB,
+   DISPATCH_CMD_BlendFuncSeparateiARB,
+   DISPATCH_CMD_BlendFunciARB,
+   DISPATCH_CMD_BindSampler,
+   DISPATCH_CMD_DeleteSamplers,
+   DISPATCH_CMD_GenSamplers,
+   DISPATCH_CMD_GetSamplerParameterIiv,
+   DISPATCH_CMD_GetSamplerParameterIuiv,
+   DISPATCH_CMD_GetSamplerParameterfv,
+   DISPATCH_CMD_GetSamplerParameteriv,
+   DISPATCH_CMD_IsSampler,
+   DISPATCH_CMD_SamplerParameterIiv,
+   DISPATCH_CMD_SamplerParameterIuiv,
+   DISPATCH_CMD_SamplerParameterf,
+   DISPATCH_CMD_SamplerParameterfv,
+   DISPATCH_CMD_SamplerParameteri,
+   DISPATCH_CMD_SamplerParameteriv,
+   DISPATCH_CMD_ColorP3ui,
+   DISPATCH_CMD_ColorP3uiv,
+   DISPATCH_CMD_ColorP4ui,
+   DISPATCH_CMD_ColorP4uiv,
+   DISPATCH_CMD_MultiTexCoordP1ui,
+   DISPATCH_CMD_MultiTexCoordP1uiv,
+   DISPATCH_CMD_MultiTexCoordP2ui,
+   DISPATCH_CMD_MultiTexCoordP2uiv,
+   DISPATCH_CMD_MultiTexCoordP3ui,
+   DISPATCH_CMD_MultiTexCoordP3uiv,
+   DISPATCH_CMD_MultiTexCoordP4ui,
+   DISPATCH_CMD_MultiTexCoordP4uiv,
+   DISPATCH_CMD_NormalP3ui,
+   DISPATCH_CMD_NormalP3uiv,
+   DISPATCH_CMD_SecondaryColorP3ui,
+   DISPATCH_CMD_SecondaryColorP3uiv,
+   DISPATCH_CMD_TexCoordP1ui,
+   DISPATCH_CMD_TexCoordP1uiv,
+   DISPATCH_CMD_TexCoordP2ui,
+   DISPATCH_CMD_TexCoordP2uiv,
+   DISPATCH_CMD_TexCoordP3ui,
+   DISPATCH_CMD_TexCoordP3uiv,
+   DISPATCH_CMD_TexCoordP4ui,
+   DISPATCH_CMD_TexCoordP4uiv,
+   DISPATCH_CMD_VertexAttribP1ui,
+   DISPATCH_CMD_VertexAttribP1uiv,
+   DISPATCH_CMD_VertexAttribP2ui,
+   DISPATCH_CMD_VertexAttribP2uiv,
+   DISPATCH_CMD_VertexAttribP3ui,
+   DISPATCH_CMD_VertexAttribP3uiv,
+   DISPATCH_CMD_VertexAttribP4ui,
+   DISPATCH_CMD_VertexAttribP4uiv,
+   DISPATCH_CMD_VertexP2ui,
+   DISPATCH_CMD_VertexP2uiv,
+   DISPATCH_CMD_VertexP3ui,
+   DISPATCH_CMD_VertexP3uiv,
+   DISPATCH_CMD_VertexP4ui,
+   DISPATCH_CMD_VertexP4uiv,
+   DISPATCH_CMD_BindTransformFeedback,
+   DISPATCH_CMD_DeleteTransformFeedbacks,
+   DISPATCH_CMD_DrawTransformFeedback,
+   DISPATCH_CMD_GenTransformFeedbacks,
+   DISPATCH_CMD_IsTransformFeedback,
+   DISPATCH_CMD_PauseTransformFeedback,
+   DISPATCH_CMD_ResumeTransformFeedback,
+   DISPATCH_CMD_ClearDepthf,
+   DISPATCH_CMD_DepthRangef,
+   DISPATCH_CMD_GetShaderPrecisionFormat,
+   DISPATCH_CMD_ReleaseShaderCompiler,
+   DISPATCH_CMD_ShaderBinary,
+   DISPATCH_CMD_GetGraphicsResetStatusARB,
+   DISPATCH_CMD_GetnColorTableARB,
+   DISPATCH_CMD_GetnCompressedTexImageARB,
+   DISPATCH_CMD_GetnConvolutionFilterARB,
+   DISPATCH_CMD_GetnHistogramARB,
+   DISPATCH_CMD_GetnMapdvARB,
+   DISPATCH_CMD_GetnMapfvARB,
+   DISPATCH_CMD_GetnMapivARB,
+   DISPATCH_CMD_GetnMinmaxARB,
+   DISPATCH_CMD_GetnPixelMapfvARB,
+   DISPATCH_CMD_GetnPixelMapuivARB,
+   DISPATCH_CMD_GetnPixelMapusvARB,
+   DISPATCH_CMD_GetnPolygonStippleARB,
+   DISPATCH_CMD_GetnSeparableFilterARB,
+   DISPATCH_CMD_GetnTexImageARB,
+   DISPATCH_CMD_GetnUniformdvARB,
+   DISPATCH_CMD_GetnUniformfvARB,
+   DISPATCH_CMD_GetnUniformivARB,
+   DISPATCH_CMD_GetnUniformuivARB,
+   DISPATCH_CMD_ReadnPixelsARB,
+   DISPATCH_CMD_PolygonOffsetEXT,
+   DISPATCH_CMD_GetPixelTexGenParameterfvSGIS,
+   DISPATCH_CMD_GetPixelTexGenParameterivSGIS,
+   DISPATCH_CMD_PixelTexGenParameterfSGIS,
+   DISPATCH_CMD_PixelTexGenParameterfvSGIS,
+   DISPATCH_CMD_PixelTexGenParameteriSGIS,
+   DISPATCH_CMD_PixelTexGenParameterivSGIS,
+   DISPATCH_CMD_SampleMaskSGIS,
+   DISPATCH_CMD_SamplePatternSGIS,
+   DISPATCH_CMD_ColorPointerEXT,
+   DISPATCH_CMD_EdgeFlagPointerEXT,
+   DISPATCH_CMD_IndexPointerEXT,
+   DISPATCH_CMD_NormalPointerEXT,
+   DISPATCH_CMD_TexCoordPointerEXT,
+   DISPATCH_CMD_VertexPointerEXT,
+   DISPATCH_CMD_PointParameterfEXT,
+   DISPATCH_CMD_PointParameterfvEXT,
+   DISPATCH_CMD_LockArraysEXT,
+   DISPATCH_CMD_UnlockArraysEXT,
+   DISPATCH_CMD_SecondaryColor3bEXT,
+   DISPATCH_CMD_SecondaryColor3bvEXT,
+   DISPATCH_CMD_SecondaryColor3dEXT,
+   DISPATCH_CMD_SecondaryColor3dvEXT,
+   DISPATCH_CMD_SecondaryColor3fEXT,
+   DISPATCH_CMD_SecondaryColor3fvEXT,
+   DISPATCH_CMD_SecondaryColor3iEXT,
+   DISPATCH_CMD_SecondaryColor3ivEXT,
+   DISPATCH_CMD_SecondaryColor3sEXT,
+   DISPATCH_CMD_SecondaryColor3svEXT,
+   DISPATCH_CMD_SecondaryColor3ubEXT,
+   DISPATCH_CMD_SecondaryColor3ubvEXT,
+   DISPATCH_CMD_SecondaryColor3uiEXT,
+   DISPATCH_CMD_SecondaryColor3uivEXT,
+   DISPATCH_CMD_SecondaryColor3usEXT,
+   DISPATCH_CMD_SecondaryColor3usvEXT,
+   DISPATCH_CMD_SecondaryColorPointerEXT,
+   DISPATCH_CMD_MultiDrawArraysEXT,
+   DISPATCH_CMD_MultiDrawElementsEXT,
+   DISPATCH_CMD_FogCoordPointerEXT,
+   DISPATCH_CMD_FogCoorddEXT,
+   DISPATCH_CMD_FogCoorddvEXT,
+   DISPATCH_CMD_FogCoordfEXT,
+   DISPATCH_CMD_FogCoordfvEXT,
+   DISPATCH_CMD_PixelTexGenSGIX,
+   DISPATCH_CMD_BlendFuncSeparateEXT,
+   DISPATCH_CMD_FlushVertexArrayRangeNV,
+   DISPATCH_CMD_VertexArrayRangeNV,
+   DISPATCH_CMD_CombinerInputNV,
+   DISPATCH_CMD_CombinerOutputNV,
+   DISPATCH_CMD_CombinerParameterfNV,
+   DISPATCH_CMD_CombinerParameterfvNV,
+   DISPATCH_CMD_CombinerParameteriNV,
+   DISPATCH_CMD_CombinerParameterivNV,
+   DISPATCH_CMD_FinalCombinerInputNV,
+   DISPATCH_CMD_GetCombinerInputParameterfvNV,
+   DISPATCH_CMD_GetCombinerInputParameterivNV,
+   DISPATCH_CMD_GetCombinerOutputParameterfvNV,
+   DISPATCH_CMD_GetCombinerOutputParameterivNV,
+   DISPATCH_CMD_GetFinalCombinerInputParameterfvNV,
+   DISPATCH_CMD_GetFinalCombinerInputParameterivNV,
+   DISPATCH_CMD_ResizeBuffersMESA,
+   DISPATCH_CMD_WindowPos2dMESA,
+   DISPATCH_CMD_WindowPos2dvMESA,
+   DISPATCH_CMD_WindowPos2fMESA,
+   DISPATCH_CMD_WindowPos2fvMESA,
+   DISPATCH_CMD_WindowPos2iMESA,
+   DISPATCH_CMD_WindowPos2ivMESA,
+   DISPATCH_CMD_WindowPos2sMESA,
+   DISPATCH_CMD_WindowPos2svMESA,
+   DISPATCH_CMD_WindowPos3dMESA,
+   DISPATCH_CMD_WindowPos3dvMESA,
+   DISPATCH_CMD_WindowPos3fMESA,
+   DISPATCH_CMD_WindowPos3fvMESA,
+   DISPATCH_CMD_WindowPos3iMESA,
+   DISPATCH_CMD_WindowPos3ivMESA,
+   DISPATCH_CMD_WindowPos3sMESA,
+   DISPATCH_CMD_WindowPos3svMESA,
+   DISPATCH_CMD_WindowPos4dMESA,
+   DISPATCH_CMD_WindowPos4dvMESA,
+   DISPATCH_CMD_WindowPos4fMESA,
+   DISPATCH_CMD_WindowPos4fvMESA,
+   DISPATCH_CMD_WindowPos4iMESA,
+   DISPATCH_CMD_WindowPos4ivMESA,
+   DISPATCH_CMD_WindowPos4sMESA,
+   DISPATCH_CMD_WindowPos4svMESA,
+   DISPATCH_CMD_MultiModeDrawArraysIBM,
+   DISPATCH_CMD_MultiModeDrawElementsIBM,
+   DISPATCH_CMD_DeleteFencesNV,
+   DISPATCH_CMD_FinishFenceNV,
+   DISPATCH_CMD_GenFencesNV,
+   DISPATCH_CMD_GetFenceivNV,
+   DISPATCH_CMD_IsFenceNV,
+   DISPATCH_CMD_SetFenceNV,
+   DISPATCH_CMD_TestFenceNV,
+   DISPATCH_CMD_AreProgramsResidentNV,
+   DISPATCH_CMD_BindProgramNV,
+   DISPATCH_CMD_DeleteProgramsNV,
+   DISPATCH_CMD_ExecuteProgramNV,
+   DISPATCH_CMD_GenProgramsNV,
+   DISPATCH_CMD_GetProgramParameterdvNV,
+   DISPATCH_CMD_GetProgramParameterfvNV,
+   DISPATCH_CMD_GetProgramStringNV,
+   DISPATCH_CMD_GetProgramivNV,
+   DISPATCH_CMD_GetTrackMatrixivNV,
+   DISPATCH_CMD_GetVertexAttribPointervNV,
+   DISPATCH_CMD_GetVertexAttribdvNV,
+   DISPATCH_CMD_GetVertexAttribfvNV,
+   DISPATCH_CMD_GetVertexAttribivNV,
+   DISPATCH_CMD_IsProgramNV,
+   DISPATCH_CMD_LoadProgramNV,
+   DISPATCH_CMD_ProgramParameters4dvNV,
+   DISPATCH_CMD_ProgramParameters4fvNV,
+   DISPATCH_CMD_RequestResidentProgramsNV,
+   DISPATCH_CMD_TrackMatrixNV,
+   DISPATCH_CMD_VertexAttrib1dNV,
+   DISPATCH_CMD_VertexAttrib1dvNV,
+   DISPATCH_CMD_VertexAttrib1fNV,
+   DISPATCH_CMD_VertexAttrib1fvNV,
+   DISPATCH_CMD_VertexAttrib1sNV,
+   DISPATCH_CMD_VertexAttrib1svNV,
+   DISPATCH_CMD_VertexAttrib2dNV,
+   DISPATCH_CMD_VertexAttrib2dvNV,
+   DISPATCH_CMD_VertexAttrib2fNV,
+   DISPATCH_CMD_VertexAttrib2fvNV,
+   DISPATCH_CMD_VertexAttrib2sNV,
+   DISPATCH_CMD_VertexAttrib2svNV,
+   DISPATCH_CMD_VertexAttrib3dNV,
+   DISPATCH_CMD_VertexAttrib3dvNV,
+   DISPATCH_CMD_VertexAttrib3fNV,
+   DISPATCH_CMD_VertexAttrib3fvNV,
+   DISPATCH_CMD_VertexAttrib3sNV,
+   DISPATCH_CMD_VertexAttrib3svNV,
+   DISPATCH_CMD_VertexAttrib4dNV,
+   DISPATCH_CMD_VertexAttrib4dvNV,
+   DISPATCH_CMD_VertexAttrib4fNV,
+   DISPATCH_CMD_VertexAttrib4fvNV,
+   DISPATCH_CMD_VertexAttrib4sNV,
+   DISPATCH_CMD_VertexAttrib4svNV,
+   DISPATCH_CMD_VertexAttrib4ubNV,
+   DISPATCH_CMD_VertexAttrib4ubvNV,
+   DISPATCH_CMD_VertexAttribPointerNV,
+   DISPATCH_CMD_VertexAttribs1dvNV,
+   DISPATCH_CMD_VertexAttribs1fvNV,
+   DISPATCH_CMD_VertexAttribs1svNV,
+   DISPATCH_CMD_VertexAttribs2dvNV,
+   DISPATCH_CMD_VertexAttribs2fvNV,
+   DISPATCH_CMD_VertexAttribs2svNV,
+   DISPATCH_CMD_VertexAttribs3dvNV,
+   DISPATCH_CMD_VertexAttribs3fvNV,
+   DISPATCH_CMD_VertexAttribs3svNV,
+   DISPATCH_CMD_VertexAttribs4dvNV,
+   DISPATCH_CMD_VertexAttribs4fvNV,
+   DISPATCH_CMD_VertexAttribs4svNV,
+   DISPATCH_CMD_VertexAttribs4ubvNV,
+   DISPATCH_CMD_GetTexBumpParameterfvATI,
+   DISPATCH_CMD_GetTexBumpParameterivATI,
+   DISPATCH_CMD_TexBumpParameterfvATI,
+   DISPATCH_CMD_TexBumpParameterivATI,
+   DISPATCH_CMD_AlphaFragmentOp1ATI,
+   DISPATCH_CMD_AlphaFragmentOp2ATI,
+   DISPATCH_CMD_AlphaFragmentOp3ATI,
+   DISPATCH_CMD_BeginFragmentShaderATI,
+   DISPATCH_CMD_BindFragmentShaderATI,
+   DISPATCH_CMD_ColorFragmentOp1ATI,
+   DISPATCH_CMD_ColorFragmentOp2ATI,
+   DISPATCH_CMD_ColorFragmentOp3ATI,
+   DISPATCH_CMD_DeleteFragmentShaderATI,
+   DISPATCH_CMD_EndFragmentShaderATI,
+   DISPATCH_CMD_GenFragmentShadersATI,
+   DISPATCH_CMD_PassTexCoordATI,
+   DISPATCH_CMD_SampleMapATI,
+   DISPATCH_CMD_SetFragmentShaderConstantATI,
+   DISPATCH_CMD_PointParameteriNV,
+   DISPATCH_CMD_PointParameterivNV,
+   DISPATCH_CMD_ActiveStencilFaceEXT,
+   DISPATCH_CMD_BindVertexArrayAPPLE,
+   DISPATCH_CMD_DeleteVertexArraysAPPLE,
+   DISPATCH_CMD_GenVertexArraysAPPLE,
+   DISPATCH_CMD_IsVertexArrayAPPLE,
+   DISPATCH_CMD_GetProgramNamedParameterdvNV,
+   DISPATCH_CMD_GetProgramNamedParameterfvNV,
+   DISPATCH_CMD_ProgramNamedParameter4dNV,
+   DISPATCH_CMD_ProgramNamedParameter4dvNV,
+   DISPATCH_CMD_ProgramNamedParameter4fNV,
+   DISPATCH_CMD_ProgramNamedParameter4fvNV,
+   DISPATCH_CMD_PrimitiveRestartIndexNV,
+   DISPATCH_CMD_PrimitiveRestartNV,
+   DISPATCH_CMD_DepthBoundsEXT,
+   DISPATCH_CMD_BlendEquationSeparateEXT,
+   DISPATCH_CMD_BindFramebufferEXT,
+   DISPATCH_CMD_BindRenderbufferEXT,
+   DISPATCH_CMD_CheckFramebufferStatusEXT,
+   DISPATCH_CMD_DeleteFramebuffersEXT,
+   DISPATCH_CMD_DeleteRenderbuffersEXT,
+   DISPATCH_CMD_FramebufferRenderbufferEXT,
+   DISPATCH_CMD_FramebufferTexture1DEXT,
+   DISPATCH_CMD_FramebufferTexture2DEXT,
+   DISPATCH_CMD_FramebufferTexture3DEXT,
+   DISPATCH_CMD_GenFramebuffersEXT,
+   DISPATCH_CMD_GenRenderbuffersEXT,
+   DISPATCH_CMD_GenerateMipmapEXT,
+   DISPATCH_CMD_GetFramebufferAttachmentParameterivEXT,
+   DISPATCH_CMD_GetRenderbufferParameterivEXT,
+   DISPATCH_CMD_IsFramebufferEXT,
+   DISPATCH_CMD_IsRenderbufferEXT,
+   DISPATCH_CMD_RenderbufferStorageEXT,
+   DISPATCH_CMD_BlitFramebufferEXT,
+   DISPATCH_CMD_BufferParameteriAPPLE,
+   DISPATCH_CMD_FlushMappedBufferRangeAPPLE,
+   DISPATCH_CMD_BindFragDataLocationEXT,
+   DISPATCH_CMD_GetFragDataLocationEXT,
+   DISPATCH_CMD_GetUniformuivEXT,
+   DISPATCH_CMD_GetVertexAttribIivEXT,
+   DISPATCH_CMD_GetVertexAttribIuivEXT,
+   DISPATCH_CMD_Uniform1uiEXT,
+   DISPATCH_CMD_Uniform1uivEXT,
+   DISPATCH_CMD_Uniform2uiEXT,
+   DISPATCH_CMD_Uniform2uivEXT,
+   DISPATCH_CMD_Uniform3uiEXT,
+   DISPATCH_CMD_Uniform3uivEXT,
+   DISPATCH_CMD_Uniform4uiEXT,
+   DISPATCH_CMD_Uniform4uivEXT,
+   DISPATCH_CMD_VertexAttribI1iEXT,
+   DISPATCH_CMD_VertexAttribI1ivEXT,
+   DISPATCH_CMD_VertexAttribI1uiEXT,
+   DISPATCH_CMD_VertexAttribI1uivEXT,
+   DISPATCH_CMD_VertexAttribI2iEXT,
+   DISPATCH_CMD_VertexAttribI2ivEXT,
+   DISPATCH_CMD_VertexAttribI2uiEXT,
+   DISPATCH_CMD_VertexAttribI2uivEXT,
+   DISPATCH_CMD_VertexAttribI3iEXT,
+   DISPATCH_CMD_VertexAttribI3ivEXT,
+   DISPATCH_CMD_VertexAttribI3uiEXT,
+   DISPATCH_CMD_VertexAttribI3uivEXT,
+   DISPATCH_CMD_VertexAttribI4bvEXT,
+   DISPATCH_CMD_VertexAttribI4iEXT,
+   DISPATCH_CMD_VertexAttribI4ivEXT,
+   DISPATCH_CMD_VertexAttribI4svEXT,
+   DISPATCH_CMD_VertexAttribI4ubvEXT,
+   DISPATCH_CMD_VertexAttribI4uiEXT,
+   DISPATCH_CMD_VertexAttribI4uivEXT,
+   DISPATCH_CMD_VertexAttribI4usvEXT,
+   DISPATCH_CMD_VertexAttribIPointerEXT,
+   DISPATCH_CMD_FramebufferTextureLayerEXT,
+   DISPATCH_CMD_ColorMaskIndexedEXT,
+   DISPATCH_CMD_DisableIndexedEXT,
+   DISPATCH_CMD_EnableIndexedEXT,
+   DISPATCH_CMD_GetBooleanIndexedvEXT,
+   DISPATCH_CMD_GetIntegerIndexedvEXT,
+   DISPATCH_CMD_IsEnabledIndexedEXT,
+   DISPATCH_CMD_ClearColorIiEXT,
+   DISPATCH_CMD_ClearColorIuiEXT,
+   DISPATCH_CMD_GetTexParameterIivEXT,
+   DISPATCH_CMD_GetTexParameterIuivEXT,
+   DISPATCH_CMD_TexParameterIivEXT,
+   DISPATCH_CMD_TexParameterIuivEXT,
+   DISPATCH_CMD_BeginConditionalRenderNV,
+   DISPATCH_CMD_EndConditionalRenderNV,
+   DISPATCH_CMD_BeginTransformFeedbackEXT,
+   DISPATCH_CMD_BindBufferBaseEXT,
+   DISPATCH_CMD_BindBufferOffsetEXT,
+   DISPATCH_CMD_BindBufferRangeEXT,
+   DISPATCH_CMD_EndTransformFeedbackEXT,
+   DISPATCH_CMD_GetTransformFeedbackVaryingEXT,
+   DISPATCH_CMD_TransformFeedbackVaryingsEXT,
+   DISPATCH_CMD_ProvokingVertexEXT,
+   DISPATCH_CMD_GetTexParameterPointervAPPLE,
+   DISPATCH_CMD_TextureRangeAPPLE,
+   DISPATCH_CMD_GetObjectParameterivAPPLE,
+   DISPATCH_CMD_ObjectPurgeableAPPLE,
+   DISPATCH_CMD_ObjectUnpurgeableAPPLE,
+   DISPATCH_CMD_ActiveProgramEXT,
+   DISPATCH_CMD_CreateShaderProgramEXT,
+   DISPATCH_CMD_UseShaderProgramEXT,
+   DISPATCH_CMD_TextureBarrierNV,
+   DISPATCH_CMD_StencilFuncSeparateATI,
+   DISPATCH_CMD_ProgramEnvParameters4fvEXT,
+   DISPATCH_CMD_ProgramLocalParameters4fvEXT,
+   DISPATCH_CMD_GetQueryObjecti64vEXT,
+   DISPATCH_CMD_GetQueryObjectui64vEXT,
+   DISPATCH_CMD_EGLImageTargetRenderbufferStorageOES,
+   DISPATCH_CMD_EGLImageTargetTexture2DOES,
+   NUM_DISPATCH_CMD
+};
+
+struct gl_context;
+struct _glapi_table;
+
+typedef void (*_mesa_unmarshal_func)(struct gl_context *ctx, const void *cmd);
+
+extern const _mesa_unmarshal_func _mesa_unmarshal_dispatch[NUM_DISPATCH_CMD];
+
+extern struct _glapi_table *
+_mesa_create_marshal_table(void);
+
+#endif /* !defined( MARSHAL_GENERATED_H ) */
@@ -38,6 +38,15 @@
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 
 
 static GLint
@@ -129,6 +138,47 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
 /*@}*/
 
 
+#ifdef __SSE2__
+/**
+ * 2x2 box filter of 4 x GLubyte texels, four destination texels at a time.
+ * Gives the same results as the C loop in do_row().
+ * \return number of destination texels done
+ */
+static GLuint
+do_row_ubyte4_sse2(const GLubyte *rowA, const GLubyte *rowB,
+                   GLuint dstWidth, GLubyte *dst)
+{
+   const __m128i zero = _mm_setzero_si128();
+   GLuint i;
+
+   for (i = 0; i + 4 <= dstWidth; i += 4) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *) (rowA + i * 8 + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *) (rowB + i * 8 + 16));
+      /* column sums of the two rows, as 16-bit values, two texels each */
+      const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+                                       _mm_unpacklo_epi8(b0, zero));
+      const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+                                       _mm_unpackhi_epi8(b0, zero));
+      const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+                                       _mm_unpacklo_epi8(b1, zero));
+      const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+                                       _mm_unpackhi_epi8(b1, zero));
+      /* add horizontally neighbouring texels */
+      const __m128i d0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1),
+                                       _mm_unpackhi_epi64(s0, s1));
+      const __m128i d1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3),
+                                       _mm_unpackhi_epi64(s2, s3));
+      _mm_storeu_si128((__m128i *) (dst + i * 4),
+                       _mm_packus_epi16(_mm_srli_epi16(d0, 2),
+                                        _mm_srli_epi16(d1, 2)));
+   }
+   return i;
+}
+#endif
+
+
 /**
  * Average together two rows of a source image to produce a single new
  * row in the dest image.  It's legal for the two source rows to point
@@ -153,11 +203,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    */
 
    if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
-      GLuint i, j, k;
+      GLuint i = 0, j, k;
       const GLubyte(*rowA)[4] = (const GLubyte(*)[4]) srcRowA;
       const GLubyte(*rowB)[4] = (const GLubyte(*)[4]) srcRowB;
       GLubyte(*dst)[4] = (GLubyte(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#ifdef __SSE2__
+      if (colStride == 2)
+         i = do_row_ubyte4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] + rowB[j][0] + rowB[k][0]) / 4;
          dst[i][1] = (rowA[j][1] + rowA[k][1] + rowB[j][1] + rowB[k][1]) / 4;
@@ -1403,6 +1457,112 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
 }
 
 
+/**
+ * A band of destination rows of a 2D mipmap level, each computed by do_row()
+ * from two source rows.
+ */
+struct mipmap_rows
+{
+   GLenum datatype;
+   GLuint comps;
+   GLint srcWidth, dstWidth;
+   const GLubyte *srcA, *srcB;
+   GLint srcRowStep;            /**< bytes between source row pairs */
+   GLubyte *dst;
+   GLint dstRowStep;            /**< bytes between destination rows */
+   GLint numRows;
+};
+
+
+static void
+do_rows(const struct mipmap_rows *rows)
+{
+   const GLubyte *srcA = rows->srcA, *srcB = rows->srcB;
+   GLubyte *dst = rows->dst;
+   GLint row;
+
+   for (row = 0; row < rows->numRows; row++) {
+      do_row(rows->datatype, rows->comps, rows->srcWidth, srcA, srcB,
+             rows->dstWidth, dst);
+      srcA += rows->srcRowStep;
+      srcB += rows->srcRowStep;
+      dst += rows->dstRowStep;
+   }
+}
+
+
+#ifdef PTHREADS
+
+/** Levels smaller than this (in destination texels) use one thread. */
+#define MIPMAP_THREAD_MIN_TEXELS (256 * 256)
+
+#define MIPMAP_MAX_THREADS 8
+
+
+static void *
+do_rows_thread(void *data)
+{
+   do_rows((const struct mipmap_rows *) data);
+   return NULL;
+}
+
+
+/**
+ * Like do_rows(), but split large levels in bands of rows computed by
+ * separate threads.
+ */
+static void
+do_rows_parallel(const struct mipmap_rows *rows)
+{
+   static GLint numCPUs = 0;
+   struct mipmap_rows bands[MIPMAP_MAX_THREADS];
+   pthread_t threads[MIPMAP_MAX_THREADS];
+   GLboolean started[MIPMAP_MAX_THREADS];
+   GLint numBands, rowsPerBand, b;
+
+   if (numCPUs == 0) {
+      long n = sysconf(_SC_NPROCESSORS_ONLN);
+      numCPUs = (GLint) CLAMP(n, 1, MIPMAP_MAX_THREADS);
+   }
+
+   numBands = MIN2(numCPUs, rows->numRows);
+   if (numBands <= 1 ||
+       rows->dstWidth * rows->numRows < MIPMAP_THREAD_MIN_TEXELS) {
+      do_rows(rows);
+      return;
+   }
+
+   rowsPerBand = (rows->numRows + numBands - 1) / numBands;
+   for (b = 0; b < numBands; b++) {
+      const GLint first = b * rowsPerBand;
+      bands[b] = *rows;
+      bands[b].srcA += first * rows->srcRowStep;
+      bands[b].srcB += first * rows->srcRowStep;
+      bands[b].dst += first * rows->dstRowStep;
+      bands[b].numRows = MIN2(rowsPerBand, rows->numRows - first);
+   }
+
+   /* the calling thread does the first band itself */
+   for (b = 1; b < numBands; b++) {
+      started[b] = pthread_create(&threads[b], NULL, do_rows_thread,
+                                  &bands[b]) == 0;
+   }
+   do_rows(&bands[0]);
+   for (b = 1; b < numBands; b++) {
+      if (started[b])
+         pthread_join(threads[b], NULL);
+      else
+         do_rows(&bands[b]);
+   }
+}
+
+#else
+
+#define do_rows_parallel(rows) do_rows(rows)
+
+#endif /* PTHREADS */
+
+
 static void
 make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
                GLint srcWidth, GLint srcHeight,
@@ -1435,12 +1595,19 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
    dst = dstPtr + border * ((dstWidth + 1) * bpt);
 
-   for (row = 0; row < dstHeightNB; row++) {
-      do_row(datatype, comps, srcWidthNB, srcA, srcB,
-             dstWidthNB, dst);
-      srcA += srcRowStep * srcRowBytes;
-      srcB += srcRowStep * srcRowBytes;
-      dst += dstRowBytes;
+   {
+      struct mipmap_rows rows;
+      rows.datatype = datatype;
+      rows.comps = comps;
+      rows.srcWidth = srcWidthNB;
+      rows.dstWidth = dstWidthNB;
+      rows.srcA = srcA;
+      rows.srcB = srcB;
+      rows.srcRowStep = srcRowStep * srcRowBytes;
+      rows.dst = dst;
+      rows.dstRowStep = dstRowBytes;
+      rows.numRows = dstHeightNB;
+      do_rows_parallel(&rows);
    }
 
    /* This is ugly but probably won't be used much */
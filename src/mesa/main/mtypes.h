@@ -75,10 +75,12 @@ struct gl_list_extensions;
 struct gl_meta_state;
 struct gl_pixelstore_attrib;
 struct gl_program_cache;
+struct gl_shader_job;
 struct gl_texture_format;
 struct gl_texture_image;
 struct gl_texture_object;
 struct gl_context;
+struct glthread_state;
 struct st_context;
 /*@}*/
 
@@ -970,6 +972,7 @@ struct gl_light_attrib
    GLboolean _NeedVertices;		/**< Use fast shader? */
    GLbitfield _Flags;		        /**< LIGHT_* flags, see above */
    GLfloat _BaseColor[2][3];
+   GLbitfield _DirtyLights;             /**< lights whose _Position etc. are stale */
    /*@}*/
 };
 
@@ -1522,6 +1525,24 @@ struct gl_viewport_attrib
 };
 
 
+/** Number of index ranges remembered per buffer object */
+#define MAX_INDEX_RANGE_CACHE 4
+
+/**
+ * Index range of a glDrawElements call taking its indices from a buffer
+ * object, as computed by vbo_get_minmax_index().
+ */
+struct gl_index_range
+{
+   GLintptr Offset;      /**< Byte offset of the first index */
+   GLuint Count;         /**< Number of indices; 0 if the entry is unused */
+   GLenum Type;          /**< GL_UNSIGNED_BYTE/SHORT/INT */
+   GLboolean Restart;    /**< Was primitive restart enabled? */
+   GLuint RestartIndex;  /**< Restart index, if Restart */
+   GLuint Min, Max;      /**< The range found */
+};
+
+
 /**
  * GL_ARB_vertex/pixel_buffer_object buffer object
  */
@@ -1542,6 +1563,14 @@ struct gl_buffer_object
    /*@}*/
    GLboolean Written;   /**< Ever written to? (for debugging) */
    GLboolean Purgeable; /**< Is the buffer purgeable under memory pressure? */
+
+   /** Index ranges of recent indexed draws from this buffer */
+   /*@{*/
+   struct gl_index_range IndexRanges[MAX_INDEX_RANGE_CACHE];
+   GLuint NextIndexRange;      /**< Entry to replace next */
+   GLboolean GPUWritten;       /**< May be written without our knowledge,
+                                *   so index ranges can't be cached */
+   /*@}*/
 };
 
 
@@ -2131,6 +2160,10 @@ struct gl_shader
    /** Shaders containing built-in functions that are used for linking. */
    struct gl_shader *builtins_to_link[16];
    unsigned num_builtins_to_link;
+
+   _glthread_Mutex Mutex; /**< Guards CompileJob, and the IR while linking */
+   struct gl_shader_job *CompileJob; /**< Pending background compile */
+   GLuint PendingLinks; /**< Background links reading this shader's IR */
 };
 
 
@@ -2192,6 +2225,8 @@ struct gl_shader_program
     * \c NULL.
     */
    struct gl_shader *_LinkedShaders[MESA_SHADER_TYPES];
+
+   struct gl_shader_job *LinkJob; /**< Pending background link */
 };   
 
 
@@ -2203,6 +2238,7 @@ struct gl_shader_program
 #define GLSL_NOP_VERT 0x20  /**< Force no-op vertex shaders */
 #define GLSL_NOP_FRAG 0x40  /**< Force no-op fragment shaders */
 #define GLSL_USE_PROG 0x80  /**< Log glUseProgram calls */
+#define GLSL_ASYNC   0x100  /**< Compile and link on worker threads */
 
 
 /**
@@ -3076,6 +3112,39 @@ struct gl_display_list
 };
 
 
+/**
+ * Sections of the driver timed by the call profile, see callprof.h.
+ */
+typedef enum
+{
+   MESA_PROF_DRAW_ARRAYS,       /**< vbo glDrawArrays path */
+   MESA_PROF_DRAW_ELEMENTS,     /**< vbo glDraw[Range]Elements path */
+   MESA_PROF_CALL_LIST,         /**< glCallList(s) */
+   MESA_PROF_UPDATE_STATE,      /**< _mesa_update_state() */
+   MESA_PROF_DRIVER_VALIDATE,   /**< driver state validation */
+   MESA_PROF_NUM_SECTIONS
+} gl_prof_section;
+
+
+/**
+ * Call counts and time spent in each section, collected when the
+ * MESA_PROFILE environment variable is set.
+ */
+struct gl_call_profile
+{
+   GLboolean Enabled;
+   GLuint64 Calls[MESA_PROF_NUM_SECTIONS];
+   GLuint64 Time[MESA_PROF_NUM_SECTIONS];   /**< in nanoseconds */
+
+   /**
+    * Number of _mesa_update_state() calls each _NEW_* bit was set in, and
+    * the time those calls took.  A call is counted for all of its bits.
+    */
+   GLuint64 StateCalls[32];
+   GLuint64 StateTime[32];
+};
+
+
 /**
  * State used during display list compilation and execution.
  */
@@ -3142,8 +3211,12 @@ struct gl_context
    struct _glapi_table *Save;	/**< Display list save functions */
    struct _glapi_table *Exec;	/**< Execute functions */
    struct _glapi_table *CurrentDispatch;  /**< == Save or Exec !! */
+   struct _glapi_table *MarshalExec;  /**< Threaded dispatch, see glthread.c */
    /*@}*/
 
+   /** Threaded dispatch state, NULL unless MESA_GLTHREAD is set */
+   struct glthread_state *GLThread;
+
    struct gl_config Visual;
    struct gl_framebuffer *DrawBuffer;	/**< buffer for writing */
    struct gl_framebuffer *ReadBuffer;	/**< buffer for reading */
@@ -3304,6 +3377,7 @@ struct gl_context
    /** \name For debugging/development only */
    /*@{*/
    GLboolean FirstTimeCurrent;
+   struct gl_call_profile Profile;
    /*@}*/
 
    /** software compression/decompression supported or not */
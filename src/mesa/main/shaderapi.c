@@ -45,6 +45,7 @@
 #include "main/mtypes.h"
 #include "main/shaderapi.h"
 #include "main/shaderobj.h"
+#include "main/shaderqueue.h"
 #include "program/program.h"
 #include "program/prog_parameter.h"
 #include "program/prog_uniform.h"
@@ -82,6 +83,8 @@ get_shader_flags(void)
          flags |= GLSL_UNIFORMS;
       if (strstr(env, "useprog"))
          flags |= GLSL_USE_PROG;
+      if (strstr(env, "async"))
+         flags |= GLSL_ASYNC;
    }
 
    return flags;
@@ -119,6 +122,10 @@ _mesa_init_shader_state(struct gl_context *ctx)
 void
 _mesa_free_shader_state(struct gl_context *ctx)
 {
+   /* Background jobs may still refer to this context. */
+   if (ctx->Shader.Flags & GLSL_ASYNC)
+      _mesa_shader_queue_finish();
+
    _mesa_reference_shader_program(ctx, &ctx->Shader.CurrentVertexProgram, NULL);
    _mesa_reference_shader_program(ctx, &ctx->Shader.CurrentGeometryProgram,
 				  NULL);
@@ -825,24 +832,138 @@ shader_source(struct gl_context *ctx, GLuint shader, const GLchar *source)
 }
 
 
+/**
+ * Background compile, see compile_shader().
+ */
+struct compile_job
+{
+   struct gl_shader_job Base;
+   struct gl_context *Context;
+   struct gl_shader *Shader;
+};
+
+
+/**
+ * Background link, see link_program().
+ */
+struct link_job
+{
+   struct gl_shader_job Base;
+   struct gl_context *Context;
+   struct gl_shader_program *Program;
+};
+
+
+static void
+execute_compile_job(struct gl_shader_job *job)
+{
+   struct compile_job *compile = (struct compile_job *) job;
+
+   _mesa_glsl_compile_shader(compile->Context, compile->Shader);
+}
+
+
+/**
+ * Lock the mutexes of the program's shaders for linking.
+ *
+ * The GLSL linker updates some of the IR of the shaders it links (array
+ * sizes of globals, for instance), so links must not overlap when they
+ * share a shader.  The mutexes are taken in address order, so that links
+ * of programs sharing several shaders can't deadlock.
+ */
+static void
+lock_shaders(struct gl_shader_program *shProg)
+{
+   uintptr_t prev = 0;
+   GLuint i, n;
+
+   for (n = 0; n < shProg->NumShaders; n++) {
+      struct gl_shader *next = NULL;
+
+      for (i = 0; i < shProg->NumShaders; i++) {
+         struct gl_shader *sh = shProg->Shaders[i];
+         if ((uintptr_t) sh > prev &&
+             (next == NULL || (uintptr_t) sh < (uintptr_t) next))
+            next = sh;
+      }
+
+      _glthread_LOCK_MUTEX(next->Mutex);
+      prev = (uintptr_t) next;
+   }
+}
+
+
+static void
+unlock_shaders(struct gl_shader_program *shProg)
+{
+   GLuint i;
+
+   for (i = 0; i < shProg->NumShaders; i++)
+      _glthread_UNLOCK_MUTEX(shProg->Shaders[i]->Mutex);
+}
+
+
+static void
+execute_link_job(struct gl_shader_job *job)
+{
+   struct link_job *link = (struct link_job *) job;
+   struct gl_shader_program *shProg = link->Program;
+   GLuint i;
+
+   /* Compile jobs never wait for anything, and the ones of these shaders
+    * were queued before this job, so they are running or done by now.
+    */
+   for (i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader(link->Context, shProg->Shaders[i]);
+
+   lock_shaders(shProg);
+   _mesa_glsl_link_shader_ir(link->Context, shProg);
+   unlock_shaders(shProg);
+
+   for (i = 0; i < shProg->NumShaders; i++)
+      _mesa_shader_queue_release(&shProg->Shaders[i]->PendingLinks);
+}
+
+
 /**
  * Compile a shader.
+ *
+ * With MESA_GLSL=async the compile runs on a shader queue thread.  Looking
+ * up the shader by name waits for it to finish, see _mesa_lookup_shader().
  */
 static void
 compile_shader(struct gl_context *ctx, GLuint shaderObj)
 {
    struct gl_shader *sh;
    struct gl_shader_compiler_options *options;
+   struct compile_job *job = NULL;
 
    sh = _mesa_lookup_shader_err(ctx, shaderObj, "glCompileShader");
    if (!sh)
       return;
 
+   /* Recompiling replaces the IR, which background links may be reading. */
+   _mesa_shader_queue_wait_released(&sh->PendingLinks);
+
    options = &ctx->ShaderCompilerOptions[_mesa_shader_type_to_index(sh->Type)];
 
    /* set default pragma state for shader */
    sh->Pragmas = options->DefaultPragmas;
 
+   if (ctx->Shader.Flags & GLSL_ASYNC)
+      job = CALLOC_STRUCT(compile_job);
+
+   if (job) {
+      job->Base.Execute = execute_compile_job;
+      job->Context = ctx;
+      job->Shader = sh;
+      _glthread_LOCK_MUTEX(sh->Mutex);
+      sh->CompileJob = &job->Base;
+      _glthread_UNLOCK_MUTEX(sh->Mutex);
+      _mesa_shader_queue_submit(&job->Base);
+      return;
+   }
+
    /* this call will set the sh->CompileStatus field to indicate if
     * compilation was successful.
     */
@@ -850,6 +971,32 @@ compile_shader(struct gl_context *ctx, GLuint shaderObj)
 }
 
 
+/**
+ * Might the program be bound for rendering or glUniform?
+ *
+ * We can only tell for this context, so programs of a share group with
+ * other contexts are always considered in use.
+ */
+static GLboolean
+program_in_use(struct gl_context *ctx,
+               const struct gl_shader_program *shProg)
+{
+   GLboolean shared;
+
+   if (shProg == ctx->Shader.CurrentVertexProgram ||
+       shProg == ctx->Shader.CurrentGeometryProgram ||
+       shProg == ctx->Shader.CurrentFragmentProgram ||
+       shProg == ctx->Shader.ActiveProgram)
+      return GL_TRUE;
+
+   _glthread_LOCK_MUTEX(ctx->Shared->Mutex);
+   shared = ctx->Shared->RefCount > 1;
+   _glthread_UNLOCK_MUTEX(ctx->Shared->Mutex);
+
+   return shared;
+}
+
+
 /**
  * Link a program's shaders.
  */
@@ -859,6 +1006,8 @@ link_program(struct gl_context *ctx, GLuint program)
    struct gl_shader_program *shProg;
    struct gl_transform_feedback_object *obj =
       ctx->TransformFeedback.CurrentObject;
+   struct link_job *job = NULL;
+   GLuint i;
 
    shProg = _mesa_lookup_shader_program_err(ctx, program, "glLinkProgram");
    if (!shProg)
@@ -875,12 +1024,35 @@ link_program(struct gl_context *ctx, GLuint program)
 
    FLUSH_VERTICES(ctx, _NEW_PROGRAM);
 
+   /* A program that is in use is relinked right away, since rendering
+    * depends on its link results.
+    */
+   if ((ctx->Shader.Flags & GLSL_ASYNC) && !program_in_use(ctx, shProg))
+      job = CALLOC_STRUCT(link_job);
+
+   if (job) {
+      _mesa_glsl_link_shader_begin(ctx, shProg);
+
+      for (i = 0; i < shProg->NumShaders; i++)
+         _mesa_shader_queue_hold(&shProg->Shaders[i]->PendingLinks);
+
+      job->Base.Execute = execute_link_job;
+      job->Context = ctx;
+      job->Program = shProg;
+      shProg->LinkJob = &job->Base;
+      _mesa_shader_queue_submit(&job->Base);
+      return;
+   }
+
+   for (i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader(ctx, shProg->Shaders[i]);
+
+   lock_shaders(shProg);
    _mesa_glsl_link_shader(ctx, shProg);
+   unlock_shaders(shProg);
 
    /* debug code */
    if (0) {
-      GLuint i;
-
       printf("Link %u shaders in program %u: %s\n",
                    shProg->NumShaders, shProg->Name,
                    shProg->LinkStatus ? "Success" : "Failed");
@@ -35,6 +35,7 @@
 #include "main/mfeatures.h"
 #include "main/mtypes.h"
 #include "main/shaderobj.h"
+#include "main/shaderqueue.h"
 #include "program/program.h"
 #include "program/prog_parameter.h"
 #include "program/prog_uniform.h"
@@ -94,6 +95,7 @@ void
 _mesa_init_shader(struct gl_context *ctx, struct gl_shader *shader)
 {
    shader->RefCount = 1;
+   _glthread_INIT_MUTEX(shader->Mutex);
 }
 
 /**
@@ -123,15 +125,44 @@ _mesa_new_shader(struct gl_context *ctx, GLuint name, GLenum type)
 static void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh)
 {
+   _mesa_wait_shader(ctx, sh);
    if (sh->Source)
       free((void *) sh->Source);
    _mesa_reference_program(ctx, &sh->Program, NULL);
+   _glthread_DESTROY_MUTEX(sh->Mutex);
    ralloc_free(sh);
 }
 
 
+/**
+ * Wait for a background compile of the shader (see MESA_GLSL=async) to
+ * finish.
+ *
+ * Contexts of a share group and background links may wait for the same
+ * shader at once.  The shader's mutex is held while waiting, so the first
+ * of them frees the job and the others find it gone once the compile is
+ * done.
+ */
+void
+_mesa_wait_shader(struct gl_context *ctx, struct gl_shader *sh)
+{
+   (void) ctx;
+
+   _glthread_LOCK_MUTEX(sh->Mutex);
+   if (sh->CompileJob) {
+      _mesa_shader_queue_wait(sh->CompileJob);
+      free(sh->CompileJob);
+      sh->CompileJob = NULL;
+   }
+   _glthread_UNLOCK_MUTEX(sh->Mutex);
+}
+
+
 /**
  * Lookup a GLSL shader object.
+ *
+ * Any pending background compile of the shader is finished first, so the
+ * caller sees the compile results.
  */
 struct gl_shader *
 _mesa_lookup_shader(struct gl_context *ctx, GLuint name)
@@ -146,6 +177,8 @@ _mesa_lookup_shader(struct gl_context *ctx, GLuint name)
       if (sh && sh->Type == GL_SHADER_PROGRAM_MESA) {
          return NULL;
       }
+      if (sh)
+         _mesa_wait_shader(ctx, sh);
       return sh;
    }
    return NULL;
@@ -173,6 +206,7 @@ _mesa_lookup_shader_err(struct gl_context *ctx, GLuint name, const char *caller)
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s", caller);
          return NULL;
       }
+      _mesa_wait_shader(ctx, sh);
       return sh;
    }
 }
@@ -305,6 +339,13 @@ _mesa_free_shader_program_data(struct gl_context *ctx,
 
    assert(shProg->Type == GL_SHADER_PROGRAM_MESA);
 
+   /* Nobody will look at the results of a pending link anymore. */
+   if (shProg->LinkJob) {
+      _mesa_shader_queue_wait(shProg->LinkJob);
+      free(shProg->LinkJob);
+      shProg->LinkJob = NULL;
+   }
+
    _mesa_clear_shader_program_data(ctx, shProg);
 
    if (shProg->Attributes) {
@@ -354,8 +395,29 @@ _mesa_delete_shader_program(struct gl_context *ctx, struct gl_shader_program *sh
 }
 
 
+/**
+ * Wait for a background link of the program (see MESA_GLSL=async) to
+ * finish, and hand its results to the driver.
+ */
+void
+_mesa_wait_shader_program(struct gl_context *ctx,
+                          struct gl_shader_program *shProg)
+{
+   if (shProg->LinkJob) {
+      _mesa_shader_queue_wait(shProg->LinkJob);
+      free(shProg->LinkJob);
+      shProg->LinkJob = NULL;
+
+      _mesa_glsl_link_shader_end(ctx, shProg);
+   }
+}
+
+
 /**
  * Lookup a GLSL program object.
+ *
+ * Any pending background link of the program is finished first, so the
+ * caller sees the link results.
  */
 struct gl_shader_program *
 _mesa_lookup_shader_program(struct gl_context *ctx, GLuint name)
@@ -371,6 +433,8 @@ _mesa_lookup_shader_program(struct gl_context *ctx, GLuint name)
       if (shProg && shProg->Type != GL_SHADER_PROGRAM_MESA) {
          return NULL;
       }
+      if (shProg)
+         _mesa_wait_shader_program(ctx, shProg);
       return shProg;
    }
    return NULL;
@@ -399,6 +463,7 @@ _mesa_lookup_shader_program_err(struct gl_context *ctx, GLuint name,
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s", caller);
          return NULL;
       }
+      _mesa_wait_shader_program(ctx, shProg);
       return shProg;
    }
 }
@@ -50,6 +50,9 @@ extern void
 _mesa_reference_shader(struct gl_context *ctx, struct gl_shader **ptr,
                        struct gl_shader *sh);
 
+extern void
+_mesa_wait_shader(struct gl_context *ctx, struct gl_shader *sh);
+
 extern struct gl_shader *
 _mesa_lookup_shader(struct gl_context *ctx, GLuint name);
 
@@ -71,6 +74,10 @@ _mesa_new_shader(struct gl_context *ctx, GLuint name, GLenum type);
 extern void
 _mesa_init_shader_program(struct gl_context *ctx, struct gl_shader_program *prog);
 
+extern void
+_mesa_wait_shader_program(struct gl_context *ctx,
+                          struct gl_shader_program *shProg);
+
 extern struct gl_shader_program *
 _mesa_lookup_shader_program(struct gl_context *ctx, GLuint name);
 
@@ -0,0 +1,254 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+ * AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file shaderqueue.c
+ * Worker thread pool for background GLSL compiles and links.
+ *
+ * The pool is shared by all contexts and started on first use.  Jobs are
+ * taken in submission order.  Without thread support, or if the threads
+ * can't be created, jobs simply run synchronously in
+ * _mesa_shader_queue_submit().
+ */
+
+#include "main/glheader.h"
+#include "main/imports.h"
+#include "main/shaderqueue.h"
+
+#ifdef PTHREADS
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define MAX_SHADER_THREADS 16
+
+static pthread_mutex_t QueueMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t QueueCond = PTHREAD_COND_INITIALIZER; /**< new work */
+static pthread_cond_t DoneCond = PTHREAD_COND_INITIALIZER;  /**< job done */
+
+static struct gl_shader_job *QueueHead, *QueueTail;
+static GLuint NumThreads;
+static GLuint NumBusy;
+static GLboolean Initialized;
+
+
+static void *
+shader_queue_thread(void *arg)
+{
+   (void) arg;
+
+   pthread_mutex_lock(&QueueMutex);
+   for (;;) {
+      struct gl_shader_job *job;
+
+      while (!QueueHead)
+         pthread_cond_wait(&QueueCond, &QueueMutex);
+
+      job = QueueHead;
+      QueueHead = job->Next;
+      if (!QueueHead)
+         QueueTail = NULL;
+      NumBusy++;
+      pthread_mutex_unlock(&QueueMutex);
+
+      job->Execute(job);
+
+      pthread_mutex_lock(&QueueMutex);
+      job->Done = GL_TRUE;
+      NumBusy--;
+      pthread_cond_broadcast(&DoneCond);
+   }
+
+   return NULL;
+}
+
+
+/**
+ * Start the worker threads.  Called with QueueMutex held.
+ */
+static void
+shader_queue_init(void)
+{
+   pthread_attr_t attr;
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+   GLuint i;
+
+   Initialized = GL_TRUE;
+
+   if (count < 1)
+      count = 1;
+   if (count > MAX_SHADER_THREADS)
+      count = MAX_SHADER_THREADS;
+
+   pthread_attr_init(&attr);
+   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+   for (i = 0; i < count; i++) {
+      pthread_t thread;
+      if (pthread_create(&thread, &attr, shader_queue_thread, NULL) != 0)
+         break;
+      NumThreads++;
+   }
+   pthread_attr_destroy(&attr);
+
+   if (NumThreads == 0)
+      _mesa_warning(NULL, "couldn't start GLSL compiler threads");
+}
+
+
+/**
+ * Queue a job.  The caller owns the job and must not free it before
+ * _mesa_shader_queue_wait() returned for it.
+ */
+void
+_mesa_shader_queue_submit(struct gl_shader_job *job)
+{
+   job->Next = NULL;
+   job->Done = GL_FALSE;
+
+   pthread_mutex_lock(&QueueMutex);
+   if (!Initialized)
+      shader_queue_init();
+
+   if (NumThreads == 0) {
+      pthread_mutex_unlock(&QueueMutex);
+      job->Execute(job);
+      job->Done = GL_TRUE;
+      return;
+   }
+
+   if (QueueTail)
+      QueueTail->Next = job;
+   else
+      QueueHead = job;
+   QueueTail = job;
+
+   pthread_cond_signal(&QueueCond);
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+
+/**
+ * Block until the given job has finished executing.
+ */
+void
+_mesa_shader_queue_wait(struct gl_shader_job *job)
+{
+   pthread_mutex_lock(&QueueMutex);
+   while (!job->Done)
+      pthread_cond_wait(&DoneCond, &QueueMutex);
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+
+/**
+ * Block until every queued job has finished executing.
+ */
+void
+_mesa_shader_queue_finish(void)
+{
+   pthread_mutex_lock(&QueueMutex);
+   while (QueueHead || NumBusy)
+      pthread_cond_wait(&DoneCond, &QueueMutex);
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+
+/**
+ * Count a job that some object waits for, see
+ * _mesa_shader_queue_wait_released().
+ */
+void
+_mesa_shader_queue_hold(GLuint *count)
+{
+   pthread_mutex_lock(&QueueMutex);
+   (*count)++;
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+
+/**
+ * Called by a job counted with _mesa_shader_queue_hold() when the object
+ * needn't wait for it anymore.
+ */
+void
+_mesa_shader_queue_release(GLuint *count)
+{
+   pthread_mutex_lock(&QueueMutex);
+   assert(*count > 0);
+   (*count)--;
+   pthread_cond_broadcast(&DoneCond);
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+
+/**
+ * Block until every job counted in *count released it.
+ */
+void
+_mesa_shader_queue_wait_released(GLuint *count)
+{
+   pthread_mutex_lock(&QueueMutex);
+   while (*count)
+      pthread_cond_wait(&DoneCond, &QueueMutex);
+   pthread_mutex_unlock(&QueueMutex);
+}
+
+#else /* PTHREADS */
+
+void
+_mesa_shader_queue_submit(struct gl_shader_job *job)
+{
+   job->Next = NULL;
+   job->Execute(job);
+   job->Done = GL_TRUE;
+}
+
+void
+_mesa_shader_queue_wait(struct gl_shader_job *job)
+{
+   assert(job->Done);
+}
+
+void
+_mesa_shader_queue_finish(void)
+{
+}
+
+void
+_mesa_shader_queue_hold(GLuint *count)
+{
+   (*count)++;
+}
+
+void
+_mesa_shader_queue_release(GLuint *count)
+{
+   assert(*count > 0);
+   (*count)--;
+}
+
+void
+_mesa_shader_queue_wait_released(GLuint *count)
+{
+   assert(*count == 0);
+}
+
+#endif /* PTHREADS */
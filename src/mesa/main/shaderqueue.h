@@ -0,0 +1,69 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+ * AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file shaderqueue.h
+ * Worker thread pool for background GLSL compiles and links.
+ */
+
+#ifndef SHADERQUEUE_H
+#define SHADERQUEUE_H
+
+#include "main/glheader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A unit of work for the shader queue.  Embed this in a larger structure
+ * to carry the job's arguments.
+ */
+struct gl_shader_job
+{
+   void (*Execute)(struct gl_shader_job *job);
+   struct gl_shader_job *Next;
+   GLboolean Done;
+};
+
+extern void
+_mesa_shader_queue_submit(struct gl_shader_job *job);
+
+extern void
+_mesa_shader_queue_wait(struct gl_shader_job *job);
+
+extern void
+_mesa_shader_queue_finish(void);
+
+extern void
+_mesa_shader_queue_hold(GLuint *count);
+
+extern void
+_mesa_shader_queue_release(GLuint *count);
+
+extern void
+_mesa_shader_queue_wait_released(GLuint *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHADERQUEUE_H */
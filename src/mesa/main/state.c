@@ -34,6 +34,7 @@
 #include "glheader.h"
 #include "mtypes.h"
 #include "context.h"
+#include "callprof.h"
 #include "debug.h"
 #include "macros.h"
 #include "ffvertex_prog.h"
@@ -216,11 +217,16 @@ update_program_enables(struct gl_context *ctx)
  * This function needs to be called after texture state validation in case
  * we're generating a fragment program from fixed-function texture state.
  *
+ * Fixed-function programs are only looked up again when state they depend
+ * on changed: \p changed is the new _NEW_* state, \p fp_flags and
+ * \p vp_flags the flags the fragment and vertex stage depend on.
+ *
  * \return bitfield which will indicate _NEW_PROGRAM state if a new vertex
  * or fragment program is being used.
  */
 static GLbitfield
-update_program(struct gl_context *ctx)
+update_program(struct gl_context *ctx, GLbitfield changed,
+               GLbitfield fp_flags, GLbitfield vp_flags)
 {
    const struct gl_shader_program *vsProg = ctx->Shader.CurrentVertexProgram;
    const struct gl_shader_program *gsProg = ctx->Shader.CurrentGeometryProgram;
@@ -258,10 +264,13 @@ update_program(struct gl_context *ctx)
    }
    else if (ctx->FragmentProgram._MaintainTexEnvProgram) {
       /* Use fragment program generated from fixed-function state */
-      _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._Current,
-                               _mesa_get_fixed_func_fragment_program(ctx));
-      _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._TexEnvProgram,
-                               ctx->FragmentProgram._Current);
+      if ((changed & fp_flags) ||
+          !prevFP || prevFP != ctx->FragmentProgram._TexEnvProgram) {
+         _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._Current,
+                                  _mesa_get_fixed_func_fragment_program(ctx));
+         _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._TexEnvProgram,
+                                  ctx->FragmentProgram._Current);
+      }
    }
    else {
       /* No fragment program */
@@ -292,11 +301,17 @@ update_program(struct gl_context *ctx)
                                ctx->VertexProgram.Current);
    }
    else if (ctx->VertexProgram._MaintainTnlProgram) {
-      /* Use vertex program generated from fixed-function state */
-      _mesa_reference_vertprog(ctx, &ctx->VertexProgram._Current,
-                               _mesa_get_fixed_func_vertex_program(ctx));
-      _mesa_reference_vertprog(ctx, &ctx->VertexProgram._TnlProgram,
-                               ctx->VertexProgram._Current);
+      /* Use vertex program generated from fixed-function state.  It
+       * depends on the fragment program inputs, too.
+       */
+      if ((changed & vp_flags) ||
+          ctx->FragmentProgram._Current != prevFP ||
+          !prevVP || prevVP != ctx->VertexProgram._TnlProgram) {
+         _mesa_reference_vertprog(ctx, &ctx->VertexProgram._Current,
+                                  _mesa_get_fixed_func_vertex_program(ctx));
+         _mesa_reference_vertprog(ctx, &ctx->VertexProgram._TnlProgram,
+                                  ctx->VertexProgram._Current);
+      }
    }
    else {
       /* no vertex program */
@@ -569,7 +584,11 @@ void
 _mesa_update_state_locked( struct gl_context *ctx )
 {
    GLbitfield new_state = ctx->NewState;
-   GLbitfield prog_flags = _NEW_PROGRAM;
+   const GLbitfield profile_state = new_state;
+   const GLuint64 start = _mesa_call_profile_begin(ctx);
+   GLbitfield fp_flags = _NEW_PROGRAM;
+   GLbitfield vp_flags = _NEW_PROGRAM;
+   GLbitfield prog_flags;
    GLbitfield new_prog_state = 0x0;
 
    if (new_state == _NEW_CURRENT_ATTRIB) 
@@ -578,18 +597,21 @@ _mesa_update_state_locked( struct gl_context *ctx )
    if (MESA_VERBOSE & VERBOSE_STATE)
       _mesa_print_state("_mesa_update_state", new_state);
 
-   /* Determine which state flags effect vertex/fragment program state */
+   /* Determine which state flags effect vertex/fragment program state.
+    * _NEW_TEXTURE_MATRIX is there for ctx->Texture._TexMatEnabled.
+    */
    if (ctx->FragmentProgram._MaintainTexEnvProgram) {
-      prog_flags |= (_NEW_BUFFERS | _NEW_TEXTURE | _NEW_FOG |
-		     _NEW_ARRAY | _NEW_LIGHT | _NEW_POINT | _NEW_RENDERMODE |
-		     _NEW_PROGRAM | _NEW_FRAG_CLAMP);
+      fp_flags |= (_NEW_BUFFERS | _NEW_TEXTURE | _NEW_TEXTURE_MATRIX |
+                   _NEW_FOG | _NEW_ARRAY | _NEW_LIGHT | _NEW_POINT |
+                   _NEW_RENDERMODE | _NEW_PROGRAM | _NEW_FRAG_CLAMP);
    }
    if (ctx->VertexProgram._MaintainTnlProgram) {
-      prog_flags |= (_NEW_ARRAY | _NEW_TEXTURE | _NEW_TEXTURE_MATRIX |
-                     _NEW_TRANSFORM | _NEW_POINT |
-                     _NEW_FOG | _NEW_LIGHT |
-                     _MESA_NEW_NEED_EYE_COORDS);
+      vp_flags |= (_NEW_ARRAY | _NEW_TEXTURE | _NEW_TEXTURE_MATRIX |
+                   _NEW_TRANSFORM | _NEW_POINT |
+                   _NEW_FOG | _NEW_LIGHT |
+                   _MESA_NEW_NEED_EYE_COORDS);
    }
+   prog_flags = fp_flags | vp_flags;
 
    /*
     * Now update derived state info
@@ -666,7 +688,7 @@ _mesa_update_state_locked( struct gl_context *ctx )
        * this call may generate/bind a new program.  If so, we need to
        * propogate the _NEW_PROGRAM flag to the driver.
        */
-      new_prog_state |= update_program( ctx );
+      new_prog_state |= update_program( ctx, new_state, fp_flags, vp_flags );
    }
 
    if (new_state & (_NEW_ARRAY | _NEW_PROGRAM | _NEW_BUFFER_OBJECT))
@@ -690,6 +712,8 @@ _mesa_update_state_locked( struct gl_context *ctx )
    ctx->Array.NewState = 0;
    if (!ctx->Array.RebindArrays)
       ctx->Array.RebindArrays = (new_state & (_NEW_ARRAY | _NEW_PROGRAM)) != 0;
+
+   _mesa_call_profile_state(ctx, profile_state, start);
 }
 
 
@@ -698,9 +722,13 @@ _mesa_update_state_locked( struct gl_context *ctx )
 void
 _mesa_update_state( struct gl_context *ctx )
 {
+   const GLuint64 start = _mesa_call_profile_begin(ctx);
+
    _mesa_lock_context_textures(ctx);
    _mesa_update_state_locked(ctx);
    _mesa_unlock_context_textures(ctx);
+
+   _mesa_call_profile_end(ctx, MESA_PROF_UPDATE_STATE, start);
 }
 
 
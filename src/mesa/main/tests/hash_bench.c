@@ -0,0 +1,392 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file hash_bench.c
+ * Micro-benchmark of the object name table (main/hash.c) on bind-heavy
+ * workloads, compared against the fixed 1023-bucket chained table it
+ * replaced.
+ *
+ * Every workload creates its objects the way the glGen* functions do
+ * (_mesa_HashFindFreeKeyBlock + _mesa_HashInsert) and then spends its time
+ * in _mesa_HashLookup, which is what every glBind* call does.  The
+ * threaded workload does the lookups from several threads at once, as
+ * contexts of one share group would.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "main/glheader.h"
+#include "main/hash.h"
+
+
+struct gl_context;
+
+/* main/hash.c reports problems through these; keep the benchmark
+ * independent of the rest of core Mesa.
+ */
+void
+_mesa_problem(const struct gl_context *ctx, const char *fmtString, ...)
+{
+   va_list args;
+   va_start(args, fmtString);
+   vfprintf(stderr, fmtString, args);
+   va_end(args);
+   fprintf(stderr, "\n");
+}
+
+void
+_mesa_debug(const struct gl_context *ctx, const char *fmtString, ...)
+{
+}
+
+
+/* The chained implementation, as it was before the rewrite. */
+#define OLD_TABLE_SIZE 1023
+
+struct old_entry {
+   GLuint Key;
+   void *Data;
+   struct old_entry *Next;
+};
+
+struct old_table {
+   struct old_entry *Table[OLD_TABLE_SIZE];
+   GLuint MaxKey;
+   pthread_mutex_t Mutex;
+};
+
+static struct old_table *
+old_new(void)
+{
+   struct old_table *t = calloc(1, sizeof(*t));
+   pthread_mutex_init(&t->Mutex, NULL);
+   return t;
+}
+
+static void
+old_delete(struct old_table *t)
+{
+   GLuint pos;
+   for (pos = 0; pos < OLD_TABLE_SIZE; pos++) {
+      struct old_entry *e = t->Table[pos];
+      while (e) {
+         struct old_entry *next = e->Next;
+         free(e);
+         e = next;
+      }
+   }
+   pthread_mutex_destroy(&t->Mutex);
+   free(t);
+}
+
+static void *
+old_lookup(struct old_table *t, GLuint key)
+{
+   const struct old_entry *e;
+   void *res = NULL;
+   pthread_mutex_lock(&t->Mutex);
+   for (e = t->Table[key % OLD_TABLE_SIZE]; e; e = e->Next) {
+      if (e->Key == key) {
+         res = e->Data;
+         break;
+      }
+   }
+   pthread_mutex_unlock(&t->Mutex);
+   return res;
+}
+
+static void
+old_insert(struct old_table *t, GLuint key, void *data)
+{
+   GLuint pos = key % OLD_TABLE_SIZE;
+   struct old_entry *e;
+   pthread_mutex_lock(&t->Mutex);
+   if (key > t->MaxKey)
+      t->MaxKey = key;
+   for (e = t->Table[pos]; e; e = e->Next) {
+      if (e->Key == key) {
+         e->Data = data;
+         pthread_mutex_unlock(&t->Mutex);
+         return;
+      }
+   }
+   e = malloc(sizeof(*e));
+   e->Key = key;
+   e->Data = data;
+   e->Next = t->Table[pos];
+   t->Table[pos] = e;
+   pthread_mutex_unlock(&t->Mutex);
+}
+
+static void
+old_remove(struct old_table *t, GLuint key)
+{
+   struct old_entry **link;
+   pthread_mutex_lock(&t->Mutex);
+   for (link = &t->Table[key % OLD_TABLE_SIZE]; *link; link = &(*link)->Next) {
+      if ((*link)->Key == key) {
+         struct old_entry *e = *link;
+         *link = e->Next;
+         free(e);
+         break;
+      }
+   }
+   pthread_mutex_unlock(&t->Mutex);
+}
+
+static GLuint
+old_gen(struct old_table *t)
+{
+   GLuint key;
+   pthread_mutex_lock(&t->Mutex);
+   key = t->MaxKey + 1;
+   pthread_mutex_unlock(&t->Mutex);
+   return key;
+}
+
+
+/* Both tables behind one interface. */
+struct table_ops {
+   const char *name;
+   void *(*create)(void);
+   void (*destroy)(void *t);
+   void *(*lookup)(void *t, GLuint key);
+   void (*insert)(void *t, GLuint key, void *data);
+   void (*remove)(void *t, GLuint key);
+   GLuint (*gen)(void *t);
+};
+
+static void *old_create_cb(void) { return old_new(); }
+static void old_destroy_cb(void *t) { old_delete(t); }
+static void *old_lookup_cb(void *t, GLuint k) { return old_lookup(t, k); }
+static void old_insert_cb(void *t, GLuint k, void *d) { old_insert(t, k, d); }
+static void old_remove_cb(void *t, GLuint k) { old_remove(t, k); }
+static GLuint old_gen_cb(void *t) { return old_gen(t); }
+
+static void *new_create_cb(void) { return _mesa_NewHashTable(); }
+static void *new_lookup_cb(void *t, GLuint k) { return _mesa_HashLookup(t, k); }
+static void new_insert_cb(void *t, GLuint k, void *d) { _mesa_HashInsert(t, k, d); }
+static void new_remove_cb(void *t, GLuint k) { _mesa_HashRemove(t, k); }
+static GLuint new_gen_cb(void *t) { return _mesa_HashFindFreeKeyBlock(t, 1); }
+
+static void
+remove_all_cb(GLuint key, void *data, void *userData)
+{
+}
+
+static void
+new_destroy_cb(void *t)
+{
+   _mesa_HashDeleteAll(t, remove_all_cb, NULL);
+   _mesa_DeleteHashTable(t);
+}
+
+static const struct table_ops old_ops = {
+   "chained", old_create_cb, old_destroy_cb, old_lookup_cb, old_insert_cb,
+   old_remove_cb, old_gen_cb
+};
+
+static const struct table_ops new_ops = {
+   "new", new_create_cb, new_destroy_cb, new_lookup_cb, new_insert_cb,
+   new_remove_cb, new_gen_cb
+};
+
+
+static double
+get_time(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static unsigned
+next_rand(unsigned *seed)
+{
+   *seed = *seed * 1103515245 + 12345;
+   return *seed >> 8;
+}
+
+static char objects[1];   /* all entries point here */
+
+#define NUM_BINDS 4000000
+
+
+struct workload {
+   const char *name;
+   unsigned num_objects;
+   GLboolean scattered;   /* app-chosen names instead of generated ones */
+   GLboolean churn;       /* delete and re-create objects while binding */
+   unsigned num_threads;
+};
+
+struct thread_args {
+   const struct table_ops *ops;
+   void *table;
+   const GLuint *names;
+   unsigned num_names;
+   unsigned seed;
+   unsigned binds;
+   unsigned long found;
+};
+
+static void *
+bind_thread(void *data)
+{
+   struct thread_args *a = data;
+   unsigned seed = a->seed;
+   unsigned i;
+
+   for (i = 0; i < a->binds; i++) {
+      GLuint name = a->names[next_rand(&seed) % a->num_names];
+      if (a->ops->lookup(a->table, name))
+         a->found++;
+   }
+   return NULL;
+}
+
+/**
+ * Run one workload and return its time in seconds.  The number of
+ * successful lookups is returned in \p found to check the tables agree.
+ */
+static double
+run(const struct table_ops *ops, const struct workload *w,
+    unsigned long *found)
+{
+   void *table = ops->create();
+   GLuint *names = malloc(w->num_objects * sizeof(GLuint));
+   unsigned seed = 1;
+   unsigned i, t;
+   double start;
+
+   for (i = 0; i < w->num_objects; i++) {
+      GLuint name;
+      if (w->scattered) {
+         do {
+            name = (next_rand(&seed) << 8) | 1;
+         } while (ops->lookup(table, name));
+      }
+      else {
+         name = ops->gen(table);
+      }
+      ops->insert(table, name, objects);
+      names[i] = name;
+   }
+
+   *found = 0;
+   start = get_time();
+
+   if (w->churn) {
+      /* like a streaming app: every 16 binds, one object is deleted and a
+       * new one is generated in its place
+       */
+      for (i = 0; i < NUM_BINDS; i++) {
+         unsigned slot = next_rand(&seed) % w->num_objects;
+         if (ops->lookup(table, names[slot]))
+            (*found)++;
+         if ((i & 15) == 0) {
+            ops->remove(table, names[slot]);
+            names[slot] = ops->gen(table);
+            ops->insert(table, names[slot], objects);
+         }
+      }
+   }
+   else {
+      pthread_t threads[16];
+      struct thread_args args[16];
+
+      assert(w->num_threads <= 16);
+      for (t = 0; t < w->num_threads; t++) {
+         args[t].ops = ops;
+         args[t].table = table;
+         args[t].names = names;
+         args[t].num_names = w->num_objects;
+         args[t].seed = t + 1;
+         args[t].binds = NUM_BINDS / w->num_threads;
+         args[t].found = 0;
+      }
+      if (w->num_threads == 1) {
+         bind_thread(&args[0]);
+      }
+      else {
+         for (t = 0; t < w->num_threads; t++)
+            pthread_create(&threads[t], NULL, bind_thread, &args[t]);
+         for (t = 0; t < w->num_threads; t++)
+            pthread_join(threads[t], NULL);
+      }
+      for (t = 0; t < w->num_threads; t++)
+         *found += args[t].found;
+   }
+
+   start = get_time() - start;
+
+   ops->destroy(table);
+   free(names);
+   return start;
+}
+
+
+static const struct workload workloads[] = {
+   { "100 objects",           100,    GL_FALSE, GL_FALSE, 1 },
+   { "10k objects",           10000,  GL_FALSE, GL_FALSE, 1 },
+   { "50k objects",           50000,  GL_FALSE, GL_FALSE, 1 },
+   { "10k scattered names",   10000,  GL_TRUE,  GL_FALSE, 1 },
+   { "10k objects, churn",    10000,  GL_FALSE, GL_TRUE,  1 },
+   { "10k objects, 4 threads", 10000, GL_FALSE, GL_FALSE, 4 },
+};
+
+
+int
+main(int argc, char **argv)
+{
+   unsigned i;
+   int ret = 0;
+
+   printf("%u binds per workload\n", NUM_BINDS);
+   printf("%-24s %12s %12s %8s\n", "workload", "chained (s)", "new (s)",
+          "speedup");
+
+   for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+      const struct workload *w = &workloads[i];
+      unsigned long found_old, found_new;
+      double t_old = run(&old_ops, w, &found_old);
+      double t_new = run(&new_ops, w, &found_new);
+
+      printf("%-24s %12.4f %12.4f %7.2fx\n", w->name, t_old, t_new,
+             t_old / t_new);
+
+      if (found_old != found_new) {
+         printf("  MISMATCH: lookups returned different results\n");
+         ret = 1;
+      }
+   }
+
+   return ret;
+}
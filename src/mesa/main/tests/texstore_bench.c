@@ -0,0 +1,198 @@
+/*
+ * Copyright 2026 agent <agent@local>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texstore_bench.c
+ * Throughput of _mesa_texstore() for every pair of common client
+ * format/type and texture format, i.e. the work of a glTexSubImage2D
+ * call once the driver has mapped the texture.  Pairs that go through
+ * the temporary float/ubyte images stand out as the slow rows.
+ *
+ * Usage: texstore_bench [size]   (default 512, images are size x size)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "main/glheader.h"
+#include "main/formats.h"
+#include "main/imports.h"
+#include "main/mtypes.h"
+#include "main/pixel.h"
+#include "main/texstore.h"
+
+
+struct src_format {
+   const char *name;
+   GLenum format, type;
+   GLboolean depth;
+};
+
+static const struct src_format src_formats[] = {
+   { "RGBA/ubyte",           GL_RGBA, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "BGRA/ubyte",           GL_BGRA, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "RGB/ubyte",            GL_RGB, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "BGRA/8888_REV",        GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, GL_FALSE },
+   { "RGB/565",              GL_RGB, GL_UNSIGNED_SHORT_5_6_5, GL_FALSE },
+   { "BGRA/4444_REV",        GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4_REV, GL_FALSE },
+   { "LUMINANCE/ubyte",      GL_LUMINANCE, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "LUMINANCE_ALPHA/ubyte", GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "ALPHA/ubyte",          GL_ALPHA, GL_UNSIGNED_BYTE, GL_FALSE },
+   { "RGBA/half",            GL_RGBA, GL_HALF_FLOAT_ARB, GL_FALSE },
+   { "RGBA/float",           GL_RGBA, GL_FLOAT, GL_FALSE },
+   { "DEPTH_STENCIL/24_8",   GL_DEPTH_STENCIL_EXT, GL_UNSIGNED_INT_24_8_EXT, GL_TRUE },
+   { "DEPTH/uint",           GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, GL_TRUE },
+};
+
+static const gl_format dst_formats[] = {
+   MESA_FORMAT_RGBA8888,
+   MESA_FORMAT_RGBA8888_REV,
+   MESA_FORMAT_ARGB8888,
+   MESA_FORMAT_XRGB8888,
+   MESA_FORMAT_RGB888,
+   MESA_FORMAT_RGB565,
+   MESA_FORMAT_ARGB4444,
+   MESA_FORMAT_RGBA5551,
+   MESA_FORMAT_ARGB1555,
+   MESA_FORMAT_L8,
+   MESA_FORMAT_AL88,
+   MESA_FORMAT_A8,
+   MESA_FORMAT_RGBA_FLOAT16,
+   MESA_FORMAT_RGBA_FLOAT32,
+   MESA_FORMAT_Z24_S8,
+   MESA_FORMAT_S8_Z24,
+};
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/** Minimum time spent on each pair, in seconds. */
+#define MIN_TIME 0.2
+
+
+static double
+get_time(void)
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+
+static GLboolean
+is_depth_format(gl_format format)
+{
+   const GLenum base = _mesa_get_format_base_format(format);
+   return base == GL_DEPTH_COMPONENT || base == GL_DEPTH_STENCIL;
+}
+
+
+/**
+ * Store the image repeatedly for at least MIN_TIME seconds and return
+ * the throughput in megatexels per second, or 0 if the store failed.
+ */
+static double
+run(struct gl_context *ctx, const struct src_format *src, gl_format dst,
+    const struct gl_pixelstore_attrib *packing, const void *srcImage,
+    void *dstImage, GLint size)
+{
+   const GLint dstRowStride = size * _mesa_get_format_bytes(dst);
+   const GLuint zeroImageOffset = 0;
+   unsigned iterations = 0;
+   double start = get_time(), elapsed;
+
+   do {
+      if (!_mesa_texstore(ctx, 2, _mesa_get_format_base_format(dst), dst,
+                          dstImage, 0, 0, 0, dstRowStride, &zeroImageOffset,
+                          size, size, 1, src->format, src->type,
+                          srcImage, packing))
+         return 0.0;
+      iterations++;
+      elapsed = get_time() - start;
+   } while (elapsed < MIN_TIME);
+
+   return (double) size * size * iterations / elapsed * 1e-6;
+}
+
+
+int
+main(int argc, char **argv)
+{
+   struct gl_context *ctx = calloc(1, sizeof(*ctx));
+   struct gl_pixelstore_attrib packing;
+   GLint size = argc > 1 ? atoi(argv[1]) : 512;
+   GLubyte *srcImage, *dstImage;
+   unsigned i, j;
+
+   if (size <= 0 || size > MAX_WIDTH) {
+      fprintf(stderr, "size must be between 1 and %d\n", MAX_WIDTH);
+      return 1;
+   }
+
+   _mesa_init_pixel(ctx);
+
+   memset(&packing, 0, sizeof(packing));
+   packing.Alignment = 1;
+
+   /* room for the largest texel on both sides */
+   srcImage = malloc(size * size * 16);
+   dstImage = malloc(size * size * 16);
+   for (i = 0; i < (unsigned) size * size * 16; i++)
+      srcImage[i] = (GLubyte) (i * 7 + (i >> 9));
+
+   printf("%dx%d images, Mtexels/s\n", size, size);
+   printf("%-22s %-22s %10s\n", "source", "texture", "rate");
+
+   for (i = 0; i < ARRAY_LEN(src_formats); i++) {
+      const struct src_format *src = &src_formats[i];
+
+      if (src->type == GL_FLOAT) {
+         GLfloat *f = (GLfloat *) srcImage;
+         for (j = 0; j < (unsigned) size * size * 4; j++)
+            f[j] = (j % 257) / 256.0f;
+      }
+      else if (src->type == GL_HALF_FLOAT_ARB) {
+         GLhalfARB *h = (GLhalfARB *) srcImage;
+         for (j = 0; j < (unsigned) size * size * 4; j++)
+            h[j] = _mesa_float_to_half((j % 257) / 256.0f);
+      }
+
+      for (j = 0; j < ARRAY_LEN(dst_formats); j++) {
+         const gl_format dst = dst_formats[j];
+         double rate;
+
+         if (src->depth != is_depth_format(dst))
+            continue;
+
+         rate = run(ctx, src, dst, &packing, srcImage, dstImage, size);
+         printf("%-22s %-22s %10.1f\n", src->name, _mesa_get_format_name(dst),
+                rate);
+      }
+   }
+
+   free(srcImage);
+   free(dstImage);
+   free(ctx);
+   return 0;
+}
@@ -73,6 +73,10 @@
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 enum {
    ZERO = 4, 
@@ -660,6 +664,47 @@ _mesa_make_temp_ubyte_image(struct gl_context *ctx, GLuint dims,
 }
 
 
+/**
+ * Swizzle 4-byte pixels when every destination component comes from the
+ * source pixel (no ZERO/ONE).  This is the RGBA <-> BGRA case of texture
+ * streaming, so the red/blue swap gets an SSE2 loop.
+ */
+static void
+swizzle_copy_4to4(GLubyte *dst, const GLubyte *src, const GLubyte *map,
+                  GLuint count)
+{
+   GLuint i = 0;
+
+   if (map[0] == 0 && map[1] == 1 && map[2] == 2 && map[3] == 3) {
+      memcpy(dst, src, count * 4);
+      return;
+   }
+
+#ifdef __SSE2__
+   if (map[0] == 2 && map[1] == 1 && map[2] == 0 && map[3] == 3) {
+      const __m128i gaMask = _mm_set1_epi32(0xff00ff00);
+      for (; i + 4 <= count; i += 4) {
+         const __m128i p = _mm_loadu_si128((const __m128i *) (src + i * 4));
+         const __m128i rb = _mm_andnot_si128(gaMask, p);
+         const __m128i res = _mm_or_si128(_mm_and_si128(p, gaMask),
+                                          _mm_or_si128(_mm_slli_epi32(rb, 16),
+                                                       _mm_srli_epi32(rb, 16)));
+         _mm_storeu_si128((__m128i *) (dst + i * 4), res);
+      }
+   }
+#endif
+
+   for (; i < count; i++) {
+      const GLubyte *s = src + i * 4;
+      GLubyte *d = dst + i * 4;
+      d[0] = s[map[0]];
+      d[1] = s[map[1]];
+      d[2] = s[map[2]];
+      d[3] = s[map[3]];
+   }
+}
+
+
 /**
  * Copy GLubyte pixels from <src> to <dst> with swizzling.
  * \param dst  destination pixels
@@ -704,6 +749,12 @@ swizzle_copy(GLubyte *dst, GLuint dstComponents, const GLubyte *src,
    ASSERT(srcComponents <= 4);
    ASSERT(dstComponents <= 4);
 
+   if (srcComponents == 4 && dstComponents == 4 &&
+       map[0] < 4 && map[1] < 4 && map[2] < 4 && map[3] < 4) {
+      swizzle_copy_4to4(dst, src, map, count);
+      return;
+   }
+
    switch (dstComponents) {
    case 4:
       switch (srcComponents) {
@@ -1170,6 +1221,120 @@ _mesa_texstore_z16(TEXSTORE_PARAMS)
 }
 
 
+/**
+ * Row function of the direct GLubyte -> 16-bit texel paths.  \p idx gives
+ * the byte offsets of R, G, B and A in the \p srcComps byte source pixels;
+ * an A offset of ONE means the result is opaque.
+ */
+typedef void (*pack_ubyte_row_func)(GLushort *dst, const GLubyte *src,
+                                    GLuint srcComps, const GLubyte *idx,
+                                    GLint n);
+
+#define PACK_UBYTE_ROW(NAME, EXPR)                                      \
+static void                                                             \
+NAME(GLushort *dst, const GLubyte *src, GLuint srcComps,                \
+     const GLubyte *idx, GLint n)                                       \
+{                                                                       \
+   const GLuint r = idx[0], g = idx[1], b = idx[2], a = idx[3];         \
+   GLint i;                                                             \
+   if (a == ONE) {                                                      \
+      for (i = 0; i < n; i++, src += srcComps) {                        \
+         const GLubyte R = src[r], G = src[g], B = src[b], A = 0xff;    \
+         (void) A;                                                      \
+         dst[i] = EXPR;                                                 \
+      }                                                                 \
+   }                                                                    \
+   else {                                                               \
+      for (i = 0; i < n; i++, src += srcComps) {                        \
+         const GLubyte R = src[r], G = src[g], B = src[b], A = src[a];  \
+         (void) A;                                                      \
+         dst[i] = EXPR;                                                 \
+      }                                                                 \
+   }                                                                    \
+}
+
+PACK_UBYTE_ROW(pack_ubyte_row_565, PACK_COLOR_565(R, G, B))
+PACK_UBYTE_ROW(pack_ubyte_row_565_rev, PACK_COLOR_565_REV(R, G, B))
+PACK_UBYTE_ROW(pack_ubyte_row_4444, PACK_COLOR_4444(A, R, G, B))
+PACK_UBYTE_ROW(pack_ubyte_row_4444_rev, PACK_COLOR_4444_REV(A, R, G, B))
+PACK_UBYTE_ROW(pack_ubyte_row_5551, PACK_COLOR_5551(R, G, B, A))
+PACK_UBYTE_ROW(pack_ubyte_row_1555, PACK_COLOR_1555(A, R, G, B))
+PACK_UBYTE_ROW(pack_ubyte_row_1555_rev, PACK_COLOR_1555_REV(A, R, G, B))
+
+#undef PACK_UBYTE_ROW
+
+
+/**
+ * Return GL_TRUE if store_ubyte_packed16() can store the source image,
+ * i.e. it is plain RGB(A)/BGR(A) bytes going into an RGB(A) texture.
+ */
+static GLboolean
+can_store_ubyte_packed16(const struct gl_context *ctx,
+                         GLenum baseInternalFormat,
+                         GLenum srcFormat, GLenum srcType)
+{
+   if (ctx->_ImageTransferState || srcType != GL_UNSIGNED_BYTE)
+      return GL_FALSE;
+   if (baseInternalFormat != GL_RGBA && baseInternalFormat != GL_RGB)
+      return GL_FALSE;
+   return (srcFormat == GL_RGBA || srcFormat == GL_BGRA ||
+           srcFormat == GL_RGB || srcFormat == GL_BGR);
+}
+
+
+/**
+ * Store GLubyte RGB(A)/BGR(A) data in a 16-bit/texel format by packing
+ * straight from the client image, instead of going through
+ * _mesa_make_temp_ubyte_image().
+ */
+static void
+store_ubyte_packed16(GLuint dimensions,
+                     GLenum baseInternalFormat,
+                     pack_ubyte_row_func pack,
+                     GLvoid *dstAddr,
+                     GLint dstXoffset, GLint dstYoffset, GLint dstZoffset,
+                     GLint dstRowStride,
+                     const GLuint *dstImageOffsets,
+                     GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                     GLenum srcFormat, GLenum srcType,
+                     const GLvoid *srcAddr,
+                     const struct gl_pixelstore_attrib *srcPacking)
+{
+   const GLuint srcComps = _mesa_components_in_format(srcFormat);
+   const GLint srcRowStride =
+      _mesa_image_row_stride(srcPacking, srcWidth, srcFormat, srcType);
+   GLubyte idx[4];
+   GLint img, row;
+
+   if (srcFormat == GL_RGBA || srcFormat == GL_RGB) {
+      idx[0] = 0;
+      idx[2] = 2;
+   }
+   else {
+      idx[0] = 2;
+      idx[2] = 0;
+   }
+   idx[1] = 1;
+   idx[3] = (srcComps == 4 && baseInternalFormat == GL_RGBA) ? 3 : ONE;
+
+   for (img = 0; img < srcDepth; img++) {
+      const GLubyte *src = (const GLubyte *)
+         _mesa_image_address(dimensions, srcPacking, srcAddr,
+                             srcWidth, srcHeight, srcFormat, srcType,
+                             img, 0, 0);
+      GLubyte *dstRow = (GLubyte *) dstAddr
+         + dstImageOffsets[dstZoffset + img] * 2
+         + dstYoffset * dstRowStride
+         + dstXoffset * 2;
+      for (row = 0; row < srcHeight; row++) {
+         pack((GLushort *) dstRow, src, srcComps, idx, srcWidth);
+         src += srcRowStride;
+         dstRow += dstRowStride;
+      }
+   }
+}
+
+
 /**
  * Store an rgb565 or rgb565_rev texture image.
  */
@@ -1197,41 +1362,15 @@ _mesa_texstore_rgb565(TEXSTORE_PARAMS)
                      srcWidth, srcHeight, srcDepth, srcFormat, srcType,
                      srcAddr, srcPacking);
    }
-   else if (!ctx->_ImageTransferState &&
-            !srcPacking->SwapBytes &&
-            baseInternalFormat == GL_RGB &&
-            srcFormat == GL_RGB &&
-            srcType == GL_UNSIGNED_BYTE &&
-            dims == 2) {
-      /* do optimized tex store */
-      const GLint srcRowStride =
-         _mesa_image_row_stride(srcPacking, srcWidth, srcFormat, srcType);
-      const GLubyte *src = (const GLubyte *)
-         _mesa_image_address(dims, srcPacking, srcAddr, srcWidth, srcHeight,
-                             srcFormat, srcType, 0, 0, 0);
-      GLubyte *dst = (GLubyte *) dstAddr
-                   + dstYoffset * dstRowStride
-                   + dstXoffset * texelBytes;
-      GLint row, col;
-      for (row = 0; row < srcHeight; row++) {
-         const GLubyte *srcUB = (const GLubyte *) src;
-         GLushort *dstUS = (GLushort *) dst;
-         /* check for byteswapped format */
-         if (dstFormat == MESA_FORMAT_RGB565) {
-            for (col = 0; col < srcWidth; col++) {
-               dstUS[col] = PACK_COLOR_565( srcUB[0], srcUB[1], srcUB[2] );
-               srcUB += 3;
-            }
-         }
-         else {
-            for (col = 0; col < srcWidth; col++) {
-               dstUS[col] = PACK_COLOR_565_REV( srcUB[0], srcUB[1], srcUB[2] );
-               srcUB += 3;
-            }
-         }
-         dst += dstRowStride;
-         src += srcRowStride;
-      }
+   else if (can_store_ubyte_packed16(ctx, baseInternalFormat,
+                                     srcFormat, srcType)) {
+      store_ubyte_packed16(dims, baseInternalFormat,
+                           dstFormat == MESA_FORMAT_RGB565 ?
+                           pack_ubyte_row_565 : pack_ubyte_row_565_rev,
+                           dstAddr, dstXoffset, dstYoffset, dstZoffset,
+                           dstRowStride, dstImageOffsets,
+                           srcWidth, srcHeight, srcDepth, srcFormat, srcType,
+                           srcAddr, srcPacking);
    }
    else {
       /* general path */
@@ -1871,6 +2010,15 @@ _mesa_texstore_argb4444(TEXSTORE_PARAMS)
                      srcWidth, srcHeight, srcDepth, srcFormat, srcType,
                      srcAddr, srcPacking);
    }
+   else if (can_store_ubyte_packed16(ctx, baseInternalFormat,
+                                     srcFormat, srcType)) {
+      store_ubyte_packed16(dims, baseInternalFormat, dstFormat == MESA_FORMAT_ARGB4444 ?
+                           pack_ubyte_row_4444 : pack_ubyte_row_4444_rev,
+                           dstAddr, dstXoffset, dstYoffset, dstZoffset,
+                           dstRowStride, dstImageOffsets,
+                           srcWidth, srcHeight, srcDepth, srcFormat, srcType,
+                           srcAddr, srcPacking);
+   }
    else {
       /* general path */
       const GLubyte *tempImage = _mesa_make_temp_ubyte_image(ctx, dims,
@@ -1939,6 +2087,14 @@ _mesa_texstore_rgba5551(TEXSTORE_PARAMS)
                      srcWidth, srcHeight, srcDepth, srcFormat, srcType,
                      srcAddr, srcPacking);
    }
+   else if (can_store_ubyte_packed16(ctx, baseInternalFormat,
+                                     srcFormat, srcType)) {
+      store_ubyte_packed16(dims, baseInternalFormat, pack_ubyte_row_5551,
+                           dstAddr, dstXoffset, dstYoffset, dstZoffset,
+                           dstRowStride, dstImageOffsets,
+                           srcWidth, srcHeight, srcDepth, srcFormat, srcType,
+                           srcAddr, srcPacking);
+   }
    else {
       /* general path */
       const GLubyte *tempImage = _mesa_make_temp_ubyte_image(ctx, dims,
@@ -1997,6 +2153,15 @@ _mesa_texstore_argb1555(TEXSTORE_PARAMS)
                      srcWidth, srcHeight, srcDepth, srcFormat, srcType,
                      srcAddr, srcPacking);
    }
+   else if (can_store_ubyte_packed16(ctx, baseInternalFormat,
+                                     srcFormat, srcType)) {
+      store_ubyte_packed16(dims, baseInternalFormat, dstFormat == MESA_FORMAT_ARGB1555 ?
+                           pack_ubyte_row_1555 : pack_ubyte_row_1555_rev,
+                           dstAddr, dstXoffset, dstYoffset, dstZoffset,
+                           dstRowStride, dstImageOffsets,
+                           srcWidth, srcHeight, srcDepth, srcFormat, srcType,
+                           srcAddr, srcPacking);
+   }
    else {
       /* general path */
       const GLubyte *tempImage = _mesa_make_temp_ubyte_image(ctx, dims,
@@ -3355,6 +3520,35 @@ _mesa_texstore_s8_z24(TEXSTORE_PARAMS)
    ASSERT(srcFormat != GL_DEPTH_STENCIL_EXT ||
           srcType == GL_UNSIGNED_INT_24_8_EXT);
 
+   if (srcFormat == GL_DEPTH_STENCIL && ctx->Pixel.DepthScale == 1.0f &&
+       ctx->Pixel.DepthBias == 0.0f &&
+       !srcPacking->SwapBytes) {
+      /* Z24_S8 -> S8_Z24 is a rotate of each texel, like the memcpy
+       * path of _mesa_texstore_z24_s8().
+       */
+      for (img = 0; img < srcDepth; img++) {
+         GLuint *dstRow = (GLuint *) dstAddr
+            + dstImageOffsets[dstZoffset + img]
+            + dstYoffset * dstRowStride / sizeof(GLuint)
+            + dstXoffset;
+         const GLubyte *src
+            = (const GLubyte *) _mesa_image_address(dims, srcPacking, srcAddr,
+                                                   srcWidth, srcHeight,
+                                                   srcFormat, srcType,
+                                                   img, 0, 0);
+         for (row = 0; row < srcHeight; row++) {
+            const GLuint *srcRow = (const GLuint *) src;
+            GLint i;
+            for (i = 0; i < srcWidth; i++) {
+               dstRow[i] = (srcRow[i] >> 8) | (srcRow[i] << 24);
+            }
+            src += srcRowStride;
+            dstRow += dstRowStride / sizeof(GLuint);
+         }
+      }
+      return GL_TRUE;
+   }
+
    for (img = 0; img < srcDepth; img++) {
       GLuint *dstRow = (GLuint *) dstAddr
 	 + dstImageOffsets[dstZoffset + img]
@@ -3593,6 +3787,35 @@ _mesa_texstore_rgba_float16(TEXSTORE_PARAMS)
                      srcWidth, srcHeight, srcDepth, srcFormat, srcType,
                      srcAddr, srcPacking);
    }
+   else if (!ctx->_ImageTransferState &&
+            !srcPacking->SwapBytes &&
+            baseInternalFormat == srcFormat &&
+            baseInternalFormat == baseFormat &&
+            srcType == GL_FLOAT) {
+      /* same components, just convert each float, no temporary image */
+      const GLint srcRowStride =
+         _mesa_image_row_stride(srcPacking, srcWidth, srcFormat, srcType);
+      GLint img, row, i;
+      for (img = 0; img < srcDepth; img++) {
+         const GLubyte *srcRow = (const GLubyte *)
+            _mesa_image_address(dims, srcPacking, srcAddr,
+                                srcWidth, srcHeight, srcFormat, srcType,
+                                img, 0, 0);
+         GLubyte *dstRow = (GLubyte *) dstAddr
+            + dstImageOffsets[dstZoffset + img] * texelBytes
+            + dstYoffset * dstRowStride
+            + dstXoffset * texelBytes;
+         for (row = 0; row < srcHeight; row++) {
+            const GLfloat *src = (const GLfloat *) srcRow;
+            GLhalfARB *dstTexel = (GLhalfARB *) dstRow;
+            for (i = 0; i < srcWidth * components; i++) {
+               dstTexel[i] = _mesa_float_to_half(src[i]);
+            }
+            srcRow += srcRowStride;
+            dstRow += dstRowStride;
+         }
+      }
+   }
    else {
       /* general path */
       const GLfloat *tempImage = _mesa_make_temp_float_image(ctx, dims,
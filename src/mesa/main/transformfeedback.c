@@ -419,6 +419,9 @@ bind_buffer_range(struct gl_context *ctx, GLuint index,
 
    obj->BufferNames[index] = bufObj->Name;
 
+   /* written by the GPU, see vbo_get_minmax_index() */
+   bufObj->GPUWritten = GL_TRUE;
+
    obj->Offset[index] = offset;
    obj->Size[index] = size;
 }
@@ -29,28 +29,69 @@
  */
 
 #include "main/imports.h"
-#include "main/simple_list.h"
 #include "hash_table.h"
 
-struct node {
-   struct node *next;
-   struct node *prev;
+/**
+ * The table uses open addressing with linear probing.  Each slot caches the
+ * full hash value of its key so that probing rarely needs to call the
+ * compare function.  A \c NULL key marks an empty slot, \c deleted_key a
+ * slot whose entry has been removed.
+ */
+struct hash_entry {
+    unsigned hash;
+    const void *key;
+    void *data;
 };
 
 struct hash_table {
     hash_func_t    hash;
     hash_compare_func_t  compare;
 
-    unsigned num_buckets;
-    struct node buckets[1];
+    unsigned size;      /**< Number of slots, always a power of two. */
+    unsigned entries;   /**< Number of live entries. */
+    unsigned deleted;   /**< Number of slots holding \c deleted_key. */
+    struct hash_entry *table;
 };
 
+static const char deleted_key_value;
+#define deleted_key ((const void *) &deleted_key_value)
 
-struct hash_node {
-    struct node link;
-    const void *key;
-    void *data;
-};
+#define MIN_SIZE 16
+
+
+static void
+hash_table_rehash(struct hash_table *ht, unsigned new_size)
+{
+    struct hash_entry *old_table = ht->table;
+    const unsigned old_size = ht->size;
+    const unsigned mask = new_size - 1;
+    unsigned i;
+
+    ht->table = calloc(new_size, sizeof(*ht->table));
+    if (ht->table == NULL) {
+        ht->table = old_table;
+        return;
+    }
+
+    ht->size = new_size;
+    ht->deleted = 0;
+
+    /* Keys are known to be distinct, so only an empty slot is needed. */
+    for (i = 0; i < old_size; i++) {
+        const struct hash_entry *e = &old_table[i];
+        unsigned j;
+
+        if (e->key == NULL || e->key == deleted_key)
+            continue;
+
+        for (j = e->hash & mask; ht->table[j].key != NULL; j = (j + 1) & mask)
+            ;
+
+        ht->table[j] = *e;
+    }
+
+    free(old_table);
+}
 
 
 struct hash_table *
@@ -58,22 +99,25 @@ hash_table_ctor(unsigned num_buckets, hash_func_t hash,
                 hash_compare_func_t compare)
 {
     struct hash_table *ht;
-    unsigned i;
+    unsigned size = MIN_SIZE;
 
 
-    if (num_buckets < 16) {
-        num_buckets = 16;
+    while (size < num_buckets) {
+        size *= 2;
     }
 
-    ht = malloc(sizeof(*ht) + ((num_buckets - 1) 
-				     * sizeof(ht->buckets[0])));
+    ht = malloc(sizeof(*ht));
     if (ht != NULL) {
         ht->hash = hash;
         ht->compare = compare;
-        ht->num_buckets = num_buckets;
-
-        for (i = 0; i < num_buckets; i++) {
-            make_empty_list(& ht->buckets[i]);
+        ht->size = size;
+        ht->entries = 0;
+        ht->deleted = 0;
+        ht->table = calloc(size, sizeof(*ht->table));
+
+        if (ht->table == NULL) {
+            free(ht);
+            ht = NULL;
         }
     }
 
@@ -84,7 +128,7 @@ hash_table_ctor(unsigned num_buckets, hash_func_t hash,
 void
 hash_table_dtor(struct hash_table *ht)
 {
-   hash_table_clear(ht);
+   free(ht->table);
    free(ht);
 }
 
@@ -92,19 +136,32 @@ hash_table_dtor(struct hash_table *ht)
 void
 hash_table_clear(struct hash_table *ht)
 {
-   struct node *node;
-   struct node *temp;
-   unsigned i;
+   memset(ht->table, 0, ht->size * sizeof(*ht->table));
+   ht->entries = 0;
+   ht->deleted = 0;
+}
+
+
+/**
+ * Return the slot holding \c key, or \c NULL if there is none.
+ */
+static struct hash_entry *
+hash_table_search(struct hash_table *ht, unsigned hash_value,
+                  const void *key)
+{
+    const unsigned mask = ht->size - 1;
+    unsigned i;
 
+    for (i = hash_value & mask; ht->table[i].key != NULL; i = (i + 1) & mask) {
+       struct hash_entry *e = &ht->table[i];
 
-   for (i = 0; i < ht->num_buckets; i++) {
-      foreach_s(node, temp, & ht->buckets[i]) {
-	 remove_from_list(node);
-	 free(node);
-      }
+       if (e->key != deleted_key && e->hash == hash_value
+           && (*ht->compare)(e->key, key) == 0) {
+	  return e;
+       }
+    }
 
-      assert(is_empty_list(& ht->buckets[i]));
-   }
+    return NULL;
 }
 
 
@@ -112,18 +169,9 @@ void *
 hash_table_find(struct hash_table *ht, const void *key)
 {
     const unsigned hash_value = (*ht->hash)(key);
-    const unsigned bucket = hash_value % ht->num_buckets;
-    struct node *node;
-
-    foreach(node, & ht->buckets[bucket]) {
-       struct hash_node *hn = (struct hash_node *) node;
+    struct hash_entry *e = hash_table_search(ht, hash_value, key);
 
-       if ((*ht->compare)(hn->key, key) == 0) {
-	  return hn->data;
-       }
-    }
-
-    return NULL;
+    return e != NULL ? e->data : NULL;
 }
 
 
@@ -131,33 +179,69 @@ void
 hash_table_insert(struct hash_table *ht, void *data, const void *key)
 {
     const unsigned hash_value = (*ht->hash)(key);
-    const unsigned bucket = hash_value % ht->num_buckets;
-    struct hash_node *node;
+    struct hash_entry *free_slot = NULL;
+    unsigned mask;
+    unsigned i;
 
-    node = calloc(1, sizeof(*node));
+    assert(key != NULL);
 
-    node->data = data;
-    node->key = key;
+    /* Keep at least a quarter of the slots empty so that probe sequences
+     * stay short.  If most of the used slots only hold deleted entries,
+     * rehashing at the same size is enough to clean them up.
+     */
+    if ((ht->entries + ht->deleted + 1) * 4 > ht->size * 3) {
+       hash_table_rehash(ht, (ht->entries + 1) * 2 > ht->size
+                         ? ht->size * 2 : ht->size);
+    }
+
+    mask = ht->size - 1;
+    for (i = hash_value & mask; ht->table[i].key != NULL; i = (i + 1) & mask) {
+       struct hash_entry *e = &ht->table[i];
 
-    insert_at_head(& ht->buckets[bucket], & node->link);
+       if (e->key == deleted_key) {
+	  if (free_slot == NULL)
+	     free_slot = e;
+       } else if (e->hash == hash_value && (*ht->compare)(e->key, key) == 0) {
+	  e->key = key;
+	  e->data = data;
+	  return;
+       }
+    }
+
+    if (free_slot != NULL) {
+       ht->deleted--;
+    } else {
+       free_slot = &ht->table[i];
+    }
+
+    free_slot->hash = hash_value;
+    free_slot->key = key;
+    free_slot->data = data;
+    ht->entries++;
 }
 
 void
 hash_table_remove(struct hash_table *ht, const void *key)
 {
     const unsigned hash_value = (*ht->hash)(key);
-    const unsigned bucket = hash_value % ht->num_buckets;
-    struct node *node;
-
-    foreach(node, & ht->buckets[bucket]) {
-       struct hash_node *hn = (struct hash_node *) node;
-
-       if ((*ht->compare)(hn->key, key) == 0) {
-	  remove_from_list(node);
-	  free(node);
-	  return;
-       }
+    struct hash_entry *e = hash_table_search(ht, hash_value, key);
+    unsigned next;
+
+    if (e == NULL)
+       return;
+
+    /* If the following slot is empty, no probe sequence continues past this
+     * one and it can be emptied too.  Otherwise leave a deleted marker.
+     */
+    next = ((e - ht->table) + 1) & (ht->size - 1);
+    if (ht->table[next].key == NULL) {
+       e->key = NULL;
+    } else {
+       e->key = deleted_key;
+       ht->deleted++;
     }
+    e->data = NULL;
+    ht->entries--;
 }
 
 void
@@ -167,15 +251,13 @@ hash_table_call_foreach(struct hash_table *ht,
 					 void *closure),
 			void *closure)
 {
-   int bucket;
+   unsigned i;
 
-   for (bucket = 0; bucket < ht->num_buckets; bucket++) {
-      struct node *node, *temp;
-      foreach_s(node, temp, &ht->buckets[bucket]) {
-	 struct hash_node *hn = (struct hash_node *) node;
+   for (i = 0; i < ht->size; i++) {
+      struct hash_entry *e = &ht->table[i];
 
-	 callback(hn->key, hn->data, closure);
-      }
+      if (e->key != NULL && e->key != deleted_key)
+	 callback(e->key, e->data, closure);
    }
 }
 
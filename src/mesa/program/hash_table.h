@@ -43,11 +43,13 @@ extern "C" {
 /**
  * Hash table constructor
  *
- * Creates a hash table with the specified number of buckets.  The supplied
- * \c hash and \c compare routines are used when adding elements to the table
- * and when searching for elements in the table.
+ * Creates an open-addressing hash table with room for at least the specified
+ * number of entries.  The table grows automatically as entries are added, so
+ * this is only a hint.  The supplied \c hash and \c compare routines are
+ * used when adding elements to the table and when searching for elements in
+ * the table.
  *
- * \param num_buckets  Number of buckets (bins) in the hash table.
+ * \param num_buckets  Initial number of slots in the hash table.
  * \param hash         Function used to compute hash value of input keys.
  * \param compare      Function used to compare keys.
  */
@@ -88,6 +90,9 @@ extern void *hash_table_find(struct hash_table *ht, const void *key);
 
 /**
  * Add an element to a hash table
+ *
+ * If an element with a matching key is already in the table, its data is
+ * replaced.  \c key must not be \c NULL.
  */
 extern void hash_table_insert(struct hash_table *ht, void *data,
     const void *key);
@@ -2371,7 +2371,7 @@ ir_to_mesa_visitor::ir_to_mesa_visitor()
    next_temp = 1;
    next_signature_id = 1;
    current_function = NULL;
-   mem_ctx = ralloc_context(NULL);
+   mem_ctx = ralloc_arena_context(NULL);
 }
 
 ir_to_mesa_visitor::~ir_to_mesa_visitor()
@@ -3337,8 +3337,12 @@ _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
 void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader)
 {
+   /* The AST and all intermediate IR come out of an arena that is thrown
+    * away in bulk once the live IR has been copied out of it.
+    */
+   void *arena = ralloc_arena_context(shader);
    struct _mesa_glsl_parse_state *state =
-      new(shader) _mesa_glsl_parse_state(ctx, shader->Type, shader);
+      new(arena) _mesa_glsl_parse_state(ctx, shader->Type, shader);
 
    const char *source = shader->Source;
    /* Check if the user called glCompileShader without first calling
@@ -3346,6 +3350,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader)
     */
    if (source == NULL) {
       shader->CompileStatus = GL_FALSE;
+      ralloc_free(arena);
       return;
    }
 
@@ -3409,17 +3414,20 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader)
    }
 
    /* Retain any live IR, but trash the rest. */
-   reparent_ir(shader->ir, shader->ir);
+   _mesa_glsl_copy_ir_from_arena(shader);
 
-   ralloc_free(state);
+   ralloc_free(arena);
 }
 
 
 /**
- * Link a GLSL shader program.  Called via glLinkProgram().
+ * First step of linking: release the program's previous link results.
+ *
+ * This may call into the driver, so it must run on the context's thread.
  */
 void
-_mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
+_mesa_glsl_link_shader_begin(struct gl_context *ctx,
+                             struct gl_shader_program *prog)
 {
    unsigned int i;
 
@@ -3427,21 +3435,70 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
 
    prog->LinkStatus = GL_TRUE;
 
-   for (i = 0; i < prog->NumShaders; i++) {
+   prog->Varying = _mesa_new_parameter_list();
+   _mesa_reference_vertprog(ctx, &prog->VertexProgram, NULL);
+   _mesa_reference_fragprog(ctx, &prog->FragmentProgram, NULL);
+   _mesa_reference_geomprog(ctx, &prog->GeometryProgram, NULL);
+
+   for (i = 0; i < MESA_SHADER_TYPES; i++) {
+      if (prog->_LinkedShaders[i] != NULL)
+	 ctx->Driver.DeleteShader(ctx, prog->_LinkedShaders[i]);
+
+      prog->_LinkedShaders[i] = NULL;
+   }
+}
+
+
+/**
+ * Second step of linking: run the GLSL linker on the program's shaders.
+ *
+ * This only works on GLSL IR and reads the context's constants, without
+ * calling into the driver, so it may run on a shader queue thread.  The
+ * linked shaders are plain gl_shader objects until the last step.
+ */
+void
+_mesa_glsl_link_shader_ir(struct gl_context *ctx,
+                          struct gl_shader_program *prog)
+{
+   for (unsigned i = 0; i < prog->NumShaders; i++) {
       if (!prog->Shaders[i]->CompileStatus) {
 	 linker_error(prog, "linking with uncompiled shader");
 	 prog->LinkStatus = GL_FALSE;
       }
    }
 
-   prog->Varying = _mesa_new_parameter_list();
-   _mesa_reference_vertprog(ctx, &prog->VertexProgram, NULL);
-   _mesa_reference_fragprog(ctx, &prog->FragmentProgram, NULL);
-   _mesa_reference_geomprog(ctx, &prog->GeometryProgram, NULL);
-
    if (prog->LinkStatus) {
       link_shaders(ctx, prog);
    }
+}
+
+
+/**
+ * Last step of linking: hand the linked shaders to the driver.
+ *
+ * Like _mesa_glsl_link_shader_begin(), this must run on the context's thread.
+ */
+void
+_mesa_glsl_link_shader_end(struct gl_context *ctx,
+                           struct gl_shader_program *prog)
+{
+   /* Move the linker's results into the driver's own shader objects. */
+   for (unsigned i = 0; i < MESA_SHADER_TYPES; i++) {
+      struct gl_shader *linked = prog->_LinkedShaders[i];
+      struct gl_shader *sh;
+
+      if (linked == NULL)
+	 continue;
+
+      sh = ctx->Driver.NewShader(ctx, 0, linked->Type);
+      sh->ir = linked->ir;
+      sh->symbols = linked->symbols;
+      ralloc_steal(sh, sh->ir);
+      ralloc_steal(sh, sh->symbols);
+      ralloc_free(linked);
+
+      prog->_LinkedShaders[i] = sh;
+   }
 
    if (prog->LinkStatus) {
       if (!ctx->Driver.LinkShader(ctx, prog)) {
@@ -3463,4 +3520,16 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
    }
 }
 
+
+/**
+ * Link a GLSL shader program.  Called via glLinkProgram().
+ */
+void
+_mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
+{
+   _mesa_glsl_link_shader_begin(ctx, prog);
+   _mesa_glsl_link_shader_ir(ctx, prog);
+   _mesa_glsl_link_shader_end(ctx, prog);
+}
+
 } /* extern "C" */
@@ -19,6 +19,7 @@ MAIN_SOURCES = \
 	main/blend.c \
 	main/bufferobj.c \
 	main/buffers.c \
+	main/callprof.c \
 	main/clear.c \
 	main/clip.c \
 	main/colortab.c \
@@ -47,12 +48,14 @@ MAIN_SOURCES = \
 	main/framebuffer.c \
 	main/get.c \
 	main/getstring.c \
+	main/glthread.c \
 	main/hash.c \
 	main/hint.c \
 	main/histogram.c \
 	main/image.c \
 	main/imports.c \
 	main/light.c \
+	main/marshal_generated.c \
 	main/lines.c \
 	main/matrix.c \
 	main/mipmap.c \
@@ -76,6 +79,7 @@ MAIN_SOURCES = \
 	main/scissor.c \
 	main/shaderapi.c \
 	main/shaderobj.c \
+	main/shaderqueue.c \
 	main/shared.c \
 	main/state.c \
 	main/stencil.c \
@@ -28,6 +28,7 @@
 
 #include "main/glheader.h"
 #include "main/context.h"
+#include "main/callprof.h"
 
 #include "pipe/p_defines.h"
 #include "st_context.h"
@@ -127,7 +128,7 @@ static void check_program_state( struct st_context *st )
  * Update all derived state:
  */
 
-void st_validate_state( struct st_context *st )
+static void validate_state( struct st_context *st )
 {
    struct st_state_flags *state = &st->dirty;
    GLuint i;
@@ -202,4 +203,14 @@ void st_validate_state( struct st_context *st )
 }
 
 
+void st_validate_state( struct st_context *st )
+{
+   const GLuint64 start = _mesa_call_profile_begin(st->ctx);
+
+   validate_state(st);
+
+   _mesa_call_profile_end(st->ctx, MESA_PROF_DRIVER_VALIDATE, start);
+}
+
+
 
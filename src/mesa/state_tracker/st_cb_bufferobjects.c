@@ -77,6 +77,8 @@ st_bufferobj_free(struct gl_context *ctx, struct gl_buffer_object *obj)
    assert(obj->RefCount == 0);
    assert(st_obj->transfer == NULL);
 
+   st_discard_pbo_readback(st_obj);
+
    if (st_obj->buffer) 
       pipe_resource_reference(&st_obj->buffer, NULL);
 
@@ -115,6 +117,8 @@ st_bufferobj_subdata(struct gl_context *ctx,
    if (!data)
       return;
 
+   st_bufferobj_sync_readback(ctx, st_obj);
+
    /* Now that transfers are per-context, we don't have to figure out
     * flushing here.  Usually drivers won't need to flush in this case
     * even if the buffer is currently referenced by hardware - they
@@ -146,6 +150,8 @@ st_bufferobj_get_subdata(struct gl_context *ctx,
    if (!size)
       return;
 
+   st_bufferobj_sync_readback(ctx, st_obj);
+
    pipe_buffer_read(st_context(ctx)->pipe, st_obj->buffer,
                     offset, size, data);
 }
@@ -173,6 +179,9 @@ st_bufferobj_data(struct gl_context *ctx,
 
    st_obj->Base.Size = size;
    st_obj->Base.Usage = usage;
+
+   /* the old contents are gone, including any pending glReadPixels */
+   st_discard_pbo_readback(st_obj);
    
    switch(target) {
    case GL_PIXEL_PACK_BUFFER_ARB:
@@ -273,6 +282,11 @@ st_bufferobj_map_range(struct gl_context *ctx,
    assert(offset < obj->Size);
    assert(offset + length <= obj->Size);
 
+   if (!(flags & PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE))
+      st_bufferobj_sync_readback(ctx, st_obj);
+   else
+      st_discard_pbo_readback(st_obj);
+
    obj->Pointer = pipe_buffer_map_range(pipe,
                                         st_obj->buffer,
                                         offset, length,
@@ -356,6 +370,9 @@ st_copy_buffer_subdata(struct gl_context *ctx,
    assert(!src->Pointer);
    assert(!dst->Pointer);
 
+   st_bufferobj_sync_readback(ctx, srcObj);
+   st_bufferobj_sync_readback(ctx, dstObj);
+
    u_box_1d(readOffset, size, &box);
 
    pipe->resource_copy_region(pipe, dstObj->buffer, 0, writeOffset, 0, 0,
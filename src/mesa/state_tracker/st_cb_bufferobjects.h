@@ -34,6 +34,7 @@
 struct dd_function_table;
 struct pipe_resource;
 struct st_context;
+struct st_pbo_readback;
 
 /**
  * State_tracker vertex/pixel buffer object, derived from Mesa's
@@ -44,6 +45,7 @@ struct st_buffer_object
    struct gl_buffer_object Base;
    struct pipe_resource *buffer;     /* GPU storage */
    struct pipe_transfer *transfer; /* In-progress map information */
+   struct st_pbo_readback *readback; /**< glReadPixels not yet stored */
 };
 
 
@@ -55,6 +57,26 @@ st_buffer_object(struct gl_buffer_object *obj)
 }
 
 
+extern void
+st_finish_pbo_readback(struct gl_context *ctx, struct st_buffer_object *obj);
+
+extern void
+st_discard_pbo_readback(struct st_buffer_object *obj);
+
+
+/**
+ * Store any pending glReadPixels result in the buffer before its contents
+ * are used.
+ */
+static INLINE void
+st_bufferobj_sync_readback(struct gl_context *ctx,
+                           struct st_buffer_object *obj)
+{
+   if (obj->readback)
+      st_finish_pbo_readback(ctx, obj);
+}
+
+
 extern void
 st_bufferobj_validate_usage(struct st_context *st,
 			    struct st_buffer_object *obj,
@@ -42,6 +42,7 @@
 
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
+#include "util/u_box.h"
 #include "util/u_format.h"
 #include "util/u_inlines.h"
 #include "util/u_tile.h"
@@ -50,9 +51,28 @@
 #include "st_context.h"
 #include "st_atom.h"
 #include "st_cb_bitmap.h"
+#include "st_cb_bufferobjects.h"
+#include "st_cb_flush.h"
 #include "st_cb_readpixels.h"
 #include "st_cb_fbo.h"
 
+
+/**
+ * A glReadPixels into a pixel pack buffer that hasn't been stored yet.
+ * The framebuffer region was copied to \c staging on the GPU; it is
+ * converted into the buffer object when the buffer is next used (see
+ * st_bufferobj_sync_readback()).
+ */
+struct st_pbo_readback
+{
+   struct pipe_resource *staging;
+   GLsizei width, height;
+   GLenum format, type;
+   struct gl_pixelstore_attrib packing;
+   const GLvoid *dest;        /**< offset into the buffer object */
+   GLboolean invert;          /**< staging rows are bottom to top */
+};
+
 /**
  * Special case for reading stencil buffer.
  * For color/depth we use get_tile().  For stencil, map the stencil buffer.
@@ -206,6 +226,261 @@ st_get_color_read_renderbuffer(struct gl_context *ctx)
 }
 
 
+/**
+ * Return GL_TRUE if pack_rows_ubyte() can convert images of the given
+ * renderbuffer format to format/type: the color channels have 8 bits or
+ * less, so no precision is lost by not going through float.
+ */
+static GLboolean
+can_pack_ubyte(enum pipe_format pformat, GLenum format, GLenum type,
+               const struct gl_pixelstore_attrib *pack,
+               GLbitfield transferOps)
+{
+   const struct util_format_description *desc =
+      util_format_description(pformat);
+
+   /* clamping is a no-op for normalized formats */
+   if (transferOps & ~IMAGE_CLAMP_BIT)
+      return GL_FALSE;
+
+   if (!desc ||
+       desc->colorspace == UTIL_FORMAT_COLORSPACE_ZS ||
+       !desc->unpack_rgba_8unorm ||
+       !util_format_fits_8unorm(desc))
+      return GL_FALSE;
+
+   switch (type) {
+   case GL_UNSIGNED_BYTE:
+      return (format == GL_RGBA || format == GL_BGRA ||
+              format == GL_RGB || format == GL_BGR);
+   case GL_UNSIGNED_INT_8_8_8_8:
+   case GL_UNSIGNED_INT_8_8_8_8_REV:
+      return (format == GL_RGBA || format == GL_BGRA) && !pack->SwapBytes;
+   default:
+      return GL_FALSE;
+   }
+}
+
+
+/**
+ * Convert rows of a renderbuffer image to GLubyte-based format/type,
+ * one row of \p srcStride bytes (negative to flip the image) after the
+ * other, via the format's unpack_rgba_8unorm function.
+ */
+static void
+pack_rows_ubyte(enum pipe_format pformat,
+                const GLubyte *src, GLint srcStride,
+                GLsizei width, GLsizei height,
+                GLenum format, GLenum type,
+                GLubyte *dst, GLint dstStride)
+{
+   const struct util_format_description *desc =
+      util_format_description(pformat);
+   const GLboolean bgr = (format == GL_BGRA || format == GL_BGR);
+   const GLuint c0 = bgr ? 2 : 0, c2 = bgr ? 0 : 2;
+   GLubyte rgba[MAX_WIDTH][4];
+   GLint row, col;
+
+   assert(width <= MAX_WIDTH);
+
+   for (row = 0; row < height; row++) {
+      if (format == GL_RGBA && type == GL_UNSIGNED_BYTE) {
+         desc->unpack_rgba_8unorm(dst, 0, src, 0, width, 1);
+      }
+      else {
+         desc->unpack_rgba_8unorm(&rgba[0][0], 0, src, 0, width, 1);
+
+         if (type == GL_UNSIGNED_INT_8_8_8_8_REV) {
+            GLuint *dst4 = (GLuint *) dst;
+            for (col = 0; col < width; col++) {
+               dst4[col] = (rgba[col][c0] | rgba[col][1] << 8 |
+                            rgba[col][c2] << 16 | (GLuint) rgba[col][3] << 24);
+            }
+         }
+         else if (type == GL_UNSIGNED_INT_8_8_8_8) {
+            GLuint *dst4 = (GLuint *) dst;
+            for (col = 0; col < width; col++) {
+               dst4[col] = ((GLuint) rgba[col][c0] << 24 | rgba[col][1] << 16 |
+                            rgba[col][c2] << 8 | rgba[col][3]);
+            }
+         }
+         else if (format == GL_BGRA) {
+            for (col = 0; col < width; col++) {
+               dst[col * 4 + 0] = rgba[col][2];
+               dst[col * 4 + 1] = rgba[col][1];
+               dst[col * 4 + 2] = rgba[col][0];
+               dst[col * 4 + 3] = rgba[col][3];
+            }
+         }
+         else {
+            /* GL_RGB, GL_BGR */
+            for (col = 0; col < width; col++) {
+               dst[col * 3 + 0] = rgba[col][c0];
+               dst[col * 3 + 1] = rgba[col][1];
+               dst[col * 3 + 2] = rgba[col][c2];
+            }
+         }
+      }
+      src += srcStride;
+      dst += dstStride;
+   }
+}
+
+
+/**
+ * Store a pending PBO readback in its buffer object.  This waits for the
+ * copy made by st_readpixels_to_pbo().
+ */
+void
+st_finish_pbo_readback(struct gl_context *ctx, struct st_buffer_object *obj)
+{
+   struct pipe_context *pipe = st_context(ctx)->pipe;
+   struct st_pbo_readback *rb = obj->readback;
+   struct pipe_transfer *src_trans, *dst_trans;
+   const GLubyte *map;
+   GLubyte *buf;
+
+   if (!rb)
+      return;
+   obj->readback = NULL;
+
+   src_trans = pipe_get_transfer(pipe, rb->staging, 0, 0,
+                                 PIPE_TRANSFER_READ,
+                                 0, 0, rb->width, rb->height);
+   map = src_trans ? pipe_transfer_map(pipe, src_trans) : NULL;
+   buf = map ? pipe_buffer_map(pipe, obj->buffer, PIPE_TRANSFER_WRITE,
+                               &dst_trans) : NULL;
+
+   if (buf) {
+      GLubyte *dst = _mesa_image_address2d(&rb->packing,
+                                           ADD_POINTERS(buf, rb->dest),
+                                           rb->width, rb->height,
+                                           rb->format, rb->type, 0, 0);
+      const GLint dstStride = _mesa_image_row_stride(&rb->packing, rb->width,
+                                                     rb->format, rb->type);
+      GLint srcStride = src_trans->stride;
+
+      if (rb->invert) {
+         map += (rb->height - 1) * srcStride;
+         srcStride = -srcStride;
+      }
+
+      /* like the synchronous path, return the raw sRGB values */
+      pack_rows_ubyte(util_format_linear(rb->staging->format),
+                      map, srcStride, rb->width, rb->height,
+                      rb->format, rb->type, dst, dstStride);
+
+      pipe_buffer_unmap(pipe, dst_trans);
+   }
+   else {
+      _mesa_error(ctx, GL_OUT_OF_MEMORY, "glReadPixels");
+   }
+
+   if (map)
+      pipe_transfer_unmap(pipe, src_trans);
+   if (src_trans)
+      pipe->transfer_destroy(pipe, src_trans);
+
+   pipe_resource_reference(&rb->staging, NULL);
+   free(rb);
+}
+
+
+/**
+ * Forget a pending PBO readback, e.g. because the buffer is deleted or
+ * given new storage.
+ */
+void
+st_discard_pbo_readback(struct st_buffer_object *obj)
+{
+   struct st_pbo_readback *rb = obj->readback;
+
+   if (rb) {
+      obj->readback = NULL;
+      pipe_resource_reference(&rb->staging, NULL);
+      free(rb);
+   }
+}
+
+
+/**
+ * glReadPixels into a pixel pack buffer without waiting for rendering:
+ * copy the region to a staging texture on the GPU and leave the
+ * conversion into the buffer for later.
+ * \return GL_TRUE for success, GL_FALSE if the normal path must be used
+ */
+static GLboolean
+st_readpixels_to_pbo(struct gl_context *ctx, struct st_renderbuffer *strb,
+                     GLint x, GLint y, GLsizei width, GLsizei height,
+                     GLenum format, GLenum type,
+                     const struct gl_pixelstore_attrib *pack,
+                     const GLvoid *dest)
+{
+   struct st_context *st = st_context(ctx);
+   struct pipe_context *pipe = st->pipe;
+   struct pipe_screen *screen = pipe->screen;
+   struct st_buffer_object *stobj = st_buffer_object(pack->BufferObj);
+   struct pipe_resource templ, *staging;
+   struct st_pbo_readback *rb;
+   struct pipe_box box;
+
+   if (!stobj->buffer ||
+       strb->texture->nr_samples > 1 ||
+       width > MAX_WIDTH ||
+       !can_pack_ubyte(util_format_linear(strb->texture->format),
+                       format, type, pack, ctx->_ImageTransferState))
+      return GL_FALSE;
+
+   memset(&templ, 0, sizeof(templ));
+   templ.target = PIPE_TEXTURE_2D;
+   templ.format = strb->texture->format;
+   templ.width0 = width;
+   templ.height0 = height;
+   templ.depth0 = 1;
+   templ.array_size = 1;
+   templ.usage = PIPE_USAGE_STAGING;
+
+   staging = screen->resource_create(screen, &templ);
+   if (!staging)
+      return GL_FALSE;
+
+   rb = CALLOC_STRUCT(st_pbo_readback);
+   if (!rb) {
+      pipe_resource_reference(&staging, NULL);
+      return GL_FALSE;
+   }
+
+   if (st_fb_orientation(ctx->ReadBuffer) == Y_0_TOP) {
+      /* convert GL Y to Gallium Y */
+      y = strb->Base.Height - y - height;
+      rb->invert = GL_TRUE;
+   }
+
+   u_box_2d_zslice(x, y, strb->rtt_face + strb->rtt_slice,
+                   width, height, &box);
+   pipe->resource_copy_region(pipe, staging, 0, 0, 0, 0,
+                              strb->texture, strb->rtt_level, &box);
+
+   /* an older readback into this buffer must land before this one */
+   st_bufferobj_sync_readback(ctx, stobj);
+
+   rb->staging = staging;
+   rb->width = width;
+   rb->height = height;
+   rb->format = format;
+   rb->type = type;
+   rb->packing = *pack;
+   rb->packing.BufferObj = NULL;
+   rb->dest = dest;
+   stobj->readback = rb;
+
+   /* get the copy going while the application carries on */
+   st_flush(st, NULL);
+
+   return GL_TRUE;
+}
+
+
 /**
  * Try to do glReadPixels in a fast manner for common cases.
  * \return GL_TRUE for success, GL_FALSE for failure
@@ -404,6 +679,17 @@ st_readpixels(struct gl_context *ctx, GLint x, GLint y, GLsizei width, GLsizei h
 
    st_flush_bitmap_cache(st);
 
+   if (_mesa_is_bufferobj(clippedPacking.BufferObj) &&
+       format != GL_STENCIL_INDEX &&
+       format != GL_DEPTH_STENCIL &&
+       format != GL_DEPTH_COMPONENT) {
+      strb = st_get_color_read_renderbuffer(ctx);
+      if (strb &&
+          st_readpixels_to_pbo(ctx, strb, x, y, width, height,
+                               format, type, &clippedPacking, dest))
+         return;
+   }
+
    dest = _mesa_map_pbo_dest(ctx, &clippedPacking, dest);
    if (!dest)
       return;
@@ -611,6 +897,22 @@ st_readpixels(struct gl_context *ctx, GLint x, GLint y, GLsizei width, GLsizei h
             dst += dstStride;
          }
       }
+      else if (can_pack_ubyte(pformat, format, type, &clippedPacking,
+                              transferOps) &&
+               width <= MAX_WIDTH) {
+         /* channels of 8 bits or less: convert without going via float */
+         const GLubyte *map = pipe_transfer_map(pipe, trans);
+         if (map) {
+            GLint srcStride = trans->stride;
+            if (yStep < 0) {
+               map += (height - 1) * srcStride;
+               srcStride = -srcStride;
+            }
+            pack_rows_ubyte(pformat, map, srcStride, width, height,
+                            format, type, dst, dstStride);
+            pipe_transfer_unmap(pipe, trans);
+         }
+      }
       else {
          /* RGBA format */
          /* Do a row at a time to flip image data vertically */
@@ -377,6 +377,7 @@ setup_interleaved_attribs(struct gl_context *ctx,
 
       if (attr == 0) {
          if (bufobj && _mesa_is_bufferobj(bufobj)) {
+            st_bufferobj_sync_readback(ctx, stobj);
             vbuffer->buffer = NULL;
             pipe_resource_reference(&vbuffer->buffer, stobj->buffer);
             vbuffer->buffer_offset = pointer_to_offset(low_addr);
@@ -450,6 +451,7 @@ setup_non_interleaved_attribs(struct gl_context *ctx,
          struct st_buffer_object *stobj = st_buffer_object(bufobj);
          assert(stobj->buffer);
 
+         st_bufferobj_sync_readback(ctx, stobj);
          vbuffer[attr].buffer = NULL;
          pipe_resource_reference(&vbuffer[attr].buffer, stobj->buffer);
          vbuffer[attr].buffer_offset = pointer_to_offset(array->Ptr);
@@ -536,6 +538,7 @@ setup_index_buffer(struct gl_context *ctx,
       if (bufobj && _mesa_is_bufferobj(bufobj)) {
          /* elements/indexes are in a real VBO */
          struct st_buffer_object *stobj = st_buffer_object(bufobj);
+         st_bufferobj_sync_readback(ctx, stobj);
          pipe_resource_reference(&ibuffer->buffer, stobj->buffer);
          ibuffer->offset = pointer_to_offset(ib->ptr);
       }
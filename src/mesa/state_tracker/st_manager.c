@@ -44,6 +44,7 @@
 #include "main/texstate.h"
 #include "main/framebuffer.h"
 #include "main/fbobject.h"
+#include "main/glthread.h"
 #include "main/renderbuffer.h"
 #include "main/version.h"
 #include "st_texture.h"
@@ -514,6 +515,7 @@ st_context_flush(struct st_context_iface *stctxi, unsigned flags,
                  struct pipe_fence_handle **fence)
 {
    struct st_context *st = (struct st_context *) stctxi;
+   _mesa_glthread_finish(st->ctx);
    st_flush(st, fence);
    if (flags & ST_FLUSH_FRONT)
       st_manager_flush_frontbuffer(st);
@@ -535,6 +537,8 @@ st_context_teximage(struct st_context_iface *stctxi,
    GLenum internalFormat;
    GLuint width, height, depth;
 
+   _mesa_glthread_finish(ctx);
+
    switch (target) {
    case ST_TEXTURE_1D:
       target = GL_TEXTURE_1D;
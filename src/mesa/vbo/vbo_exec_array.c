@@ -28,6 +28,7 @@
 
 #include "main/glheader.h"
 #include "main/context.h"
+#include "main/callprof.h"
 #include "main/state.h"
 #include "main/api_validate.h"
 #include "main/varray.h"
@@ -37,6 +38,10 @@
 
 #include "vbo_context.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 /**
  * All vertex buffers should be in an unmapped state when we're about
@@ -76,11 +81,255 @@ vbo_check_buffers_are_unmapped(struct gl_context *ctx)
 
 
 
+/*
+ * Index scanning.  The restart index, if any, is made neutral before it
+ * enters the min/max computation: OR-ing in the all-ones comparison mask
+ * turns it into the largest value, which can't lower the minimum, and
+ * clearing it with the mask makes it zero, which can't raise the maximum.
+ * The SSE2 versions do the same thing on sixteen bytes at a time; SSE2 has
+ * no unsigned 16 or 32-bit compares, so those values are biased into the
+ * signed range first.
+ */
+
+static void
+minmax_ubyte(const GLubyte *indices, GLuint count,
+             GLboolean restart, GLuint restartIndex,
+             GLuint *min_index, GLuint *max_index)
+{
+   GLuint min_ub = ~0U, max_ub = 0;
+   GLuint i = 0;
+
+   if (restartIndex > 0xff)
+      restart = GL_FALSE;
+
+#ifdef __SSE2__
+   if (count >= 16) {
+      const __m128i rst = _mm_set1_epi8((char) restartIndex);
+      __m128i vmin = _mm_set1_epi8((char) 0xff);
+      __m128i vmax = _mm_setzero_si128();
+      GLubyte tmp[16];
+      GLuint j;
+
+      for (; i + 16 <= count; i += 16) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         if (restart) {
+            __m128i m = _mm_cmpeq_epi8(v, rst);
+            vmin = _mm_min_epu8(vmin, _mm_or_si128(v, m));
+            vmax = _mm_max_epu8(vmax, _mm_andnot_si128(m, v));
+         }
+         else {
+            vmin = _mm_min_epu8(vmin, v);
+            vmax = _mm_max_epu8(vmax, v);
+         }
+      }
+
+      _mm_storeu_si128((__m128i *) tmp, vmin);
+      for (j = 0; j < 16; j++)
+         if (tmp[j] < min_ub) min_ub = tmp[j];
+      _mm_storeu_si128((__m128i *) tmp, vmax);
+      for (j = 0; j < 16; j++)
+         if (tmp[j] > max_ub) max_ub = tmp[j];
+   }
+#endif
+
+   for (; i < count; i++) {
+      if (restart && indices[i] == restartIndex)
+         continue;
+      if (indices[i] > max_ub) max_ub = indices[i];
+      if (indices[i] < min_ub) min_ub = indices[i];
+   }
+
+   /* An all-restart range on the SIMD path leaves 0xff behind as the
+    * minimum, keep the scalar result instead.
+    */
+   if (min_ub > max_ub)
+      min_ub = ~0U;
+
+   *min_index = min_ub;
+   *max_index = max_ub;
+}
+
+
+static void
+minmax_ushort(const GLushort *indices, GLuint count,
+              GLboolean restart, GLuint restartIndex,
+              GLuint *min_index, GLuint *max_index)
+{
+   GLuint min_us = ~0U, max_us = 0;
+   GLuint i = 0;
+
+   if (restartIndex > 0xffff)
+      restart = GL_FALSE;
+
+#ifdef __SSE2__
+   if (count >= 8) {
+      const __m128i bias = _mm_set1_epi16((short) 0x8000);
+      const __m128i rst = _mm_set1_epi16((short) restartIndex);
+      __m128i vmin = _mm_set1_epi16(0x7fff);
+      __m128i vmax = _mm_set1_epi16((short) 0x8000);
+      GLushort tmp[8];
+      GLuint j;
+
+      for (; i + 8 <= count; i += 8) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         __m128i lo = v, hi = v;
+         if (restart) {
+            __m128i m = _mm_cmpeq_epi16(v, rst);
+            lo = _mm_or_si128(v, m);
+            hi = _mm_andnot_si128(m, v);
+         }
+         vmin = _mm_min_epi16(vmin, _mm_xor_si128(lo, bias));
+         vmax = _mm_max_epi16(vmax, _mm_xor_si128(hi, bias));
+      }
+
+      _mm_storeu_si128((__m128i *) tmp, _mm_xor_si128(vmin, bias));
+      for (j = 0; j < 8; j++)
+         if (tmp[j] < min_us) min_us = tmp[j];
+      _mm_storeu_si128((__m128i *) tmp, _mm_xor_si128(vmax, bias));
+      for (j = 0; j < 8; j++)
+         if (tmp[j] > max_us) max_us = tmp[j];
+   }
+#endif
+
+   for (; i < count; i++) {
+      if (restart && indices[i] == restartIndex)
+         continue;
+      if (indices[i] > max_us) max_us = indices[i];
+      if (indices[i] < min_us) min_us = indices[i];
+   }
+
+   if (min_us > max_us)
+      min_us = ~0U;
+
+   *min_index = min_us;
+   *max_index = max_us;
+}
+
+
+static void
+minmax_uint(const GLuint *indices, GLuint count,
+            GLboolean restart, GLuint restartIndex,
+            GLuint *min_index, GLuint *max_index)
+{
+   GLuint min_ui = ~0U, max_ui = 0;
+   GLuint i = 0;
+
+#ifdef __SSE2__
+   if (count >= 4) {
+      const __m128i bias = _mm_set1_epi32((int) 0x80000000);
+      const __m128i rst = _mm_set1_epi32((int) restartIndex);
+      __m128i vmin = _mm_set1_epi32(0x7fffffff);
+      __m128i vmax = _mm_set1_epi32((int) 0x80000000);
+      GLuint tmp[4];
+      GLuint j;
+
+      for (; i + 4 <= count; i += 4) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         __m128i lo = v, hi = v, m;
+         if (restart) {
+            m = _mm_cmpeq_epi32(v, rst);
+            lo = _mm_or_si128(v, m);
+            hi = _mm_andnot_si128(m, v);
+         }
+         lo = _mm_xor_si128(lo, bias);
+         hi = _mm_xor_si128(hi, bias);
+         /* no min/max for 32-bit lanes, select with the compare mask */
+         m = _mm_cmplt_epi32(lo, vmin);
+         vmin = _mm_or_si128(_mm_and_si128(m, lo), _mm_andnot_si128(m, vmin));
+         m = _mm_cmpgt_epi32(hi, vmax);
+         vmax = _mm_or_si128(_mm_and_si128(m, hi), _mm_andnot_si128(m, vmax));
+      }
+
+      _mm_storeu_si128((__m128i *) tmp, _mm_xor_si128(vmin, bias));
+      for (j = 0; j < 4; j++)
+         if (tmp[j] < min_ui) min_ui = tmp[j];
+      _mm_storeu_si128((__m128i *) tmp, _mm_xor_si128(vmax, bias));
+      for (j = 0; j < 4; j++)
+         if (tmp[j] > max_ui) max_ui = tmp[j];
+   }
+#endif
+
+   for (; i < count; i++) {
+      if (restart && indices[i] == restartIndex)
+         continue;
+      if (indices[i] > max_ui) max_ui = indices[i];
+      if (indices[i] < min_ui) min_ui = indices[i];
+   }
+
+   *min_index = min_ui;
+   *max_index = max_ui;
+}
+
+
+/**
+ * Look for the index range of the given draw among those remembered for
+ * the buffer object.  The buffer may be shared with other contexts, the
+ * cache is only accessed with its mutex held.
+ */
+static GLboolean
+find_cached_index_range(struct gl_buffer_object *obj,
+                        GLintptr offset, GLuint count, GLenum type,
+                        GLboolean restart, GLuint restartIndex,
+                        GLuint *min_index, GLuint *max_index)
+{
+   GLboolean found = GL_FALSE;
+   GLuint i;
+
+   _glthread_LOCK_MUTEX(obj->Mutex);
+   for (i = 0; i < MAX_INDEX_RANGE_CACHE; i++) {
+      const struct gl_index_range *r = &obj->IndexRanges[i];
+      if (r->Count == count &&
+          r->Offset == offset &&
+          r->Type == type &&
+          r->Restart == restart &&
+          (!restart || r->RestartIndex == restartIndex)) {
+         *min_index = r->Min;
+         *max_index = r->Max;
+         found = GL_TRUE;
+         break;
+      }
+   }
+   _glthread_UNLOCK_MUTEX(obj->Mutex);
+   return found;
+}
+
+
+/**
+ * Remember the index range of a draw, replacing the oldest entry.
+ */
+static void
+cache_index_range(struct gl_buffer_object *obj,
+                  GLintptr offset, GLuint count, GLenum type,
+                  GLboolean restart, GLuint restartIndex,
+                  GLuint min_index, GLuint max_index)
+{
+   struct gl_index_range *r;
+
+   _glthread_LOCK_MUTEX(obj->Mutex);
+   r = &obj->IndexRanges[obj->NextIndexRange];
+   r->Offset = offset;
+   r->Count = count;
+   r->Type = type;
+   r->Restart = restart;
+   r->RestartIndex = restartIndex;
+   r->Min = min_index;
+   r->Max = max_index;
+
+   obj->NextIndexRange = (obj->NextIndexRange + 1) % MAX_INDEX_RANGE_CACHE;
+   _glthread_UNLOCK_MUTEX(obj->Mutex);
+}
+
+
 /**
  * Compute min and max elements by scanning the index buffer for
  * glDraw[Range]Elements() calls.
  * If primitive restart is enabled, we need to ignore restart
  * indexes when computing min/max.
+ *
+ * The result is remembered in the buffer object, so drawing the same
+ * range of a static index buffer again doesn't need to map and scan it.
+ * The cached ranges are thrown away whenever the buffer's contents change
+ * (see _mesa_bufferobj_invalidate_index_ranges()).
  */
 void
 vbo_get_minmax_index(struct gl_context *ctx,
@@ -91,8 +340,14 @@ vbo_get_minmax_index(struct gl_context *ctx,
    const GLboolean restart = ctx->Array.PrimitiveRestart;
    const GLuint restartIndex = ctx->Array.RestartIndex;
    const GLuint count = prim->count;
+   const GLboolean use_cache = _mesa_is_bufferobj(ib->obj) &&
+                               !ib->obj->GPUWritten && count > 0;
    const void *indices;
-   GLuint i;
+
+   if (use_cache &&
+       find_cached_index_range(ib->obj, (GLintptr) ib->ptr, count, ib->type,
+                               restart, restartIndex, min_index, max_index))
+      return;
 
    if (_mesa_is_bufferobj(ib->obj)) {
       unsigned map_size;
@@ -119,72 +374,18 @@ vbo_get_minmax_index(struct gl_context *ctx,
    }
 
    switch (ib->type) {
-   case GL_UNSIGNED_INT: {
-      const GLuint *ui_indices = (const GLuint *)indices;
-      GLuint max_ui = 0;
-      GLuint min_ui = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (ui_indices[i] != restartIndex) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
-         }
-      }
-      else {
-         for (i = 0; i < count; i++) {
-            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-         }
-      }
-      *min_index = min_ui;
-      *max_index = max_ui;
+   case GL_UNSIGNED_INT:
+      minmax_uint((const GLuint *) indices, count, restart, restartIndex,
+                  min_index, max_index);
       break;
-   }
-   case GL_UNSIGNED_SHORT: {
-      const GLushort *us_indices = (const GLushort *)indices;
-      GLuint max_us = 0;
-      GLuint min_us = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (us_indices[i] != restartIndex) {
-               if (us_indices[i] > max_us) max_us = us_indices[i];
-               if (us_indices[i] < min_us) min_us = us_indices[i];
-            }
-         }
-      }
-      else {
-         for (i = 0; i < count; i++) {
-            if (us_indices[i] > max_us) max_us = us_indices[i];
-            if (us_indices[i] < min_us) min_us = us_indices[i];
-         }
-      }
-      *min_index = min_us;
-      *max_index = max_us;
+   case GL_UNSIGNED_SHORT:
+      minmax_ushort((const GLushort *) indices, count, restart, restartIndex,
+                    min_index, max_index);
       break;
-   }
-   case GL_UNSIGNED_BYTE: {
-      const GLubyte *ub_indices = (const GLubyte *)indices;
-      GLuint max_ub = 0;
-      GLuint min_ub = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (ub_indices[i] != restartIndex) {
-               if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
-               if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
-            }
-         }
-      }
-      else {
-         for (i = 0; i < count; i++) {
-            if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
-            if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
-         }
-      }
-      *min_index = min_ub;
-      *max_index = max_ub;
+   case GL_UNSIGNED_BYTE:
+      minmax_ubyte((const GLubyte *) indices, count, restart, restartIndex,
+                   min_index, max_index);
       break;
-   }
    default:
       assert(0);
       break;
@@ -193,6 +394,10 @@ vbo_get_minmax_index(struct gl_context *ctx,
    if (_mesa_is_bufferobj(ib->obj)) {
       ctx->Driver.UnmapBuffer(ctx, ib->obj);
    }
+
+   if (use_cache)
+      cache_index_range(ib->obj, (GLintptr) ib->ptr, count, ib->type,
+                        restart, restartIndex, *min_index, *max_index);
 }
 
 
@@ -588,6 +793,7 @@ vbo_draw_arrays(struct gl_context *ctx, GLenum mode, GLint start,
    struct vbo_context *vbo = vbo_context(ctx);
    struct vbo_exec_context *exec = &vbo->exec;
    struct _mesa_prim prim[2];
+   const GLuint64 prof_start = _mesa_call_profile_begin(ctx);
 
    bind_arrays(ctx);
 
@@ -654,6 +860,8 @@ vbo_draw_arrays(struct gl_context *ctx, GLenum mode, GLint start,
       vbo->draw_prims(ctx, exec->array.inputs, prim, 1, NULL,
                       GL_TRUE, start, start + count - 1);
    }
+
+   _mesa_call_profile_end(ctx, MESA_PROF_DRAW_ARRAYS, prof_start);
 }
 
 
@@ -796,6 +1004,7 @@ vbo_validated_drawrangeelements(struct gl_context *ctx, GLenum mode,
    struct vbo_exec_context *exec = &vbo->exec;
    struct _mesa_index_buffer ib;
    struct _mesa_prim prim[1];
+   GLuint64 prof_start;
 
    FLUSH_CURRENT( ctx, 0 );
 
@@ -803,6 +1012,8 @@ vbo_validated_drawrangeelements(struct gl_context *ctx, GLenum mode,
       return;
    }
 
+   prof_start = _mesa_call_profile_begin(ctx);
+
    bind_arrays( ctx );
 
    /* check for dirty state again */
@@ -859,6 +1070,8 @@ vbo_validated_drawrangeelements(struct gl_context *ctx, GLenum mode,
    check_buffers_are_unmapped(exec->array.inputs);
    vbo->draw_prims( ctx, exec->array.inputs, prim, 1, &ib,
 		    index_bounds_valid, start, end );
+
+   _mesa_call_profile_end(ctx, MESA_PROF_DRAW_ELEMENTS, prof_start);
 }
 
 
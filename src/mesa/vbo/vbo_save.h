@@ -147,6 +147,7 @@ struct vbo_save_context {
    GLuint max_vert;
    GLboolean dangling_attr_ref;
    GLboolean have_materials;
+   GLboolean no_current_update;	   /* of the last compiled vertex list */
 
    GLuint opcode_vertex_list;
 
@@ -322,6 +322,8 @@ _save_compile_vertex_list(struct gl_context *ctx)
    node->vertex_store->refcount++;
    node->prim_store->refcount++;
 
+   save->no_current_update = node->prim[0].no_current_update;
+
    if (node->prim[0].no_current_update) {
       node->current_size = 0;
       node->current_data = NULL;
@@ -483,15 +485,30 @@ _save_wrap_filled_vertex(struct gl_context *ctx)
 }
 
 
+/**
+ * Copy the last vertex's attributes to ListState.
+ *
+ * A vertex list replays without updating the current values if its first
+ * primitive says so.  The values of such a list are still carried over to
+ * the following vertices, but their sizes are cleared so that dlist.c
+ * doesn't take them for the current values when looking for redundant
+ * attribute calls.
+ */
 static void
 _save_copy_to_current(struct gl_context *ctx)
 {
    struct vbo_save_context *save = &vbo_context(ctx)->save;
+   GLboolean no_current_update;
    GLuint i;
 
+   if (save->prim_count)
+      no_current_update = save->prim[0].no_current_update;
+   else
+      no_current_update = save->no_current_update;
+
    for (i = VBO_ATTRIB_POS + 1; i < VBO_ATTRIB_MAX; i++) {
       if (save->attrsz[i]) {
-         save->currentsz[i][0] = save->attrsz[i];
+         save->currentsz[i][0] = no_current_update ? 0 : save->attrsz[i];
          COPY_CLEAN_4V(save->current[i], save->attrsz[i], save->attrptr[i]);
       }
    }
@@ -848,6 +865,13 @@ _save_End(void)
       assert(save->copied.nr == 0);
    }
 
+   /* Keep ListState up to date even though the vertices aren't flushed
+    * yet, so dlist.c can tell whether a following glColor, etc. is
+    * redundant.  Lists that don't update the current values at replay
+    * clear the tracked sizes instead.
+    */
+   _save_copy_to_current(ctx);
+
    /* Swap out this vertex format while outside begin/end.  Any color,
     * etc. received between here and the next begin will be compiled
     * as opcodes.
@@ -1278,6 +1302,7 @@ vbo_save_NewList(struct gl_context *ctx, GLuint list, GLenum mode)
 
    _save_reset_vertex(ctx);
    _save_reset_counters(ctx);
+   save->no_current_update = GL_FALSE;
    ctx->Driver.SaveNeedFlush = 0;
 }
 
@@ -1358,6 +1383,69 @@ vbo_destroy_vertex_list(struct gl_context *ctx, void *data)
 }
 
 
+/**
+ * Fold vertex list \p next_data into \p data, which comes right before it
+ * in the display list.  This works when both were compiled one after the
+ * other into the same vertex and primitive stores with the same vertex
+ * layout, as happens when only redundant state changes were between them.
+ */
+static GLboolean
+vbo_merge_vertex_list(struct gl_context *ctx, void *data, void *next_data)
+{
+   struct vbo_save_vertex_list *node = (struct vbo_save_vertex_list *) data;
+   struct vbo_save_vertex_list *next =
+      (struct vbo_save_vertex_list *) next_data;
+   GLuint i;
+
+   if (node->vertex_store != next->vertex_store ||
+       node->prim_store != next->prim_store ||
+       node->vertex_size != next->vertex_size ||
+       memcmp(node->attrsz, next->attrsz, sizeof(node->attrsz)) != 0)
+      return GL_FALSE;
+
+   /* The vertices and primitives must follow on from the first list's. */
+   if (next->buffer_offset != node->buffer_offset +
+       node->count * node->vertex_size * sizeof(GLfloat) ||
+       next->prim != node->prim + node->prim_count)
+      return GL_FALSE;
+
+   /* Primitives split across vertex lists, and lists that don't update
+    * the current values, are left alone.
+    */
+   if (node->prim_count == 0 || next->prim_count == 0 ||
+       !node->prim[node->prim_count - 1].end ||
+       !next->prim[0].begin ||
+       next->wrap_count != 0 ||
+       node->prim[0].no_current_update ||
+       next->prim[0].no_current_update)
+      return GL_FALSE;
+
+   for (i = 0; i < next->prim_count; i++)
+      next->prim[i].start += node->count;
+
+   node->count += next->count;
+   node->prim_count += next->prim_count;
+   node->dangling_attr_ref |= next->dangling_attr_ref;
+
+   /* The last vertex is now the second list's */
+   if (node->current_data)
+      FREE(node->current_data);
+   node->current_data = next->current_data;
+   next->current_data = NULL;
+
+   /* Drop the second list's references; the first one still holds its
+    * own on the same stores.
+    */
+   next->vertex_store->refcount--;
+   next->prim_store->refcount--;
+   assert(node->vertex_store->refcount != 0);
+   assert(node->prim_store->refcount != 0);
+
+   (void) ctx;
+   return GL_TRUE;
+}
+
+
 static void
 vbo_print_vertex_list(struct gl_context *ctx, void *data)
 {
@@ -1418,7 +1506,8 @@ vbo_save_api_init(struct vbo_save_context *save)
                                sizeof(struct vbo_save_vertex_list),
                                vbo_save_playback_vertex_list,
                                vbo_destroy_vertex_list,
-                               vbo_print_vertex_list);
+                               vbo_print_vertex_list,
+                               vbo_merge_vertex_list);
 
    ctx->Driver.NotifySaveBegin = vbo_save_NotifyBegin;
 